@@ -0,0 +1,96 @@
+// Page-fault and throughput comparison for frame-sized buffers allocated
+// per frame with malloc versus HugePageArena in each huge page mode.
+//
+// Usage: bench_huge_pages [width height frames]
+
+#include "ufra/huge_page_allocator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <sys/resource.h>
+
+namespace {
+
+long minorFaults() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+}
+
+// Stand-in for per-frame work: write the input copy, read it back for output
+uint64_t touchFrame(unsigned char* input, unsigned char* output, size_t bytes, int frame) {
+    std::memset(input, frame & 0xFF, bytes);
+    uint64_t checksum = 0;
+    for (size_t i = 0; i < bytes; i += 64) {
+        output[i] = static_cast<unsigned char>(input[i] + 1);
+        checksum += output[i];
+    }
+    return checksum;
+}
+
+void report(const std::string& name, size_t bytes, int frames,
+            const std::function<void*(size_t)>& alloc, const std::function<void(void*)>& release) {
+    uint64_t checksum = 0;
+    long faults_before = minorFaults();
+    auto start = std::chrono::steady_clock::now();
+
+    for (int frame = 0; frame < frames; ++frame) {
+        auto* input = static_cast<unsigned char*>(alloc(bytes));
+        auto* output = static_cast<unsigned char*>(alloc(bytes));
+        checksum += touchFrame(input, output, bytes, frame);
+        release(output);
+        release(input);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long faults = minorFaults() - faults_before;
+    double gbps = 2.0 * bytes * frames / seconds / 1e9;
+
+    std::printf("%-18s %10ld faults %8.1f faults/frame %8.2f ms/frame %7.2f GB/s  (checksum %llu)\n",
+                name.c_str(), faults, static_cast<double>(faults) / frames,
+                seconds * 1000.0 / frames, gbps, static_cast<unsigned long long>(checksum));
+}
+
+const char* modeName(ufra::HugePageMode mode) {
+    switch (mode) {
+        case ufra::HugePageMode::EXPLICIT: return "explicit";
+        case ufra::HugePageMode::TRANSPARENT: return "transparent";
+        default: return "none";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int width = 3840, height = 2160, frames = 200;
+    if (argc >= 4) {
+        width = std::atoi(argv[1]);
+        height = std::atoi(argv[2]);
+        frames = std::atoi(argv[3]);
+    }
+    const size_t bytes = static_cast<size_t>(width) * height * 3;
+
+    std::printf("Frame %dx%d RGB (%.1f MB), %d frames, 2 buffers per frame\n",
+                width, height, bytes / (1024.0 * 1024.0), frames);
+
+    // glibc returns blocks of this size to the kernel on free, so every
+    // frame faults its buffers in again
+    report("malloc", bytes, frames,
+           [](size_t n) { return std::malloc(n); },
+           [](void* p) { std::free(p); });
+
+    for (auto mode : {ufra::HugePageMode::NONE, ufra::HugePageMode::TRANSPARENT,
+                      ufra::HugePageMode::EXPLICIT}) {
+        ufra::HugePageArena arena;
+        arena.setMode(mode);
+        report(std::string("arena/") + modeName(mode), bytes, frames,
+               [&arena](size_t n) { return arena.allocate(n); },
+               [&arena](void* p) { arena.deallocate(p); });
+        std::printf("%-18s mapped as %s, %zu reuses\n", "", modeName(arena.getLastMappingMode()),
+                    arena.getReuseCount());
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Cost of rendering out of process: per-frame latency added by ufra_server's
+// transport (input copy, socket round trip, wake-ups) over calling the
+// handler in process. The handler only copies the frame, so everything
+// above the in-process column is transport. Concurrent clients show what
+// cross-client batching costs and saves.
+//
+// Usage: bench_render_service [frames] [socket]
+
+#include "ufra/render_service.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace ufra::service;
+
+namespace {
+
+void copyFrames(std::vector<RenderJob*>& jobs) {
+    for (RenderJob* job : jobs) {
+        std::memcpy(job->output.data, job->input.data, job->input.bytes());
+        job->success = true;
+    }
+}
+
+double percentile(std::vector<double> values, double fraction) {
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()))];
+}
+
+double mean(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    return sum / values.size();
+}
+
+struct Samples {
+    std::vector<double> round_trip;
+    std::vector<double> overhead;
+};
+
+// One client rendering `frames` frames back to back
+void runClient(const std::string& socket_path, int width, int height, int frames, Samples& samples) {
+    RenderClient client;
+    if (!client.connect(socket_path)) {
+        std::fprintf(stderr, "%s\n", client.getLastError().c_str());
+        return;
+    }
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 3, 128);
+    FrameView input{pixels.data(), width, height, 3, static_cast<size_t>(width) * 3};
+    FrameView output;
+    for (int i = 0; i < frames + 3; ++i) {
+        std::map<std::string, float> metrics;
+        if (!client.render(input, JobSettings(), output, &metrics)) {
+            std::fprintf(stderr, "%s\n", client.getLastError().c_str());
+            return;
+        }
+        if (i >= 3) {   // First frames map the buffer and fault its pages in
+            samples.round_trip.push_back(metrics["client_round_trip_ms"]);
+            samples.overhead.push_back(metrics["transport_overhead_ms"]);
+        }
+    }
+}
+
+double inProcessMs(int width, int height, int frames) {
+    std::vector<uint8_t> input(static_cast<size_t>(width) * height * 3, 128);
+    std::vector<uint8_t> output(input.size());
+    RenderJob job;
+    job.input = FrameView{input.data(), width, height, 3, static_cast<size_t>(width) * 3};
+    job.output = job.input;
+    job.output.data = output.data();
+    std::vector<RenderJob*> jobs{&job};
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        copyFrames(jobs);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+    const std::string socket_path =
+        argc > 2 ? argv[2] : "/tmp/ufra-bench-" + std::to_string(getpid()) + ".sock";
+
+    RenderServer server;
+    ServerOptions options;
+    options.socket_path = socket_path;
+    options.batch_window_us = 0;   // Batch only what is already queued
+    if (!server.start(options, copyFrames)) {
+        return 1;
+    }
+
+    std::printf("%-11s %7s %12s %12s %12s %12s\n", "frame", "clients", "in-proc ms", "round ms",
+                "overhead ms", "p99 ovh ms");
+    const int sizes[][2] = {{1280, 720}, {1920, 1080}, {3840, 2160}};
+    for (const auto& size : sizes) {
+        const double baseline = inProcessMs(size[0], size[1], std::max(1, frames / 4));
+        for (int clients : {1, 4}) {
+            std::vector<Samples> samples(clients);
+            std::vector<std::thread> threads;
+            for (int c = 0; c < clients; ++c) {
+                threads.emplace_back(runClient, socket_path, size[0], size[1], frames, std::ref(samples[c]));
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            Samples all;
+            for (const auto& s : samples) {
+                all.round_trip.insert(all.round_trip.end(), s.round_trip.begin(), s.round_trip.end());
+                all.overhead.insert(all.overhead.end(), s.overhead.begin(), s.overhead.end());
+            }
+            if (all.round_trip.empty()) {
+                return 1;
+            }
+            const std::string label = std::to_string(size[0]) + "x" + std::to_string(size[1]);
+            std::printf("%-11s %7d %12.3f %12.3f %12.3f %12.3f\n", label.c_str(), clients, baseline,
+                        mean(all.round_trip), mean(all.overhead), percentile(all.overhead, 0.99));
+        }
+    }
+
+    auto stats = server.getStats();
+    std::printf("\nbatches: %.0f, mean batch %.2f, max batch %.0f\n", stats["batches"], stats["mean_batch_size"],
+                stats["max_batch_size"]);
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Tensor runtime throughput: reference kernels versus packed direct
+// convolutions (one thread and all threads), and cv::dnn on the same graph
+// when OpenCV is available. Synthetic MobileNet- and U-Net-shaped networks
+// are built in memory; ONNX files given on the command line are run too.
+//
+// Usage: bench_tensor_runtime [iterations] [model.onnx ...]
+
+#include "synthetic_graphs.h"
+#include "ufra/tensor_runtime.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+
+#ifdef OPENCV_FOUND
+#include <opencv2/dnn.hpp>
+#endif
+
+using namespace ufra::runtime;
+using ufra::bench::mobileNet;
+using ufra::bench::randomInput;
+using ufra::bench::uNet;
+
+namespace {
+
+float maxAbsDiff(const std::vector<float>& a, const float* b, size_t size) {
+    if (a.size() != size) {
+        return INFINITY;
+    }
+    float diff = 0.0f;
+    for (size_t i = 0; i < size; ++i) {
+        diff = std::max(diff, std::fabs(a[i] - b[i]));
+    }
+    return diff;
+}
+
+double timeMs(int iterations, const std::function<void()>& run) {
+    run();   // Warm-up: first-touch allocations, weight packing caches
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        run();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+void benchmark(const std::string& name, const Graph& graph, int iterations) {
+    std::printf("%s\n", name.c_str());
+    if (graph.inputs.empty()) {
+        std::printf("  no graph inputs\n");
+        return;
+    }
+    const Tensor input = randomInput(graph.inputs[0]);
+    std::vector<Tensor> expected;
+
+    auto runNetwork = [&](const char* label, bool optimize, int threads) {
+        Network net;
+        net.enableOptimizations(optimize);
+        net.setNumThreads(threads);
+        if (!net.load(graph)) {
+            std::printf("  %-22s load failed: %s\n", label, net.getLastError().c_str());
+            return;
+        }
+        net.setInput(input);
+        std::vector<Tensor> outputs;
+        bool ok = true;
+        double ms = timeMs(iterations, [&] { ok = ok && net.forward(outputs); });
+        if (!ok) {
+            std::printf("  %-22s forward failed: %s\n", label, net.getLastError().c_str());
+            return;
+        }
+        if (expected.empty()) {
+            expected = outputs;
+        }
+        std::printf("  %-22s %9.2f ms  weights %6.1f MB  max diff %.2e\n", label, ms,
+                    net.getWeightBytes() / (1024.0 * 1024.0),
+                    maxAbsDiff(expected[0].data, outputs[0].data.data(), outputs[0].size()));
+    };
+
+    const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    runNetwork("reference", false, 1);
+    runNetwork("packed, 1 thread", true, 1);
+    runNetwork(("packed, all " + std::to_string(cores) + " cores").c_str(), true, 0);
+
+#ifdef OPENCV_FOUND
+    std::string bytes;
+    serializeOnnxModel(graph, bytes);
+    try {
+        cv::dnn::Net net = cv::dnn::readNetFromONNX(bytes.data(), bytes.size());
+        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        std::vector<int> dims(input.shape.begin(), input.shape.end());
+        cv::Mat blob(static_cast<int>(dims.size()), dims.data(), CV_32F, const_cast<float*>(input.data.data()));
+        cv::Mat result;
+        double ms = timeMs(iterations, [&] {
+            net.setInput(blob);
+            result = net.forward();
+        });
+        float diff = expected.empty() ? NAN : maxAbsDiff(expected[0].data, result.ptr<float>(), result.total());
+        std::printf("  %-22s %9.2f ms  %s threads   max diff %.2e\n", "cv::dnn", ms,
+                    std::to_string(cv::getNumThreads()).c_str(), diff);
+    }
+    catch (const cv::Exception& e) {
+        std::printf("  %-22s failed: %s\n", "cv::dnn", e.what());
+    }
+#else
+    std::printf("  %-22s skipped (built without OpenCV)\n", "cv::dnn");
+#endif
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10;
+
+    benchmark("mobilenet 1x3x160x160", mobileNet(), iterations);
+    benchmark("unet 1x3x128x128", uNet(), iterations);
+
+    for (int i = 2; i < argc; ++i) {
+        Graph graph;
+        std::string error;
+        if (!readOnnxModel(argv[i], graph, error)) {
+            std::fprintf(stderr, "%s: %s\n", argv[i], error.c_str());
+            continue;
+        }
+        benchmark(argv[i], graph, iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,433 @@
+// Performance regression gate. Times fixed CPU-only scenarios (the synthetic
+// networks on the tensor runtime, the per-frame image kernels and, with
+// OpenCV, the whole engine on stub models) and compares them with golden
+// timings stored per machine in a baseline file.
+//
+// Each scenario is sampled repeatedly and summarised by its median and a
+// distribution-free 95% confidence interval of the median. A scenario
+// regresses only when that whole interval lies above the baseline median
+// plus the tolerance plus the baseline's own noise, and a second measurement
+// agrees, so a busy build machine does not fail the run.
+//
+// Usage: perf_regression [--baseline FILE] [--update] [--samples N]
+//                        [--tolerance FRACTION] [--filter SUBSTRING]
+//
+// Exit status: 0 pass, 1 regression or, with an explicit --baseline, no
+// golden timings for this machine in it, 2 bad arguments or I/O error,
+// 77 no baseline for this machine without --baseline (skipped by ctest).
+
+#include "synthetic_graphs.h"
+#include "ufra/image_kernels.h"
+#include "ufra/roi_skip_cache.h"
+#include "ufra/scene_cut_detector.h"
+#include "ufra/tensor_runtime.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef OPENCV_FOUND
+#include "ufra/engine.h"
+#include "ufra/stub_network.h"
+#endif
+
+namespace {
+
+using Body = std::function<void()>;
+
+struct Scenario {
+    std::string name;
+    std::function<Body()> prepare;   // Allocates inputs, returns the timed body
+};
+
+struct Timing {
+    double median = 0.0;   // Milliseconds per iteration
+    double ci_low = 0.0;
+    double ci_high = 0.0;
+};
+
+std::vector<uint8_t> pattern(size_t bytes, uint32_t seed) {
+    std::vector<uint8_t> data(bytes);
+    for (uint8_t& v : data) {
+        seed = seed * 1664525u + 1013904223u;
+        v = static_cast<uint8_t>(seed >> 24);
+    }
+    return data;
+}
+
+// Smooth gradient with a moving highlight, so flow and scene-cut scores do
+// real work instead of short-circuiting on noise or flat frames
+std::vector<uint8_t> frame(int width, int height, int channels, int shift) {
+    std::vector<uint8_t> data(static_cast<size_t>(width) * height * channels);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int dx = x - width / 2 - shift, dy = y - height / 2;
+            int highlight = std::max(0, 96 - (dx * dx + dy * dy) / (width / 4 + 1));
+            for (int c = 0; c < channels; ++c) {
+                data[(static_cast<size_t>(y) * width + x) * channels + c] =
+                    static_cast<uint8_t>(std::min(255, (x * 160 / width + y * 64 / height + c * 16 + highlight)));
+            }
+        }
+    }
+    return data;
+}
+
+Body network(ufra::runtime::Graph graph) {
+    auto net = std::make_shared<ufra::runtime::Network>();
+    net->setNumThreads(1);   // Thread scheduling is the largest noise source
+    auto outputs = std::make_shared<std::vector<ufra::runtime::Tensor>>();
+    const ufra::runtime::Tensor input = ufra::bench::randomInput(graph.inputs[0]);
+    if (!net->load(std::move(graph))) {
+        std::fprintf(stderr, "network load failed: %s\n", net->getLastError().c_str());
+        return nullptr;
+    }
+    net->setInput(input);
+    return [net, outputs] { net->forward(*outputs); };
+}
+
+std::vector<Scenario> scenarios() {
+    using namespace ufra::kernels;
+    std::vector<Scenario> list;
+
+    list.push_back({"runtime_unet_128", [] { return network(ufra::bench::uNet()); }});
+    list.push_back({"runtime_mobilenet_160", [] { return network(ufra::bench::mobileNet()); }});
+
+    list.push_back({"resize_4k_to_1080p", [] {
+        auto src = std::make_shared<std::vector<uint8_t>>(pattern(3840 * 2160 * 3, 1));
+        auto dst = std::make_shared<std::vector<uint8_t>>(1920 * 1080 * 3);
+        return Body([src, dst] {
+            resizeBilinear(src->data(), 3840, 2160, 3840 * 3, 3, dst->data(), 1920, 1080, 1920 * 3);
+        });
+    }});
+
+    list.push_back({"pack_planar_512", [] {
+        auto src = std::make_shared<std::vector<uint8_t>>(pattern(512 * 512 * 3, 2));
+        auto dst = std::make_shared<std::vector<float>>(512 * 512 * 3);
+        return Body([src, dst] {
+            const float mean[3] = {104.0f, 117.0f, 123.0f};
+            packPlanar(src->data(), 512, 512, 512 * 3, 3, true, mean, 1.0f / 255.0f, dst->data());
+        });
+    }});
+
+    list.push_back({"blend_masked_512", [] {
+        auto src = std::make_shared<std::vector<uint8_t>>(pattern(512 * 512 * 3, 3));
+        auto alpha = std::make_shared<std::vector<uint8_t>>(pattern(512 * 512, 4));
+        auto dst = std::make_shared<std::vector<uint8_t>>(pattern(512 * 512 * 3, 5));
+        return Body([src, alpha, dst] {
+            blendMasked(src->data(), 512 * 3, alpha->data(), 512, 512, 512, 3, dst->data(), 512 * 3);
+        });
+    }});
+
+    list.push_back({"flow_lk_128", [] {
+        auto reference = std::make_shared<std::vector<uint8_t>>(frame(128, 128, 1, 0));
+        auto target = std::make_shared<std::vector<uint8_t>>(frame(128, 128, 1, 3));
+        auto flow = std::make_shared<std::vector<float>>(128 * 128 * 2);
+        return Body([reference, target, flow] {
+            computeFlowLK(reference->data(), 128, target->data(), 128, 128, 128, 3, 2, 3, flow->data());
+        });
+    }});
+
+    list.push_back({"scene_cut_4k", [] {
+        auto a = std::make_shared<std::vector<uint8_t>>(frame(3840, 2160, 3, 0));
+        auto b = std::make_shared<std::vector<uint8_t>>(frame(3840, 2160, 3, 40));
+        auto detector = std::make_shared<ufra::SceneCutDetector>();
+        auto flip = std::make_shared<bool>(false);
+        return Body([a, b, detector, flip] {
+            *flip = !*flip;
+            detector->update((*flip ? a : b)->data(), 3840, 2160, 3840 * 3, 3);
+        });
+    }});
+
+    list.push_back({"content_hash_4k", [] {
+        auto src = std::make_shared<std::vector<uint8_t>>(pattern(3840 * 2160 * 3, 6));
+        return Body([src] {
+            volatile uint64_t hash = contentHash(src->data(), 3840 * 3, 2160, 3840 * 3);
+            (void)hash;
+        });
+    }});
+
+    list.push_back({"roi_signature_512", [] {
+        auto src = std::make_shared<std::vector<uint8_t>>(frame(512, 512, 3, 0));
+        return Body([src] {
+            volatile uint64_t hash = ufra::computeRoiSignature(src->data(), 512, 512, 512 * 3, 3).hash;
+            (void)hash;
+        });
+    }});
+
+#ifdef OPENCV_FOUND
+    // Engine overhead around zero-cost stub networks: detection decode,
+    // tracking, crops, parsing, generation and compositing of two faces
+    list.push_back({"pipeline_stub_640", [] {
+        std::shared_ptr<ufra::Engine> engine = ufra::createEngine();
+        ufra::ModelConfig config;
+        config.backend = ufra::GPUBackend::CPU_FALLBACK;
+        config.batch_size = 1;
+        if (!engine->initialize(config) || !engine->loadModels(ufra::stubModelDir())) {
+            return Body();
+        }
+        auto context = std::make_shared<ufra::FrameContext>();
+        context->input_frame = ufra::renderStubFrame(640, 480, 2);
+        context->controls.target_age = 70.0f;
+        context->mode = ufra::ProcessingMode::FEEDFORWARD;
+        return Body([engine, context] {
+            ++context->frame_number;
+            engine->processFrame(*context);
+        });
+    }});
+#endif
+
+    return list;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Median and the order-statistic 95% interval of the median (normal
+// approximation to the binomial ranks; needs no distribution assumption)
+Timing measure(const Body& body, int samples) {
+    body();   // Warm-up: first-touch allocations, packed weights
+
+    // Enough iterations per sample that timer resolution does not matter
+    int iterations = 1;
+    for (;;) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            body();
+        }
+        if (elapsedMs(start) >= 10.0 || iterations >= (1 << 16)) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    std::vector<double> times;
+    times.reserve(samples);
+    for (int s = 0; s < samples; ++s) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            body();
+        }
+        times.push_back(elapsedMs(start) / iterations);
+    }
+    std::sort(times.begin(), times.end());
+
+    const int n = samples;
+    const double spread = 1.96 * std::sqrt(static_cast<double>(n));
+    const int low = std::max(1, static_cast<int>(std::floor((n - spread) / 2.0)));
+    const int high = std::min(n, static_cast<int>(std::ceil(1.0 + (n + spread) / 2.0)));
+
+    Timing timing;
+    timing.median = n % 2 ? times[n / 2] : 0.5 * (times[n / 2 - 1] + times[n / 2]);
+    timing.ci_low = times[low - 1];
+    timing.ci_high = times[high - 1];
+    return timing;
+}
+
+// Golden timings are only comparable on the same CPU model
+std::string hostKey() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    std::string model = "unknown";
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0 && line.find(':') != std::string::npos) {
+            model = line.substr(line.find(':') + 1);
+            break;
+        }
+    }
+    std::string key;
+    for (char c : model) {
+        bool keep = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' || c == '-';
+        if (keep) {
+            key += c;
+        }
+        else if (!key.empty() && key.back() != '_') {
+            key += '_';
+        }
+    }
+    while (!key.empty() && key.back() == '_') {
+        key.pop_back();
+    }
+    return key.empty() ? "unknown" : key;
+}
+
+// Baseline lines: scenario host median_ms ci_low_ms ci_high_ms
+using Baseline = std::map<std::pair<std::string, std::string>, Timing>;
+
+bool readBaseline(const std::string& path, Baseline& baseline) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string scenario, host;
+        Timing timing;
+        if (fields >> scenario >> host >> timing.median >> timing.ci_low >> timing.ci_high) {
+            baseline[{scenario, host}] = timing;
+        }
+    }
+    return true;
+}
+
+bool writeBaseline(const std::string& path, const Baseline& baseline) {
+    const std::string temp = path + ".tmp";
+    {
+        std::ofstream out(temp);
+        if (!out) {
+            return false;
+        }
+        out << "# Golden timings for perf_regression, per CPU model. Regenerate with\n"
+               "# `cmake --build <dir> --target perf_baseline` on an idle machine.\n"
+               "# ctest registers the gate only on CPU models listed here.\n"
+               "# scenario host median_ms ci_low_ms ci_high_ms\n";
+        char buffer[64];
+        for (const auto& entry : baseline) {
+            const Timing& t = entry.second;
+            std::snprintf(buffer, sizeof(buffer), "%.4f %.4f %.4f", t.median, t.ci_low, t.ci_high);
+            out << entry.first.first << ' ' << entry.first.second << ' ' << buffer << '\n';
+        }
+        if (!out) {
+            return false;
+        }
+    }
+    return std::rename(temp.c_str(), path.c_str()) == 0;
+}
+
+// Regressed when the current interval lies wholly above the baseline median
+// plus the tolerance, widened by the baseline's own upper noise
+bool regressed(const Timing& current, const Timing& golden, double tolerance) {
+    const double limit = golden.median * (1.0 + tolerance) + (golden.ci_high - golden.median);
+    return current.ci_low > limit;
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "Usage: perf_regression [--baseline FILE] [--update] [--samples N]\n"
+                 "                       [--tolerance FRACTION] [--filter SUBSTRING]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string baseline_path = "perf_baseline.txt";
+    std::string filter;
+    bool explicit_baseline = false;   // A named baseline must cover this host
+    bool update = false;
+    int samples = 15;
+    double tolerance = 0.15;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--baseline" && has_value) {
+            baseline_path = argv[++i];
+            explicit_baseline = true;
+        }
+        else if (arg == "--update") {
+            update = true;
+        }
+        else if (arg == "--samples" && has_value) {
+            samples = std::max(5, std::atoi(argv[++i]));
+        }
+        else if (arg == "--tolerance" && has_value) {
+            tolerance = std::max(0.0, std::atof(argv[++i]));
+        }
+        else if (arg == "--filter" && has_value) {
+            filter = argv[++i];
+        }
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    Baseline baseline;
+    if (!readBaseline(baseline_path, baseline) && !update) {
+        std::printf("No baseline at %s; record one with --update\n", baseline_path.c_str());
+        return explicit_baseline ? 1 : 77;
+    }
+
+    const std::string host = hostKey();
+    std::printf("Host %s, %d samples per scenario, tolerance %.0f%%\n", host.c_str(), samples, tolerance * 100.0);
+    std::printf("%-24s %10s %21s %10s  %s\n", "scenario", "median ms", "95% interval ms", "golden ms", "result");
+
+    int compared = 0;
+    int regressions = 0;
+    for (const Scenario& scenario : scenarios()) {
+        if (!filter.empty() && scenario.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        Body body = scenario.prepare();
+        if (!body) {
+            std::printf("%-24s setup failed\n", scenario.name.c_str());
+            ++regressions;
+            continue;
+        }
+        Timing current = measure(body, samples);
+
+        auto golden = baseline.find({scenario.name, host});
+        const char* result = "recorded";
+        if (update) {
+            baseline[{scenario.name, host}] = current;
+        }
+        else if (golden == baseline.end()) {
+            result = "no baseline";
+        }
+        else {
+            ++compared;
+            result = "ok";
+            if (regressed(current, golden->second, tolerance)) {
+                // Confirm before failing: transient load rarely repeats
+                current = measure(body, samples);
+                if (regressed(current, golden->second, tolerance)) {
+                    result = "REGRESSION";
+                    ++regressions;
+                }
+            }
+            else if (current.ci_high < golden->second.median * (1.0 - tolerance)) {
+                result = "faster (consider --update)";
+            }
+        }
+
+        char interval[32];
+        std::snprintf(interval, sizeof(interval), "[%.3f, %.3f]", current.ci_low, current.ci_high);
+        char reference[16] = "-";
+        if (golden != baseline.end() && !update) {
+            std::snprintf(reference, sizeof(reference), "%.3f", golden->second.median);
+        }
+        std::printf("%-24s %10.3f %21s %10s  %s\n", scenario.name.c_str(), current.median, interval, reference, result);
+        std::fflush(stdout);
+    }
+
+    if (update) {
+        if (!writeBaseline(baseline_path, baseline)) {
+            std::fprintf(stderr, "Failed to write %s\n", baseline_path.c_str());
+            return 2;
+        }
+        std::printf("Baseline written to %s\n", baseline_path.c_str());
+        return 0;
+    }
+    if (regressions > 0) {
+        std::printf("%d scenario(s) regressed\n", regressions);
+        return 1;
+    }
+    if (compared == 0) {
+        std::printf("No golden timings for host %s in %s; record them with --update\n", host.c_str(),
+                    baseline_path.c_str());
+        return explicit_baseline ? 1 : 77;
+    }
+    return 0;
+}
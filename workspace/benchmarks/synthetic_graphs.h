@@ -0,0 +1,146 @@
+#pragma once
+
+// Deterministic synthetic networks shared by the benchmarks and the
+// performance regression harness: fixed-seed weights, no model files.
+
+#include "ufra/tensor_runtime.h"
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ufra {
+namespace bench {
+
+using namespace ufra::runtime;
+
+// Builds Conv -> BatchNormalization -> activation chains with random weights
+class GraphBuilder {
+public:
+    Graph graph;
+
+    std::string conv(const std::string& x, int in_channels, int out_channels, int kernel, int stride,
+                     int group, const std::string& activation) {
+        const std::string id = std::to_string(counter_++);
+        const int64_t oc = out_channels;
+        const float limit = 1.0f / std::sqrt(static_cast<float>(in_channels / group * kernel * kernel));
+        graph.initializers["w" + id] = random({oc, in_channels / group, kernel, kernel}, -limit, limit);
+        graph.initializers["scale" + id] = random({oc}, 0.5f, 1.5f);
+        graph.initializers["shift" + id] = random({oc}, -0.1f, 0.1f);
+        graph.initializers["mean" + id] = random({oc}, -0.1f, 0.1f);
+        graph.initializers["var" + id] = random({oc}, 0.5f, 1.5f);
+
+        Node node = makeNode("Conv", {x, "w" + id}, "conv" + id);
+        node.ints["group"] = group;
+        node.int_lists["kernel_shape"] = {kernel, kernel};
+        node.int_lists["strides"] = {stride, stride};
+        node.int_lists["pads"] = std::vector<int64_t>(4, kernel / 2);
+        graph.nodes.push_back(node);
+        Node bn = makeNode("BatchNormalization",
+                           {"conv" + id, "scale" + id, "shift" + id, "mean" + id, "var" + id}, "bn" + id);
+        graph.nodes.push_back(bn);
+        if (activation.empty()) {
+            return "bn" + id;
+        }
+        Node act = makeNode(activation, {"bn" + id}, "act" + id);
+        if (activation == "Clip") {
+            // ReLU6 as min/max inputs, as opset 11+ exporters write it
+            graph.initializers["min" + id] = Tensor({}, {0.0f});
+            graph.initializers["max" + id] = Tensor({}, {6.0f});
+            act.inputs = {"bn" + id, "min" + id, "max" + id};
+        }
+        graph.nodes.push_back(act);
+        return "act" + id;
+    }
+
+    std::string node(const std::string& op, std::vector<std::string> inputs) {
+        const std::string name = op + std::to_string(counter_++);
+        graph.nodes.push_back(makeNode(op, std::move(inputs), name));
+        return name;
+    }
+
+    std::string upsample(const std::string& x) {
+        if (!graph.initializers.count("scales")) {
+            graph.initializers["roi"] = Tensor({0});
+            graph.initializers["scales"] = Tensor({4}, {1, 1, 2, 2});
+        }
+        return node("Resize", {x, "roi", "scales"});
+    }
+
+    std::string concat(const std::string& a, const std::string& b) {
+        std::string name = node("Concat", {a, b});
+        graph.nodes.back().ints["axis"] = 1;
+        return name;
+    }
+
+private:
+    static Node makeNode(const std::string& op, std::vector<std::string> inputs, const std::string& output) {
+        Node node;
+        node.op_type = op;
+        node.name = output;
+        node.inputs = std::move(inputs);
+        node.outputs = {output};
+        return node;
+    }
+
+    Tensor random(std::vector<int64_t> shape, float lo, float hi) {
+        Tensor t(std::move(shape));
+        for (float& v : t.data) {
+            seed_ = seed_ * 1664525u + 1013904223u;
+            v = lo + (hi - lo) * static_cast<float>(seed_ >> 8) / static_cast<float>(1u << 24);
+        }
+        return t;
+    }
+
+    uint32_t seed_ = 1;
+    int counter_ = 0;
+};
+
+// Depthwise-separable stack in the shape of MobileNetV1 at 160x160
+inline Graph mobileNet() {
+    GraphBuilder b;
+    b.graph.inputs.push_back({"input", {1, 3, 160, 160}});
+    std::string x = b.conv("input", 3, 32, 3, 2, 1, "Clip");
+    const int blocks[][2] = {{64, 1}, {128, 2}, {128, 1}, {256, 2}, {256, 1}, {512, 2},
+                             {512, 1}, {512, 1}, {1024, 2}};
+    int channels = 32;
+    for (const auto& block : blocks) {
+        x = b.conv(x, channels, channels, 3, block[1], channels, "Clip");
+        x = b.conv(x, channels, block[0], 1, 1, 1, "Clip");
+        channels = block[0];
+    }
+    x = b.node("GlobalAveragePool", {x});
+    b.graph.outputs.push_back({x, {}});
+    return std::move(b.graph);
+}
+
+// Encoder/decoder with skip connections, the shape of the parsing and
+// generator networks, at 128x128
+inline Graph uNet() {
+    GraphBuilder b;
+    b.graph.inputs.push_back({"input", {1, 3, 128, 128}});
+    std::string e1 = b.conv(b.conv("input", 3, 32, 3, 1, 1, "Relu"), 32, 32, 3, 1, 1, "Relu");
+    std::string e2 = b.conv(b.conv(e1, 32, 64, 3, 2, 1, "Relu"), 64, 64, 3, 1, 1, "Relu");
+    std::string e3 = b.conv(b.conv(e2, 64, 128, 3, 2, 1, "Relu"), 128, 128, 3, 1, 1, "Relu");
+    std::string d2 = b.conv(b.concat(b.upsample(e3), e2), 192, 64, 3, 1, 1, "LeakyRelu");
+    std::string d1 = b.conv(b.concat(b.upsample(d2), e1), 96, 32, 3, 1, 1, "LeakyRelu");
+    std::string out = b.node("Sigmoid", {b.conv(d1, 32, 3, 1, 1, 1, "")});
+    b.graph.outputs.push_back({out, {}});
+    return std::move(b.graph);
+}
+
+inline Tensor randomInput(const ValueInfo& info) {
+    std::vector<int64_t> shape = info.shape;
+    for (int64_t& d : shape) {
+        d = d > 0 ? d : 1;
+    }
+    Tensor t(shape);
+    for (size_t i = 0; i < t.size(); ++i) {
+        t.data[i] = static_cast<float>((i * 2654435761u) % 1000) / 500.0f - 1.0f;
+    }
+    return t;
+}
+
+} // namespace bench
+} // namespace ufra
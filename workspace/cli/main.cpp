@@ -1,9 +1,16 @@
 #include "ufra/engine.h"
+#include "ufra/render_service.h"
+#include "ufra/image_kernels.h"
 #include <opencv2/opencv.hpp>
+#include <deque>
+#include <iomanip>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
 
 namespace fs = std::filesystem;
 
@@ -14,16 +21,28 @@ void printUsage() {
     std::cout << "  -i, --input <path>      Input video file or image sequence\n";
     std::cout << "  -o, --output <path>     Output video file or image sequence\n";
     std::cout << "  -a, --age <value>       Target age (0-100)\n";
-    std::cout << "  -m, --mode <mode>       Processing mode (feedforward|diffusion|hybrid|auto)\n";
-    std::cout << "  --models <path>         Path to model directory\n";
+    std::cout << "  -m, --mode <mode>       Processing mode (feedforward|diffusion|hybrid|auto|keyframe)\n";
+    std::cout << "  --models <path>         Path to model directory, or stub: for built-in stubs\n";
     std::cout << "  --gpu <backend>         GPU backend (cuda|metal|directml|cpu)\n";
     std::cout << "  --batch-size <size>     Batch size for processing\n";
     std::cout << "  --identity-lock <val>   Identity preservation strength (0.0-1.0)\n";
     std::cout << "  --temporal-stability    Enable temporal stability\n";
+    std::cout << "  --detection-interval <n> Detect faces every nth frame and after cuts, track between\n";
+    std::cout << "  --skip-unchanged        Reuse a face's previous result while its region is unchanged\n";
+    std::cout << "  --deterministic         Bit-reproducible output; prints the output hash of the clip\n";
+    std::cout << "  --result-cache <dir>    Reuse per-face results from earlier renders, stored in <dir>\n";
+    std::cout << "  --result-cache-gb <n>   Size limit of the result cache (default 8)\n";
+    std::cout << "  --auto-batch            Measure the fastest face batch size per network (stored per machine)\n";
+    std::cout << "  --batch-latency-cap <ms> Longest network call --auto-batch may choose (default 100)\n";
+    std::cout << "  --metrics-file <path>   Write OpenMetrics text to <path> every 5 s\n";
+    std::cout << "  --metrics-port <n>      Serve OpenMetrics at http://127.0.0.1:<n>/metrics\n";
+    std::cout << "  --profile-counters      Report per-stage IPC and cache/branch miss rates (Linux perf events)\n";
+    std::cout << "  --server [socket]       Render on a running ufra_server instead of loading models\n";
     std::cout << "  --help                  Show this help message\n";
     std::cout << "\nExamples:\n";
     std::cout << "  ufra_cli -i input.mp4 -o output.mp4 -a 25 -m feedforward\n";
     std::cout << "  ufra_cli -i frame_%04d.jpg -o aged_%04d.jpg -a 65 --identity-lock 0.8\n";
+    std::cout << "  ufra_cli -i input.mp4 -o output.mp4 -a 70 --server\n";
 }
 
 struct CLIConfig {
@@ -36,9 +55,33 @@ struct CLIConfig {
     int batch_size = 1;
     float identity_lock = 0.5f;
     bool temporal_stability = true;
+    int detection_interval = 1;
+    bool skip_unchanged = false;
+    bool deterministic = false;
+    std::string result_cache_dir;    // Empty: no result cache
+    size_t result_cache_bytes = size_t(8) << 30;
+    bool profile_counters = false;
+    std::string metrics_file;
+    int metrics_port = 0;
+    bool auto_batch = false;
+    float batch_latency_cap_ms = 100.0f;
+    bool use_server = false;
+    std::string server_socket;       // Empty: default socket path
     bool help = false;
 };
 
+// Renders frames in order with up to `depth` in flight: submit() queues a
+// frame, receive() returns the oldest outstanding result
+struct FramePipeline {
+    size_t depth = 1;
+    std::function<bool(const ufra::FrameContext&)> submit;
+    std::function<ufra::ProcessingResult()> receive;
+};
+
+// Frames kept in flight on ufra_server, so decoding and encoding here overlap
+// with rendering there
+constexpr int kServerStreamDepth = 4;
+
 CLIConfig parseArguments(int argc, char* argv[]) {
     CLIConfig config;
     
@@ -59,6 +102,7 @@ CLIConfig parseArguments(int argc, char* argv[]) {
             else if (mode_str == "diffusion") config.mode = ufra::ProcessingMode::DIFFUSION;
             else if (mode_str == "hybrid") config.mode = ufra::ProcessingMode::HYBRID;
             else if (mode_str == "auto") config.mode = ufra::ProcessingMode::AUTO;
+            else if (mode_str == "keyframe") config.mode = ufra::ProcessingMode::KEYFRAME;
         } else if (arg == "--models" && i + 1 < argc) {
             config.models_path = argv[++i];
         } else if (arg == "--gpu" && i + 1 < argc) {
@@ -73,13 +117,105 @@ CLIConfig parseArguments(int argc, char* argv[]) {
             config.identity_lock = std::stof(argv[++i]);
         } else if (arg == "--temporal-stability") {
             config.temporal_stability = true;
+        } else if (arg == "--detection-interval" && i + 1 < argc) {
+            config.detection_interval = std::stoi(argv[++i]);
+        } else if (arg == "--skip-unchanged") {
+            config.skip_unchanged = true;
+        } else if (arg == "--deterministic") {
+            config.deterministic = true;
+        } else if (arg == "--result-cache" && i + 1 < argc) {
+            config.result_cache_dir = argv[++i];
+        } else if (arg == "--result-cache-gb" && i + 1 < argc) {
+            config.result_cache_bytes = static_cast<size_t>(std::stod(argv[++i]) * (1 << 30));
+        } else if (arg == "--profile-counters") {
+            config.profile_counters = true;
+        } else if (arg == "--auto-batch") {
+            config.auto_batch = true;
+        } else if (arg == "--batch-latency-cap" && i + 1 < argc) {
+            config.batch_latency_cap_ms = std::stof(argv[++i]);
+        } else if (arg == "--metrics-file" && i + 1 < argc) {
+            config.metrics_file = argv[++i];
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            config.metrics_port = std::stoi(argv[++i]);
+        } else if (arg == "--server") {
+            config.use_server = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                config.server_socket = argv[++i];
+            }
         }
     }
     
     return config;
 }
 
-int processVideo(const CLIConfig& config, ufra::Engine& engine) {
+// Streams frames to ufra_server through shared-memory rings; models stay
+// loaded there between CLI runs
+FramePipeline serverPipeline(ufra::service::RenderClient& client) {
+    FramePipeline pipeline;
+    pipeline.depth = kServerStreamDepth;
+    pipeline.submit = [&client](const ufra::FrameContext& context) {
+        const cv::Mat& frame = context.input_frame;
+        if (!client.isStreaming() && !client.openStream(kServerStreamDepth, frame.total() * frame.elemSize())) {
+            return false;
+        }
+        ufra::service::JobSettings settings;
+        settings.target_age = context.controls.target_age;
+        settings.identity_lock = context.controls.identity_lock_strength;
+        settings.temporal_stability = context.controls.temporal_stability;
+        settings.mode = static_cast<int>(context.mode);
+        settings.frame_number = context.frame_number;
+        return client.submit(ufra::service::FrameView{frame.data, frame.cols, frame.rows, frame.channels(), frame.step},
+                             settings);
+    };
+    pipeline.receive = [&client]() {
+        ufra::ProcessingResult result;
+        ufra::service::FrameView output;
+        result.success = client.receive(output, &result.metrics);
+        if (result.success) {
+            result.output_frame = cv::Mat(output.height, output.width, CV_8UC(output.channels),
+                                          output.data, output.stride).clone();
+        } else {
+            result.error_message = client.getLastError();
+        }
+        return result;
+    };
+    return pipeline;
+}
+
+FramePipeline enginePipeline(ufra::Engine& engine) {
+    auto result = std::make_shared<ufra::ProcessingResult>();
+    FramePipeline pipeline;
+    pipeline.submit = [&engine, result](const ufra::FrameContext& context) {
+        *result = engine.processFrame(context);
+        return true;
+    };
+    pipeline.receive = [result]() { return std::move(*result); };
+    return pipeline;
+}
+
+void printStageCounters(std::map<std::string, float>& metrics) {
+    if (metrics["perf_counters"] == 0.0f) {
+        std::cout << "Hardware counters: unavailable (see the warning at startup)" << std::endl;
+        return;
+    }
+    std::cout << "Hardware counters per stage:" << std::endl;
+    for (const char* stage : {"detect", "parse", "generate", "diffusion", "propagate", "composite"}) {
+        const std::string prefix = std::string("perf_") + stage + "_";
+        if (!metrics.count(prefix + "ipc")) {
+            continue;
+        }
+        std::cout << "  " << stage << ": IPC " << metrics[prefix + "ipc"];
+        for (const char* counter : {"l1d", "llc", "branch"}) {
+            const std::string key = prefix + counter + "_mpki";
+            if (metrics.count(key)) {
+                std::cout << ", " << counter << " " << metrics[key] << " MPKI";
+            }
+        }
+        std::cout << " (" << metrics[prefix + "gcycles"] << " Gcycles)" << std::endl;
+    }
+}
+
+int processVideo(const CLIConfig& config, const FramePipeline& pipeline) {
     cv::VideoCapture cap(config.input_path);
     if (!cap.isOpened()) {
         std::cerr << "Error: Could not open input video: " << config.input_path << std::endl;
@@ -105,34 +241,93 @@ int processVideo(const CLIConfig& config, ufra::Engine& engine) {
     controls.identity_lock_strength = config.identity_lock;
     controls.temporal_stability = config.temporal_stability ? 1.0f : 0.0f;
 
-    cv::Mat frame;
-    int frame_number = 0;
+    // Inputs of frames in flight, written unchanged if rendering fails
+    std::deque<std::pair<int, cv::Mat>> in_flight;
+    int repeated_frames = 0;
+    int pulldown_phase = -1;
+    std::vector<uint64_t> frame_hashes;
+    std::map<std::string, float> last_metrics;
+    auto writeOldest = [&]() {
+        const int number = in_flight.front().first;
+        ufra::ProcessingResult result = pipeline.receive();
+        if (result.success) {
+            writer.write(result.output_frame);
+            last_metrics = result.metrics;
+            repeated_frames += result.metrics["frame_repeat"] > 0.0f ? 1 : 0;
+            if (result.metrics.count("pulldown_phase")) {
+                pulldown_phase = static_cast<int>(result.metrics["pulldown_phase"]);
+            }
+            if (config.deterministic) {
+                const cv::Mat& output = result.output_frame;
+                frame_hashes.push_back(result.output_hash ? result.output_hash
+                                       : ufra::kernels::contentHash(output.data, output.cols * output.elemSize(),
+                                                                    output.rows, output.step[0]));
+            }
+        } else {
+            std::cerr << "Warning: Failed to process frame " << number << ": " << result.error_message << std::endl;
+            writer.write(in_flight.front().second); // Write original frame on failure
+        }
+        in_flight.pop_front();
 
-    while (cap.read(frame)) {
+        // Progress indicator
+        if (number % 30 == 0) {
+            float progress = static_cast<float>(number) / total_frames * 100.0f;
+            std::cout << "Progress: " << std::fixed << std::setprecision(1) << progress << "% (" << number << "/" << total_frames << ")" << std::endl;
+        }
+    };
+
+    int frame_number = 0;
+    for (cv::Mat frame; cap.read(frame); frame = cv::Mat(), frame_number++) {
         ufra::FrameContext context;
         context.frame_number = frame_number;
         context.input_frame = frame;
         context.controls = controls;
         context.mode = config.mode;
 
-        ufra::ProcessingResult result = engine.processFrame(context);
-
-        if (result.success) {
-            writer.write(result.output_frame);
-        } else {
-            std::cerr << "Warning: Failed to process frame " << frame_number << ": " << result.error_message << std::endl;
-            writer.write(frame); // Write original frame on failure
+        if (!pipeline.submit(context)) {
+            while (!in_flight.empty()) {
+                writeOldest();
+            }
+            std::cerr << "Warning: Failed to submit frame " << frame_number << std::endl;
+            writer.write(frame);
+            continue;
         }
-
-        // Progress indicator
-        if (frame_number % 30 == 0) {
-            float progress = static_cast<float>(frame_number) / total_frames * 100.0f;
-            std::cout << "Progress: " << std::fixed << std::setprecision(1) << progress << "% (" << frame_number << "/" << total_frames << ")" << std::endl;
+        in_flight.emplace_back(frame_number, frame);
+        if (in_flight.size() >= pipeline.depth) {
+            writeOldest();
         }
-
-        frame_number++;
+    }
+    while (!in_flight.empty()) {
+        writeOldest();
     }
 
+    if (repeated_frames > 0) {
+        std::cout << "Repeated frames: " << repeated_frames;
+        if (pulldown_phase >= 0) {
+            std::cout << " (3:2 pulldown, phase " << pulldown_phase << ")";
+        }
+        std::cout << std::endl;
+    }
+    if (last_metrics.count("result_cache_hits")) {
+        std::cout << "Result cache: " << last_metrics["result_cache_hits"] << " faces reused, "
+                  << last_metrics["result_cache_misses"] << " rendered ("
+                  << last_metrics["result_cache_hit_rate"] * 100.0f << "% hits), "
+                  << last_metrics["result_cache_bytes_saved"] / (1024.0f * 1024.0f) << " MB saved" << std::endl;
+    }
+    if (config.auto_batch && last_metrics.count("scheduler_parser_batch_limit")) {
+        std::cout << "Tuned face batch sizes: parser " << last_metrics["scheduler_parser_batch_limit"]
+                  << ", generator " << last_metrics["scheduler_generator_batch_limit"] << std::endl;
+    }
+    if (config.profile_counters) {
+        printStageCounters(last_metrics);
+    }
+    if (config.deterministic) {
+        // Frame hashes in order; shards and re-renders of a clip compare equal
+        const uint64_t clip_hash = ufra::kernels::contentHash(
+            reinterpret_cast<const uint8_t*>(frame_hashes.data()), frame_hashes.size() * sizeof(uint64_t), 1, 0);
+        std::cout << "Output hash: " << std::hex << std::setw(16) << std::setfill('0') << clip_hash
+                  << std::dec << std::setfill(' ') << " (" << frame_hashes.size() << " frames)" << std::endl;
+    }
     std::cout << "Processing complete. Output saved to: " << config.output_path << std::endl;
     return 0;
 }
@@ -145,6 +340,16 @@ int main(int argc, char* argv[]) {
         return config.help ? 0 : -1;
     }
 
+    if (config.use_server) {
+        ufra::service::RenderClient client;
+        if (!client.connect(config.server_socket)) {
+            std::cerr << "Error: " << client.getLastError() << std::endl;
+            return -1;
+        }
+        std::cout << "UFRa CLI rendering on ufra_server" << std::endl;
+        return processVideo(config, serverPipeline(client));
+    }
+
     // Initialize engine
     auto engine = ufra::createEngine();
     
@@ -153,6 +358,17 @@ int main(int argc, char* argv[]) {
     model_config.batch_size = config.batch_size;
     model_config.use_half_precision = true;
     model_config.max_resolution = 1024;
+    model_config.temporal_coherence = config.temporal_stability;
+    model_config.detection_interval = config.detection_interval;
+    model_config.skip_unchanged_faces = config.skip_unchanged;
+    model_config.deterministic = config.deterministic;
+    model_config.result_cache_dir = config.result_cache_dir;
+    model_config.result_cache_max_bytes = config.result_cache_bytes;
+    model_config.profile_counters = config.profile_counters;
+    model_config.metrics_file = config.metrics_file;
+    model_config.metrics_port = config.metrics_port;
+    model_config.auto_tune_batch = config.auto_batch;
+    model_config.batch_latency_cap_ms = config.batch_latency_cap_ms;
 
     if (!engine->initialize(model_config)) {
         std::cerr << "Error: Failed to initialize UFRa engine" << std::endl;
@@ -169,5 +385,5 @@ int main(int argc, char* argv[]) {
     std::cout << "UFRa CLI initialized successfully" << std::endl;
     std::cout << "Engine version: " << engine->getVersionInfo() << std::endl;
 
-    return processVideo(config, *engine);
+    return processVideo(config, enginePipeline(*engine));
 }
\ No newline at end of file
@@ -12,10 +12,12 @@ public:
     ~AgeEstimator();
 
     bool loadModel(const std::string& model_path);
+    void setDeterministic(bool enabled);   // Before loadModel; see SharedModel::load
     float estimateAge(const ImageData& face_crop);
     std::vector<float> estimateAgeBatch(const std::vector<ImageData>& face_crops);
 
     void setInputSize(int width, int height);
+    cv::Size getInputSize() const;
     void setNormalization(float mean, float std);
 
 private:
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ufra {
+
+struct BatchSchedulerOptions {
+    int max_batch_size = 16;   // Items per batch function call
+    int max_delay_us = 2000;   // How long the oldest queued item waits for company
+};
+
+// Dynamic batching for one network shared by concurrent callers. run()
+// queues a caller's items under a key (the input resolution) and blocks;
+// items with the same key from all callers are cut into batches of up to
+// max_batch_size, run through the batch function and scattered back.
+//
+// There is no scheduler thread: the first waiting caller of a key leads,
+// collecting items for up to max_delay_us and then running the batch on
+// its own thread, so thread-keyed session pools keep working. The delay is
+// only spent while more than one caller is registered through enter(); a
+// lone caller runs at once.
+template <typename Item, typename Result>
+class BatchScheduler {
+public:
+    using BatchFunction = std::function<std::vector<Result>(const std::vector<Item>& items)>;
+
+    explicit BatchScheduler(BatchFunction run_batch, BatchSchedulerOptions options = BatchSchedulerOptions())
+        : run_batch_(std::move(run_batch)) {
+        setOptions(options);
+    }
+
+    void setOptions(const BatchSchedulerOptions& options) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        options_.max_batch_size = std::max(1, options.max_batch_size);
+        options_.max_delay_us = std::max(0, options.max_delay_us);
+    }
+
+    BatchSchedulerOptions getOptions() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return options_;
+    }
+
+    // Registers a caller that may submit soon, e.g. for the duration of
+    // one frame batch
+    void enter() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++participants_;
+    }
+
+    void leave() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --participants_;
+        }
+        cv_.notify_all();   // A leader may no longer have anyone to wait for
+    }
+
+    // Results are in item order. Rethrows the batch function's exception if
+    // a batch holding one of the items failed.
+    std::vector<Result> run(uint64_t key, std::vector<Item> items) {
+        Request request;
+        request.items = std::move(items);
+        request.results.resize(request.items.size());
+        request.pending = request.items.size();
+        if (request.pending == 0) {
+            return {};
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        Lane& lane = lanes_[key];
+        const auto now = Clock::now();
+        for (size_t i = 0; i < request.items.size(); ++i) {
+            lane.queue.push_back(Entry{&request, i, now});
+        }
+        cv_.notify_all();   // A leader may be waiting for a full batch
+
+        while (request.pending > 0) {
+            if (lane.leading || lane.queue.empty()) {
+                cv_.wait(lock);   // Another caller is running our items or leads this key
+                continue;
+            }
+            lane.leading = true;
+            const auto deadline = lane.queue.front().queued + std::chrono::microseconds(options_.max_delay_us);
+            const size_t max_batch = static_cast<size_t>(options_.max_batch_size);
+            cv_.wait_until(lock, deadline, [&] { return lane.queue.size() >= max_batch || participants_ <= 1; });
+
+            std::vector<Entry> batch;
+            while (!lane.queue.empty() && batch.size() < max_batch) {
+                batch.push_back(lane.queue.front());
+                lane.queue.pop_front();
+            }
+            const auto started = Clock::now();
+            lock.unlock();
+            runBatch(batch);
+            lock.lock();
+
+            ++batches_;
+            items_ += batch.size();
+            max_batch_seen_ = std::max(max_batch_seen_, batch.size());
+            for (const Entry& entry : batch) {
+                queue_seconds_ += std::chrono::duration<double>(started - entry.queued).count();
+                --entry.request->pending;
+            }
+            lane.leading = false;
+            cv_.notify_all();
+        }
+
+        if (request.error) {
+            std::rethrow_exception(request.error);
+        }
+        return std::move(request.results);
+    }
+
+    // batches, items, mean_batch_size, max_batch_size, mean_queue_ms
+    std::map<std::string, float> getStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::map<std::string, float> stats;
+        stats["batches"] = static_cast<float>(batches_);
+        stats["items"] = static_cast<float>(items_);
+        stats["mean_batch_size"] = batches_ ? static_cast<float>(items_) / batches_ : 0.0f;
+        stats["max_batch_size"] = static_cast<float>(max_batch_seen_);
+        stats["mean_queue_ms"] = items_ ? static_cast<float>(queue_seconds_ * 1000.0 / items_) : 0.0f;
+        return stats;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        std::vector<Item> items;
+        std::vector<Result> results;
+        size_t pending = 0;
+        std::exception_ptr error;
+    };
+
+    struct Entry {
+        Request* request;
+        size_t index;
+        Clock::time_point queued;
+    };
+
+    struct Lane {
+        std::deque<Entry> queue;
+        bool leading = false;
+    };
+
+    // Runs without the lock; the owners of these entries are blocked in
+    // run() until pending drops, so their items and results stay put
+    void runBatch(const std::vector<Entry>& batch) {
+        std::vector<Item> items;
+        items.reserve(batch.size());
+        for (const Entry& entry : batch) {
+            items.push_back(std::move(entry.request->items[entry.index]));
+        }
+        try {
+            std::vector<Result> results = run_batch_(items);
+            if (results.size() != batch.size()) {
+                throw std::length_error("batch function returned a different number of results");
+            }
+            for (size_t i = 0; i < batch.size(); ++i) {
+                batch[i].request->results[batch[i].index] = std::move(results[i]);
+            }
+        }
+        catch (...) {
+            for (const Entry& entry : batch) {
+                entry.request->error = std::current_exception();
+            }
+        }
+    }
+
+    BatchFunction run_batch_;
+    BatchSchedulerOptions options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::map<uint64_t, Lane> lanes_;
+    int participants_ = 0;
+
+    size_t batches_ = 0;
+    size_t items_ = 0;
+    size_t max_batch_seen_ = 0;
+    double queue_seconds_ = 0.0;
+};
+
+} // namespace ufra
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ufra {
+
+// Median wall time of one network call at a batch size
+struct BatchTiming {
+    int batch_size = 0;
+    double call_ms = 0.0;
+
+    double itemMs() const { return call_ms / batch_size; }
+};
+
+// Picks a network's batch size from measurements instead of a guess. A sweep
+// times calls at increasing batch sizes; the chosen size has the lowest time
+// per item among those whose call fits the latency cap. Sweeps are stored per
+// key (machine, device, model hash and input size), so later runs skip them.
+class BatchTuner {
+public:
+    BatchTuner();
+    ~BatchTuner();
+
+    // Loads the tab-separated store at `path` (empty: defaultPath()). A
+    // missing file is an empty store; false if it cannot be created.
+    bool open(const std::string& path);
+    std::vector<BatchTiming> lookup(const std::string& key) const;   // Empty if never swept
+    bool store(const std::string& key, const std::vector<BatchTiming>& sweep);
+
+    // $XDG_CACHE_HOME/ufra/batch_tuning.tsv, else ~/.cache/ufra/batch_tuning.tsv
+    static std::string defaultPath();
+    // CPU model and hardware thread count, e.g. "AMD_EPYC_7763_64-Core_Processor_16t"
+    static std::string machineKey();
+
+    // Times run(n) for each candidate, ascending: one untimed warm-up call,
+    // then the median of `repeats`. Stops after the first call over
+    // latency_cap_ms (0 = none), as larger batches only take longer.
+    static std::vector<BatchTiming> sweep(const std::function<void(int)>& run, const std::vector<int>& candidates,
+                                          double latency_cap_ms, int repeats = 3);
+    // Whether a stored sweep answers for these candidates and cap, or a
+    // larger cap than it was taken under needs more sizes
+    static bool covers(const std::vector<BatchTiming>& sweep, const std::vector<int>& candidates,
+                       double latency_cap_ms);
+    // Fastest per item within the cap; a smaller size wins within 5%, as it
+    // has lower latency. 1 when nothing fits.
+    static int select(const std::vector<BatchTiming>& sweep, double latency_cap_ms);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace ufra
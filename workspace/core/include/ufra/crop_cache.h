@@ -0,0 +1,35 @@
+#pragma once
+
+#include "types.h"
+#include <memory>
+
+namespace ufra {
+
+class FramePyramid;
+
+// Per-frame memo of face crops resampled to network input resolutions.
+// Every stage that needs a face at a given size shares one resized copy;
+// the crop itself stays a non-owning ROI view of the frame.
+class CropCache {
+public:
+    CropCache();
+    ~CropCache();
+
+    // Returns the face crop at the requested size, resizing at most once per
+    // (face, size) until reset(). The reference stays valid until reset().
+    const ImageData& getResized(const Face& face, const cv::Size& size);
+
+    // Start a new frame. With a pyramid, crops that are views of its level 0
+    // are sampled from the nearest pyramid level rather than full resolution.
+    void reset(FramePyramid* pyramid = nullptr);
+
+    size_t getResizeCount() const;
+    size_t getHitCount() const;
+    size_t getMemoryBytes() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace ufra
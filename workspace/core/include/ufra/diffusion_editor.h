@@ -6,25 +6,48 @@
 
 namespace ufra {
 
+struct TemporalPrior;
+
 class DiffusionEditor {
 public:
     DiffusionEditor();
     ~DiffusionEditor();
 
     bool loadModel(const std::string& model_dir);
+    void setDeterministic(bool enabled);   // Before loadModel; see SharedModel::load
     ImageData generateAgedFace(const ImageData& face_crop,
                               const AgeControls& controls,
                               const MaskImage& parsing_mask);
+
+    // With temporal coherence on and a valid prior, sampling starts part-way
+    // down the schedule from the previous frame's result (warped onto this
+    // crop) and its noise, so only a fraction of the steps run; the better
+    // the warp matches, the fewer. `noise` receives the noise to carry to
+    // the next frame (CV_32FC3), `steps_run` the steps spent. A cold start
+    // draws its noise from `seed`.
+    ImageData generateAgedFace(const ImageData& face_crop,
+                              const AgeControls& controls,
+                              const MaskImage& parsing_mask,
+                              const TemporalPrior& prior,
+                              unsigned int seed,
+                              cv::Mat& noise,
+                              int& steps_run);
     
     bool loadIdentityAdapter(const std::string& adapter_path);
     void setDiffusionSteps(int steps);
     void setGuidanceScale(float scale);
     void setSeed(unsigned int seed);
+    unsigned int getSeed() const;
+
+    // Seed for one face of one frame: mixes the base seed with both, so a
+    // face's noise does not depend on what was processed before it
+    static unsigned int faceSeed(unsigned int seed, int frame_number, int face_key);
     void enableTemporalCoherence(bool enable);
+    cv::Size getInputSize() const;
 
 private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
 };
 
-} // namespace ufra
\ No newline at end of file
+} // namespace ufra
@@ -22,9 +22,15 @@ public:
     bool loadFaceAdapter(const std::string& face_name);
     std::vector<std::string> getAvailableFaces() const;
 
-    // Frame processing
+    // Frame processing. With temporal_coherence, skip_unchanged_faces or
+    // KEYFRAME mode, tracks and caches are kept per FrameContext::clip_id.
+    // Frames of several clips may share a call; calls for the same clip take
+    // turns, lowest frame_number first.
     ProcessingResult processFrame(const FrameContext& context);
-    ProcessingResult processBatch(const std::vector<FrameContext>& contexts);
+    std::vector<ProcessingResult> processBatch(const std::vector<FrameContext>& contexts);
+    // True when `context` continues its clip's state, so the clip's frames
+    // should be handed over in order
+    bool usesClipState(const FrameContext& context) const;
 
     // Interactive preview
     bool startPreview(int width, int height);
@@ -6,13 +6,19 @@
 
 namespace ufra {
 
+class FramePyramid;
+
 class FaceDetector {
 public:
     FaceDetector();
     ~FaceDetector();
 
     bool loadModel(const std::string& model_path);
+    void setDeterministic(bool enabled);   // Before loadModel; see SharedModel::load
     std::vector<Face> detectFaces(const ImageData& image);
+    std::vector<Face> detectFaces(FramePyramid& pyramid);  // Network input sampled from the pyramid
+    // Re-cuts aligned_crop of known faces (e.g. tracked boxes) from `image`
+    void cropFaces(std::vector<Face>& faces, const ImageData& image);
     
     void setConfidenceThreshold(float threshold);
     void setNMSThreshold(float threshold);
@@ -12,6 +12,7 @@ public:
     ~FaceParser();
 
     bool loadModel(const std::string& model_path);
+    void setDeterministic(bool enabled);   // Before loadModel; see SharedModel::load
     MaskImage parseFace(const ImageData& face_crop);
     std::vector<MaskImage> parseFacesBatch(const std::vector<ImageData>& face_crops);
     
@@ -26,6 +27,7 @@ public:
     MaskImage getEyebrowsMask(const MaskImage& full_mask);
 
     void setInputSize(int width, int height);
+    cv::Size getInputSize() const;
 
 private:
     class Impl;
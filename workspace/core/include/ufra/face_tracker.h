@@ -0,0 +1,30 @@
+#pragma once
+
+#include "types.h"
+#include <memory>
+
+namespace ufra {
+
+// Assigns stable track_ids to detections across consecutive frames by
+// greedy box-overlap matching. A track survives up to `max_missed_frames`
+// frames without a match before its id is retired; ids are never reused.
+class FaceTracker {
+public:
+    FaceTracker();
+    ~FaceTracker();
+
+    // Sets track_id and frame_number on each face; returns the ids of
+    // tracks retired by this update
+    std::vector<int> update(std::vector<Face>& faces, int frame_number);
+    void reset();
+
+    void setIoUThreshold(float threshold);
+    void setMaxMissedFrames(int frames);
+    size_t getActiveTrackCount() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace ufra
@@ -6,12 +6,15 @@
 
 namespace ufra {
 
+struct TemporalPrior;
+
 class FeedforwardGenerator {
 public:
     FeedforwardGenerator();
     ~FeedforwardGenerator();
 
     bool loadModel(const std::string& model_path);
+    void setDeterministic(bool enabled);   // Before loadModel; see SharedModel::load
     ImageData generateAgedFace(const ImageData& face_crop, 
                               const AgeControls& controls,
                               const MaskImage& parsing_mask);
@@ -21,7 +24,13 @@ public:
         const std::vector<AgeControls>& controls,
         const std::vector<MaskImage>& parsing_masks);
 
+    // Blends a generated face with the previous frame's result warped onto
+    // it: weighted by temporal_stability, and less the worse the warp
+    // matches. Returns `generated` unless temporal stabilization is enabled.
+    ImageData stabilize(const ImageData& generated, const TemporalPrior& prior, float temporal_stability) const;
+
     void setInputResolution(int width, int height);
+    cv::Size getInputSize() const;
     void enableTemporalStabilization(bool enable);
     void setIdentityPreservationStrength(float strength);
 
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "types.h"
+#include <memory>
+
+namespace ufra {
+
+// Lazily built 2x box-filtered pyramid of one frame. The detector input and
+// every face crop are sampled from the smallest level that still covers the
+// requested resolution instead of from the full-resolution frame.
+class FramePyramid {
+public:
+    FramePyramid();
+    ~FramePyramid();
+
+    // Start a new frame. Level 0 is a view of `frame`; level buffers from the
+    // previous frame are reused when the size matches.
+    void reset(const ImageData& frame);
+
+    const ImageData& getLevel(int level);
+    int getLevelCount() const;   // Levels built so far
+
+    // Resample `roi` (level-0 coordinates) to `size` from the nearest level
+    ImageData sample(const cv::Rect& roi, const cv::Size& size);
+    ImageData sampleFrame(const cv::Size& size);
+
+    // True if `view` is a ROI of this pyramid's level 0; `roi` receives its rect
+    bool locate(const ImageData& view, cv::Rect& roi) const;
+
+    size_t getMemoryBytes() const;
+    void releaseBuffers();   // Free level buffers, e.g. under memory pressure
+
+    // Allocator for level buffers (nullptr = OpenCV default)
+    void setAllocator(cv::MatAllocator* allocator);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace ufra
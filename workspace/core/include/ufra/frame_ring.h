@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace ufra {
+namespace service {
+
+constexpr size_t kRingMetaBytes = 2048;
+
+// Per-slot description written by the producer next to the pixels. `meta`
+// carries transport-specific data (job settings, result metrics).
+struct RingSlot {
+    uint64_t sequence = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t channels = 0;
+    uint32_t stride = 0;
+    uint32_t meta_bytes = 0;
+    uint8_t meta[kRingMetaBytes];
+};
+
+// Single-producer, single-consumer ring of fixed-size frame slots in one
+// memfd, shared between processes. Waiting uses futexes on the shared
+// head/tail counters; a side that is not waiting costs the other side no
+// syscall. The consumer maps the pixel slots read-only, so frames are
+// handed over without copies and cannot be modified by the reader.
+//
+// Slots are acquired, filled and published in order by the producer and
+// received and released in order by the consumer; several may be held at
+// once on either side. On the consumer, receive() and release() may be
+// called from different threads.
+class FrameRing {
+public:
+    enum class Role {
+        PRODUCER,
+        CONSUMER
+    };
+
+    FrameRing();
+    ~FrameRing();
+
+    // Producer side: creates a new ring (sealed against resizing)
+    bool create(size_t slot_count, size_t slot_bytes);
+    // Maps a ring created by the peer. Takes ownership of fd.
+    bool attach(int fd, Role role);
+    void reset();
+
+    int fd() const;
+    size_t slotCount() const;
+    size_t slotBytes() const;
+
+    // Producer. acquire() returns the next free slot, or nullptr on timeout
+    // (timeout_ms < 0 waits forever) or when the ring is closed.
+    uint8_t* acquire(int timeout_ms = -1);
+    bool publish(const RingSlot& slot);   // Publishes the oldest acquired slot
+
+    // Consumer. `data` stays valid until the matching release().
+    bool receive(RingSlot& slot, const uint8_t*& data, int timeout_ms = -1);
+    void release();
+
+    // Either side; wakes all waiters, later calls fail
+    void close();
+    bool isClosed() const;
+
+    const std::string& getLastError() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace service
+} // namespace ufra
@@ -23,6 +23,9 @@ public:
     
     void enableMemoryPool(bool enable);
     void setMemoryPoolSize(size_t size_bytes);
+
+    // Serve large CPU allocations from HugePageArena (default on)
+    void enableHugePages(bool enable);
     
     std::string getBackendInfo() const;
 
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace cv {
+class MatAllocator;
+}
+
+namespace ufra {
+
+enum class HugePageMode {
+    EXPLICIT,      // MAP_HUGETLB from the reserved hugetlbfs pool
+    TRANSPARENT,   // Anonymous mapping with madvise(MADV_HUGEPAGE)
+    NONE           // Regular 4 KB pages
+};
+
+// Arena for large, long-lived-shape buffers (full frames, pyramid levels,
+// activations). Blocks are backed by 2 MB pages when the system allows it,
+// pre-faulted when mapped, and kept on a free list so that the next frame
+// reuses already-faulted memory instead of paying first-touch costs again.
+// Requests below the threshold go straight to the regular heap.
+class HugePageArena {
+public:
+    HugePageArena();
+    ~HugePageArena();
+
+    static HugePageArena& instance();
+
+    void* allocate(size_t bytes);
+    void deallocate(void* ptr);
+
+    // Preferred mode; falls back EXPLICIT -> TRANSPARENT -> NONE per mapping
+    void setMode(HugePageMode mode);
+    void setThreshold(size_t bytes);           // Default 1 MB
+    void setMaxCachedBytes(size_t bytes);      // Free-list cap, default 1 GB
+    void trim();                               // Unmap all cached blocks
+
+    HugePageMode getLastMappingMode() const;
+    size_t getMappedBytes() const;
+    size_t getCachedBytes() const;
+    size_t getReuseCount() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// cv::Mat allocator routing large matrices through HugePageArena::instance()
+cv::MatAllocator* getHugePageMatAllocator();
+
+} // namespace ufra
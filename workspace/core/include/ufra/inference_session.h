@@ -0,0 +1,105 @@
+#pragma once
+
+#include "types.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ufra {
+
+class InferenceSession;
+
+// Immutable network weights loaded once per (model file, backend,
+// determinism) and shared by every session created from it, including across
+// Engine instances. Paths under "stub:" load built-in stand-in networks
+// (stub_network.h).
+class SharedModel {
+public:
+    ~SharedModel();
+
+    // Deterministic models run on the CPU backend whatever backend is
+    // requested, and their sessions skip Winograd convolutions, so outputs
+    // depend only on the inputs and the CPU feature level
+    static std::shared_ptr<SharedModel> load(const std::string& model_path, GPUBackend backend,
+                                             bool deterministic = false);
+
+    std::unique_ptr<InferenceSession> createSession() const;
+
+    const std::string& getModelPath() const;
+    GPUBackend getBackend() const;
+    bool isDeterministic() const;
+    size_t getWeightBytes() const;
+
+private:
+    SharedModel();
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Stateful execution context (input bindings and activations). Not
+// thread-safe; obtain one per worker through a SessionPool.
+class InferenceSession {
+public:
+    ~InferenceSession();
+
+    void setInput(const cv::Mat& blob, const std::string& name = "");
+    cv::Mat forward();
+    void forward(std::vector<cv::Mat>& outputs);
+
+private:
+    friend class SharedModel;
+    InferenceSession();
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// 1xCxHxW view of item `index` of an NxCxHxW network output, for splitting
+// a batched call's output per input image
+cv::Mat blobItem(const cv::Mat& blob, int index);
+
+// Hands out sessions of one SharedModel keyed by calling thread or by request.
+// Sessions are created lazily, so memory grows by activations per worker only.
+// A thread's session goes back to the pool when the thread exits, as does a
+// request's on release(), and is reused by the next thread or request.
+class SessionPool {
+public:
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        ~Lease();
+
+        InferenceSession* operator->() const;
+        InferenceSession& operator*() const;
+
+    private:
+        friend class SessionPool;
+        struct State;
+        explicit Lease(std::unique_ptr<State> state);
+
+        std::unique_ptr<State> state_;
+    };
+
+    explicit SessionPool(std::shared_ptr<const SharedModel> model);
+    ~SessionPool();
+
+    Lease acquire();                      // Keyed by the calling thread
+    Lease acquire(uint64_t request_key);  // Keyed by request, see release()
+    void release(uint64_t request_key);
+
+    size_t getSessionCount() const;
+    void clear();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Process-wide totals across loaded models and live sessions, used for
+// engine memory accounting
+size_t getLoadedModelBytes();
+size_t getSessionActivationBytes();
+
+} // namespace ufra
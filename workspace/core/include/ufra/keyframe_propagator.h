@@ -0,0 +1,64 @@
+#pragma once
+
+#include "types.h"
+#include <map>
+#include <memory>
+#include <string>
+
+namespace ufra {
+
+// When a track needs a fresh generator pass. All distances are measured on
+// the track's crops at generator resolution, against its last keyframe.
+struct KeyframePolicy {
+    int max_interval = 12;       // Frames after which a keyframe is forced
+    float max_motion = 0.08f;    // Mean displacement, as a fraction of the crop width
+    float max_change = 0.03f;    // Mean |crop - aligned keyframe crop| / 255 left after alignment
+};
+
+// Keyframe-and-propagate for long, mostly static shots. The generator runs on
+// keyframes only; in between, each track's keyframe residual (generated
+// minus input) is aligned to the current crop with a landmark-driven affine
+// warp refined by optical flow, and added to it. Decisions and outputs
+// depend only on the frames and the policy.
+//
+// plan() is called per face in frame order, before generation; keyframe
+// results are handed back with setKeyframe() and in-between frames produced
+// with propagate(), also in frame order. Thread-safe.
+class KeyframePropagator {
+public:
+    class Keyframe;
+
+    struct Plan {
+        bool keyframe = true;
+        std::shared_ptr<Keyframe> key;   // The keyframe this frame propagates from (or is)
+        cv::Mat affine;                  // Current crop -> keyframe crop coordinates (2x3)
+        cv::Mat flow;                    // Residual flow after the affine warp (CV_32FC2)
+        float motion = 0.0f;
+        float change = 0.0f;
+    };
+
+    KeyframePropagator();
+    ~KeyframePropagator();
+
+    void setPolicy(const KeyframePolicy& policy);
+    KeyframePolicy getPolicy() const;
+
+    // `landmarks` are in crop coordinates; alignment is flow-only when either
+    // side has fewer than three
+    Plan plan(int track_id, const ImageData& crop, const std::vector<cv::Point2f>& landmarks, int frame_number);
+    void setKeyframe(const Plan& plan, const ImageData& crop, const ImageData& generated);
+    ImageData propagate(const Plan& plan, const ImageData& crop) const;
+
+    void invalidate(int track_id);
+    void reset();
+    size_t getMemoryBytes() const;
+
+    // keyframes, propagated, keyframe_ratio
+    std::map<std::string, float> getStats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace ufra
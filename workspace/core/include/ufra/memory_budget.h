@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace ufra {
+
+enum class MemoryCategory {
+    MODELS,          // Network weights
+    TENSOR_ARENAS,   // Session activations and scratch buffers
+    CACHES,          // Crop cache, frame pyramid and other reusable buffers
+    FRAMES           // Input/output frames currently in flight
+};
+
+enum class MemoryPressure {
+    NORMAL,
+    HIGH,       // Above the soft threshold: shrink caches and batches
+    CRITICAL    // At or above the budget: new work is refused
+};
+
+// Thread-safe accounting of the engine's major allocations against an
+// optional byte budget. A limit of 0 means unlimited (accounting only).
+class MemoryBudget {
+public:
+    MemoryBudget();
+    ~MemoryBudget();
+
+    void setLimit(size_t bytes);
+    size_t getLimit() const;
+    void setSoftThreshold(float fraction);   // Default 0.8 of the limit
+
+    // Absolute usage for categories whose size is measured, e.g. caches
+    void setUsage(MemoryCategory category, size_t bytes);
+
+    // Admission control for transient allocations; fails without side effects
+    // if the reservation would exceed the limit
+    bool tryReserve(MemoryCategory category, size_t bytes);
+    void release(MemoryCategory category, size_t bytes);
+
+    size_t getUsage(MemoryCategory category) const;
+    size_t getTotalUsage() const;
+    MemoryPressure getPressure() const;
+
+    // memory_used_mb, memory_budget_mb, memory_<category>_mb, ...
+    std::map<std::string, float> getMetrics() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace ufra
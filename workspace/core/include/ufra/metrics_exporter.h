@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ufra {
+
+// Cumulative latency histogram with fixed buckets. Each thread observes into
+// its own shard with plain relaxed stores, so recording takes no lock and no
+// contended cache line; shards are summed when the histogram is read.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+    ~LatencyHistogram();
+
+    // Upper bucket bounds in seconds, 0.5 ms to 10 s; +Inf is implicit
+    static const std::vector<double>& bucketBounds();
+
+    void observe(double seconds);
+
+    struct Snapshot {
+        std::vector<uint64_t> buckets;   // Per bound plus +Inf, not cumulative
+        uint64_t count = 0;
+        double sum = 0.0;                // Seconds
+    };
+    Snapshot snapshot() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+// Exposes engine metrics in the OpenMetrics text format for central
+// monitoring: frames and errors processed, frames/sec, latency histograms per
+// frame and per pipeline stage, cache hit ratios and memory usage. The text
+// is written to a file periodically, served over HTTP on a loopback port, or
+// both. Recording is safe from any thread.
+class MetricsExporter {
+public:
+    // Stages are fixed up front so observeStage() needs no lookup lock;
+    // unknown stage names are ignored
+    explicit MetricsExporter(const std::vector<std::string>& stages);
+    ~MetricsExporter();
+
+    // Rewrites `path` atomically every interval_ms and once more on stop()
+    bool writeToFile(const std::string& path, int interval_ms = 5000);
+    // GET /metrics on 127.0.0.1:port; port 0 picks a free port
+    bool listen(int port);
+    int getPort() const;
+    void stop();
+
+    void observeStage(const char* stage, double seconds);
+    // One successfully processed frame; gauges are taken from its metrics map
+    void recordFrame(double seconds, const std::map<std::string, float>& metrics);
+    void recordError();
+
+    std::string render() const;
+
+    // Times a stage on the calling thread; no-op for a null exporter
+    class StageTimer {
+    public:
+        StageTimer(MetricsExporter* exporter, const char* stage);
+        ~StageTimer();
+
+        StageTimer(const StageTimer&) = delete;
+        StageTimer& operator=(const StageTimer&) = delete;
+
+    private:
+        MetricsExporter* exporter_;
+        const char* stage_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace ufra
@@ -8,7 +8,8 @@
 
 namespace ufra {
 
-// Minimal image representation
+// Minimal image representation: interleaved 8-bit, BGR channel order like
+// the OpenCV build
 struct ImageData {
     int width = 0;
     int height = 0;
@@ -2,6 +2,7 @@
 
 #include "types.h"
 #include <memory>
+#include <string>
 
 namespace ufra {
 
@@ -10,10 +11,12 @@ public:
     OpticalFlow();
     ~OpticalFlow();
 
+    // CV_32FC2 flow with frame2(p + flow(p)) ~ frame1(p)
     cv::Mat computeFlow(const ImageData& frame1, const ImageData& frame2);
+    // warped(p) = source(p + flow(p)): brings frame2 content onto frame1
     cv::Mat warpImage(const ImageData& source, const cv::Mat& flow);
     
-    void setFlowAlgorithm(const std::string& algorithm); // "lucas_kanade", "farneback", "tvl1"
+    void setFlowAlgorithm(const std::string& algorithm); // "lucas_kanade" (default) or "farneback"
     void setQualityLevel(float quality);
     void enableGPUAcceleration(bool enable);
 
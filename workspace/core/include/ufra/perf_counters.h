@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace ufra {
+
+// Hardware event counts of user-space code on one thread. Events the PMU or
+// the kernel does not offer stay 0; counts are scaled up when the kernel had
+// to multiplex the counters.
+struct CounterSample {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t l1d_misses = 0;       // L1 data cache read misses
+    uint64_t llc_misses = 0;       // Last-level cache misses
+    uint64_t branch_misses = 0;
+
+    CounterSample& operator+=(const CounterSample& other);
+    CounterSample operator-(const CounterSample& other) const;
+};
+
+// Linux perf_event counters of the calling thread, opened lazily once per
+// thread. False when perf events are unavailable, e.g. in containers whose
+// seccomp profile blocks perf_event_open, with perf_event_paranoid > 2, or
+// without a PMU in the VM; then every read returns zeros.
+bool perfCountersAvailable();
+std::string perfCountersUnavailableReason();   // Empty when available
+CounterSample readThreadCounters();
+
+// Accumulates counter deltas per named stage across threads. Each Scope
+// counts only the thread it runs on, so a stage should be scoped where its
+// work executes (e.g. inside a batch function, not around a wait for it).
+class StageProfiler {
+public:
+    StageProfiler();
+    ~StageProfiler();
+
+    class Scope {
+    public:
+        Scope(StageProfiler* profiler, const char* stage);   // No-op for a null profiler
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        StageProfiler* profiler_;
+        const char* stage_;
+        CounterSample start_;
+    };
+
+    bool isAvailable() const;
+    void add(const std::string& stage, const CounterSample& delta);
+    CounterSample getTotals(const std::string& stage) const;
+
+    // perf_counters (1 or 0) and per stage since the last reset:
+    // perf_<stage>_ipc, perf_<stage>_l1d_mpki, perf_<stage>_llc_mpki,
+    // perf_<stage>_branch_mpki (misses per 1000 instructions) and
+    // perf_<stage>_gcycles (billions of cycles)
+    std::map<std::string, float> getMetrics() const;
+    void reset();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace ufra
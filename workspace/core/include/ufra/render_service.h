@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ufra {
+namespace service {
+
+// Local render service: ufra_server keeps engines and models resident and
+// renders frames for short-lived clients (ufra_cli --server, pyufra, the
+// OpenFX plugin). Control messages travel over a Unix domain socket; pixels
+// travel through a memfd shared by client and server, so a frame is never
+// copied through the socket.
+//
+// render() is a synchronous round trip. Clients with frames to spare open a
+// stream instead: a pair of FrameRings (request and result) keeps several
+// frames in flight, so decoding, transport and rendering overlap and no
+// socket message is exchanged per frame.
+
+// Interleaved 8-bit pixels, BGR for 3-channel frames
+struct FrameView {
+    uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    size_t stride = 0;   // Bytes per row
+
+    bool empty() const { return data == nullptr || width <= 0 || height <= 0; }
+    size_t bytes() const { return stride * static_cast<size_t>(height); }
+};
+
+// Per-frame settings forwarded to Engine::processBatch
+struct JobSettings {
+    float target_age = 30.0f;
+    float identity_lock = 0.5f;
+    float temporal_stability = 1.0f;
+    int mode = 0;            // ProcessingMode
+    int frame_number = 0;
+    uint64_t clip_id = 0;    // Clip continued across connections (unique across clients); 0 = the connection's
+};
+
+// One frame inside a scheduled batch. The handler reads `input` and writes
+// the rendered frame into `output`; both point into the client's shared
+// memory and have the same geometry.
+struct RenderJob {
+    uint64_t client_id = 0;
+    JobSettings settings;
+    FrameView input;
+    FrameView output;
+
+    bool success = false;
+    std::string error;
+    std::map<std::string, float> metrics;
+};
+
+// Called on the scheduler thread only, so the handler may drive a single
+// Engine without locking
+using BatchHandler = std::function<void(std::vector<RenderJob*>& jobs)>;
+
+struct ServerOptions {
+    std::string socket_path;       // Empty: defaultSocketPath()
+    int max_batch = 8;             // Frames handed to the handler at once
+    int batch_window_us = 2000;    // How long the first job waits for company
+};
+
+// $UFRA_SOCKET, else $XDG_RUNTIME_DIR/ufra.sock, else /tmp/ufra-<uid>.sock
+std::string defaultSocketPath();
+
+class RenderServer {
+public:
+    RenderServer();
+    ~RenderServer();
+
+    bool start(const ServerOptions& options, BatchHandler handler);
+    void stop();
+    bool isRunning() const;
+    const std::string& getSocketPath() const;
+
+    // clients, streams, jobs, batches, mean_batch_size, max_batch_size
+    std::map<std::string, float> getStats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+class RenderClient {
+public:
+    RenderClient();
+    ~RenderClient();
+
+    bool connect(const std::string& socket_path = "");
+    void disconnect();
+    bool isConnected() const;
+
+    // Writable input frame in shared memory. Producers that render straight
+    // into it skip the copy in render().
+    FrameView inputBuffer(int width, int height, int channels);
+
+    // Renders the frame in `input` (copied into shared memory unless it
+    // already is the input buffer). `output` receives a view of the result
+    // in shared memory, valid until the next call. Besides the server's
+    // metrics, `metrics` gets client_round_trip_ms and
+    // transport_overhead_ms (round trip minus server queue and processing).
+    bool render(const FrameView& input, const JobSettings& settings, FrameView& output,
+                std::map<std::string, float>* metrics = nullptr);
+
+    // Streaming. Up to `depth` frames of at most `max_frame_bytes` may be
+    // submitted before their results are received; results arrive in
+    // submission order.
+    bool openStream(int depth, size_t max_frame_bytes);
+    bool isStreaming() const;
+    int inFlight() const;
+    // Next free request slot; rendering straight into it skips the copy in
+    // submit(). Empty when `depth` frames are already in flight.
+    FrameView streamInputBuffer(int width, int height, int channels);
+    bool submit(const FrameView& input, const JobSettings& settings);
+    // Oldest outstanding result. `output` is a read-only view, valid until
+    // the next receive(). Returns false on a failed frame (the frame is
+    // still consumed) or when no result arrives within timeout_ms.
+    bool receive(FrameView& output, std::map<std::string, float>* metrics = nullptr, int timeout_ms = -1);
+
+    const std::string& getLastError() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace service
+} // namespace ufra
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace ufra {
+
+// 128-bit content address of one face result
+struct ResultKey {
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    std::string hex() const;
+};
+
+// Per-face results on local disk, addressed by a hash of everything they
+// depend on: the face ROI's pixels plus a context hash covering controls,
+// mode, seed, model file contents and engine version. Lets a re-render after
+// a small edit skip every face whose inputs did not change.
+//
+// One file per entry under the cache directory, written to a temporary name
+// and renamed, so readers never see partial entries. Least recently used
+// entries are evicted beyond the size limit. Thread-safe.
+class ResultCache {
+public:
+    ResultCache();
+    ~ResultCache();
+
+    // Creates the directory if needed and indexes existing entries
+    bool open(const std::string& directory, size_t max_bytes);
+    bool isOpen() const;
+
+    static ResultKey makeKey(const ImageData& roi, uint64_t context);
+    static uint64_t hashFile(const std::string& path);   // 0 if unreadable
+
+    bool load(const ResultKey& key, ImageData& result, MaskImage& parsing_mask);
+    bool store(const ResultKey& key, const ImageData& result, const MaskImage& parsing_mask);
+    void clear();   // Deletes every entry
+
+    // hits, misses, hit_rate, bytes_saved (results served from disk),
+    // bytes, entries, evictions
+    std::map<std::string, float> getStats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace ufra
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "types.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace ufra {
+
+// Cheap fingerprint of a face ROI: 16x16 cell means of the source pixels,
+// plus a hash of them for the exact-match case
+struct RoiSignature {
+    static constexpr int kGrid = 16;
+
+    int width = 0;
+    int height = 0;
+    uint64_t hash = 0;
+    std::array<uint8_t, kGrid * kGrid> cells{};
+};
+
+// `roi` is interleaved 8-bit; every row is read once
+RoiSignature computeRoiSignature(const uint8_t* roi, int width, int height, size_t stride, int channels);
+
+// Each track's last result, reused outright while its ROI and controls do
+// not change (holds, freeze frames, pulldown duplicates). A ROI matches when
+// its signature hashes the same, or when no cell moved by more than the max
+// tolerance and the mean cell difference stays within the mean tolerance.
+// Thread-safe.
+class RoiSkipCache {
+public:
+    RoiSkipCache();
+    ~RoiSkipCache();
+
+    // True if `track_id`'s stored ROI matches; `result` and `parsing_mask`
+    // then receive the stored outputs and `exact` whether the hash matched
+    bool lookup(int track_id, const RoiSignature& signature, uint64_t controls_key,
+                ImageData& result, MaskImage& parsing_mask, bool* exact = nullptr);
+    void store(int track_id, const RoiSignature& signature, uint64_t controls_key,
+               const ImageData& result, const MaskImage& parsing_mask);
+
+    // Same test without the cache, e.g. against an earlier frame of a batch
+    bool matches(const RoiSignature& previous, const RoiSignature& current) const;
+
+    void invalidate(int track_id);
+    void clear();
+
+    void setTolerance(float mean_difference, int max_difference);   // Cell levels; default 0.5 and 2
+
+    // hits, exact_hits, misses, hit_rate
+    std::map<std::string, float> getStats() const;
+    size_t getMemoryBytes() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace ufra
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "types.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ufra {
+
+// Built-in stand-ins for the model files, so the whole pipeline runs in tests
+// and benchmarks without models, a GPU or network access. Model paths under
+// "stub:" (see stubModelDir) load a StubNetwork picked by file name, e.g.
+// Engine::loadModels(stubModelDir()). Outputs are deterministic and follow
+// the real networks' layouts:
+//   face_detector          bright blobs crossing the middle row of the input,
+//                          i.e. the faces drawn by renderStubFrame
+//   face_parser            labels by position in the crop: skin, brows, eyes,
+//                          nose, lips, hair, neck
+//   feedforward_generator  input desaturated and darkened with target age
+//   age_estimator          age from mean brightness
+//   unet                   zero noise prediction
+// Every forward call spins the CPU for the configured cost, standing in for
+// real inference time in throughput and scheduler tests.
+
+struct StubCost {
+    double call_ms = 0.0;   // Per forward call
+    double item_ms = 0.0;   // Per image in the input batch
+};
+
+// "stub:<call_ms>,<item_ms>", usable wherever a model directory is expected
+std::string stubModelDir(const StubCost& cost = StubCost());
+bool isStubModelPath(const std::string& path);
+
+// Face boxes, in pixels, of a renderStubFrame(width, height, face_count)
+// frame: one row of faces across the middle of the frame
+std::vector<FaceBox> stubFaceLayout(int width, int height, int face_count);
+
+// Dark gradient background with skin-toned face ellipses (eyes and mouth
+// drawn in) at stubFaceLayout positions. BGR, CV_8UC3.
+ImageData renderStubFrame(int width, int height, int face_count = 2);
+
+class StubNetwork {
+public:
+    ~StubNetwork();
+
+    // nullptr when the path is not a stub path or names an unknown network
+    static std::shared_ptr<StubNetwork> create(const std::string& model_path);
+
+    // Inputs by name as given to InferenceSession::setInput ("" when unnamed)
+    cv::Mat forward(const std::map<std::string, cv::Mat>& inputs) const;
+
+    const std::string& getKind() const;
+    StubCost getCost() const;
+
+private:
+    StubNetwork();
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace ufra
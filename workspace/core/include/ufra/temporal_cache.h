@@ -0,0 +1,52 @@
+#pragma once
+
+#include "types.h"
+#include <map>
+#include <memory>
+#include <string>
+
+namespace ufra {
+
+// What the previous frame of a track leaves for the current one, warped
+// onto the current crop with optical flow
+struct TemporalPrior {
+    bool valid = false;
+    ImageData result;        // Previous output for this track
+    cv::Mat state;           // Previous generator state (e.g. diffusion noise); may be empty
+    float residual = 1.0f;   // Mean |crop - warped previous crop| / 255; 0 = perfect match
+    int frame_gap = 0;
+};
+
+// Per-track memory of generator inputs, outputs and internal state across
+// frames, keyed by track_id. lookup() estimates flow from the current crop
+// to the stored one and warps the stored output and state onto it, so
+// generators can start from the previous result instead of from scratch.
+// Crops of one track must share a resolution (the generator input size).
+// Thread-safe; frames of a track are expected in order.
+class TemporalCache {
+public:
+    TemporalCache();
+    ~TemporalCache();
+
+    TemporalPrior lookup(int track_id, const ImageData& crop, int frame_number);
+    // Copies crop, result and state
+    void store(int track_id, const ImageData& crop, const ImageData& result, const cv::Mat& state, int frame_number);
+    void invalidate(int track_id);
+    void clear();
+
+    void setMaxFrameGap(int frames);    // Older entries are not reused (default 2)
+    void setFlowResolution(int size);   // Longest side flow is estimated at (default 128)
+
+    // Generator steps spent on one frame (network passes or diffusion steps)
+    void recordFrameSteps(int steps);
+
+    // hits, misses, tracks, frames, mean_steps_per_frame, mean_residual
+    std::map<std::string, float> getStats() const;
+    size_t getMemoryBytes() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace ufra
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ufra {
+namespace runtime {
+
+// Small dependency-free inference runtime for the minimal build. It reads
+// ONNX files directly and executes them with CPU kernels in NCHW float32.
+// All tensors are float; integer tensors (shapes, indices) are converted on
+// load. Convolutions run direct (no im2col) on weights repacked into
+// SIMD-width output-channel blocks, with BatchNormalization and activations
+// folded in at load time; other ops use reference kernels.
+
+struct Tensor {
+    std::vector<int64_t> shape;
+    std::vector<float> data;
+
+    Tensor() = default;
+    explicit Tensor(std::vector<int64_t> tensor_shape);   // Zero filled
+    Tensor(std::vector<int64_t> tensor_shape, std::vector<float> values);
+
+    size_t size() const { return data.size(); }
+    bool empty() const { return data.empty(); }
+    int rank() const { return static_cast<int>(shape.size()); }
+    int64_t dim(int axis) const;   // Negative axes count from the back
+};
+
+size_t shapeSize(const std::vector<int64_t>& shape);
+
+struct Node {
+    std::string name;
+    std::string op_type;
+    std::vector<std::string> inputs;     // "" marks an omitted optional input
+    std::vector<std::string> outputs;
+
+    std::map<std::string, int64_t> ints;
+    std::map<std::string, float> floats;
+    std::map<std::string, std::string> strings;
+    std::map<std::string, std::vector<int64_t>> int_lists;
+    std::map<std::string, std::vector<float>> float_lists;
+    std::map<std::string, Tensor> tensors;
+
+    int64_t getInt(const std::string& key, int64_t fallback) const;
+    float getFloat(const std::string& key, float fallback) const;
+    std::string getString(const std::string& key, const std::string& fallback) const;
+    std::vector<int64_t> getInts(const std::string& key) const;
+};
+
+struct ValueInfo {
+    std::string name;
+    std::vector<int64_t> shape;   // -1 for symbolic dimensions
+};
+
+// Topologically sorted graph, as stored in ONNX files
+struct Graph {
+    std::vector<Node> nodes;
+    std::map<std::string, Tensor> initializers;
+    std::vector<ValueInfo> inputs;    // Excludes initializers
+    std::vector<ValueInfo> outputs;
+};
+
+bool parseOnnxModel(const uint8_t* data, size_t size, Graph& graph, std::string& error);
+bool readOnnxModel(const std::string& path, Graph& graph, std::string& error);
+
+// Writes opset 13 with every initializer as float; used to hand synthetic
+// graphs to other runtimes for comparison
+void serializeOnnxModel(const Graph& graph, std::string& bytes);
+bool writeOnnxModel(const std::string& path, const Graph& graph);
+
+class Network {
+public:
+    Network();
+    ~Network();
+
+    // Optimizations (BatchNorm/activation folding, packed convolutions) are
+    // on by default and take effect at the next load(); off runs the
+    // reference kernels only. 0 threads uses every core.
+    void enableOptimizations(bool enabled);
+    void setNumThreads(int threads);
+
+    bool load(const std::string& onnx_path);
+    bool load(Graph graph);
+    bool empty() const;
+
+    const std::vector<ValueInfo>& getInputs() const;
+    const std::vector<ValueInfo>& getOutputs() const;
+
+    // Binds by name; an empty name binds the first graph input
+    void setInput(const Tensor& tensor, const std::string& name = "");
+
+    // Runs the graph and returns all graph outputs in declaration order
+    bool forward(std::vector<Tensor>& outputs);
+
+    const std::string& getLastError() const;
+    size_t getWeightBytes() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace runtime
+} // namespace ufra
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <string>
@@ -86,10 +87,11 @@ struct FaceLandmarks {
 struct Face {
     FaceBox box;
     FaceLandmarks landmarks;
-    cv::Mat aligned_crop;
+    cv::Mat aligned_crop;        // ROI view into the source frame, not a copy
+    cv::Mat parsing_mask;        // Face-parser labels (CV_8UC1) for the parser crop
     cv::Mat transform_matrix;
-    int track_id;
-    int frame_number;
+    int track_id = -1;           // Set by FaceTracker; -1 when untracked
+    int frame_number = 0;
 };
 
 // Age control structures
@@ -118,7 +120,8 @@ enum class ProcessingMode {
     FEEDFORWARD,
     DIFFUSION,
     HYBRID,
-    AUTO
+    AUTO,
+    KEYFRAME    // Feedforward on keyframes only, propagated in between (one clip, in order)
 };
 
 // GPU backend types
@@ -133,14 +136,34 @@ enum class GPUBackend {
 struct ModelConfig {
     std::string model_path;
     GPUBackend backend;
-    int batch_size;
+    int batch_size = 1;                 // Frames admitted per processBatch chunk
     bool use_half_precision;
     int max_resolution;
+    size_t memory_budget_bytes = 0;     // 0 = unlimited; see MemoryBudget
+    bool use_huge_pages = true;         // Large frames/tensors from HugePageArena
+    int face_batch_size = 16;           // Faces per network call across concurrent requests
+    int face_batch_delay_us = 2000;     // How long a face waits for others to join its batch
+    bool temporal_coherence = false;    // Track faces and reuse each track's previous result (per clip_id, in order)
+    int detection_interval = 1;         // With temporal_coherence: run the detector every Nth frame and after cuts
+    bool skip_unchanged_faces = false;  // Track faces and reuse a result while its ROI and controls are unchanged
+    int keyframe_max_interval = 12;     // KEYFRAME mode: frames after which a track is re-keyed; see KeyframePolicy
+    float keyframe_max_motion = 0.08f;
+    float keyframe_max_change = 0.03f;
+    bool deterministic = false;         // Bit-reproducible output on CPUs of one feature level; see output_hash
+    std::string result_cache_dir;       // Per-face results on disk by content hash; empty = off
+    size_t result_cache_max_bytes = size_t(8) << 30;
+    bool profile_counters = false;      // Per-stage perf_event counters (IPC, misses) in the metrics
+    std::string metrics_file;           // OpenMetrics text rewritten every 5 s; empty = off
+    int metrics_port = 0;               // OpenMetrics over HTTP on 127.0.0.1; 0 = off
+    bool auto_tune_batch = false;       // Measure face batch sizes per network at loadModels; see BatchTuner
+    float batch_latency_cap_ms = 100.0f;   // Longest network call auto-tuning may choose
+    std::string batch_tuning_file;      // Stored sweeps; empty = BatchTuner::defaultPath()
 };
 
 // Frame processing context
 struct FrameContext {
     int frame_number;
+    uint64_t clip_id = 0;        // Clip whose tracks and caches this frame continues
     ImageData input_frame;
     std::vector<Face> detected_faces;
     cv::Mat optical_flow;
@@ -155,6 +178,7 @@ struct ProcessingResult {
     std::map<std::string, float> metrics;
     bool success;
     std::string error_message;
+    uint64_t output_hash = 0;    // Content hash of output_frame, with ModelConfig::deterministic
 };
 
 // Callback types
@@ -1,4 +1,5 @@
 #include "ufra/age_estimator.h"
+#include "ufra/inference_session.h"
 #include <opencv2/dnn.hpp>
 #include <iostream>
 
@@ -11,15 +12,13 @@ public:
 
     bool loadModel(const std::string& model_path) {
         try {
-            net_ = cv::dnn::readNet(model_path);
-            if (net_.empty()) {
+            model_ = SharedModel::load(model_path, GPUBackend::CUDA, deterministic_);
+            if (!model_) {
                 std::cerr << "Failed to load age estimation model: " << model_path << std::endl;
                 return false;
             }
             
-            net_.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
-            net_.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
-            
+            sessions_ = std::make_unique<SessionPool>(model_);
             model_loaded_ = true;
             return true;
         }
@@ -36,8 +35,11 @@ public:
 
         try {
             // Preprocess image
-            cv::Mat resized;
-            cv::resize(face_crop, resized, cv::Size(input_width_, input_height_));
+            // Input-sized crops are used directly, without another resample
+            cv::Mat resized = face_crop;
+            if (face_crop.cols != input_width_ || face_crop.rows != input_height_) {
+                cv::resize(face_crop, resized, cv::Size(input_width_, input_height_));
+            }
             
             // Create blob
             cv::Mat blob;
@@ -45,10 +47,10 @@ public:
                                    cv::Size(input_width_, input_height_), 
                                    cv::Scalar(mean_, mean_, mean_), true, false);
             
-            net_.setInput(blob);
-            
-            // Run inference
-            cv::Mat output = net_.forward();
+            // Run inference on this thread's session
+            auto session = sessions_->acquire();
+            session->setInput(blob);
+            cv::Mat output = session->forward();
             
             // Extract age prediction (assuming regression output)
             float predicted_age = output.at<float>(0, 0);
@@ -73,7 +75,9 @@ public:
         return ages;
     }
 
-    cv::dnn::Net net_;
+    std::shared_ptr<SharedModel> model_;
+    bool deterministic_ = false;
+    std::unique_ptr<SessionPool> sessions_;
     bool model_loaded_;
     int input_width_, input_height_;
     float mean_, std_;
@@ -86,6 +90,10 @@ bool AgeEstimator::loadModel(const std::string& model_path) {
     return pImpl->loadModel(model_path);
 }
 
+void AgeEstimator::setDeterministic(bool enabled) {
+    pImpl->deterministic_ = enabled;
+}
+
 float AgeEstimator::estimateAge(const ImageData& face_crop) {
     return pImpl->estimateAge(face_crop);
 }
@@ -99,6 +107,10 @@ void AgeEstimator::setInputSize(int width, int height) {
     pImpl->input_height_ = height;
 }
 
+cv::Size AgeEstimator::getInputSize() const {
+    return cv::Size(pImpl->input_width_, pImpl->input_height_);
+}
+
 void AgeEstimator::setNormalization(float mean, float std) {
     pImpl->mean_ = mean;
     pImpl->std_ = std;
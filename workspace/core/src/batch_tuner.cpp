@@ -0,0 +1,219 @@
+#include "ufra/batch_tuner.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace ufra {
+
+namespace {
+
+// Within this fraction of the best time per item, the smaller batch wins
+constexpr double kThroughputTolerance = 0.05;
+
+// One line per key: "<key>\t<size>:<call_ms> <size>:<call_ms> ..."
+std::map<std::string, std::vector<BatchTiming>> readStore(const std::string& path) {
+    std::map<std::string, std::vector<BatchTiming>> entries;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t tab = line.find('\t');
+        if (line.empty() || line[0] == '#' || tab == std::string::npos) {
+            continue;
+        }
+        std::vector<BatchTiming> sweep;
+        std::istringstream fields(line.substr(tab + 1));
+        std::string field;
+        while (fields >> field) {
+            BatchTiming timing;
+            if (std::sscanf(field.c_str(), "%d:%lf", &timing.batch_size, &timing.call_ms) == 2 &&
+                timing.batch_size > 0 && timing.call_ms >= 0.0) {
+                sweep.push_back(timing);
+            }
+        }
+        if (!sweep.empty()) {
+            entries[line.substr(0, tab)] = sweep;
+        }
+    }
+    return entries;
+}
+
+} // namespace
+
+class BatchTuner::Impl {
+public:
+    mutable std::mutex mutex_;
+    std::string path_;
+    std::map<std::string, std::vector<BatchTiming>> entries_;
+};
+
+BatchTuner::BatchTuner() : pImpl(std::make_unique<Impl>()) {}
+BatchTuner::~BatchTuner() = default;
+
+bool BatchTuner::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->path_ = path.empty() ? defaultPath() : path;
+    pImpl->entries_ = readStore(pImpl->path_);
+    std::error_code error;
+    const fs::path parent = fs::path(pImpl->path_).parent_path();
+    if (!parent.empty()) {
+        fs::create_directories(parent, error);
+    }
+    return !error && access(parent.empty() ? "." : parent.c_str(), W_OK) == 0;
+}
+
+std::vector<BatchTiming> BatchTuner::lookup(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    auto it = pImpl->entries_.find(key);
+    return it == pImpl->entries_.end() ? std::vector<BatchTiming>() : it->second;
+}
+
+// Merges with entries other processes stored since open(), then replaces the
+// file by rename so concurrent readers never see a partial store
+bool BatchTuner::store(const std::string& key, const std::vector<BatchTiming>& sweep) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->entries_[key] = sweep;
+    if (pImpl->path_.empty()) {
+        return false;
+    }
+    std::map<std::string, std::vector<BatchTiming>> entries = readStore(pImpl->path_);
+    entries[key] = sweep;
+
+    const std::string temp_path = pImpl->path_ + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream out(temp_path, std::ios::trunc);
+        out << "# ufra batch size sweeps: key\tbatch:ms_per_call ...\n";
+        for (const auto& entry : entries) {
+            out << entry.first << '\t';
+            for (size_t i = 0; i < entry.second.size(); ++i) {
+                char field[48];
+                std::snprintf(field, sizeof(field), "%s%d:%.4f", i ? " " : "", entry.second[i].batch_size,
+                              entry.second[i].call_ms);
+                out << field;
+            }
+            out << '\n';
+        }
+        if (!out) {
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+    return std::rename(temp_path.c_str(), pImpl->path_.c_str()) == 0;
+}
+
+std::string BatchTuner::defaultPath() {
+    const char* cache = std::getenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    fs::path directory;
+    if (cache && *cache) {
+        directory = cache;
+    } else if (home && *home) {
+        directory = fs::path(home) / ".cache";
+    } else {
+        directory = fs::temp_directory_path();
+    }
+    return (directory / "ufra" / "batch_tuning.tsv").string();
+}
+
+std::string BatchTuner::machineKey() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    std::string model = "unknown";
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0 && line.find(':') != std::string::npos) {
+            model = line.substr(line.find(':') + 1);
+            break;
+        }
+    }
+    std::string key;
+    for (char c : model) {
+        bool keep = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' || c == '-';
+        if (keep) {
+            key += c;
+        } else if (!key.empty() && key.back() != '_') {
+            key += '_';
+        }
+    }
+    if (!key.empty() && key.back() != '_') {
+        key += '_';
+    }
+    return key + std::to_string(std::thread::hardware_concurrency()) + "t";
+}
+
+std::vector<BatchTiming> BatchTuner::sweep(const std::function<void(int)>& run, const std::vector<int>& candidates,
+                                           double latency_cap_ms, int repeats) {
+    std::vector<int> sizes = candidates;
+    std::sort(sizes.begin(), sizes.end());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+
+    std::vector<BatchTiming> timings;
+    for (int size : sizes) {
+        if (size < 1) {
+            continue;
+        }
+        run(size);   // Warm-up: first-call allocations and kernel selection
+        std::vector<double> samples;
+        for (int r = 0; r < std::max(1, repeats); ++r) {
+            const auto start = std::chrono::steady_clock::now();
+            run(size);
+            samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+        BatchTiming timing;
+        timing.batch_size = size;
+        timing.call_ms = samples[samples.size() / 2];
+        timings.push_back(timing);
+        if (latency_cap_ms > 0.0 && timing.call_ms > latency_cap_ms) {
+            break;
+        }
+    }
+    return timings;
+}
+
+bool BatchTuner::covers(const std::vector<BatchTiming>& sweep, const std::vector<int>& candidates,
+                        double latency_cap_ms) {
+    if (sweep.empty()) {
+        return false;
+    }
+    const BatchTiming& largest = sweep.back();
+    const bool stopped_at_cap = latency_cap_ms > 0.0 && largest.call_ms > latency_cap_ms;
+    for (int size : candidates) {
+        const bool swept = std::any_of(sweep.begin(), sweep.end(),
+                                       [size](const BatchTiming& timing) { return timing.batch_size == size; });
+        if (!swept && (size < largest.batch_size || !stopped_at_cap)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int BatchTuner::select(const std::vector<BatchTiming>& sweep, double latency_cap_ms) {
+    auto fits = [latency_cap_ms](const BatchTiming& timing) {
+        return latency_cap_ms <= 0.0 || timing.call_ms <= latency_cap_ms;
+    };
+    double best_item_ms = -1.0;
+    for (const BatchTiming& timing : sweep) {
+        if (fits(timing) && (best_item_ms < 0.0 || timing.itemMs() < best_item_ms)) {
+            best_item_ms = timing.itemMs();
+        }
+    }
+    int chosen = 0;
+    for (const BatchTiming& timing : sweep) {
+        if (fits(timing) && timing.itemMs() <= best_item_ms * (1.0 + kThroughputTolerance) &&
+            (chosen == 0 || timing.batch_size < chosen)) {
+            chosen = timing.batch_size;
+        }
+    }
+    return std::max(1, chosen);
+}
+
+} // namespace ufra
@@ -0,0 +1,435 @@
+#include "conv_kernels.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ufra {
+namespace runtime {
+
+namespace {
+
+// One SIMD register of output channels. Lane count and instructions are fixed
+// at compile time, like the image kernels; the packed weight layout follows.
+#if defined(__AVX512F__)
+constexpr int kLanes = 16;
+using Vec = __m512;
+inline Vec vzero() { return _mm512_setzero_ps(); }
+inline Vec vload(const float* p) { return _mm512_loadu_ps(p); }
+inline void vstore(float* p, Vec v) { _mm512_storeu_ps(p, v); }
+inline Vec vset(float x) { return _mm512_set1_ps(x); }
+inline Vec vfmadd(Vec a, Vec b, Vec c) { return _mm512_fmadd_ps(a, b, c); }
+inline Vec vmax(Vec a, Vec b) { return _mm512_max_ps(a, b); }
+inline Vec vmin(Vec a, Vec b) { return _mm512_min_ps(a, b); }
+inline Vec vadd(Vec a, Vec b) { return _mm512_add_ps(a, b); }
+inline Vec vmul(Vec a, Vec b) { return _mm512_mul_ps(a, b); }
+#elif defined(__AVX2__) && defined(__FMA__)
+constexpr int kLanes = 8;
+using Vec = __m256;
+inline Vec vzero() { return _mm256_setzero_ps(); }
+inline Vec vload(const float* p) { return _mm256_loadu_ps(p); }
+inline void vstore(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+inline Vec vset(float x) { return _mm256_set1_ps(x); }
+inline Vec vfmadd(Vec a, Vec b, Vec c) { return _mm256_fmadd_ps(a, b, c); }
+inline Vec vmax(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+inline Vec vmin(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+inline Vec vadd(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+inline Vec vmul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+#elif defined(__SSE2__)
+constexpr int kLanes = 4;
+using Vec = __m128;
+inline Vec vzero() { return _mm_setzero_ps(); }
+inline Vec vload(const float* p) { return _mm_loadu_ps(p); }
+inline void vstore(float* p, Vec v) { _mm_storeu_ps(p, v); }
+inline Vec vset(float x) { return _mm_set1_ps(x); }
+inline Vec vfmadd(Vec a, Vec b, Vec c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline Vec vmax(Vec a, Vec b) { return _mm_max_ps(a, b); }
+inline Vec vmin(Vec a, Vec b) { return _mm_min_ps(a, b); }
+inline Vec vadd(Vec a, Vec b) { return _mm_add_ps(a, b); }
+inline Vec vmul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+#else
+constexpr int kLanes = 4;
+struct Vec {
+    float v[4];
+};
+inline Vec vzero() { return Vec{{0.0f, 0.0f, 0.0f, 0.0f}}; }
+inline Vec vload(const float* p) { return Vec{{p[0], p[1], p[2], p[3]}}; }
+inline void vstore(float* p, Vec a) { std::copy(a.v, a.v + 4, p); }
+inline Vec vset(float x) { return Vec{{x, x, x, x}}; }
+template <typename F>
+inline Vec vmap(Vec a, Vec b, F f) {
+    return Vec{{f(a.v[0], b.v[0]), f(a.v[1], b.v[1]), f(a.v[2], b.v[2]), f(a.v[3], b.v[3])}};
+}
+inline Vec vadd(Vec a, Vec b) { return vmap(a, b, [](float x, float y) { return x + y; }); }
+inline Vec vmul(Vec a, Vec b) { return vmap(a, b, [](float x, float y) { return x * y; }); }
+inline Vec vmax(Vec a, Vec b) { return vmap(a, b, [](float x, float y) { return std::max(x, y); }); }
+inline Vec vmin(Vec a, Vec b) { return vmap(a, b, [](float x, float y) { return std::min(x, y); }); }
+inline Vec vfmadd(Vec a, Vec b, Vec c) { return vadd(vmul(a, b), c); }
+#endif
+
+// Output pixels per register tile. With kLanes channels each this keeps the
+// accumulators, one weight vector and one broadcast in registers.
+constexpr int kTile = 8;
+
+inline Vec activate(const PackedConv& conv, Vec v) {
+    switch (conv.activation) {
+        case Activation::RELU:
+            return vmax(v, vzero());
+        case Activation::LEAKY_RELU:
+            return vadd(vmax(v, vzero()), vmul(vset(conv.alpha), vmin(v, vzero())));
+        case Activation::CLIP:
+            return vmin(vmax(v, vset(conv.lower)), vset(conv.upper));
+        default:
+            return v;
+    }
+}
+
+inline float activate(const PackedConv& conv, float v) {
+    switch (conv.activation) {
+        case Activation::RELU:
+            return std::max(v, 0.0f);
+        case Activation::LEAKY_RELU:
+            return v < 0.0f ? v * conv.alpha : v;
+        case Activation::CLIP:
+            return std::min(std::max(v, conv.lower), conv.upper);
+        default:
+            return v;
+    }
+}
+
+// Accumulates a T-pixel row tile for one block of output channels. `in`
+// points at the top-left input tap of the first pixel in the (padded) input.
+template <int T>
+inline void accumulateTile(const float* in, size_t in_plane, int in_width, const float* weights,
+                           int in_channels, int kernel_h, int kernel_w, int stride_w,
+                           int dilation_h, int dilation_w, Vec* acc) {
+    for (int ic = 0; ic < in_channels; ++ic) {
+        const float* in_c = in + ic * in_plane;
+        const float* w_c = weights + static_cast<size_t>(ic) * kernel_h * kernel_w * kLanes;
+        for (int ky = 0; ky < kernel_h; ++ky) {
+            const float* row = in_c + static_cast<size_t>(ky) * dilation_h * in_width;
+            for (int kx = 0; kx < kernel_w; ++kx) {
+                const Vec w = vload(w_c + (ky * kernel_w + kx) * kLanes);
+                const float* p = row + kx * dilation_w;
+                for (int j = 0; j < T; ++j) {
+                    acc[j] = vfmadd(vset(p[j * stride_w]), w, acc[j]);
+                }
+            }
+        }
+    }
+}
+
+// Transposes the channel-blocked accumulators into NCHW output planes
+template <int T>
+inline void storeTile(const PackedConv& conv, const Vec* acc, int valid_lanes, float* out, size_t out_plane) {
+    alignas(64) float lanes[T * kLanes];
+    for (int j = 0; j < T; ++j) {
+        vstore(lanes + j * kLanes, activate(conv, acc[j]));
+    }
+    for (int l = 0; l < valid_lanes; ++l) {
+        float* o = out + l * out_plane;
+        for (int j = 0; j < T; ++j) {
+            o[j] = lanes[j * kLanes + l];
+        }
+    }
+}
+
+template <int T>
+inline void convTile(const PackedConv& conv, const ConvWindow& win, const float* in, size_t in_plane,
+                     int in_width, const float* weights, const float* bias, int valid_lanes,
+                     float* out, size_t out_plane) {
+    Vec acc[T];
+    const Vec b = vload(bias);
+    for (int j = 0; j < T; ++j) {
+        acc[j] = b;
+    }
+    accumulateTile<T>(in, in_plane, in_width, weights, conv.in_channels, conv.kernel_h, conv.kernel_w,
+                      win.stride_w, win.dilation_h, win.dilation_w, acc);
+    storeTile<T>(conv, acc, valid_lanes, out, out_plane);
+}
+
+// --- Worker pool --------------------------------------------------------------
+
+class WorkerPool {
+public:
+    static WorkerPool& instance() {
+        // Leaked on purpose: workers block forever and must not be joined
+        // during static destruction
+        static WorkerPool* pool = new WorkerPool();
+        return *pool;
+    }
+
+    void run(size_t count, int max_threads, const std::function<void(size_t)>& fn) {
+        std::unique_lock<std::mutex> busy(run_mutex_, std::try_to_lock);
+        size_t helpers = workers_.size();
+        if (max_threads > 0) {
+            helpers = std::min(helpers, static_cast<size_t>(max_threads - 1));
+        }
+        helpers = std::min(helpers, count > 0 ? count - 1 : 0);
+        if (!busy.owns_lock() || helpers == 0) {
+            for (size_t i = 0; i < count; ++i) {
+                fn(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &fn;
+            count_ = count;
+            next_ = 0;
+            active_ = helpers;
+            pending_ = helpers;
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        drain(fn, count);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+        job_ = nullptr;
+    }
+
+private:
+    WorkerPool() {
+        unsigned threads = std::thread::hardware_concurrency();
+        for (unsigned i = 1; i < threads; ++i) {
+            workers_.emplace_back([this, i] { loop(i - 1); });
+        }
+    }
+
+    void drain(const std::function<void(size_t)>& fn, size_t count) {
+        for (size_t i = next_.fetch_add(1); i < count; i = next_.fetch_add(1)) {
+            fn(i);
+        }
+    }
+
+    void loop(size_t index) {
+        uint64_t seen = 0;
+        for (;;) {
+            const std::function<void(size_t)>* job;
+            size_t count;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return generation_ != seen; });
+                seen = generation_;
+                if (index >= active_) {
+                    continue;
+                }
+                job = job_;
+                count = count_;
+            }
+            drain(*job, count);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --pending_;
+            }
+            done_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex run_mutex_;          // One parallel region at a time
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* job_ = nullptr;
+    size_t count_ = 0;
+    std::atomic<size_t> next_{0};
+    size_t active_ = 0;
+    size_t pending_ = 0;
+    uint64_t generation_ = 0;
+};
+
+// Zero-padded copy of the input so the tile loops need no bounds checks
+const float* padInput(const Tensor& x, int planes, int h, int w, const ConvWindow& win,
+                      std::vector<float>& buffer, int& padded_h, int& padded_w, int max_threads) {
+    padded_h = h + win.pad_top + win.pad_bottom;
+    padded_w = w + win.pad_left + win.pad_right;
+    if (win.pad_top == 0 && win.pad_left == 0 && win.pad_bottom == 0 && win.pad_right == 0) {
+        return x.data.data();
+    }
+
+    const size_t padded_plane = static_cast<size_t>(padded_h) * padded_w;
+    buffer.assign(padded_plane * planes, 0.0f);
+    parallelFor(planes, max_threads, [&](size_t p) {
+        const float* src = x.data.data() + p * static_cast<size_t>(h) * w;
+        float* dst = buffer.data() + p * padded_plane + static_cast<size_t>(win.pad_top) * padded_w + win.pad_left;
+        for (int y = 0; y < h; ++y) {
+            std::copy(src + static_cast<size_t>(y) * w, src + static_cast<size_t>(y + 1) * w,
+                      dst + static_cast<size_t>(y) * padded_w);
+        }
+    });
+    return buffer.data();
+}
+
+void depthwiseRow(const PackedConv& conv, const ConvWindow& win, const float* in, int in_width,
+                  const float* weights, float bias, float* out, int out_width) {
+    int ox = 0;
+    if (win.stride_w == 1) {
+        const Vec b = vset(bias);
+        for (; ox + kLanes <= out_width; ox += kLanes) {
+            Vec acc = b;
+            for (int ky = 0; ky < conv.kernel_h; ++ky) {
+                const float* row = in + static_cast<size_t>(ky) * win.dilation_h * in_width + ox;
+                for (int kx = 0; kx < conv.kernel_w; ++kx) {
+                    acc = vfmadd(vload(row + kx * win.dilation_w), vset(weights[ky * conv.kernel_w + kx]), acc);
+                }
+            }
+            vstore(out + ox, activate(conv, acc));
+        }
+    }
+    for (; ox < out_width; ++ox) {
+        float acc = bias;
+        for (int ky = 0; ky < conv.kernel_h; ++ky) {
+            const float* row = in + static_cast<size_t>(ky) * win.dilation_h * in_width + ox * win.stride_w;
+            for (int kx = 0; kx < conv.kernel_w; ++kx) {
+                acc += row[kx * win.dilation_w] * weights[ky * conv.kernel_w + kx];
+            }
+        }
+        out[ox] = activate(conv, acc);
+    }
+}
+
+} // namespace
+
+int convLanes() {
+    return kLanes;
+}
+
+void parallelFor(size_t count, int max_threads, const std::function<void(size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1 || max_threads == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+    WorkerPool::instance().run(count, max_threads, fn);
+}
+
+void packConv(const Tensor& weights, const Tensor* bias, int group, PackedConv& conv) {
+    conv.out_channels = static_cast<int>(weights.shape[0]);
+    conv.in_channels = static_cast<int>(weights.shape[1]);
+    conv.group = group;
+    conv.kernel_h = weights.rank() == 4 ? static_cast<int>(weights.shape[2]) : 1;
+    conv.kernel_w = static_cast<int>(weights.shape.back());
+    const int group_out = conv.out_channels / group;
+    const size_t taps = static_cast<size_t>(conv.kernel_h) * conv.kernel_w;
+
+    // One input and one output channel per group: per-plane kernel, plain layout
+    conv.depthwise = (group > 1 && conv.in_channels == 1 && group_out == 1);
+    if (conv.depthwise) {
+        conv.blocks_per_group = 1;
+        conv.weights = weights.data;
+        conv.bias.assign(conv.out_channels, 0.0f);
+        if (bias) {
+            std::copy(bias->data.begin(), bias->data.end(), conv.bias.begin());
+        }
+        return;
+    }
+
+    const int blocks = (group_out + kLanes - 1) / kLanes;
+    conv.blocks_per_group = blocks;
+    conv.weights.assign(static_cast<size_t>(group) * blocks * conv.in_channels * taps * kLanes, 0.0f);
+    conv.bias.assign(static_cast<size_t>(group) * blocks * kLanes, 0.0f);
+
+    for (int m = 0; m < conv.out_channels; ++m) {
+        const int g = m / group_out, local = m % group_out;
+        const int block = local / kLanes, lane = local % kLanes;
+        const size_t block_base = static_cast<size_t>(g) * blocks + block;
+        for (int ic = 0; ic < conv.in_channels; ++ic) {
+            for (size_t t = 0; t < taps; ++t) {
+                conv.weights[((block_base * conv.in_channels + ic) * taps + t) * kLanes + lane] =
+                    weights.data[(static_cast<size_t>(m) * conv.in_channels + ic) * taps + t];
+            }
+        }
+        if (bias) {
+            conv.bias[block_base * kLanes + lane] = bias->data[m];
+        }
+    }
+}
+
+void runPackedConv(const PackedConv& conv, const ConvWindow& win, const Tensor& x, Tensor& y, int max_threads) {
+    const int batch = static_cast<int>(x.shape[0]);
+    const int channels = static_cast<int>(x.shape[1]);
+    const int in_h = x.rank() == 4 ? static_cast<int>(x.shape[2]) : 1;
+    const int in_w = static_cast<int>(x.shape.back());
+
+    const int out_h = (in_h + win.pad_top + win.pad_bottom - ((conv.kernel_h - 1) * win.dilation_h + 1)) / win.stride_h + 1;
+    const int out_w = (in_w + win.pad_left + win.pad_right - ((conv.kernel_w - 1) * win.dilation_w + 1)) / win.stride_w + 1;
+    y.shape = x.rank() == 4 ? std::vector<int64_t>{batch, conv.out_channels, out_h, out_w}
+                            : std::vector<int64_t>{batch, conv.out_channels, out_w};
+    y.data.resize(shapeSize(y.shape));
+
+    thread_local std::vector<float> padded_buffer;
+    int padded_h, padded_w;
+    const float* padded = padInput(x, batch * channels, in_h, in_w, win, padded_buffer, padded_h, padded_w,
+                                   max_threads);
+    const size_t in_plane = static_cast<size_t>(padded_h) * padded_w;
+    const size_t out_plane = static_cast<size_t>(out_h) * out_w;
+    const size_t row_step = static_cast<size_t>(win.stride_h) * padded_w;
+
+    if (conv.depthwise) {
+        const size_t taps = static_cast<size_t>(conv.kernel_h) * conv.kernel_w;
+        parallelFor(static_cast<size_t>(batch) * channels, max_threads, [&](size_t p) {
+            const int c = static_cast<int>(p % channels);
+            const float* in = padded + p * in_plane;
+            float* out = y.data.data() + p * out_plane;
+            for (int oy = 0; oy < out_h; ++oy) {
+                depthwiseRow(conv, win, in + oy * row_step, padded_w, conv.weights.data() + c * taps,
+                             conv.bias[c], out + static_cast<size_t>(oy) * out_w, out_w);
+            }
+        });
+        return;
+    }
+
+    // Work items are (image, group, channel block, output row); rows of one
+    // block reuse the same packed weights while they are hot in cache
+    const int blocks = conv.blocks_per_group;
+    const int group_out = conv.out_channels / conv.group;
+    const size_t block_weights = static_cast<size_t>(conv.in_channels) * conv.kernel_h * conv.kernel_w * kLanes;
+    const size_t items = static_cast<size_t>(batch) * conv.group * blocks * out_h;
+
+    parallelFor(items, max_threads, [&](size_t item) {
+        const int oy = static_cast<int>(item % out_h);
+        size_t rest = item / out_h;
+        const int block = static_cast<int>(rest % blocks);
+        rest /= blocks;
+        const int g = static_cast<int>(rest % conv.group);
+        const int n = static_cast<int>(rest / conv.group);
+
+        const size_t block_index = static_cast<size_t>(g) * blocks + block;
+        const float* weights = conv.weights.data() + block_index * block_weights;
+        const float* bias = conv.bias.data() + block_index * kLanes;
+        const int valid_lanes = std::min(kLanes, group_out - block * kLanes);
+
+        const float* in = padded + (static_cast<size_t>(n) * channels + g * conv.in_channels) * in_plane + oy * row_step;
+        float* out = y.data.data() +
+                     (static_cast<size_t>(n) * conv.out_channels + g * group_out + block * kLanes) * out_plane +
+                     static_cast<size_t>(oy) * out_w;
+
+        int ox = 0;
+        for (; ox + kTile <= out_w; ox += kTile) {
+            convTile<kTile>(conv, win, in + ox * win.stride_w, in_plane, padded_w, weights, bias,
+                            valid_lanes, out + ox, out_plane);
+        }
+        for (; ox < out_w; ++ox) {
+            convTile<1>(conv, win, in + ox * win.stride_w, in_plane, padded_w, weights, bias,
+                        valid_lanes, out + ox, out_plane);
+        }
+    });
+}
+
+} // namespace runtime
+} // namespace ufra
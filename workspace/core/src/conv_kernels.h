@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ufra/tensor_runtime.h"
+#include <functional>
+
+namespace ufra {
+namespace runtime {
+
+// Internal to the tensor runtime: packed-weight direct convolution and the
+// worker pool it runs on.
+
+struct ConvWindow {
+    int kernel_h = 1, kernel_w = 1;
+    int stride_h = 1, stride_w = 1;
+    int dilation_h = 1, dilation_w = 1;
+    int pad_top = 0, pad_left = 0, pad_bottom = 0, pad_right = 0;
+};
+
+enum class Activation {
+    NONE,
+    RELU,
+    LEAKY_RELU,   // alpha
+    CLIP          // [lower, upper], covers ReLU6
+};
+
+// Convolution with weights repacked at load time. Output channels of each
+// group are padded to blocks of convLanes() and stored OIhw<lanes>o, so one
+// vector load yields the tap weight for a whole block of output channels.
+// BatchNormalization and a following activation may be folded in.
+struct PackedConv {
+    int out_channels = 0;
+    int in_channels = 0;   // Per group
+    int group = 1;
+    int kernel_h = 1, kernel_w = 1;
+    bool depthwise = false;
+    int blocks_per_group = 0;
+
+    std::vector<float> weights;   // [group][block][in_channels][kh][kw][lanes]
+    std::vector<float> bias;      // [group][block][lanes]
+
+    Activation activation = Activation::NONE;
+    float alpha = 0.0f;
+    float lower = 0.0f, upper = 0.0f;
+};
+
+int convLanes();
+
+// `weights` is ONNX layout [out_channels, in_channels / group, kh, kw]
+void packConv(const Tensor& weights, const Tensor* bias, int group, PackedConv& conv);
+
+// NCHW in, NCHW out (rank 3 inputs are treated as height 1)
+void runPackedConv(const PackedConv& conv, const ConvWindow& window, const Tensor& x, Tensor& y,
+                   int max_threads);
+
+// Runs fn(0..count-1) on the shared worker pool, using at most `max_threads`
+// threads including the caller (0 = all). Nested or concurrent calls run
+// inline on the calling thread.
+void parallelFor(size_t count, int max_threads, const std::function<void(size_t)>& fn);
+
+} // namespace runtime
+} // namespace ufra
@@ -0,0 +1,79 @@
+#include "ufra/crop_cache.h"
+#include "ufra/frame_pyramid.h"
+#include <opencv2/imgproc.hpp>
+#include <map>
+#include <tuple>
+
+namespace ufra {
+
+class CropCache::Impl {
+public:
+    // Faces are identified by the ROI they view, so detector crops and
+    // caller-supplied crops are handled alike.
+    using Key = std::tuple<const uchar*, int, int, int, int>;
+
+    const ImageData& getResized(const Face& face, const cv::Size& size) {
+        const cv::Mat& crop = face.aligned_crop;
+        if (crop.empty() || crop.size() == size) {
+            return crop;
+        }
+
+        Key key(crop.data, crop.cols, crop.rows, size.width, size.height);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            ++hits_;
+            return it->second;
+        }
+
+        cv::Mat& resized = entries_[key];
+        cv::Rect roi;
+        if (pyramid_ && pyramid_->locate(crop, roi)) {
+            resized = pyramid_->sample(roi, size);
+        } else {
+            int interpolation = (size.width < crop.cols) ? cv::INTER_AREA : cv::INTER_LINEAR;
+            cv::resize(crop, resized, size, 0, 0, interpolation);
+        }
+        ++resizes_;
+        memory_bytes_ += resized.total() * resized.elemSize();
+        return resized;
+    }
+
+    void reset(FramePyramid* pyramid) {
+        pyramid_ = pyramid;
+        entries_.clear();
+        resizes_ = 0;
+        hits_ = 0;
+        memory_bytes_ = 0;
+    }
+
+    FramePyramid* pyramid_ = nullptr;
+    std::map<Key, cv::Mat> entries_;
+    size_t resizes_ = 0;
+    size_t hits_ = 0;
+    size_t memory_bytes_ = 0;
+};
+
+CropCache::CropCache() : pImpl(std::make_unique<Impl>()) {}
+CropCache::~CropCache() = default;
+
+const ImageData& CropCache::getResized(const Face& face, const cv::Size& size) {
+    return pImpl->getResized(face, size);
+}
+
+void CropCache::reset(FramePyramid* pyramid) {
+    pImpl->reset(pyramid);
+}
+
+size_t CropCache::getResizeCount() const {
+    return pImpl->resizes_;
+}
+
+size_t CropCache::getHitCount() const {
+    return pImpl->hits_;
+}
+
+size_t CropCache::getMemoryBytes() const {
+    return pImpl->memory_bytes_;
+}
+
+} // namespace ufra
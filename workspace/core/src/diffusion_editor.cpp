@@ -0,0 +1,280 @@
+#include "ufra/diffusion_editor.h"
+#include "ufra/inference_session.h"
+#include "ufra/temporal_cache.h"
+#include <opencv2/dnn.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+
+namespace ufra {
+
+namespace {
+
+constexpr int kTrainSteps = 1000;          // Length of the training noise schedule
+constexpr float kMinWarmStrength = 0.25f;  // Share of the schedule a warm start always re-runs
+constexpr float kResidualGain = 8.0f;      // Warp residual -> extra share of the schedule
+
+// Standard normal noise by Box-Muller over mt19937 words. Unlike
+// std::normal_distribution, the sequence is the same with every standard library.
+void fillNormal(cv::Mat& noise, unsigned int seed) {
+    constexpr double kTwoPi = 6.283185307179586;
+    std::mt19937 rng(seed);
+    float* values = noise.ptr<float>();
+    const size_t count = noise.total() * noise.channels();
+    for (size_t i = 0; i < count; i += 2) {
+        const double u1 = (static_cast<double>(rng()) + 1.0) / 4294967297.0;
+        const double u2 = static_cast<double>(rng()) / 4294967296.0;
+        const double radius = std::sqrt(-2.0 * std::log(u1));
+        values[i] = static_cast<float>(radius * std::cos(kTwoPi * u2));
+        if (i + 1 < count) {
+            values[i + 1] = static_cast<float>(radius * std::sin(kTwoPi * u2));
+        }
+    }
+}
+
+} // namespace
+
+// Pixel-space DDIM sampler around a noise-prediction UNet
+// (sample, timestep, age -> predicted noise), deterministic for a seed
+class DiffusionEditor::Impl {
+public:
+    Impl() {
+        // Linear beta schedule
+        alphas_cumprod_.resize(kTrainSteps);
+        double product = 1.0;
+        for (int t = 0; t < kTrainSteps; ++t) {
+            const double beta = 1e-4 + (0.02 - 1e-4) * t / (kTrainSteps - 1);
+            product *= 1.0 - beta;
+            alphas_cumprod_[t] = static_cast<float>(product);
+        }
+    }
+
+    bool loadModel(const std::string& model_dir) {
+        try {
+            auto model = SharedModel::load(model_dir + "/unet.onnx", GPUBackend::CUDA, deterministic_);
+            if (!model) {
+                std::cerr << "Failed to load diffusion model: " << model_dir << std::endl;
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            model_ = model;
+            sessions_ = std::make_shared<SessionPool>(model_);
+            return true;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error loading diffusion model: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    // Actor-specific UNet fine-tunes replace the base network
+    bool loadIdentityAdapter(const std::string& adapter_path) {
+        try {
+            auto adapter = SharedModel::load(adapter_path, GPUBackend::CUDA, deterministic_);
+            if (!adapter) {
+                std::cerr << "Failed to load identity adapter: " << adapter_path << std::endl;
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            sessions_ = std::make_shared<SessionPool>(adapter);
+            return true;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error loading identity adapter: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    ImageData generateAgedFace(const ImageData& face_crop, const AgeControls& controls,
+                               const MaskImage& parsing_mask, const TemporalPrior& prior, unsigned int seed,
+                               cv::Mat& noise, int& steps_run) {
+        steps_run = 0;
+        std::shared_ptr<SessionPool> sessions;
+        int steps;
+        float guidance;
+        bool temporal;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            sessions = sessions_;
+            steps = steps_;
+            guidance = guidance_scale_;
+            temporal = temporal_coherence_;
+        }
+        if (!sessions || face_crop.empty()) {
+            return face_crop.clone();
+        }
+
+        try {
+            const cv::Size size(input_size_, input_size_);
+            cv::Mat crop = face_crop;
+            if (crop.size() != size) {
+                cv::resize(face_crop, crop, size);
+            }
+
+            // Cold start from pure noise; warm start from the warped previous
+            // result, re-noised with the warped previous noise so grain stays
+            // attached to the face
+            float strength = 1.0f;
+            const bool warm = temporal && prior.valid && prior.result.size() == size &&
+                              prior.state.size() == size && prior.state.type() == CV_32FC3;
+            if (warm) {
+                noise = prior.state.clone();
+                strength = std::min(1.0f, kMinWarmStrength + prior.residual * kResidualGain);
+            } else {
+                noise.create(size, CV_32FC3);
+                fillNormal(noise, seed);
+            }
+
+            const int start = std::max(0, static_cast<int>(std::lround(strength * (kTrainSteps - 1))));
+            const int count = std::max(1, static_cast<int>(std::ceil(std::max(1, steps) * strength)));
+            cv::Mat sample;
+            const float start_alpha = alphas_cumprod_[start];
+            if (warm) {
+                cv::Mat init;
+                prior.result.convertTo(init, CV_32F, 2.0 / 255.0, -1.0);
+                sample = init * std::sqrt(start_alpha) + noise * std::sqrt(1.0f - start_alpha);
+            } else {
+                sample = noise.clone();
+            }
+
+            cv::Mat age_input(1, 1, CV_32F, cv::Scalar(controls.target_age / 100.0f));
+            cv::Mat uncond_input(1, 1, CV_32F, cv::Scalar(-1.0f));
+            auto session = sessions->acquire();
+            for (int i = 0; i < count; ++i) {
+                const int t = start - (start * i) / count;
+                const int t_prev = start - (start * (i + 1)) / count;
+                cv::Mat eps = predictNoise(*session, sample, t, age_input);
+                if (guidance > 1.0f) {
+                    cv::Mat eps_uncond = predictNoise(*session, sample, t, uncond_input);
+                    eps = eps_uncond + (eps - eps_uncond) * guidance;
+                }
+                // DDIM (eta = 0) update
+                const float alpha = alphas_cumprod_[t];
+                const float alpha_prev = i + 1 == count ? 1.0f : alphas_cumprod_[t_prev];
+                cv::Mat x0 = (sample - eps * std::sqrt(1.0f - alpha)) / std::sqrt(alpha);
+                x0 = cv::min(cv::max(x0, -1.0), 1.0);
+                sample = x0 * std::sqrt(alpha_prev) + eps * std::sqrt(1.0f - alpha_prev);
+                ++steps_run;
+            }
+
+            cv::Mat aged;
+            sample.convertTo(aged, CV_8UC3, 127.5, 127.5);
+
+            // Identity lock and background from the source crop
+            cv::Mat result;
+            cv::addWeighted(crop, controls.identity_lock_strength, aged, 1.0f - controls.identity_lock_strength, 0,
+                            result);
+            if (!parsing_mask.empty()) {
+                cv::Mat background;
+                cv::Mat mask = parsing_mask;
+                if (mask.size() != size) {
+                    cv::resize(parsing_mask, mask, size, 0, 0, cv::INTER_NEAREST);
+                }
+                cv::compare(mask, 0, background, cv::CMP_EQ);
+                crop.copyTo(result, background);
+            }
+            return result;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error in diffusion editing: " << e.what() << std::endl;
+            return face_crop.clone();
+        }
+    }
+
+    cv::Mat predictNoise(InferenceSession& session, const cv::Mat& sample, int t, const cv::Mat& age) {
+        cv::Mat blob = cv::dnn::blobFromImage(sample, 1.0, cv::Size(), cv::Scalar(), false, false, CV_32F);
+        cv::Mat timestep(1, 1, CV_32F, cv::Scalar(static_cast<float>(t)));
+        session.setInput(blob, "sample");
+        session.setInput(timestep, "timestep");
+        session.setInput(age, "age");
+        std::vector<cv::Mat> images;
+        cv::dnn::imagesFromBlob(session.forward(), images);
+        return images.front();
+    }
+
+    std::vector<float> alphas_cumprod_;
+    int input_size_ = 256;
+
+    mutable std::mutex mutex_;
+    std::shared_ptr<SharedModel> model_;
+    bool deterministic_ = false;
+    std::shared_ptr<SessionPool> sessions_;
+    int steps_ = 30;
+    float guidance_scale_ = 1.0f;
+    unsigned int seed_ = 0;
+    bool temporal_coherence_ = false;
+};
+
+DiffusionEditor::DiffusionEditor() : pImpl(std::make_unique<Impl>()) {}
+
+DiffusionEditor::~DiffusionEditor() = default;
+
+bool DiffusionEditor::loadModel(const std::string& model_dir) {
+    return pImpl->loadModel(model_dir);
+}
+
+void DiffusionEditor::setDeterministic(bool enabled) {
+    pImpl->deterministic_ = enabled;
+}
+
+ImageData DiffusionEditor::generateAgedFace(const ImageData& face_crop, const AgeControls& controls,
+                                            const MaskImage& parsing_mask) {
+    cv::Mat noise;
+    int steps_run = 0;
+    return pImpl->generateAgedFace(face_crop, controls, parsing_mask, TemporalPrior(), getSeed(), noise, steps_run);
+}
+
+ImageData DiffusionEditor::generateAgedFace(const ImageData& face_crop, const AgeControls& controls,
+                                            const MaskImage& parsing_mask, const TemporalPrior& prior,
+                                            unsigned int seed, cv::Mat& noise, int& steps_run) {
+    return pImpl->generateAgedFace(face_crop, controls, parsing_mask, prior, seed, noise, steps_run);
+}
+
+bool DiffusionEditor::loadIdentityAdapter(const std::string& adapter_path) {
+    return pImpl->loadIdentityAdapter(adapter_path);
+}
+
+void DiffusionEditor::setDiffusionSteps(int steps) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->steps_ = std::max(1, steps);
+}
+
+void DiffusionEditor::setGuidanceScale(float scale) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->guidance_scale_ = scale;
+}
+
+void DiffusionEditor::setSeed(unsigned int seed) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->seed_ = seed;
+}
+
+unsigned int DiffusionEditor::getSeed() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->seed_;
+}
+
+unsigned int DiffusionEditor::faceSeed(unsigned int seed, int frame_number, int face_key) {
+    // splitmix64 finalizer over the three inputs
+    uint64_t value = (static_cast<uint64_t>(seed) << 32) ^
+                     (static_cast<uint64_t>(static_cast<uint32_t>(frame_number)) * 0x9E3779B97F4A7C15ULL) ^
+                     (static_cast<uint64_t>(static_cast<uint32_t>(face_key)) * 0xC2B2AE3D27D4EB4FULL);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return static_cast<unsigned int>(value ^ (value >> 31));
+}
+
+void DiffusionEditor::enableTemporalCoherence(bool enable) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->temporal_coherence_ = enable;
+}
+
+cv::Size DiffusionEditor::getInputSize() const {
+    return cv::Size(pImpl->input_size_, pImpl->input_size_);
+}
+
+} // namespace ufra
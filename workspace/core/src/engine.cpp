@@ -7,13 +7,218 @@
 #include "ufra/diffusion_editor.h"
 #include "ufra/optical_flow.h"
 #include "ufra/compositor.h"
+#include "ufra/crop_cache.h"
+#include "ufra/frame_pyramid.h"
 #include "ufra/gpu_memory_manager.h"
+#include "ufra/huge_page_allocator.h"
 #include "ufra/model_loader.h"
+#include "ufra/inference_session.h"
+#include "ufra/memory_budget.h"
+#include "ufra/batch_scheduler.h"
+#include "ufra/temporal_cache.h"
+#include "ufra/scene_cut_detector.h"
+#include "ufra/keyframe_propagator.h"
+#include "ufra/roi_skip_cache.h"
+#include "ufra/result_cache.h"
+#include "ufra/image_kernels.h"
+#include "ufra/perf_counters.h"
+#include "ufra/metrics_exporter.h"
+#include "ufra/batch_tuner.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
 #include <iostream>
 #include <chrono>
+#include <cstdio>
+#include <functional>
 
 namespace ufra {
 
+namespace {
+
+constexpr const char* kVersionInfo = "UFRa Engine v1.0.0";
+
+// Releases a MemoryBudget reservation when the work it covers completes
+struct BudgetReservation {
+    BudgetReservation(MemoryBudget& budget, MemoryCategory category, size_t bytes)
+        : budget_(budget), category_(category), bytes_(bytes) {}
+    ~BudgetReservation() { budget_.release(category_, bytes_); }
+
+    MemoryBudget& budget_;
+    MemoryCategory category_;
+    size_t bytes_;
+};
+
+// Pipeline stages timed by the metrics exporter and counted by the profiler
+const std::vector<std::string> kStages = {"detect", "parse", "generate", "diffusion", "propagate", "composite"};
+
+// Hardware counters and wall-clock latency of one stage on the calling
+// thread; either part is off when its collector is null
+struct StageScope {
+    StageScope(StageProfiler* profiler, MetricsExporter* exporter, const char* stage)
+        : counters_(profiler, stage), timer_(exporter, stage) {}
+
+    StageProfiler::Scope counters_;
+    MetricsExporter::StageTimer timer_;
+};
+
+// Per-frame working state for one frame in flight
+struct FrameSlot {
+    FramePyramid pyramid;
+    CropCache crop_cache;
+};
+
+// One face for the generator stage
+struct GeneratorInput {
+    ImageData crop;
+    AgeControls controls;
+    MaskImage parsing_mask;
+};
+
+// Where one frame left the clip's temporal state
+struct ClipStep {
+    bool cut = false;
+    float cut_score = 0.0f;
+    bool detected = false;
+    bool repeat = false;
+    int pulldown_phase = -1;
+};
+
+// Tracks, temporal caches, keyframes and carried-over boxes of one clip
+// (FrameContext::clip_id), so clips sharing a batch never see each other's
+// faces. A chunk holds the state of each of its clips while it runs.
+struct ClipState {
+    explicit ClipState(const KeyframePolicy& policy) { keyframe_propagator.setPolicy(policy); }
+
+    // Drops everything tied to the previous shot; the next frame is detected
+    void reset() {
+        face_tracker.reset();
+        temporal_cache.clear();
+        keyframe_propagator.reset();
+        roi_skip_cache.clear();
+        clip_faces.clear();
+        frames_since_detection = 0;
+        has_detected = false;
+    }
+
+    FaceTracker face_tracker;
+    SceneCutDetector scene_cut_detector;
+    TemporalCache temporal_cache;
+    KeyframePropagator keyframe_propagator;
+    RoiSkipCache roi_skip_cache;
+    std::vector<Face> clip_faces;       // Boxes only, re-cut between detections
+    int frames_since_detection = 0;
+    bool has_detected = false;
+
+    // One chunk at a time; waiting chunks go lowest frame_number first
+    std::mutex turn_mutex;
+    std::condition_variable turn_changed;
+    std::multiset<int> waiting;
+    bool busy = false;
+    uint64_t last_used = 0;
+};
+
+// Waits for a clip's turn and holds the clip until destroyed
+class ClipTurn {
+public:
+    ClipTurn(ClipState& clip, int frame_number) : clip_(clip) {
+        std::unique_lock<std::mutex> lock(clip_.turn_mutex);
+        auto ticket = clip_.waiting.insert(frame_number);
+        clip_.turn_changed.wait(lock, [&] { return !clip_.busy && clip_.waiting.begin() == ticket; });
+        clip_.waiting.erase(ticket);
+        clip_.busy = true;
+    }
+    ~ClipTurn() {
+        std::lock_guard<std::mutex> lock(clip_.turn_mutex);
+        clip_.busy = false;
+        clip_.turn_changed.notify_all();
+    }
+    ClipTurn(const ClipTurn&) = delete;
+    ClipTurn& operator=(const ClipTurn&) = delete;
+
+private:
+    ClipState& clip_;
+};
+
+// Idle clip states kept beyond this count are dropped, least recently used first
+constexpr size_t kMaxClips = 32;
+
+// A face whose ROI and controls match its track's previous frame
+struct FaceReuse {
+    bool hit = false;
+    int source = -1;            // Earlier face of the chunk to copy from, else the cached result
+    RoiSignature signature;
+    uint64_t controls_key = 0;
+    bool from_disk = false;     // Hit served by the on-disk result cache
+    bool cacheable = false;     // Store the result under result_key once rendered
+    ResultKey result_key;
+    ImageData result;
+    MaskImage parsing_mask;
+};
+
+// Everything a face's result depends on besides its pixels. Age maps are
+// compared by buffer, or by contents when `exact` (deterministic mode, where
+// reuse must not depend on allocation addresses).
+uint64_t controlsKey(const AgeControls& controls, ProcessingMode mode, bool exact) {
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+    const float scalars[] = {controls.target_age, controls.identity_lock_strength, controls.temporal_stability,
+                             controls.texture_keep, controls.skin_clean, controls.gray_density,
+                             controls.age_map.global_strength};
+    const bool flags[] = {controls.enable_hair_aging, controls.enable_beard_aging, controls.enable_neck_aging};
+    const cv::Mat& map = controls.age_map.global_age_map;
+    const uint64_t age_map = exact && !map.empty()
+        ? kernels::contentHash(map.data, map.cols * map.elemSize(), map.rows, map.step[0])
+        : reinterpret_cast<uintptr_t>(map.data);
+    const int mode_value = static_cast<int>(mode);
+    mix(scalars, sizeof(scalars));
+    mix(flags, sizeof(flags));
+    mix(controls.age_map.region_strengths, sizeof(controls.age_map.region_strengths));
+    mix(&age_map, sizeof(age_map));
+    mix(&mode_value, sizeof(mode_value));
+    return hash;
+}
+
+// Face landmarks (frame coordinates) in the coordinates of its crop resized to `size`
+std::vector<cv::Point2f> cropLandmarks(const Face& face, const FramePyramid& pyramid, const cv::Size& size) {
+    std::vector<cv::Point2f> points;
+    cv::Rect roi;
+    if (face.landmarks.points.empty() || !pyramid.locate(face.aligned_crop, roi) || roi.area() == 0) {
+        return points;
+    }
+    const float scale_x = static_cast<float>(size.width) / roi.width;
+    const float scale_y = static_cast<float>(size.height) / roi.height;
+    for (const cv::Point2f& point : face.landmarks.points) {
+        points.emplace_back((point.x - roi.x) * scale_x, (point.y - roi.y) * scale_y);
+    }
+    return points;
+}
+
+// Batches of one network only mix crops of the same resolution
+uint64_t resolutionKey(const cv::Size& size) {
+    return (static_cast<uint64_t>(size.width) << 32) | static_cast<uint32_t>(size.height);
+}
+
+// Registers a chunk with the face schedulers while it is in flight, so
+// their batch windows are only spent when other requests could join
+template <typename Scheduler>
+struct SchedulerParticipation {
+    explicit SchedulerParticipation(Scheduler& scheduler) : scheduler_(scheduler) { scheduler_.enter(); }
+    ~SchedulerParticipation() { scheduler_.leave(); }
+
+    Scheduler& scheduler_;
+};
+
+} // namespace
+
 class Engine::Impl {
 public:
     Impl() : initialized_(false), processing_mode_(ProcessingMode::FEEDFORWARD),
@@ -29,13 +234,13 @@ public:
                 error_callback_("Failed to initialize GPU memory manager");
                 return false;
             }
+            gpu_manager_->enableHugePages(config.use_huge_pages);
 
             // Initialize model loader
             model_loader_ = std::make_unique<ModelLoader>();
             
             // Initialize core components
             face_detector_ = std::make_unique<FaceDetector>();
-            face_tracker_ = std::make_unique<FaceTracker>();
             age_estimator_ = std::make_unique<AgeEstimator>();
             face_parser_ = std::make_unique<FaceParser>();
             feedforward_generator_ = std::make_unique<FeedforwardGenerator>();
@@ -43,6 +248,73 @@ public:
             optical_flow_ = std::make_unique<OpticalFlow>();
             compositor_ = std::make_unique<Compositor>();
 
+            // Per-track reuse of the previous frame's result and noise, kept
+            // per clip; see ClipState
+            {
+                std::lock_guard<std::mutex> lock(clips_mutex_);
+                clips_.clear();
+            }
+            keyframe_policy_ = KeyframePolicy();
+            keyframe_policy_.max_interval = config.keyframe_max_interval;
+            keyframe_policy_.max_motion = config.keyframe_max_motion;
+            keyframe_policy_.max_change = config.keyframe_max_change;
+            result_cache_ = std::make_unique<ResultCache>();
+            if (!config.result_cache_dir.empty()) {
+                result_cache_->open(config.result_cache_dir, config.result_cache_max_bytes);   // Off on failure
+            }
+            feedforward_generator_->enableTemporalStabilization(config.temporal_coherence);
+            diffusion_editor_->enableTemporalCoherence(config.temporal_coherence);
+
+            // Deterministic output: CPU inference and one face per network
+            // call, so results do not depend on which requests shared a batch
+            face_detector_->setDeterministic(config.deterministic);
+            age_estimator_->setDeterministic(config.deterministic);
+            face_parser_->setDeterministic(config.deterministic);
+            feedforward_generator_->setDeterministic(config.deterministic);
+            diffusion_editor_->setDeterministic(config.deterministic);
+
+            // Hardware counters per stage; metrics report perf_counters = 0
+            // where perf events are unavailable
+            stage_profiler_.reset();
+            if (config.profile_counters) {
+                stage_profiler_ = std::make_unique<StageProfiler>();
+                if (!stage_profiler_->isAvailable()) {
+                    std::cerr << "Hardware counters unavailable: " << perfCountersUnavailableReason() << std::endl;
+                }
+            }
+
+            // OpenMetrics exposition for central monitoring; a target that
+            // fails to open is reported and left off
+            metrics_exporter_.reset();
+            if (!config.metrics_file.empty() || config.metrics_port > 0) {
+                metrics_exporter_ = std::make_unique<MetricsExporter>(kStages);
+                if (!config.metrics_file.empty()) {
+                    metrics_exporter_->writeToFile(config.metrics_file);
+                }
+                if (config.metrics_port > 0) {
+                    metrics_exporter_->listen(config.metrics_port);
+                }
+            }
+
+            // Memory accounting and admission control
+            memory_budget_ = std::make_unique<MemoryBudget>();
+            memory_budget_->setLimit(config.memory_budget_bytes);
+            effective_batch_size_ = std::max(1, config.batch_size);
+
+            // Faces from every concurrent processBatch() call share network
+            // passes through these
+            BatchSchedulerOptions batching;
+            batching.max_batch_size = config.deterministic ? 1 : config.face_batch_size;
+            batching.max_delay_us = config.deterministic ? 0 : config.face_batch_delay_us;
+            parser_scheduler_ = std::make_unique<ParserScheduler>(
+                [this](const std::vector<ImageData>& crops) {
+                    StageScope stage_scope(stage_profiler_.get(), metrics_exporter_.get(), "parse");
+                    return face_parser_->parseFacesBatch(crops);
+                },
+                batching);
+            generator_scheduler_ = std::make_unique<GeneratorScheduler>(
+                [this](const std::vector<GeneratorInput>& inputs) { return generateBatch(inputs); }, batching);
+
             initialized_ = true;
             return true;
         }
@@ -88,6 +360,24 @@ public:
             // Load diffusion model (optional for basic functionality)
             diffusion_editor_->loadModel(model_dir + "/diffusion_editor");
 
+            // Measured face batch sizes instead of face_batch_size
+            if (config_.auto_tune_batch && !config_.deterministic) {
+                tuneBatchSizes(model_dir);
+            }
+
+            // Result cache entries are only valid for these exact model files
+            if (result_cache_->isOpen()) {
+                const std::string version = kVersionInfo;
+                model_hash_ = kernels::contentHash(reinterpret_cast<const uint8_t*>(version.data()), version.size(),
+                                                   1, version.size());
+                for (const char* file : {"/face_parser.onnx", "/feedforward_generator.onnx",
+                                         "/diffusion_editor/unet.onnx"}) {
+                    const uint64_t file_hash = ResultCache::hashFile(model_dir + file);
+                    model_hash_ = kernels::contentHash(reinterpret_cast<const uint8_t*>(&file_hash),
+                                                       sizeof(file_hash), 1, sizeof(file_hash), model_hash_);
+                }
+            }
+
             return true;
         }
         catch (const std::exception& e) {
@@ -96,73 +386,694 @@ public:
         }
     }
 
+    // Sweeps the parser's and generator's batch size on neutral crops, which
+    // also warms both networks up, and limits each scheduler to the
+    // throughput-optimal size under batch_latency_cap_ms. Sweeps are stored
+    // per machine, backend, model file and input size, so later runs with
+    // the same models only look them up.
+    void tuneBatchSizes(const std::string& model_dir) {
+        batch_sweeps_ = 0;
+        BatchTuner tuner;
+        if (!tuner.open(config_.batch_tuning_file)) {
+            std::cerr << "Batch tuning results will not be kept: store is not writable" << std::endl;
+        }
+        const std::vector<int> candidates = {1, 2, 4, 8, 16, 32};
+        const double cap = config_.batch_latency_cap_ms;
+        auto tune = [&](const char* network, const std::string& model_file, const cv::Size& size,
+                        const std::function<void(int)>& run) {
+            const std::string path = model_dir + model_file;
+            uint64_t model_hash = ResultCache::hashFile(path);
+            if (model_hash == 0) {   // Stub models have no file
+                model_hash = kernels::contentHash(reinterpret_cast<const uint8_t*>(path.data()), path.size(), 1,
+                                                  path.size());
+            }
+            char hash[17];
+            std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(model_hash));
+            const std::string key = BatchTuner::machineKey() + "/" + gpu_manager_->getBackendInfo() + "/" + network +
+                                    "/" + std::to_string(size.width) + "x" + std::to_string(size.height) + "/" + hash;
+            std::vector<BatchTiming> sweep = tuner.lookup(key);
+            if (!BatchTuner::covers(sweep, candidates, cap)) {
+                sweep = BatchTuner::sweep(run, candidates, cap);
+                tuner.store(key, sweep);
+                ++batch_sweeps_;
+            }
+            return BatchTuner::select(sweep, cap);
+        };
+
+        const cv::Size parser_size = face_parser_->getInputSize();
+        const ImageData parser_crop(parser_size, CV_8UC3, cv::Scalar::all(128));
+        BatchSchedulerOptions parser_options = parser_scheduler_->getOptions();
+        parser_options.max_batch_size = tune("face_parser", "/face_parser.onnx", parser_size, [&](int n) {
+            face_parser_->parseFacesBatch(std::vector<ImageData>(n, parser_crop));
+        });
+        parser_scheduler_->setOptions(parser_options);
+
+        const cv::Size generator_size = feedforward_generator_->getInputSize();
+        const ImageData generator_crop(generator_size, CV_8UC3, cv::Scalar::all(128));
+        const MaskImage generator_mask(generator_size, CV_8UC1, cv::Scalar(0));
+        AgeControls controls = AgeControls();
+        controls.target_age = 60.0f;
+        controls.identity_lock_strength = 0.5f;
+        BatchSchedulerOptions generator_options = generator_scheduler_->getOptions();
+        generator_options.max_batch_size =
+            tune("feedforward_generator", "/feedforward_generator.onnx", generator_size, [&](int n) {
+                feedforward_generator_->generateAgedFacesBatch(std::vector<ImageData>(n, generator_crop),
+                                                               std::vector<AgeControls>(n, controls),
+                                                               std::vector<MaskImage>(n, generator_mask));
+            });
+        generator_scheduler_->setOptions(generator_options);
+    }
+
     ProcessingResult processFrame(const FrameContext& context) {
+        return processBatch(std::vector<FrameContext>{context}).front();
+    }
+
+    std::vector<ProcessingResult> processBatch(const std::vector<FrameContext>& contexts) {
+        std::vector<ProcessingResult> results;
+        results.reserve(contexts.size());
+
         if (!initialized_) {
-            ProcessingResult result;
-            result.success = false;
-            result.error_message = "Engine not initialized";
-            return result;
+            for (size_t i = 0; i < contexts.size(); ++i) {
+                results.push_back(failedResult("Engine not initialized"));
+            }
+            return results;
         }
 
+        // Frames are admitted in chunks of the current batch size, which
+        // shrinks under memory pressure
+        size_t begin = 0;
+        while (begin < contexts.size()) {
+            size_t end = std::min(contexts.size(), begin + static_cast<size_t>(effective_batch_size_));
+            processChunk(contexts, begin, end, results);
+            begin = end;
+        }
+        return results;
+    }
+
+    std::vector<ImageData> generateBatch(const std::vector<GeneratorInput>& inputs) {
+        StageScope stage_scope(stage_profiler_.get(), metrics_exporter_.get(), "generate");
+        std::vector<ImageData> crops;
+        std::vector<AgeControls> controls;
+        std::vector<MaskImage> masks;
+        for (const auto& input : inputs) {
+            crops.push_back(input.crop);
+            controls.push_back(input.controls);
+            masks.push_back(input.parsing_mask);
+        }
+        return feedforward_generator_->generateAgedFacesBatch(crops, controls, masks);
+    }
+
+    // Processes contexts[begin, end) as one batch: faces from all frames in
+    // the chunk go through each network stage together, batched with faces
+    // of chunks that other threads are processing at the same time.
+    // Safe to call concurrently.
+    void processChunk(const std::vector<FrameContext>& contexts, size_t begin, size_t end,
+                      std::vector<ProcessingResult>& results) {
         auto start_time = std::chrono::high_resolution_clock::now();
+        const size_t count = end - begin;
+
+        // Admission control for the frames in flight
+        size_t frame_bytes = 0;
+        for (size_t i = begin; i < end; ++i) {
+            frame_bytes += estimateFrameBytes(contexts[i].input_frame);
+        }
+        if (!admit(frame_bytes)) {
+            for (size_t i = begin; i < end; ++i) {
+                results.push_back(failedResult("Memory budget exceeded"));
+                recordError();
+            }
+            return;
+        }
+        BudgetReservation reservation(*memory_budget_, MemoryCategory::FRAMES, frame_bytes);
+
+        // The chunk holds each of its clips until it finishes. Clips are
+        // taken in clip_id order, so chunks sharing clips cannot deadlock,
+        // and before joining the schedulers, so no batch is held open for a
+        // chunk that is only waiting for its turn.
+        std::map<uint64_t, int> first_frames;   // Clip -> its lowest frame_number in the chunk
+        for (size_t i = begin; i < end; ++i) {
+            if (usesClipState(contexts[i])) {
+                auto it = first_frames.emplace(contexts[i].clip_id, contexts[i].frame_number).first;
+                it->second = std::min(it->second, contexts[i].frame_number);
+            }
+        }
+        std::map<uint64_t, std::shared_ptr<ClipState>> chunk_clips;
+        std::vector<std::unique_ptr<ClipTurn>> clip_turns;
+        for (const auto& clip : first_frames) {
+            std::shared_ptr<ClipState>& state = chunk_clips[clip.first];
+            state = clipState(clip.first);
+            clip_turns.push_back(std::make_unique<ClipTurn>(*state, clip.second));
+        }
+        std::vector<ClipState*> frame_clips(count, nullptr);
+        for (size_t i = 0; i < count; ++i) {
+            if (usesClipState(contexts[begin + i])) {
+                frame_clips[i] = chunk_clips[contexts[begin + i].clip_id].get();
+            }
+        }
+
+        SchedulerParticipation<ParserScheduler> parser_participation(*parser_scheduler_);
+        SchedulerParticipation<GeneratorScheduler> generator_participation(*generator_scheduler_);
+        const size_t first_result = results.size();
 
+        std::vector<std::unique_ptr<FrameSlot>> slots = acquireSlots(count);
         try {
-            ProcessingResult result;
-            
-            // Detect faces if not provided
-            std::vector<Face> faces = context.detected_faces;
-            if (faces.empty()) {
-                faces = face_detector_->detectFaces(context.input_frame);
+
+            // Detect faces if not provided. One pyramid per frame; the
+            // detector input and all face crops are sampled from it on demand.
+            std::vector<std::vector<Face>> frame_faces(count);
+            std::vector<ClipStep> clip_steps(count);
+            for (size_t i = 0; i < count; ++i) {
+                const FrameContext& context = contexts[begin + i];
+                FrameSlot& slot = *slots[i];
+                slot.pyramid.reset(context.input_frame);
+                slot.crop_cache.reset(&slot.pyramid);
+
+                frame_faces[i] = context.detected_faces;
+                StageScope stage_scope(stage_profiler_.get(), metrics_exporter_.get(), "detect");
+                if (frame_clips[i]) {
+                    clip_steps[i] = advanceClip(*frame_clips[i], context, slot, frame_faces[i]);
+                } else if (frame_faces[i].empty()) {
+                    frame_faces[i] = face_detector_->detectFaces(slot.pyramid);
+                }
             }
 
-            if (faces.empty()) {
-                result.output_frame = context.input_frame.clone();
-                result.success = true;
-                return result;
-            }
-
-            // Process each face
-            ImageData output_frame = context.input_frame.clone();
-            for (auto& face : faces) {
-                // Generate face parsing mask
-                MaskImage parsing_mask = face_parser_->parseFace(face.aligned_crop);
-                
-                // Apply age transformation based on processing mode
-                ImageData processed_face;
-                if (context.mode == ProcessingMode::FEEDFORWARD || 
-                    context.mode == ProcessingMode::AUTO) {
-                    processed_face = feedforward_generator_->generateAgedFace(
-                        face.aligned_crop, context.controls, parsing_mask);
-                } else if (context.mode == ProcessingMode::DIFFUSION) {
-                    processed_face = diffusion_editor_->generateAgedFace(
-                        face.aligned_crop, context.controls, parsing_mask);
+            std::vector<FaceReuse> face_reuse = findUnchangedFaces(contexts, begin, frame_clips, frame_faces);
+
+            // Crops are resized once per resolution and shared by every stage
+            // that consumes that resolution
+            const cv::Size parser_size = face_parser_->getInputSize();
+            std::vector<ImageData> parser_inputs;
+            size_t face_index = 0;
+            for (size_t i = 0; i < count; ++i) {
+                CropCache& crop_cache = slots[i]->crop_cache;
+                for (const auto& face : frame_faces[i]) {
+                    if (!face_reuse[face_index++].hit) {
+                        parser_inputs.push_back(crop_cache.getResized(face, parser_size));
+                    }
                 }
+            }
 
-                // Composite back to original frame
-                compositor_->compositeFace(output_frame, processed_face, face);
+            // Generate face parsing masks for the whole chunk
+            std::vector<MaskImage> parsed = parser_scheduler_->run(resolutionKey(parser_size), std::move(parser_inputs));
+            std::vector<MaskImage> parsing_masks(face_reuse.size());
+            for (size_t f = 0, parsed_index = 0; f < face_reuse.size(); ++f) {
+                const FaceReuse& reuse = face_reuse[f];
+                parsing_masks[f] = !reuse.hit ? parsed[parsed_index++]
+                                   : reuse.source >= 0 ? parsing_masks[reuse.source] : reuse.parsing_mask;
             }
 
-            result.output_frame = output_frame;
-            result.processed_faces = faces;
-            result.success = true;
+            // Apply age transformation based on processing mode. In KEYFRAME
+            // mode only faces that need a new keyframe reach the generator.
+            const cv::Size generator_size = feedforward_generator_->getInputSize();
+            std::vector<GeneratorInput> generator_inputs;
+            std::vector<KeyframePropagator::Plan> keyframe_plans(parsing_masks.size());
+            face_index = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const FrameContext& context = contexts[begin + i];
+                for (const auto& face : frame_faces[i]) {
+                    if (face_reuse[face_index].hit) {
+                        ++face_index;
+                        continue;
+                    }
+                    if (context.mode == ProcessingMode::KEYFRAME) {
+                        keyframe_plans[face_index] = frame_clips[i]->keyframe_propagator.plan(
+                            face.track_id, slots[i]->crop_cache.getResized(face, generator_size),
+                            cropLandmarks(face, slots[i]->pyramid, generator_size), context.frame_number);
+                    }
+                    if (context.mode == ProcessingMode::FEEDFORWARD || context.mode == ProcessingMode::AUTO ||
+                        (context.mode == ProcessingMode::KEYFRAME && keyframe_plans[face_index].keyframe)) {
+                        generator_inputs.push_back(GeneratorInput{
+                            slots[i]->crop_cache.getResized(face, generator_size), context.controls,
+                            parsing_masks[face_index]});
+                    }
+                    ++face_index;
+                }
+            }
+            std::vector<ImageData> generated =
+                generator_scheduler_->run(resolutionKey(generator_size), std::move(generator_inputs));
 
-            // Calculate performance metrics
+            // Composite back to the original frames. Frames are visited in
+            // order, so each face's temporal prior is the previous frame's result.
+            const cv::Size diffusion_size = diffusion_editor_->getInputSize();
             auto end_time = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                end_time - start_time).count();
-            result.metrics["processing_time_ms"] = static_cast<float>(duration);
-            result.metrics["faces_processed"] = static_cast<float>(faces.size());
+            std::vector<double> frame_seconds(count);
+            size_t generated_index = 0;
+            std::vector<ImageData> processed_faces(face_reuse.size());
+            face_index = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const FrameContext& context = contexts[begin + i];
+                ProcessingResult result;
+                ImageData output_frame;
+                if (config_.use_huge_pages) {
+                    // Output frames are the largest per-frame buffers; the arena
+                    // hands back the pre-faulted block released by the previous frame
+                    output_frame.allocator = getHugePageMatAllocator();
+                }
+                context.input_frame.copyTo(output_frame);
 
-            return result;
+                int frame_steps = 0;
+                int frame_keyframes = 0;
+                int frame_reused = 0;
+                int frame_cached = 0;
+                int frame_face = 0;
+                for (auto& face : frame_faces[i]) {
+                    ImageData processed_face;
+                    const FaceReuse& reuse = face_reuse[face_index];
+                    if (reuse.hit) {
+                        processed_face = reuse.source >= 0 ? processed_faces[reuse.source] : reuse.result;
+                        ++frame_reused;
+                    } else if (context.mode == ProcessingMode::FEEDFORWARD ||
+                        context.mode == ProcessingMode::AUTO) {
+                        processed_face = generated[generated_index++];
+                        ++frame_steps;
+                        if (config_.temporal_coherence) {
+                            const ImageData& crop = slots[i]->crop_cache.getResized(face, generator_size);
+                            TemporalCache& temporal_cache = frame_clips[i]->temporal_cache;
+                            TemporalPrior prior = temporal_cache.lookup(face.track_id, crop, context.frame_number);
+                            processed_face = feedforward_generator_->stabilize(
+                                processed_face, prior, context.controls.temporal_stability);
+                            temporal_cache.store(face.track_id, crop, processed_face, cv::Mat(), context.frame_number);
+                        }
+                    } else if (context.mode == ProcessingMode::DIFFUSION) {
+                        const ImageData& crop = slots[i]->crop_cache.getResized(face, diffusion_size);
+                        TemporalPrior prior;
+                        if (config_.temporal_coherence) {
+                            prior = frame_clips[i]->temporal_cache.lookup(face.track_id, crop, context.frame_number);
+                        }
+                        const unsigned int seed =
+                            diffusionSeed(context.frame_number, face.track_id >= 0 ? face.track_id : frame_face);
+                        cv::Mat noise;
+                        int steps_run = 0;
+                        StageScope stage_scope(stage_profiler_.get(), metrics_exporter_.get(), "diffusion");
+                        processed_face = diffusion_editor_->generateAgedFace(
+                            crop, context.controls, parsing_masks[face_index], prior, seed, noise, steps_run);
+                        frame_steps += steps_run;
+                        if (config_.temporal_coherence) {
+                            frame_clips[i]->temporal_cache.store(face.track_id, crop, processed_face, noise,
+                                                                 context.frame_number);
+                        }
+                    } else if (context.mode == ProcessingMode::KEYFRAME) {
+                        const ImageData& crop = slots[i]->crop_cache.getResized(face, generator_size);
+                        const KeyframePropagator::Plan& plan = keyframe_plans[face_index];
+                        if (plan.keyframe) {
+                            processed_face = generated[generated_index++];
+                            frame_clips[i]->keyframe_propagator.setKeyframe(plan, crop, processed_face);
+                            ++frame_steps;
+                            ++frame_keyframes;
+                        } else {
+                            StageScope stage_scope(stage_profiler_.get(), metrics_exporter_.get(), "propagate");
+                            processed_face = frame_clips[i]->keyframe_propagator.propagate(plan, crop);
+                        }
+                    }
+                    face.parsing_mask = parsing_masks[face_index];
+                    if (config_.skip_unchanged_faces && (!reuse.hit || reuse.from_disk) &&
+                        reuse.signature.width > 0) {
+                        frame_clips[i]->roi_skip_cache.store(face.track_id, reuse.signature, reuse.controls_key,
+                                                             processed_face, face.parsing_mask);
+                    }
+                    if (reuse.cacheable && !reuse.hit && !processed_face.empty()) {
+                        result_cache_->store(reuse.result_key, processed_face, face.parsing_mask);
+                    }
+                    frame_cached += reuse.from_disk ? 1 : 0;
+                    processed_faces[face_index] = processed_face;
+                    ++face_index;
+                    ++frame_face;
+
+                    if (!processed_face.empty()) {
+                        StageScope stage_scope(stage_profiler_.get(), metrics_exporter_.get(), "composite");
+                        compositor_->compositeFace(output_frame, processed_face, face);
+                    }
+                }
+
+                result.output_frame = output_frame;
+                result.processed_faces = frame_faces[i];
+                result.success = true;
+                if (config_.deterministic) {
+                    result.output_hash = kernels::contentHash(output_frame.data,
+                                                              output_frame.cols * output_frame.elemSize(),
+                                                              output_frame.rows, output_frame.step[0]);
+                }
+
+                // Calculate performance metrics
+                end_time = std::chrono::high_resolution_clock::now();
+                frame_seconds[i] = std::chrono::duration<double>(end_time - start_time).count();
+                auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    end_time - start_time).count();
+                const FrameSlot& slot = *slots[i];
+                result.metrics["processing_time_ms"] = static_cast<float>(duration);
+                result.metrics["faces_processed"] = static_cast<float>(frame_faces[i].size());
+                result.metrics["crop_resizes"] = static_cast<float>(slot.crop_cache.getResizeCount());
+                result.metrics["crop_cache_hits"] = static_cast<float>(slot.crop_cache.getHitCount());
+                result.metrics["pyramid_levels"] = static_cast<float>(slot.pyramid.getLevelCount());
+                result.metrics["batch_size"] = static_cast<float>(count);
+                result.metrics["generator_steps"] = static_cast<float>(frame_steps);
+                result.metrics["scene_cut"] = clip_steps[i].cut ? 1.0f : 0.0f;
+                result.metrics["scene_cut_score"] = clip_steps[i].cut_score;
+                result.metrics["faces_detected"] = clip_steps[i].detected ? 1.0f : 0.0f;
+                result.metrics["keyframe_faces"] = static_cast<float>(frame_keyframes);
+                result.metrics["faces_reused"] = static_cast<float>(frame_reused);
+                result.metrics["faces_from_result_cache"] = static_cast<float>(frame_cached);
+                result.metrics["frame_repeat"] = clip_steps[i].repeat ? 1.0f : 0.0f;
+                result.metrics["pulldown_phase"] = static_cast<float>(clip_steps[i].pulldown_phase);
+                if (frame_clips[i]) {
+                    frame_clips[i]->temporal_cache.recordFrameSteps(frame_steps);
+                }
+                results.push_back(std::move(result));
+            }
+
+            releaseSlots(slots);
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            updateMemoryAccounting();
+            std::map<std::string, float> scheduling = schedulerMetrics();
+            if (result_cache_->isOpen()) {
+                for (const auto& stat : result_cache_->getStats()) {
+                    scheduling["result_cache_" + stat.first] = stat.second;
+                }
+            }
+            if (stage_profiler_) {
+                const std::map<std::string, float> counters = stage_profiler_->getMetrics();
+                scheduling.insert(counters.begin(), counters.end());
+            }
+            for (size_t i = results.size() - count; i < results.size(); ++i) {
+                for (const auto& metric : memory_metrics_) {
+                    results[i].metrics[metric.first] = metric.second;
+                }
+                results[i].metrics.insert(scheduling.begin(), scheduling.end());
+                if (const ClipState* clip = frame_clips[i - (results.size() - count)]) {
+                    // Reuse statistics of the frame's own clip
+                    for (const auto& stat : clip->temporal_cache.getStats()) {
+                        results[i].metrics["temporal_" + stat.first] = stat.second;
+                    }
+                    const std::map<std::string, float> keyframe_stats = clip->keyframe_propagator.getStats();
+                    results[i].metrics.insert(keyframe_stats.begin(), keyframe_stats.end());
+                    for (const auto& stat : clip->roi_skip_cache.getStats()) {
+                        results[i].metrics["roi_skip_" + stat.first] = stat.second;
+                    }
+                }
+                if (metrics_exporter_) {
+                    metrics_exporter_->recordFrame(frame_seconds[i - (results.size() - count)], results[i].metrics);
+                }
+            }
+            performance_metrics_ = results.back().metrics;
         }
         catch (const std::exception& e) {
-            ProcessingResult result;
-            result.success = false;
-            result.error_message = "Processing failed: " + std::string(e.what());
-            return result;
+            releaseSlots(slots);
+            results.resize(first_result);
+            for (size_t i = begin; i < end; ++i) {
+                results.push_back(failedResult("Processing failed: " + std::string(e.what())));
+                recordError();
+            }
+        }
+    }
+
+    bool usesClipState(const FrameContext& context) const {
+        return config_.temporal_coherence || config_.skip_unchanged_faces || context.mode == ProcessingMode::KEYFRAME;
+    }
+
+    // The state of `clip_id`, created on first use. Beyond kMaxClips, the
+    // least recently used state that no chunk holds or waits for is dropped.
+    std::shared_ptr<ClipState> clipState(uint64_t clip_id) {
+        std::lock_guard<std::mutex> lock(clips_mutex_);
+        std::shared_ptr<ClipState>& clip = clips_[clip_id];
+        if (!clip) {
+            clip = std::make_shared<ClipState>(keyframe_policy_);
+        }
+        clip->last_used = ++clip_uses_;
+        std::shared_ptr<ClipState> state = clip;
+        while (clips_.size() > kMaxClips) {
+            auto oldest = clips_.end();
+            for (auto it = clips_.begin(); it != clips_.end(); ++it) {
+                if (it->second.use_count() == 1 &&
+                    (oldest == clips_.end() || it->second->last_used < oldest->second->last_used)) {
+                    oldest = it;
+                }
+            }
+            if (oldest == clips_.end()) {
+                break;   // All in use
+            }
+            clips_.erase(oldest);
+        }
+        return state;
+    }
+
+    // Moves the clip on by one frame: on a hard cut, tracks, temporal caches,
+    // keyframes and reused boxes are dropped and detection is forced. Between
+    // detections the previous frame's boxes are re-cut from this frame.
+    // Requires the clip's turn.
+    ClipStep advanceClip(ClipState& clip, const FrameContext& context, FrameSlot& slot, std::vector<Face>& faces) {
+        ClipStep step;
+        const ImageData& frame = context.input_frame;
+        if (frame.depth() == CV_8U) {
+            step.cut = clip.scene_cut_detector.update(frame.data, frame.cols, frame.rows, frame.step[0],
+                                                      frame.channels());
+            step.cut_score = clip.scene_cut_detector.getLastScore();
+            step.repeat = clip.scene_cut_detector.isRepeat();
+            step.pulldown_phase = clip.scene_cut_detector.getPulldownPhase();
+        }
+        if (step.cut) {
+            clip.reset();
+        }
+
+        if (faces.empty()) {
+            ++clip.frames_since_detection;
+            if (!clip.has_detected || clip.frames_since_detection >= std::max(1, config_.detection_interval)) {
+                faces = face_detector_->detectFaces(slot.pyramid);
+                clip.frames_since_detection = 0;
+                clip.has_detected = true;
+                step.detected = true;
+            } else {
+                faces = clip.clip_faces;
+                face_detector_->cropFaces(faces, slot.pyramid.getLevel(0));
+            }
+        }
+        for (int retired : clip.face_tracker.update(faces, context.frame_number)) {
+            clip.temporal_cache.invalidate(retired);
+            clip.keyframe_propagator.invalidate(retired);
+            clip.roi_skip_cache.invalidate(retired);
+        }
+        clip.clip_faces = faces;
+        for (Face& face : clip.clip_faces) {
+            face.aligned_crop = ImageData();   // Boxes only; crops are re-cut per frame
+        }
+        return step;
+    }
+
+    // With skip_unchanged_faces, one entry per face of the chunk in frame
+    // order. A face is a hit when its ROI signature and controls match the
+    // same track's last result, from the cache or from an earlier frame of
+    // this chunk (duplicates within a batch).
+    std::vector<FaceReuse> findUnchangedFaces(const std::vector<FrameContext>& contexts, size_t begin,
+                                              const std::vector<ClipState*>& frame_clips,
+                                              const std::vector<std::vector<Face>>& frame_faces) {
+        std::vector<FaceReuse> reuse;
+        std::map<std::pair<ClipState*, int>, size_t> chunk_tracks;   // Clip and track -> latest face in the chunk
+        for (size_t i = 0; i < frame_faces.size(); ++i) {
+            const FrameContext& context = contexts[begin + i];
+            const bool cacheable = isResultCacheable(context.mode);
+            int frame_face = 0;
+            for (const Face& face : frame_faces[i]) {
+                reuse.emplace_back();
+                FaceReuse& entry = reuse.back();
+                const ImageData& roi = face.aligned_crop;
+                const int face_key = face.track_id >= 0 ? face.track_id : frame_face;
+                ++frame_face;
+                if ((!config_.skip_unchanged_faces && !cacheable) || roi.depth() != CV_8U) {
+                    continue;
+                }
+                entry.controls_key = controlsKey(context.controls, context.mode, config_.deterministic);
+                if (config_.skip_unchanged_faces) {
+                    entry.signature = computeRoiSignature(roi.data, roi.cols, roi.rows, roi.step[0], roi.channels());
+                }
+                if (entry.signature.width > 0) {
+                    RoiSkipCache& roi_skip_cache = frame_clips[i]->roi_skip_cache;
+                    const std::pair<ClipState*, int> track(frame_clips[i], face.track_id);
+                    auto earlier = chunk_tracks.find(track);
+                    if (earlier != chunk_tracks.end()) {
+                        const FaceReuse& previous = reuse[earlier->second];
+                        if (previous.controls_key == entry.controls_key &&
+                            roi_skip_cache.matches(previous.signature, entry.signature)) {
+                            entry.hit = true;
+                            if (previous.hit && previous.source < 0) {
+                                entry.result = previous.result;
+                                entry.parsing_mask = previous.parsing_mask;
+                            } else {
+                                entry.source = previous.hit ? previous.source : static_cast<int>(earlier->second);
+                            }
+                        }
+                    } else {
+                        entry.hit = roi_skip_cache.lookup(face.track_id, entry.signature, entry.controls_key,
+                                                          entry.result, entry.parsing_mask);
+                    }
+                    chunk_tracks[track] = reuse.size() - 1;
+                }
+                if (cacheable) {
+                    // Content address: ROI pixels under everything else the result depends on
+                    uint64_t context_hash = entry.controls_key ^ (model_hash_ * 0x9E3779B97F4A7C15ULL);
+                    if (context.mode == ProcessingMode::DIFFUSION) {
+                        const unsigned int seed = diffusionSeed(context.frame_number, face_key);
+                        context_hash = kernels::contentHash(reinterpret_cast<const uint8_t*>(&seed), sizeof(seed), 1,
+                                                            sizeof(seed), context_hash);
+                    }
+                    entry.cacheable = true;
+                    entry.result_key = ResultCache::makeKey(roi, context_hash);
+                    if (!entry.hit) {
+                        entry.hit = entry.from_disk =
+                            result_cache_->load(entry.result_key, entry.result, entry.parsing_mask);
+                    }
+                }
+            }
+        }
+        return reuse;
+    }
+
+    // Results without temporal state are a pure function of the face ROI,
+    // the controls, the seed and the models, so they may come from disk
+    bool isResultCacheable(ProcessingMode mode) const {
+        return result_cache_->isOpen() && !config_.temporal_coherence &&
+               (mode == ProcessingMode::FEEDFORWARD || mode == ProcessingMode::AUTO ||
+                mode == ProcessingMode::DIFFUSION);
+    }
+
+    // Deterministic noise per frame and track (or position in the frame when
+    // untracked); otherwise the editor's base seed
+    unsigned int diffusionSeed(int frame_number, int face_key) const {
+        const unsigned int seed = diffusion_editor_->getSeed();
+        return config_.deterministic ? DiffusionEditor::faceSeed(seed, frame_number, face_key) : seed;
+    }
+
+    // Frame slots are pooled across chunks and concurrent callers
+    std::vector<std::unique_ptr<FrameSlot>> acquireSlots(size_t count) {
+        std::vector<std::unique_ptr<FrameSlot>> slots;
+        {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            while (slots.size() < count && !free_slots_.empty()) {
+                slots.push_back(std::move(free_slots_.back()));
+                free_slots_.pop_back();
+            }
+        }
+        while (slots.size() < count) {
+            slots.push_back(std::make_unique<FrameSlot>());
+            if (config_.use_huge_pages) {
+                slots.back()->pyramid.setAllocator(getHugePageMatAllocator());
+            }
+        }
+        return slots;
+    }
+
+    void releaseSlots(std::vector<std::unique_ptr<FrameSlot>>& slots) {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        for (auto& slot : slots) {
+            free_slots_.push_back(std::move(slot));
+        }
+        slots.clear();
+    }
+
+    // Achieved cross-request batch sizes per network
+    std::map<std::string, float> schedulerMetrics() const {
+        std::map<std::string, float> metrics;
+        for (const auto& stage : {std::make_pair("parser", parser_scheduler_->getStats()),
+                                  std::make_pair("generator", generator_scheduler_->getStats())}) {
+            const std::string prefix = std::string("scheduler_") + stage.first;
+            metrics[prefix + "_mean_batch"] = stage.second.at("mean_batch_size");
+            metrics[prefix + "_max_batch"] = stage.second.at("max_batch_size");
+            metrics[prefix + "_queue_ms"] = stage.second.at("mean_queue_ms");
+        }
+        metrics["scheduler_parser_batch_limit"] = static_cast<float>(parser_scheduler_->getOptions().max_batch_size);
+        metrics["scheduler_generator_batch_limit"] =
+            static_cast<float>(generator_scheduler_->getOptions().max_batch_size);
+        metrics["batch_tuning_sweeps"] = static_cast<float>(batch_sweeps_);
+        return metrics;
+    }
+
+    void recordError() {
+        if (metrics_exporter_) {
+            metrics_exporter_->recordError();
         }
     }
 
+    static ProcessingResult failedResult(const std::string& message) {
+        ProcessingResult result;
+        result.success = false;
+        result.error_message = message;
+        return result;
+    }
+
+    // Input copy, output frame and pyramid levels dominate per-frame memory
+    static size_t estimateFrameBytes(const ImageData& frame) {
+        size_t frame_bytes = frame.total() * frame.elemSize();
+        return frame_bytes * 2 + frame_bytes / 3;
+    }
+
+    bool admit(size_t bytes) {
+        if (memory_budget_->tryReserve(MemoryCategory::FRAMES, bytes)) {
+            return true;
+        }
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        relieveMemoryPressure();
+        return memory_budget_->tryReserve(MemoryCategory::FRAMES, bytes);
+    }
+
+    // Degrade gracefully: drop reusable buffers and halve the batch size.
+    // Requires state_mutex_; slots in use by other chunks are left alone.
+    // Deterministic output keeps the clip state, as dropping it would make
+    // results depend on the machine's memory.
+    void relieveMemoryPressure() {
+        for (auto& slot : free_slots_) {
+            slot->crop_cache.reset();
+            slot->pyramid.releaseBuffers();
+        }
+        if (free_slots_.size() > 1) {
+            free_slots_.resize(1);
+        }
+        memory_budget_->setUsage(MemoryCategory::CACHES, 0);
+        if (!config_.deterministic) {
+            std::lock_guard<std::mutex> lock(clips_mutex_);
+            for (auto& clip : clips_) {
+                clip.second->temporal_cache.clear();
+                clip.second->keyframe_propagator.reset();
+                clip.second->roi_skip_cache.clear();
+            }
+        }
+        HugePageArena::instance().trim();
+        effective_batch_size_ = std::max(1, effective_batch_size_ / 2);
+        ++memory_degradations_;
+    }
+
+    // Requires state_mutex_. Caches are counted for idle slots only.
+    void updateMemoryAccounting() {
+        size_t cache_bytes = 0;
+        for (const auto& slot : free_slots_) {
+            cache_bytes += slot->crop_cache.getMemoryBytes() + slot->pyramid.getMemoryBytes();
+        }
+        {
+            std::lock_guard<std::mutex> lock(clips_mutex_);
+            for (const auto& clip : clips_) {
+                cache_bytes += clip.second->temporal_cache.getMemoryBytes() +
+                               clip.second->keyframe_propagator.getMemoryBytes() +
+                               clip.second->roi_skip_cache.getMemoryBytes();
+            }
+        }
+        memory_budget_->setUsage(MemoryCategory::MODELS, getLoadedModelBytes());
+        memory_budget_->setUsage(MemoryCategory::TENSOR_ARENAS, getSessionActivationBytes());
+        memory_budget_->setUsage(MemoryCategory::CACHES, cache_bytes);
+
+        MemoryPressure pressure = memory_budget_->getPressure();
+        if (pressure != MemoryPressure::NORMAL) {
+            relieveMemoryPressure();
+        } else if (effective_batch_size_ < std::max(1, config_.batch_size) &&
+                   memory_budget_->getTotalUsage() < memory_budget_->getLimit() / 2) {
+            ++effective_batch_size_;  // Recover slowly once pressure is gone
+        }
+
+        memory_metrics_ = memory_budget_->getMetrics();
+        memory_metrics_["memory_degradations"] = static_cast<float>(memory_degradations_);
+        memory_metrics_["effective_batch_size"] = static_cast<float>(effective_batch_size_);
+        memory_metrics_["system_memory_utilization"] = gpu_manager_->getMemoryUtilization();
+        memory_metrics_["huge_page_mapped_mb"] =
+            static_cast<float>(HugePageArena::instance().getMappedBytes()) / (1024.0f * 1024.0f);
+        memory_metrics_["huge_page_reuses"] = static_cast<float>(HugePageArena::instance().getReuseCount());
+    }
+
     std::vector<Face> detectFaces(const ImageData& image) {
         if (!initialized_ || !face_detector_) {
             return {};
@@ -170,6 +1081,13 @@ public:
         return face_detector_->detectFaces(image);
     }
 
+    cv::Mat computeOpticalFlow(const ImageData& frame1, const ImageData& frame2) {
+        if (!initialized_ || !optical_flow_) {
+            return cv::Mat();
+        }
+        return optical_flow_->computeFlow(frame1, frame2);
+    }
+
     float estimateAge(const Face& face) {
         if (!initialized_ || !age_estimator_) {
             return 0.0f;
@@ -186,13 +1104,39 @@ public:
     std::unique_ptr<GPUMemoryManager> gpu_manager_;
     std::unique_ptr<ModelLoader> model_loader_;
     std::unique_ptr<FaceDetector> face_detector_;
-    std::unique_ptr<FaceTracker> face_tracker_;
     std::unique_ptr<AgeEstimator> age_estimator_;
     std::unique_ptr<FaceParser> face_parser_;
     std::unique_ptr<FeedforwardGenerator> feedforward_generator_;
     std::unique_ptr<DiffusionEditor> diffusion_editor_;
     std::unique_ptr<OpticalFlow> optical_flow_;
     std::unique_ptr<Compositor> compositor_;
+    std::unique_ptr<MemoryBudget> memory_budget_;
+    std::unique_ptr<ResultCache> result_cache_;
+    std::unique_ptr<StageProfiler> stage_profiler_;   // Only with ModelConfig::profile_counters
+    std::unique_ptr<MetricsExporter> metrics_exporter_;   // Only with ModelConfig::metrics_file/metrics_port
+    uint64_t model_hash_ = 0;     // Model file contents and engine version, for result cache keys
+    int batch_sweeps_ = 0;        // Networks swept by the last tuneBatchSizes(); 0 when all were stored
+
+    // Clip state for temporal_coherence, skip_unchanged_faces and KEYFRAME
+    // mode, per FrameContext::clip_id and advanced frame by frame
+    std::mutex clips_mutex_;
+    std::map<uint64_t, std::shared_ptr<ClipState>> clips_;
+    uint64_t clip_uses_ = 0;
+    KeyframePolicy keyframe_policy_;
+
+    // Cross-request dynamic batching per network
+    using ParserScheduler = BatchScheduler<ImageData, MaskImage>;
+    using GeneratorScheduler = BatchScheduler<GeneratorInput, ImageData>;
+    std::unique_ptr<ParserScheduler> parser_scheduler_;
+    std::unique_ptr<GeneratorScheduler> generator_scheduler_;
+
+    // Frames in flight; state_mutex_ guards the slot pool, memory accounting
+    // and metrics shared by concurrent processBatch() calls
+    mutable std::mutex state_mutex_;
+    std::vector<std::unique_ptr<FrameSlot>> free_slots_;
+    std::atomic<int> effective_batch_size_{1};
+    int memory_degradations_ = 0;
+    std::map<std::string, float> memory_metrics_;
 
     // Callbacks
     ProgressCallback progress_callback_;
@@ -219,10 +1163,22 @@ ProcessingResult Engine::processFrame(const FrameContext& context) {
     return pImpl->processFrame(context);
 }
 
+std::vector<ProcessingResult> Engine::processBatch(const std::vector<FrameContext>& contexts) {
+    return pImpl->processBatch(contexts);
+}
+
+bool Engine::usesClipState(const FrameContext& context) const {
+    return pImpl->usesClipState(context);
+}
+
 std::vector<Face> Engine::detectFaces(const ImageData& image) {
     return pImpl->detectFaces(image);
 }
 
+cv::Mat Engine::computeOpticalFlow(const ImageData& frame1, const ImageData& frame2) {
+    return pImpl->computeOpticalFlow(frame1, frame2);
+}
+
 float Engine::estimateAge(const Face& face) {
     return pImpl->estimateAge(face);
 }
@@ -239,8 +1195,13 @@ void Engine::setErrorCallback(ErrorCallback callback) {
     pImpl->error_callback_ = callback;
 }
 
+std::map<std::string, float> Engine::getPerformanceMetrics() const {
+    std::lock_guard<std::mutex> lock(pImpl->state_mutex_);
+    return pImpl->performance_metrics_;
+}
+
 std::string Engine::getVersionInfo() const {
-    return "UFRa Engine v1.0.0";
+    return kVersionInfo;
 }
 
 // Factory functions
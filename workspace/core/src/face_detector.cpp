@@ -1,4 +1,7 @@
 #include "ufra/face_detector.h"
+#include "ufra/inference_session.h"
+#include "ufra/frame_pyramid.h"
+#include <algorithm>
 #include <iostream>
 
 #ifdef OPENCV_FOUND
@@ -21,21 +24,8 @@ namespace cv {
     };
     
     namespace dnn {
-        class Net {
-        public:
-            bool empty() const { return true; }
-            void setPreferableBackend(int) {}
-            void setPreferableTarget(int) {}
-            void setInput(const Mat&) {}
-            Mat forward() { return Mat(); }
-        };
-        
-        Net readNet(const std::string&) { return Net(); }
         void blobFromImage(const Mat&, Mat&, double, const cv::Size&, const cv::Scalar&, bool, bool) {}
         void NMSBoxes(const std::vector<Rect>&, const std::vector<float>&, float, float, std::vector<int>&) {}
-        
-        const int DNN_BACKEND_CUDA = 0;
-        const int DNN_TARGET_CUDA = 0;
     }
     
     class Size {
@@ -55,20 +45,17 @@ namespace ufra {
 
 class FaceDetector::Impl {
 public:
-    Impl() : confidence_threshold_(0.7f), nms_threshold_(0.4f), max_faces_(10) {}
+    Impl() : confidence_threshold_(0.7f), nms_threshold_(0.4f), max_faces_(10), input_size_(640) {}
 
     bool loadModel(const std::string& model_path) {
         try {
-            net_ = cv::dnn::readNet(model_path);
-            if (net_.empty()) {
+            model_ = SharedModel::load(model_path, GPUBackend::CUDA, deterministic_);
+            if (!model_) {
                 std::cerr << "Failed to load face detection model: " << model_path << std::endl;
                 return false;
             }
             
-            // Set backend and target
-            net_.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
-            net_.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
-            
+            sessions_ = std::make_unique<SessionPool>(model_);
             model_loaded_ = true;
             return true;
         }
@@ -78,7 +65,9 @@ public:
         }
     }
 
-    std::vector<Face> detectFaces(const ImageData& image) {
+    // `network_input` may be a pre-scaled copy of `image` (e.g. sampled from a
+    // frame pyramid); boxes and crops always refer to `image`.
+    std::vector<Face> detectFaces(const ImageData& image, const ImageData& network_input) {
         std::vector<Face> faces;
         
         if (!model_loaded_ || image.empty()) {
@@ -88,14 +77,16 @@ public:
         try {
             // Prepare input blob
             cv::Mat blob;
-            cv::dnn::blobFromImage(image, blob, 1.0, cv::Size(640, 640), 
+            cv::dnn::blobFromImage(network_input, blob, 1.0, cv::Size(input_size_, input_size_), 
                                    cv::Scalar(104, 117, 123), false, false);
             
-            net_.setInput(blob);
-            
-            // Run inference
+            // Run inference on this thread's session
             std::vector<cv::Mat> outputs;
-            net_.forward(outputs, net_.getUnconnectedOutLayersNames());
+            {
+                auto session = sessions_->acquire();
+                session->setInput(blob);
+                session->forward(outputs);
+            }
             
             // Parse detections
             if (!outputs.empty()) {
@@ -135,18 +126,9 @@ public:
                     face.box.confidence = confidences[idx];
                     face.box.face_id = static_cast<int>(i);
                     
-                    // Extract face crop with padding
-                    int padding = 50;
-                    cv::Rect crop_rect(
-                        std::max(0, boxes[idx].x - padding),
-                        std::max(0, boxes[idx].y - padding),
-                        std::min(image.cols - std::max(0, boxes[idx].x - padding), 
-                                boxes[idx].width + 2 * padding),
-                        std::min(image.rows - std::max(0, boxes[idx].y - padding), 
-                                boxes[idx].height + 2 * padding)
-                    );
-                    
-                    face.aligned_crop = image(crop_rect).clone();
+                    // Non-owning ROI view; stages resample it through the
+                    // engine's crop cache only when they need a tensor
+                    face.aligned_crop = image(cropRect(boxes[idx], image.size()));
                     
                     // Create identity transform matrix for now
                     face.transform_matrix = cv::Mat::eye(2, 3, CV_32F);
@@ -162,11 +144,23 @@ public:
         return faces;
     }
 
-    cv::dnn::Net net_;
+    // Face box with padding, clipped to the image
+    static cv::Rect cropRect(const cv::Rect& box, const cv::Size& image_size) {
+        const int padding = 50;
+        const int x = std::max(0, box.x - padding);
+        const int y = std::max(0, box.y - padding);
+        return cv::Rect(x, y, std::max(0, std::min(image_size.width - x, box.width + 2 * padding)),
+                        std::max(0, std::min(image_size.height - y, box.height + 2 * padding)));
+    }
+
+    std::shared_ptr<SharedModel> model_;
+    bool deterministic_ = false;
+    std::unique_ptr<SessionPool> sessions_;
     bool model_loaded_ = false;
     float confidence_threshold_;
     float nms_threshold_;
     int max_faces_;
+    int input_size_;
 };
 
 FaceDetector::FaceDetector() : pImpl(std::make_unique<Impl>()) {}
@@ -176,8 +170,29 @@ bool FaceDetector::loadModel(const std::string& model_path) {
     return pImpl->loadModel(model_path);
 }
 
+void FaceDetector::setDeterministic(bool enabled) {
+    pImpl->deterministic_ = enabled;
+}
+
 std::vector<Face> FaceDetector::detectFaces(const ImageData& image) {
-    return pImpl->detectFaces(image);
+    return pImpl->detectFaces(image, image);
+}
+
+std::vector<Face> FaceDetector::detectFaces(FramePyramid& pyramid) {
+    const ImageData& frame = pyramid.getLevel(0);
+    if (!pImpl->model_loaded_ || frame.empty()) {
+        return {};
+    }
+    cv::Size input_size(pImpl->input_size_, pImpl->input_size_);
+    return pImpl->detectFaces(frame, pyramid.sampleFrame(input_size));
+}
+
+void FaceDetector::cropFaces(std::vector<Face>& faces, const ImageData& image) {
+    for (Face& face : faces) {
+        cv::Rect box(static_cast<int>(face.box.x), static_cast<int>(face.box.y), static_cast<int>(face.box.width),
+                     static_cast<int>(face.box.height));
+        face.aligned_crop = image(Impl::cropRect(box, image.size()));
+    }
 }
 
 void FaceDetector::setConfidenceThreshold(float threshold) {
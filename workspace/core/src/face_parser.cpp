@@ -1,6 +1,9 @@
 #include "ufra/face_parser.h"
+#include "ufra/inference_session.h"
 #include <opencv2/dnn.hpp>
+#include <atomic>
 #include <iostream>
+#include <stdexcept>
 
 namespace ufra {
 
@@ -10,15 +13,13 @@ public:
 
     bool loadModel(const std::string& model_path) {
         try {
-            net_ = cv::dnn::readNet(model_path);
-            if (net_.empty()) {
+            model_ = SharedModel::load(model_path, GPUBackend::CUDA, deterministic_);
+            if (!model_) {
                 std::cerr << "Failed to load face parsing model: " << model_path << std::endl;
                 return false;
             }
             
-            net_.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
-            net_.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
-            
+            sessions_ = std::make_unique<SessionPool>(model_);
             model_loaded_ = true;
             return true;
         }
@@ -29,49 +30,84 @@ public:
     }
 
     MaskImage parseFace(const ImageData& face_crop) {
-        if (!model_loaded_ || face_crop.empty()) {
-            return cv::Mat::zeros(face_crop.size(), CV_8UC1);
+        return parseFacesBatch({face_crop}).front();
+    }
+
+    // All crops go through one network call: an Nx3xHxW blob in, N score
+    // maps out. Networks exported with a fixed batch of one are run a crop
+    // at a time instead.
+    std::vector<MaskImage> parseFacesBatch(const std::vector<ImageData>& face_crops) {
+        std::vector<MaskImage> results;
+        std::vector<cv::Mat> inputs;
+        std::vector<size_t> indices;
+        for (size_t i = 0; i < face_crops.size(); ++i) {
+            const ImageData& crop = face_crops[i];
+            results.push_back(cv::Mat::zeros(crop.size(), CV_8UC1));
+            if (!model_loaded_ || crop.empty()) {
+                continue;
+            }
+            cv::Mat resized = crop;
+            if (crop.cols != input_width_ || crop.rows != input_height_) {
+                cv::resize(crop, resized, cv::Size(input_width_, input_height_));
+            }
+            inputs.push_back(resized);
+            indices.push_back(i);
+        }
+        if (inputs.empty()) {
+            return results;
         }
 
         try {
-            // Preprocess input
-            cv::Mat resized;
-            cv::resize(face_crop, resized, cv::Size(input_width_, input_height_));
-            
-            // Create blob
-            cv::Mat blob;
-            cv::dnn::blobFromImage(resized, blob, 1.0/255.0, 
-                                   cv::Size(input_width_, input_height_), 
-                                   cv::Scalar(0.485, 0.456, 0.406), true, false);
-            
-            net_.setInput(blob);
-            
-            // Forward pass
-            cv::Mat output = net_.forward();
-            
-            // Convert output to parsing mask
-            cv::Mat parsing_mask = convertToParseMask(output);
-            
-            // Resize back to original size
-            cv::Mat final_mask;
-            cv::resize(parsing_mask, final_mask, face_crop.size(), 0, 0, cv::INTER_NEAREST);
-            
-            return final_mask;
+            // Forward passes on this thread's session; outputs are read
+            // before the session is handed on
+            auto session = sessions_->acquire();
+            auto run = [&](const std::vector<cv::Mat>& images) {
+                cv::Mat blob;
+                cv::dnn::blobFromImages(images, blob, 1.0/255.0, cv::Size(input_width_, input_height_),
+                                        cv::Scalar(0.485, 0.456, 0.406), true, false);
+                session->setInput(blob);
+                cv::Mat output = session->forward();
+                if (output.dims != 4 || output.size[0] != static_cast<int>(images.size())) {
+                    throw std::runtime_error("face parser output does not match its batch");
+                }
+                return output;
+            };
+            auto store = [&](const cv::Mat& output, int item, size_t index) {
+                cv::Mat parsing_mask = convertToParseMask(blobItem(output, item));
+                const ImageData& crop = face_crops[index];
+                if (parsing_mask.size() == crop.size()) {
+                    results[index] = parsing_mask;
+                } else {
+                    cv::resize(parsing_mask, results[index], crop.size(), 0, 0, cv::INTER_NEAREST);
+                }
+            };
+
+            if (inputs.size() > 1 && !single_crop_only_) {
+                try {
+                    const cv::Mat output = run(inputs);
+                    for (size_t k = 0; k < inputs.size(); ++k) {
+                        store(output, static_cast<int>(k), indices[k]);
+                    }
+                    return results;
+                }
+                catch (const std::exception& e) {
+                    single_crop_only_ = true;
+                    std::cerr << "Face parser does not take batches, parsing one crop per call: " << e.what()
+                              << std::endl;
+                }
+            }
+            for (size_t k = 0; k < inputs.size(); ++k) {
+                try {
+                    store(run({inputs[k]}), 0, indices[k]);
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "Error in face parsing: " << e.what() << std::endl;
+                }
+            }
         }
         catch (const std::exception& e) {
             std::cerr << "Error in face parsing: " << e.what() << std::endl;
-            return cv::Mat::zeros(face_crop.size(), CV_8UC1);
-        }
-    }
-
-    std::vector<MaskImage> parseFacesBatch(const std::vector<ImageData>& face_crops) {
-        std::vector<MaskImage> results;
-        results.reserve(face_crops.size());
-        
-        for (const auto& crop : face_crops) {
-            results.push_back(parseFace(crop));
         }
-        
         return results;
     }
 
@@ -171,27 +207,35 @@ public:
         return getRegionMask(full_mask, {6, 7}); // l_brow, r_brow
     }
 
+    bool deterministic_ = false;
+    std::atomic<bool> single_crop_only_{false};
+
 private:
+    // Per-pixel argmax over the class planes of a (1, num_classes, H, W)
+    // output; the planes are contiguous, so scores of one pixel are a plane apart
     cv::Mat convertToParseMask(const cv::Mat& network_output) {
-        // Assuming network output is (1, num_classes, H, W)
-        cv::Mat reshaped = network_output.reshape(1, network_output.size[2] * network_output.size[3]);
-        
-        cv::Mat parsing_mask = cv::Mat::zeros(network_output.size[2], network_output.size[3], CV_8UC1);
-        
-        // Find argmax for each pixel
-        for (int i = 0; i < reshaped.rows; ++i) {
-            cv::Point max_loc;
-            cv::minMaxLoc(reshaped.row(i), nullptr, nullptr, nullptr, &max_loc);
-            
-            int y = i / network_output.size[3];
-            int x = i % network_output.size[3];
-            parsing_mask.at<uchar>(y, x) = static_cast<uchar>(max_loc.x);
+        const int classes = network_output.size[1];
+        const int height = network_output.size[2], width = network_output.size[3];
+        const size_t plane = static_cast<size_t>(height) * width;
+        const float* scores = network_output.ptr<float>();
+
+        cv::Mat parsing_mask(height, width, CV_8UC1);
+        uchar* labels = parsing_mask.ptr<uchar>();
+        for (size_t i = 0; i < plane; ++i) {
+            int best = 0;
+            for (int c = 1; c < classes; ++c) {
+                if (scores[c * plane + i] > scores[best * plane + i]) {
+                    best = c;
+                }
+            }
+            labels[i] = static_cast<uchar>(best);
         }
-        
+
         return parsing_mask;
     }
 
-    cv::dnn::Net net_;
+    std::shared_ptr<SharedModel> model_;
+    std::unique_ptr<SessionPool> sessions_;
     bool model_loaded_;
     int input_width_, input_height_;
 };
@@ -203,6 +247,10 @@ bool FaceParser::loadModel(const std::string& model_path) {
     return pImpl->loadModel(model_path);
 }
 
+void FaceParser::setDeterministic(bool enabled) {
+    pImpl->deterministic_ = enabled;
+}
+
 MaskImage FaceParser::parseFace(const ImageData& face_crop) {
     return pImpl->parseFace(face_crop);
 }
@@ -248,4 +296,8 @@ void FaceParser::setInputSize(int width, int height) {
     pImpl->input_height_ = height;
 }
 
+cv::Size FaceParser::getInputSize() const {
+    return cv::Size(pImpl->input_width_, pImpl->input_height_);
+}
+
 } // namespace ufra
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "ufra/face_tracker.h"
+#include <algorithm>
+#include <mutex>
+
+namespace ufra {
+
+namespace {
+
+float overlap(const FaceBox& a, const FaceBox& b) {
+    const float x0 = std::max(a.x, b.x);
+    const float y0 = std::max(a.y, b.y);
+    const float x1 = std::min(a.x + a.width, b.x + b.width);
+    const float y1 = std::min(a.y + a.height, b.y + b.height);
+    const float intersection = std::max(0.0f, x1 - x0) * std::max(0.0f, y1 - y0);
+    const float unite = a.width * a.height + b.width * b.height - intersection;
+    return unite > 0.0f ? intersection / unite : 0.0f;
+}
+
+} // namespace
+
+class FaceTracker::Impl {
+public:
+    struct Track {
+        int id;
+        FaceBox box;
+        int last_frame;
+    };
+
+    std::vector<int> update(std::vector<Face>& faces, int frame_number) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Best-overlap pairs first, each track and face used once
+        struct Candidate {
+            float iou;
+            size_t track;
+            size_t face;
+        };
+        std::vector<Candidate> candidates;
+        for (size_t t = 0; t < tracks_.size(); ++t) {
+            for (size_t f = 0; f < faces.size(); ++f) {
+                const float iou = overlap(tracks_[t].box, faces[f].box);
+                if (iou >= iou_threshold_) {
+                    candidates.push_back(Candidate{iou, t, f});
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Candidate& a, const Candidate& b) { return a.iou > b.iou; });
+
+        std::vector<bool> track_used(tracks_.size(), false);
+        std::vector<bool> face_matched(faces.size(), false);
+        for (const Candidate& candidate : candidates) {
+            if (track_used[candidate.track] || face_matched[candidate.face]) {
+                continue;
+            }
+            track_used[candidate.track] = true;
+            face_matched[candidate.face] = true;
+            Track& track = tracks_[candidate.track];
+            track.box = faces[candidate.face].box;
+            track.last_frame = frame_number;
+            faces[candidate.face].track_id = track.id;
+        }
+
+        for (size_t f = 0; f < faces.size(); ++f) {
+            faces[f].frame_number = frame_number;
+            if (!face_matched[f]) {
+                faces[f].track_id = next_id_++;
+                tracks_.push_back(Track{faces[f].track_id, faces[f].box, frame_number});
+            }
+        }
+
+        std::vector<int> retired;
+        auto expired = [&](const Track& track) {
+            // A jump backwards (seek) also ends the track
+            const bool gone = frame_number - track.last_frame > max_missed_frames_ || track.last_frame > frame_number;
+            if (gone) {
+                retired.push_back(track.id);
+            }
+            return gone;
+        };
+        tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(), expired), tracks_.end());
+        return retired;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tracks_.clear();
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<Track> tracks_;
+    int next_id_ = 0;
+    float iou_threshold_ = 0.3f;
+    int max_missed_frames_ = 5;
+};
+
+FaceTracker::FaceTracker() : pImpl(std::make_unique<Impl>()) {}
+
+FaceTracker::~FaceTracker() = default;
+
+std::vector<int> FaceTracker::update(std::vector<Face>& faces, int frame_number) {
+    return pImpl->update(faces, frame_number);
+}
+
+void FaceTracker::reset() {
+    pImpl->reset();
+}
+
+void FaceTracker::setIoUThreshold(float threshold) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->iou_threshold_ = threshold;
+}
+
+void FaceTracker::setMaxMissedFrames(int frames) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->max_missed_frames_ = std::max(0, frames);
+}
+
+size_t FaceTracker::getActiveTrackCount() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->tracks_.size();
+}
+
+} // namespace ufra
@@ -1,6 +1,11 @@
 #include "ufra/feedforward_generator.h"
+#include "ufra/inference_session.h"
+#include "ufra/temporal_cache.h"
 #include <opencv2/dnn.hpp>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <stdexcept>
 
 namespace ufra {
 
@@ -11,15 +16,13 @@ public:
 
     bool loadModel(const std::string& model_path) {
         try {
-            net_ = cv::dnn::readNet(model_path);
-            if (net_.empty()) {
+            model_ = SharedModel::load(model_path, GPUBackend::CUDA, deterministic_);
+            if (!model_) {
                 std::cerr << "Failed to load feedforward generator model: " << model_path << std::endl;
                 return false;
             }
             
-            net_.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
-            net_.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
-            
+            sessions_ = std::make_unique<SessionPool>(model_);
             model_loaded_ = true;
             return true;
         }
@@ -32,83 +35,155 @@ public:
     ImageData generateAgedFace(const ImageData& face_crop, 
                               const AgeControls& controls,
                               const MaskImage& parsing_mask) {
-        if (!model_loaded_ || face_crop.empty()) {
-            return face_crop.clone();
-        }
+        return generateAgedFacesBatch({face_crop}, {controls}, {parsing_mask}).front();
+    }
 
-        try {
+    // All crops go through one network call: an Nx3xHxW face blob and an
+    // Nx1 age vector in, N faces out. Networks exported with a fixed batch
+    // of one are run a crop at a time instead.
+    std::vector<ImageData> generateAgedFacesBatch(
+        const std::vector<ImageData>& face_crops,
+        const std::vector<AgeControls>& controls,
+        const std::vector<MaskImage>& parsing_masks) {
+
+        std::vector<ImageData> results;
+        std::vector<cv::Mat> inputs;
+        std::vector<size_t> indices;
+        for (size_t i = 0; i < face_crops.size(); ++i) {
+            const ImageData& crop = face_crops[i];
+            results.push_back(crop.clone());
+            if (!model_loaded_ || crop.empty() || controls.empty()) {
+                continue;
+            }
             // Preprocess input
-            cv::Mat resized;
-            cv::resize(face_crop, resized, cv::Size(input_width_, input_height_));
-            
+            // Crops already at input resolution (shared from the engine's crop
+            // cache) are used as-is instead of being resampled again
+            cv::Mat resized = crop;
+            if (crop.cols != input_width_ || crop.rows != input_height_) {
+                cv::resize(crop, resized, cv::Size(input_width_, input_height_));
+            }
+
             // Normalize to [-1, 1]
             cv::Mat normalized;
             resized.convertTo(normalized, CV_32F, 2.0/255.0, -1.0);
-            
-            // Create input blob with age conditioning
-            cv::Mat blob;
-            cv::dnn::blobFromImage(normalized, blob, 1.0, 
-                                   cv::Size(input_width_, input_height_), 
-                                   cv::Scalar(0, 0, 0), true, false);
-            
-            // Add age conditioning vector
-            cv::Mat age_vector = cv::Mat::zeros(1, 1, CV_32F);
-            age_vector.at<float>(0, 0) = controls.target_age / 100.0f; // Normalize age
-            
-            // Set inputs
-            net_.setInput(blob, "face_input");
-            net_.setInput(age_vector, "age_input");
-            
-            // Forward pass
-            cv::Mat output = net_.forward();
-            
-            // Post-process output
-            cv::Mat result_float;
-            cv::dnn::imagesFromBlob(output, result_float);
-            
-            // Denormalize from [-1, 1] to [0, 255]
-            cv::Mat result_uint8;
-            result_float = (result_float + 1.0) * 127.5;
-            result_float.convertTo(result_uint8, CV_8UC3);
-            
-            // Apply identity preservation blending
-            cv::Mat final_result;
-            cv::addWeighted(face_crop, controls.identity_lock_strength,
-                           result_uint8, 1.0f - controls.identity_lock_strength,
-                           0, final_result);
-            
-            // Apply regional masking if parsing mask is provided
-            if (!parsing_mask.empty()) {
-                applyRegionalBlending(face_crop, final_result, parsing_mask, controls);
+            inputs.push_back(normalized);
+            indices.push_back(i);
+        }
+        if (inputs.empty()) {
+            return results;
+        }
+        auto controlsFor = [&](size_t index) -> const AgeControls& {
+            return index < controls.size() ? controls[index] : controls[0];
+        };
+
+        try {
+            // Forward passes on this thread's session; outputs are read
+            // before the session is handed on
+            auto session = sessions_->acquire();
+            auto run = [&](const std::vector<cv::Mat>& images, const std::vector<size_t>& items) {
+                cv::Mat blob;
+                cv::dnn::blobFromImages(images, blob, 1.0, cv::Size(input_width_, input_height_),
+                                        cv::Scalar(0, 0, 0), true, false);
+
+                // Age conditioning, one normalized age per face
+                cv::Mat age_vector(static_cast<int>(items.size()), 1, CV_32F);
+                for (size_t k = 0; k < items.size(); ++k) {
+                    age_vector.at<float>(static_cast<int>(k), 0) = controlsFor(items[k]).target_age / 100.0f;
+                }
+                session->setInput(blob, "face_input");
+                session->setInput(age_vector, "age_input");
+                cv::Mat output = session->forward();
+                if (output.dims != 4 || output.size[0] != static_cast<int>(images.size())) {
+                    throw std::runtime_error("generator output does not match its batch");
+                }
+                return output;
+            };
+            auto store = [&](const cv::Mat& output, int item, size_t index) {
+                try {
+                    results[index] = finishFace(face_crops[index], blobItem(output, item), controlsFor(index),
+                                                index < parsing_masks.size() ? parsing_masks[index] : cv::Mat());
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "Error in feedforward generation: " << e.what() << std::endl;
+                }
+            };
+
+            if (inputs.size() > 1 && !single_crop_only_) {
+                try {
+                    const cv::Mat output = run(inputs, indices);
+                    for (size_t k = 0; k < inputs.size(); ++k) {
+                        store(output, static_cast<int>(k), indices[k]);
+                    }
+                    return results;
+                }
+                catch (const std::exception& e) {
+                    single_crop_only_ = true;
+                    std::cerr << "Feedforward generator does not take batches, generating one face per call: "
+                              << e.what() << std::endl;
+                }
+            }
+            for (size_t k = 0; k < inputs.size(); ++k) {
+                try {
+                    store(run({inputs[k]}, {indices[k]}), 0, indices[k]);
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "Error in feedforward generation: " << e.what() << std::endl;
+                }
             }
-            
-            return final_result;
         }
         catch (const std::exception& e) {
             std::cerr << "Error in feedforward generation: " << e.what() << std::endl;
-            return face_crop.clone();
         }
+        return results;
     }
 
-    std::vector<ImageData> generateAgedFacesBatch(
-        const std::vector<ImageData>& face_crops,
-        const std::vector<AgeControls>& controls,
-        const std::vector<MaskImage>& parsing_masks) {
-        
-        std::vector<ImageData> results;
-        results.reserve(face_crops.size());
-        
-        for (size_t i = 0; i < face_crops.size(); ++i) {
-            const AgeControls& ctrl = i < controls.size() ? controls[i] : controls[0];
-            const MaskImage& mask = i < parsing_masks.size() ? parsing_masks[i] : cv::Mat();
-            
-            results.push_back(generateAgedFace(face_crops[i], ctrl, mask));
+    ImageData stabilize(const ImageData& generated, const TemporalPrior& prior, float temporal_stability) const {
+        if (!temporal_stabilization_ || !prior.valid || prior.result.size() != generated.size() ||
+            prior.result.type() != generated.type()) {
+            return generated;
         }
-        
-        return results;
+        // A residual of 1/8 (occlusion, expression change) disables reuse;
+        // the current frame always keeps at least a quarter of the weight
+        const float match = std::max(0.0f, 1.0f - prior.residual * 8.0f);
+        const float weight = 0.75f * std::max(0.0f, std::min(1.0f, temporal_stability)) * match;
+        if (weight <= 0.0f) {
+            return generated;
+        }
+        cv::Mat stabilized;
+        cv::addWeighted(prior.result, weight, generated, 1.0f - weight, 0, stabilized);
+        return stabilized;
     }
 
+    bool deterministic_ = false;
+    std::atomic<bool> single_crop_only_{false};
+
 private:
+    // Network output for one face (1x3xHxW in [-1, 1]) to the aged crop
+    ImageData finishFace(const ImageData& face_crop, const cv::Mat& output, const AgeControls& controls,
+                         const MaskImage& parsing_mask) {
+        // Post-process output
+        cv::Mat result_float;
+        cv::dnn::imagesFromBlob(output, result_float);
+
+        // Denormalize from [-1, 1] to [0, 255]
+        cv::Mat result_uint8;
+        result_float = (result_float + 1.0) * 127.5;
+        result_float.convertTo(result_uint8, CV_8UC3);
+
+        // Apply identity preservation blending
+        cv::Mat final_result;
+        cv::addWeighted(face_crop, controls.identity_lock_strength,
+                       result_uint8, 1.0f - controls.identity_lock_strength,
+                       0, final_result);
+
+        // Apply regional masking if parsing mask is provided
+        if (!parsing_mask.empty()) {
+            applyRegionalBlending(face_crop, final_result, parsing_mask, controls);
+        }
+
+        return final_result;
+    }
+
     void applyRegionalBlending(const ImageData& original, ImageData& aged, 
                               const MaskImage& parsing_mask, const AgeControls& controls) {
         // Apply different blending strengths to different facial regions
@@ -158,7 +233,8 @@ private:
         }
     }
 
-    cv::dnn::Net net_;
+    std::shared_ptr<SharedModel> model_;
+    std::unique_ptr<SessionPool> sessions_;
     bool model_loaded_;
     int input_width_, input_height_;
     bool temporal_stabilization_;
@@ -172,6 +248,10 @@ bool FeedforwardGenerator::loadModel(const std::string& model_path) {
     return pImpl->loadModel(model_path);
 }
 
+void FeedforwardGenerator::setDeterministic(bool enabled) {
+    pImpl->deterministic_ = enabled;
+}
+
 ImageData FeedforwardGenerator::generateAgedFace(const ImageData& face_crop,
                                                 const AgeControls& controls,
                                                 const MaskImage& parsing_mask) {
@@ -185,11 +265,20 @@ std::vector<ImageData> FeedforwardGenerator::generateAgedFacesBatch(
     return pImpl->generateAgedFacesBatch(face_crops, controls, parsing_masks);
 }
 
+ImageData FeedforwardGenerator::stabilize(const ImageData& generated, const TemporalPrior& prior,
+                                          float temporal_stability) const {
+    return pImpl->stabilize(generated, prior, temporal_stability);
+}
+
 void FeedforwardGenerator::setInputResolution(int width, int height) {
     pImpl->input_width_ = width;
     pImpl->input_height_ = height;
 }
 
+cv::Size FeedforwardGenerator::getInputSize() const {
+    return cv::Size(pImpl->input_width_, pImpl->input_height_);
+}
+
 void FeedforwardGenerator::enableTemporalStabilization(bool enable) {
     pImpl->temporal_stabilization_ = enable;
 }
@@ -0,0 +1,161 @@
+#include "ufra/frame_pyramid.h"
+#include "ufra/image_kernels.h"
+#include <opencv2/imgproc.hpp>
+#include <vector>
+
+namespace ufra {
+
+namespace {
+
+// Stop halving once either side would drop below this many pixels
+constexpr int kMinLevelSide = 16;
+
+} // namespace
+
+class FramePyramid::Impl {
+public:
+    void reset(const ImageData& frame) {
+        base_ = frame;
+        built_ = frame.empty() ? 0 : 1;
+    }
+
+    const ImageData& getLevel(int level) {
+        if (level <= 0 || base_.empty()) {
+            return base_;
+        }
+
+        if (levels_.size() < static_cast<size_t>(level)) {
+            levels_.resize(level);
+        }
+
+        while (built_ <= level) {
+            const cv::Mat& src = (built_ == 1) ? base_ : levels_[built_ - 2];
+            if (src.cols / 2 < kMinLevelSide || src.rows / 2 < kMinLevelSide) {
+                return src;
+            }
+
+            cv::Mat& dst = levels_[built_ - 1];
+            if (dst.empty()) {
+                dst.allocator = allocator_;
+            }
+            dst.create(src.rows / 2, src.cols / 2, src.type());  // No-op when the size is unchanged
+            if (src.depth() == CV_8U) {
+                kernels::downsample2x(src.data, src.cols, src.rows, src.step,
+                                      src.channels(), dst.data, dst.step);
+            } else {
+                cv::resize(src, dst, dst.size(), 0, 0, cv::INTER_AREA);
+            }
+            ++built_;
+        }
+        return levels_[level - 1];
+    }
+
+    // Coarsest level whose resampling factor for `roi` -> `size` stays >= 1
+    int chooseLevel(const cv::Rect& roi, const cv::Size& size) const {
+        int level = 0;
+        int w = roi.width, h = roi.height;
+        while (w / 2 >= size.width && h / 2 >= size.height &&
+               (base_.cols >> (level + 1)) >= kMinLevelSide &&
+               (base_.rows >> (level + 1)) >= kMinLevelSide) {
+            w /= 2;
+            h /= 2;
+            ++level;
+        }
+        return level;
+    }
+
+    ImageData sample(const cv::Rect& roi, const cv::Size& size) {
+        if (base_.empty() || roi.width <= 0 || roi.height <= 0) {
+            return ImageData();
+        }
+
+        int level = chooseLevel(roi, size);
+        const cv::Mat& src = getLevel(level);
+        double scale = static_cast<double>(src.cols) / base_.cols;
+
+        cv::Rect level_roi(static_cast<int>(roi.x * scale), static_cast<int>(roi.y * scale),
+                           std::max(1, static_cast<int>(roi.width * scale)),
+                           std::max(1, static_cast<int>(roi.height * scale)));
+        level_roi &= cv::Rect(0, 0, src.cols, src.rows);
+        if (level_roi.empty()) {
+            return ImageData();
+        }
+
+        cv::Mat view = src(level_roi);
+        if (view.size() == size) {
+            return view;
+        }
+
+        cv::Mat resized;
+        int interpolation = (view.cols > size.width) ? cv::INTER_AREA : cv::INTER_LINEAR;
+        cv::resize(view, resized, size, 0, 0, interpolation);
+        return resized;
+    }
+
+    cv::Mat base_;
+    std::vector<cv::Mat> levels_;  // levels_[i] is level i + 1
+    int built_ = 0;
+    cv::MatAllocator* allocator_ = nullptr;
+};
+
+FramePyramid::FramePyramid() : pImpl(std::make_unique<Impl>()) {}
+FramePyramid::~FramePyramid() = default;
+
+void FramePyramid::reset(const ImageData& frame) {
+    pImpl->reset(frame);
+}
+
+const ImageData& FramePyramid::getLevel(int level) {
+    return pImpl->getLevel(level);
+}
+
+int FramePyramid::getLevelCount() const {
+    return pImpl->built_;
+}
+
+ImageData FramePyramid::sample(const cv::Rect& roi, const cv::Size& size) {
+    return pImpl->sample(roi, size);
+}
+
+ImageData FramePyramid::sampleFrame(const cv::Size& size) {
+    return pImpl->sample(cv::Rect(0, 0, pImpl->base_.cols, pImpl->base_.rows), size);
+}
+
+bool FramePyramid::locate(const ImageData& view, cv::Rect& roi) const {
+    const cv::Mat& base = pImpl->base_;
+    if (base.empty() || view.empty() || view.datastart != base.datastart) {
+        return false;
+    }
+
+    cv::Size whole;
+    cv::Point offset;
+    view.locateROI(whole, offset);
+
+    // The frame itself may be a ROI of a larger buffer
+    cv::Size base_whole;
+    cv::Point base_offset;
+    base.locateROI(base_whole, base_offset);
+
+    roi = cv::Rect(offset - base_offset, view.size());
+    return (roi & cv::Rect(0, 0, base.cols, base.rows)) == roi;
+}
+
+size_t FramePyramid::getMemoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& level : pImpl->levels_) {
+        bytes += level.total() * level.elemSize();
+    }
+    return bytes;
+}
+
+void FramePyramid::releaseBuffers() {
+    pImpl->levels_.clear();
+    pImpl->levels_.shrink_to_fit();
+    pImpl->built_ = std::min(pImpl->built_, 1);
+}
+
+void FramePyramid::setAllocator(cv::MatAllocator* allocator) {
+    pImpl->allocator_ = allocator;
+}
+
+} // namespace ufra
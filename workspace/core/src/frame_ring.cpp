@@ -0,0 +1,338 @@
+#include "ufra/frame_ring.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace ufra {
+namespace service {
+
+namespace {
+
+constexpr uint32_t kRingMagic = 0x55465247;   // "UFRG"
+constexpr uint32_t kRingVersion = 1;
+constexpr size_t kPageSize = 4096;
+
+// Shared control block at offset 0, followed by RingSlot[slot_count]. The
+// counters run freely and wrap; occupancy is head - tail.
+struct RingControl {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t slot_count;
+    uint64_t slot_bytes;
+    uint64_t data_offset;
+
+    alignas(64) std::atomic<uint32_t> head;           // Slots published
+    std::atomic<uint32_t> head_waiters;
+    alignas(64) std::atomic<uint32_t> tail;           // Slots released
+    std::atomic<uint32_t> tail_waiters;
+    alignas(64) std::atomic<uint32_t> closed;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "futex words must be plain 32-bit integers");
+
+size_t pageAlign(size_t bytes) {
+    return (bytes + kPageSize - 1) / kPageSize * kPageSize;
+}
+
+size_t headersOffset() {
+    return (sizeof(RingControl) + 63) / 64 * 64;
+}
+
+size_t controlBytes(size_t slot_count) {
+    return pageAlign(headersOffset() + slot_count * sizeof(RingSlot));
+}
+
+// Shared (not FUTEX_PRIVATE): the waiter and waker are in different processes
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected, const timespec* timeout) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, timeout, nullptr, 0);
+}
+
+void futexWake(std::atomic<uint32_t>& word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+} // namespace
+
+class FrameRing::Impl {
+public:
+    ~Impl() { reset(); }
+
+    bool map(int fd, Role role, size_t slot_count, size_t slot_bytes) {
+        const size_t control_bytes = controlBytes(slot_count);
+        void* control = mmap(nullptr, control_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (control == MAP_FAILED) {
+            last_error_ = std::string("mmap failed: ") + std::strerror(errno);
+            return false;
+        }
+        const int data_protection = role == Role::PRODUCER ? PROT_READ | PROT_WRITE : PROT_READ;
+        void* data = mmap(nullptr, slot_count * slot_bytes, data_protection, MAP_SHARED, fd,
+                          static_cast<off_t>(control_bytes));
+        if (data == MAP_FAILED) {
+            last_error_ = std::string("mmap failed: ") + std::strerror(errno);
+            munmap(control, control_bytes);
+            return false;
+        }
+        control_ = static_cast<RingControl*>(control);
+        control_bytes_ = control_bytes;
+        data_ = static_cast<uint8_t*>(data);
+        slot_count_ = slot_count;
+        slot_bytes_ = slot_bytes;
+        fd_ = fd;
+        role_ = role;
+        reserved_ = 0;
+        read_ = static_cast<RingControl*>(control)->tail.load();
+        return true;
+    }
+
+    void reset() {
+        if (control_) {
+            munmap(control_, control_bytes_);
+            munmap(data_, slot_count_ * slot_bytes_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        control_ = nullptr;
+        data_ = nullptr;
+        fd_ = -1;
+        slot_count_ = slot_bytes_ = 0;
+    }
+
+    RingSlot* headers() const {
+        return reinterpret_cast<RingSlot*>(reinterpret_cast<uint8_t*>(control_) + headersOffset());
+    }
+
+    // Waits until ready() or the deadline; false on timeout or close
+    template <typename Ready>
+    bool wait(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiters, int timeout_ms, Ready ready) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        for (;;) {
+            const uint32_t observed = word.load();
+            if (ready()) {
+                return true;
+            }
+            if (control_->closed.load()) {
+                last_error_ = "ring closed";
+                return false;
+            }
+            timespec remaining{};
+            if (timeout_ms >= 0) {
+                auto left = deadline - std::chrono::steady_clock::now();
+                if (left <= std::chrono::nanoseconds::zero()) {
+                    last_error_ = "timed out waiting for the ring";
+                    return false;
+                }
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+                remaining.tv_sec = static_cast<time_t>(ns / 1000000000);
+                remaining.tv_nsec = static_cast<long>(ns % 1000000000);
+            }
+            waiters.fetch_add(1);
+            if (!ready() && !control_->closed.load()) {
+                futexWait(word, observed, timeout_ms >= 0 ? &remaining : nullptr);
+            }
+            waiters.fetch_sub(1);
+        }
+    }
+
+    RingControl* control_ = nullptr;
+    size_t control_bytes_ = 0;
+    uint8_t* data_ = nullptr;
+    size_t slot_count_ = 0;
+    size_t slot_bytes_ = 0;
+    int fd_ = -1;
+    Role role_ = Role::PRODUCER;
+    uint32_t reserved_ = 0;    // Producer: acquired but not yet published
+    std::atomic<uint32_t> read_{0};   // Consumer: next slot to receive (tail..read_ are held)
+    std::string last_error_;
+};
+
+FrameRing::FrameRing() : pImpl(std::make_unique<Impl>()) {}
+FrameRing::~FrameRing() = default;
+
+bool FrameRing::create(size_t slot_count, size_t slot_bytes) {
+    reset();
+    if (slot_count == 0 || slot_count > (1u << 16) || slot_bytes == 0) {
+        pImpl->last_error_ = "invalid ring geometry";
+        return false;
+    }
+    slot_bytes = pageAlign(slot_bytes);
+    const size_t total = controlBytes(slot_count) + slot_count * slot_bytes;
+
+    int fd = memfd_create("ufra-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0 || ftruncate(fd, static_cast<off_t>(total)) != 0 ||
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+        pImpl->last_error_ = std::string("cannot create ring: ") + std::strerror(errno);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    if (!pImpl->map(fd, Role::PRODUCER, slot_count, slot_bytes)) {
+        ::close(fd);
+        return false;
+    }
+
+    RingControl* control = pImpl->control_;
+    control->magic = kRingMagic;
+    control->version = kRingVersion;
+    control->slot_count = slot_count;
+    control->slot_bytes = slot_bytes;
+    control->data_offset = controlBytes(slot_count);
+    control->head = 0;
+    control->head_waiters = 0;
+    control->tail = 0;
+    control->tail_waiters = 0;
+    control->closed = 0;
+    return true;
+}
+
+bool FrameRing::attach(int fd, Role role) {
+    reset();
+    // Geometry comes from the peer: check it against the sealed file size
+    // before trusting it with a mapping
+    RingControl header;
+    struct stat info;
+    const int seals = fcntl(fd, F_GET_SEALS);
+    bool valid = seals >= 0 && (seals & F_SEAL_SHRINK) && fstat(fd, &info) == 0 &&
+                 pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                 header.magic == kRingMagic && header.version == kRingVersion &&
+                 header.slot_count > 0 && header.slot_count <= (1u << 16) &&
+                 header.slot_bytes > 0 && header.slot_bytes % kPageSize == 0 &&
+                 header.data_offset == controlBytes(header.slot_count) &&
+                 header.slot_bytes <= (static_cast<uint64_t>(info.st_size) - header.data_offset) / header.slot_count;
+    if (!valid) {
+        pImpl->last_error_ = "not a sealed frame ring";
+        ::close(fd);
+        return false;
+    }
+    if (!pImpl->map(fd, role, header.slot_count, header.slot_bytes)) {
+        ::close(fd);
+        return false;
+    }
+    return true;
+}
+
+void FrameRing::reset() {
+    pImpl->reset();
+}
+
+int FrameRing::fd() const {
+    return pImpl->fd_;
+}
+
+size_t FrameRing::slotCount() const {
+    return pImpl->slot_count_;
+}
+
+size_t FrameRing::slotBytes() const {
+    return pImpl->slot_bytes_;
+}
+
+uint8_t* FrameRing::acquire(int timeout_ms) {
+    Impl& ring = *pImpl;
+    if (!ring.control_ || ring.role_ != Role::PRODUCER) {
+        ring.last_error_ = "not a producer";
+        return nullptr;
+    }
+    RingControl& control = *ring.control_;
+    const uint32_t capacity = static_cast<uint32_t>(ring.slot_count_);
+    auto has_room = [&] { return control.head.load() + ring.reserved_ - control.tail.load() < capacity; };
+    if (!ring.wait(control.tail, control.tail_waiters, timeout_ms, has_room)) {
+        return nullptr;
+    }
+    const uint32_t index = (control.head.load() + ring.reserved_++) % capacity;
+    return ring.data_ + static_cast<size_t>(index) * ring.slot_bytes_;
+}
+
+bool FrameRing::publish(const RingSlot& slot) {
+    Impl& ring = *pImpl;
+    if (!ring.control_ || ring.role_ != Role::PRODUCER || ring.reserved_ == 0) {
+        ring.last_error_ = "no acquired slot to publish";
+        return false;
+    }
+    RingControl& control = *ring.control_;
+    const uint32_t head = control.head.load();
+    RingSlot& header = ring.headers()[head % ring.slot_count_];
+    const uint32_t meta_bytes = slot.meta_bytes < kRingMetaBytes ? slot.meta_bytes : kRingMetaBytes;
+    std::memcpy(&header, &slot, offsetof(RingSlot, meta) + meta_bytes);
+    header.meta_bytes = meta_bytes;
+
+    ring.reserved_--;
+    control.head.store(head + 1);
+    if (control.head_waiters.load() > 0) {
+        futexWake(control.head);
+    }
+    return true;
+}
+
+bool FrameRing::receive(RingSlot& slot, const uint8_t*& data, int timeout_ms) {
+    Impl& ring = *pImpl;
+    if (!ring.control_ || ring.role_ != Role::CONSUMER) {
+        ring.last_error_ = "not a consumer";
+        return false;
+    }
+    RingControl& control = *ring.control_;
+    // Only the receiving thread advances read_; release() only moves tail
+    const uint32_t next = ring.read_.load();
+    auto available = [&] { return control.head.load() != next; };
+    if (!ring.wait(control.head, control.head_waiters, timeout_ms, available)) {
+        return false;
+    }
+    if (control.head.load() - next > ring.slot_count_) {
+        ring.last_error_ = "corrupt ring counters";
+        return false;
+    }
+    const uint32_t index = next % static_cast<uint32_t>(ring.slot_count_);
+    const RingSlot& header = ring.headers()[index];
+    const uint32_t meta_bytes = header.meta_bytes < kRingMetaBytes ? header.meta_bytes : kRingMetaBytes;
+    std::memcpy(&slot, &header, offsetof(RingSlot, meta) + meta_bytes);
+    slot.meta_bytes = meta_bytes;
+    data = ring.data_ + static_cast<size_t>(index) * ring.slot_bytes_;
+    ring.read_.store(next + 1);
+    return true;
+}
+
+void FrameRing::release() {
+    Impl& ring = *pImpl;
+    if (!ring.control_ || ring.role_ != Role::CONSUMER) {
+        return;
+    }
+    RingControl& control = *ring.control_;
+    const uint32_t tail = control.tail.load();
+    if (tail == ring.read_.load()) {
+        return;   // Nothing held
+    }
+    control.tail.store(tail + 1);
+    if (control.tail_waiters.load() > 0) {
+        futexWake(control.tail);
+    }
+}
+
+void FrameRing::close() {
+    if (!pImpl->control_) {
+        return;
+    }
+    RingControl& control = *pImpl->control_;
+    control.closed.store(1);
+    futexWake(control.head);
+    futexWake(control.tail);
+}
+
+bool FrameRing::isClosed() const {
+    return !pImpl->control_ || pImpl->control_->closed.load() != 0;
+}
+
+const std::string& FrameRing::getLastError() const {
+    return pImpl->last_error_;
+}
+
+} // namespace service
+} // namespace ufra
@@ -0,0 +1,300 @@
+#include "ufra/gpu_memory_manager.h"
+#include "ufra/huge_page_allocator.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#ifdef CUDA_FOUND
+#include <cuda_runtime.h>
+#endif
+
+namespace ufra {
+
+namespace {
+
+constexpr size_t kAlignment = 64;
+
+// Reads a single integer from a sysfs/procfs file; 0 when absent or "max"
+size_t readSizeFile(const std::string& path) {
+    std::ifstream file(path);
+    std::string value;
+    if (!(file >> value) || value == "max") {
+        return 0;
+    }
+    try {
+        return static_cast<size_t>(std::stoull(value));
+    } catch (...) {
+        return 0;
+    }
+}
+
+size_t readMeminfoKB(const std::string& key) {
+    std::ifstream file("/proc/meminfo");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.compare(0, key.size(), key) == 0 && line.size() > key.size() && line[key.size()] == ':') {
+            std::istringstream iss(line.substr(key.size() + 1));
+            size_t kb = 0;
+            iss >> kb;
+            return kb * 1024;
+        }
+    }
+    return 0;
+}
+
+// Memory limit and usage of the enclosing cgroup (v2, then v1), if any
+void readCgroupMemory(size_t& limit, size_t& usage) {
+    limit = readSizeFile("/sys/fs/cgroup/memory.max");
+    usage = readSizeFile("/sys/fs/cgroup/memory.current");
+    if (limit == 0) {
+        limit = readSizeFile("/sys/fs/cgroup/memory/memory.limit_in_bytes");
+        usage = readSizeFile("/sys/fs/cgroup/memory/memory.usage_in_bytes");
+    }
+}
+
+size_t physicalMemory() {
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long page_size = sysconf(_SC_PAGE_SIZE);
+    return (pages > 0 && page_size > 0) ? static_cast<size_t>(pages) * page_size : 0;
+}
+
+} // namespace
+
+class GPUMemoryManager::Impl {
+public:
+    bool initialize(GPUBackend backend) {
+        backend_ = backend;
+#ifdef CUDA_FOUND
+        if (backend == GPUBackend::CUDA) {
+            if (cudaSetDevice(0) != cudaSuccess) {
+                std::cerr << "CUDA device unavailable, using CPU memory accounting" << std::endl;
+                backend_ = GPUBackend::CPU_FALLBACK;
+            }
+            return true;
+        }
+#endif
+        if (backend != GPUBackend::CPU_FALLBACK) {
+            std::cerr << "GPU memory queries unavailable for this backend, using CPU memory accounting"
+                      << std::endl;
+            backend_ = GPUBackend::CPU_FALLBACK;
+        }
+        return true;
+    }
+
+    // Totals for the CPU backend respect container limits, which is what the
+    // OOM killer on shared farm nodes enforces
+    void queryCPU(size_t& total, size_t& available) const {
+        size_t cgroup_limit = 0, cgroup_usage = 0;
+        readCgroupMemory(cgroup_limit, cgroup_usage);
+
+        total = physicalMemory();
+        available = readMeminfoKB("MemAvailable");
+        if (cgroup_limit > 0 && cgroup_limit < total) {
+            total = cgroup_limit;
+            size_t cgroup_free = cgroup_limit > cgroup_usage ? cgroup_limit - cgroup_usage : 0;
+            available = std::min(available, cgroup_free);
+        }
+    }
+
+    void query(size_t& total, size_t& available) const {
+#ifdef CUDA_FOUND
+        if (backend_ == GPUBackend::CUDA) {
+            size_t free_bytes = 0, total_bytes = 0;
+            if (cudaMemGetInfo(&free_bytes, &total_bytes) == cudaSuccess) {
+                total = total_bytes;
+                available = free_bytes;
+                return;
+            }
+        }
+#endif
+        queryCPU(total, available);
+    }
+
+    void* allocate(size_t bytes) {
+        if (bytes == 0) {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pool_enabled_) {
+            auto it = pool_.find(bytes);
+            if (it != pool_.end() && !it->second.empty()) {
+                void* ptr = it->second.back();
+                it->second.pop_back();
+                pooled_bytes_ -= bytes;
+                allocations_[ptr] = bytes;
+                return ptr;
+            }
+        }
+
+        void* ptr = nullptr;
+#ifdef CUDA_FOUND
+        if (backend_ == GPUBackend::CUDA) {
+            if (cudaMalloc(&ptr, bytes) != cudaSuccess) {
+                ptr = nullptr;
+            }
+        } else
+#endif
+        if (huge_pages_) {
+            ptr = HugePageArena::instance().allocate(bytes);
+        } else {
+            size_t rounded = (bytes + kAlignment - 1) / kAlignment * kAlignment;
+            ptr = std::aligned_alloc(kAlignment, rounded);
+        }
+
+        if (ptr) {
+            allocations_[ptr] = bytes;
+            if (huge_pages_) {
+                arena_allocations_.insert(ptr);
+            }
+        }
+        return ptr;
+    }
+
+    void deallocate(void* ptr) {
+        if (!ptr) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = allocations_.find(ptr);
+        if (it == allocations_.end()) {
+            return;
+        }
+        size_t bytes = it->second;
+        allocations_.erase(it);
+
+        if (pool_enabled_ && pooled_bytes_ + bytes <= pool_size_) {
+            pool_[bytes].push_back(ptr);
+            pooled_bytes_ += bytes;
+            return;
+        }
+        release(ptr);
+    }
+
+    void release(void* ptr) {
+#ifdef CUDA_FOUND
+        if (backend_ == GPUBackend::CUDA) {
+            cudaFree(ptr);
+            return;
+        }
+#endif
+        if (arena_allocations_.erase(ptr)) {
+            HugePageArena::instance().deallocate(ptr);
+            return;
+        }
+        std::free(ptr);
+    }
+
+    void trimPool() {
+        for (auto& entry : pool_) {
+            for (void* ptr : entry.second) {
+                release(ptr);
+            }
+        }
+        pool_.clear();
+        pooled_bytes_ = 0;
+    }
+
+    void cleanup() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        trimPool();
+        for (auto& entry : allocations_) {
+            release(entry.first);
+        }
+        allocations_.clear();
+    }
+
+    GPUBackend backend_ = GPUBackend::CPU_FALLBACK;
+    std::mutex mutex_;
+    std::map<void*, size_t> allocations_;
+    std::map<size_t, std::vector<void*>> pool_;
+    bool pool_enabled_ = false;
+    size_t pool_size_ = 256 * 1024 * 1024;
+    size_t pooled_bytes_ = 0;
+    bool huge_pages_ = true;
+    std::set<void*> arena_allocations_;   // Blocks owned by HugePageArena
+};
+
+GPUMemoryManager::GPUMemoryManager() : pImpl(std::make_unique<Impl>()) {}
+
+GPUMemoryManager::~GPUMemoryManager() {
+    pImpl->cleanup();
+}
+
+bool GPUMemoryManager::initialize(GPUBackend backend) {
+    return pImpl->initialize(backend);
+}
+
+void GPUMemoryManager::cleanup() {
+    pImpl->cleanup();
+}
+
+size_t GPUMemoryManager::getAvailableMemory() const {
+    size_t total = 0, available = 0;
+    pImpl->query(total, available);
+    return available;
+}
+
+size_t GPUMemoryManager::getTotalMemory() const {
+    size_t total = 0, available = 0;
+    pImpl->query(total, available);
+    return total;
+}
+
+float GPUMemoryManager::getMemoryUtilization() const {
+    size_t total = 0, available = 0;
+    pImpl->query(total, available);
+    if (total == 0) {
+        return 0.0f;
+    }
+    return static_cast<float>(total - std::min(total, available)) / static_cast<float>(total);
+}
+
+void* GPUMemoryManager::allocateMemory(size_t bytes) {
+    return pImpl->allocate(bytes);
+}
+
+void GPUMemoryManager::deallocateMemory(void* ptr) {
+    pImpl->deallocate(ptr);
+}
+
+void GPUMemoryManager::enableMemoryPool(bool enable) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->pool_enabled_ = enable;
+    if (!enable) {
+        pImpl->trimPool();
+    }
+}
+
+void GPUMemoryManager::setMemoryPoolSize(size_t size_bytes) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->pool_size_ = size_bytes;
+    if (pImpl->pooled_bytes_ > size_bytes) {
+        pImpl->trimPool();
+    }
+}
+
+void GPUMemoryManager::enableHugePages(bool enable) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->huge_pages_ = enable;
+}
+
+std::string GPUMemoryManager::getBackendInfo() const {
+    switch (pImpl->backend_) {
+        case GPUBackend::CUDA: return "CUDA";
+        case GPUBackend::METAL: return "Metal";
+        case GPUBackend::DIRECTML: return "DirectML";
+        case GPUBackend::CPU_FALLBACK: return "CPU";
+    }
+    return "Unknown";
+}
+
+} // namespace ufra
@@ -0,0 +1,229 @@
+#include "ufra/huge_page_allocator.h"
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace ufra {
+
+namespace {
+
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+size_t roundUp(size_t bytes, size_t alignment) {
+    return (bytes + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+class HugePageArena::Impl {
+public:
+    struct Block {
+        size_t size;          // Mapped size, a multiple of kHugePageSize
+        bool mapped;          // false: heap allocation below the threshold
+    };
+
+    void* mapBlock(size_t size, HugePageMode& mode_used) {
+        void* ptr = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+        if (mode_ == HugePageMode::EXPLICIT) {
+            ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+            mode_used = HugePageMode::EXPLICIT;
+        }
+#endif
+        if (ptr == MAP_FAILED) {
+            ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ptr == MAP_FAILED) {
+                return nullptr;
+            }
+            mode_used = HugePageMode::NONE;
+#ifdef MADV_HUGEPAGE
+            // Must precede the first touch so the kernel can back the range
+            // with huge pages at fault time
+            if (mode_ != HugePageMode::NONE && madvise(ptr, size, MADV_HUGEPAGE) == 0) {
+                mode_used = HugePageMode::TRANSPARENT;
+            }
+#endif
+            prefault(ptr, size, mode_used);
+        }
+        return ptr;
+    }
+
+    static void prefault(void* ptr, size_t size, HugePageMode mode) {
+        const size_t stride = (mode == HugePageMode::NONE) ? static_cast<size_t>(sysconf(_SC_PAGESIZE))
+                                                           : kHugePageSize;
+        volatile char* bytes = static_cast<volatile char*>(ptr);
+        for (size_t offset = 0; offset < size; offset += stride) {
+            bytes[offset] = 0;
+        }
+    }
+
+    void* allocate(size_t bytes) {
+        if (bytes == 0) {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (bytes < threshold_) {
+            void* ptr = std::aligned_alloc(64, roundUp(bytes, 64));
+            if (ptr) {
+                blocks_[ptr] = Block{bytes, false};
+            }
+            return ptr;
+        }
+
+        size_t size = roundUp(bytes, kHugePageSize);
+
+        // Reuse the smallest cached block that fits without wasting more
+        // than a quarter of it
+        auto it = free_.lower_bound(size);
+        if (it != free_.end() && it->first <= size + size / 4) {
+            void* ptr = it->second;
+            cached_bytes_ -= it->first;
+            free_.erase(it);
+            ++reuse_count_;
+            return ptr;
+        }
+
+        HugePageMode mode_used = HugePageMode::NONE;
+        void* ptr = mapBlock(size, mode_used);
+        if (!ptr) {
+            return nullptr;
+        }
+        last_mode_ = mode_used;
+        mapped_bytes_ += size;
+        blocks_[ptr] = Block{size, true};
+        return ptr;
+    }
+
+    void deallocate(void* ptr) {
+        if (!ptr) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = blocks_.find(ptr);
+        if (it == blocks_.end()) {
+            return;
+        }
+
+        if (!it->second.mapped) {
+            blocks_.erase(it);
+            std::free(ptr);
+            return;
+        }
+
+        size_t size = it->second.size;
+        if (cached_bytes_ + size <= max_cached_bytes_) {
+            free_.emplace(size, ptr);
+            cached_bytes_ += size;
+            return;
+        }
+        unmap(it);
+    }
+
+    void unmap(std::map<void*, Block>::iterator it) {
+        munmap(it->first, it->second.size);
+        mapped_bytes_ -= it->second.size;
+        blocks_.erase(it);
+    }
+
+    void trim() {
+        for (auto& entry : free_) {
+            auto it = blocks_.find(entry.second);
+            if (it != blocks_.end()) {
+                unmap(it);
+            }
+        }
+        free_.clear();
+        cached_bytes_ = 0;
+    }
+
+    mutable std::mutex mutex_;
+    HugePageMode mode_ = HugePageMode::EXPLICIT;
+    HugePageMode last_mode_ = HugePageMode::NONE;
+    size_t threshold_ = 1024 * 1024;
+    size_t max_cached_bytes_ = 1024ull * 1024 * 1024;
+
+    std::map<void*, Block> blocks_;          // Every live or cached block
+    std::multimap<size_t, void*> free_;      // Cached mapped blocks by size
+    size_t mapped_bytes_ = 0;
+    size_t cached_bytes_ = 0;
+    size_t reuse_count_ = 0;
+};
+
+HugePageArena::HugePageArena() : pImpl(std::make_unique<Impl>()) {}
+
+HugePageArena::~HugePageArena() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    for (auto& entry : pImpl->blocks_) {
+        if (entry.second.mapped) {
+            munmap(entry.first, entry.second.size);
+        } else {
+            std::free(entry.first);
+        }
+    }
+}
+
+HugePageArena& HugePageArena::instance() {
+    // Intentionally leaked: cv::Mat buffers may be released during static
+    // destruction, after a function-local static would already be gone
+    static HugePageArena* arena = new HugePageArena();
+    return *arena;
+}
+
+void* HugePageArena::allocate(size_t bytes) {
+    return pImpl->allocate(bytes);
+}
+
+void HugePageArena::deallocate(void* ptr) {
+    pImpl->deallocate(ptr);
+}
+
+void HugePageArena::setMode(HugePageMode mode) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->mode_ = mode;
+}
+
+void HugePageArena::setThreshold(size_t bytes) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->threshold_ = bytes;
+}
+
+void HugePageArena::setMaxCachedBytes(size_t bytes) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->max_cached_bytes_ = bytes;
+    if (pImpl->cached_bytes_ > bytes) {
+        pImpl->trim();
+    }
+}
+
+void HugePageArena::trim() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->trim();
+}
+
+HugePageMode HugePageArena::getLastMappingMode() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->last_mode_;
+}
+
+size_t HugePageArena::getMappedBytes() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->mapped_bytes_;
+}
+
+size_t HugePageArena::getCachedBytes() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->cached_bytes_;
+}
+
+size_t HugePageArena::getReuseCount() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->reuse_count_;
+}
+
+} // namespace ufra
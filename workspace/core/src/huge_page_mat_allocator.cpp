@@ -0,0 +1,66 @@
+#include "ufra/huge_page_allocator.h"
+#include <opencv2/core.hpp>
+
+namespace ufra {
+
+namespace {
+
+// Mirrors OpenCV's default StdMatAllocator, but takes buffers from the
+// huge-page arena so frame-sized matrices reuse pre-faulted memory.
+class HugePageMatAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data0, size_t* step,
+                           cv::AccessFlag /*flags*/, cv::UMatUsageFlags /*usage*/) const override {
+        size_t total = CV_ELEM_SIZE(type);
+        for (int i = dims - 1; i >= 0; i--) {
+            if (step) {
+                if (data0 && step[i] != CV_AUTOSTEP) {
+                    total = step[i];
+                } else {
+                    step[i] = total;
+                }
+            }
+            total *= sizes[i];
+        }
+
+        uchar* data = data0 ? static_cast<uchar*>(data0)
+                            : static_cast<uchar*>(HugePageArena::instance().allocate(total));
+        if (!data) {
+            CV_Error(cv::Error::StsNoMem, "HugePageArena allocation failed");
+        }
+
+        cv::UMatData* u = new cv::UMatData(this);
+        u->data = u->origdata = data;
+        u->size = total;
+        if (data0) {
+            u->flags |= cv::UMatData::USER_ALLOCATED;
+        }
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag /*flags*/, cv::UMatUsageFlags /*usage*/) const override {
+        return u != nullptr;
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        if (!u) {
+            return;
+        }
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+        if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+            HugePageArena::instance().deallocate(u->origdata);
+            u->origdata = nullptr;
+        }
+        delete u;
+    }
+};
+
+} // namespace
+
+cv::MatAllocator* getHugePageMatAllocator() {
+    static HugePageMatAllocator* allocator = new HugePageMatAllocator();
+    return allocator;
+}
+
+} // namespace ufra
@@ -0,0 +1,592 @@
+#include "ufra/image_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ufra {
+namespace kernels {
+
+namespace {
+
+// sum[i] = a[i] + b[i], widened to 16 bits
+void addRows(const uint8_t* a, const uint8_t* b, uint16_t* sum, int count) {
+    int i = 0;
+#if defined(__AVX2__)
+    for (; i + 16 <= count; i += 16) {
+        __m256i va = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m256i vb = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(sum + i), _mm256_add_epi16(va, vb));
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sum + i),
+                         _mm_add_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sum + i + 8),
+                         _mm_add_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero)));
+    }
+#endif
+    for (; i < count; ++i) {
+        sum[i] = static_cast<uint16_t>(a[i] + b[i]);
+    }
+}
+
+// Pairwise horizontal reduction of a vertically summed row. The channel count
+// is a template parameter so the inner loop fully unrolls for 1, 3 and 4.
+template <int C>
+void reducePairs(const uint16_t* sum, uint8_t* dst, int dst_width) {
+    for (int x = 0; x < dst_width; ++x) {
+        const uint16_t* s = sum + 2 * x * C;
+        for (int c = 0; c < C; ++c) {
+            dst[x * C + c] = static_cast<uint8_t>((s[c] + s[C + c] + 2) >> 2);
+        }
+    }
+}
+
+void reducePairs(const uint16_t* sum, uint8_t* dst, int dst_width, int channels) {
+    for (int x = 0; x < dst_width; ++x) {
+        const uint16_t* s = sum + 2 * x * channels;
+        for (int c = 0; c < channels; ++c) {
+            dst[x * channels + c] = static_cast<uint8_t>((s[c] + s[channels + c] + 2) >> 2);
+        }
+    }
+}
+
+} // namespace
+
+void downsample2x(const uint8_t* src, int src_width, int src_height, size_t src_stride,
+                  int channels, uint8_t* dst, size_t dst_stride) {
+    const int dst_width = src_width / 2;
+    const int dst_height = src_height / 2;
+    if (dst_width <= 0 || dst_height <= 0) {
+        return;
+    }
+
+    const int row_elems = dst_width * 2 * channels;
+    thread_local std::vector<uint16_t> row_sum;
+    if (row_sum.size() < static_cast<size_t>(row_elems)) {
+        row_sum.resize(row_elems);
+    }
+
+    for (int y = 0; y < dst_height; ++y) {
+        const uint8_t* r0 = src + static_cast<size_t>(2 * y) * src_stride;
+        addRows(r0, r0 + src_stride, row_sum.data(), row_elems);
+
+        uint8_t* out = dst + static_cast<size_t>(y) * dst_stride;
+        switch (channels) {
+            case 1: reducePairs<1>(row_sum.data(), out, dst_width); break;
+            case 3: reducePairs<3>(row_sum.data(), out, dst_width); break;
+            case 4: reducePairs<4>(row_sum.data(), out, dst_width); break;
+            default: reducePairs(row_sum.data(), out, dst_width, channels); break;
+        }
+    }
+}
+
+namespace {
+
+constexpr int kResizeBits = 11;
+constexpr int kResizeOne = 1 << kResizeBits;
+
+// Source index pair and fixed-point weight of the second sample for each
+// destination coordinate, with edge clamping
+void linearCoefficients(int src_size, int dst_size, std::vector<int>& offsets, std::vector<int>& weights) {
+    offsets.resize(dst_size);
+    weights.resize(dst_size);
+    const float scale = static_cast<float>(src_size) / dst_size;
+    for (int i = 0; i < dst_size; ++i) {
+        float pos = (i + 0.5f) * scale - 0.5f;
+        int index = static_cast<int>(std::floor(pos));
+        float frac = pos - index;
+        if (index < 0) {
+            index = 0;
+            frac = 0.0f;
+        }
+        if (index >= src_size - 1) {
+            index = src_size - 1;
+            frac = 0.0f;
+        }
+        offsets[i] = index;
+        weights[i] = static_cast<int>(frac * kResizeOne + 0.5f);
+    }
+}
+
+inline uint8_t saturate(float value) {
+    return static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, value + 0.5f)));
+}
+
+} // namespace
+
+void resizeBilinear(const uint8_t* src, int src_width, int src_height, size_t src_stride,
+                    int channels, uint8_t* dst, int dst_width, int dst_height, size_t dst_stride) {
+    if (src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0) {
+        return;
+    }
+
+    thread_local std::vector<int> x_offsets, x_weights, y_offsets, y_weights;
+    linearCoefficients(src_width, dst_width, x_offsets, x_weights);
+    linearCoefficients(src_height, dst_height, y_offsets, y_weights);
+
+    // Horizontal pass results for the two source rows feeding a dst row
+    thread_local std::vector<int> row0, row1;
+    const int row_elems = dst_width * channels;
+    row0.resize(row_elems);
+    row1.resize(row_elems);
+    int cached0 = -1, cached1 = -1;
+
+    auto horizontal = [&](int sy, std::vector<int>& row) {
+        const uint8_t* s = src + static_cast<size_t>(sy) * src_stride;
+        for (int x = 0; x < dst_width; ++x) {
+            const uint8_t* p0 = s + x_offsets[x] * channels;
+            const uint8_t* p1 = (x_offsets[x] + 1 < src_width) ? p0 + channels : p0;
+            const int w1 = x_weights[x], w0 = kResizeOne - w1;
+            for (int c = 0; c < channels; ++c) {
+                row[x * channels + c] = p0[c] * w0 + p1[c] * w1;
+            }
+        }
+    };
+
+    for (int y = 0; y < dst_height; ++y) {
+        const int sy0 = y_offsets[y];
+        const int sy1 = std::min(sy0 + 1, src_height - 1);
+        if (cached0 != sy0) {
+            if (cached1 == sy0) {
+                std::swap(row0, row1);
+                std::swap(cached0, cached1);
+            } else {
+                horizontal(sy0, row0);
+                cached0 = sy0;
+            }
+        }
+        if (cached1 != sy1) {
+            horizontal(sy1, row1);
+            cached1 = sy1;
+        }
+
+        const int w1 = y_weights[y], w0 = kResizeOne - w1;
+        uint8_t* out = dst + static_cast<size_t>(y) * dst_stride;
+        for (int i = 0; i < row_elems; ++i) {
+            int64_t value = static_cast<int64_t>(row0[i]) * w0 + static_cast<int64_t>(row1[i]) * w1;
+            out[i] = static_cast<uint8_t>((value + (1 << (2 * kResizeBits - 1))) >> (2 * kResizeBits));
+        }
+    }
+}
+
+void resizeNearest(const uint8_t* src, int src_width, int src_height, size_t src_stride,
+                   int channels, uint8_t* dst, int dst_width, int dst_height, size_t dst_stride) {
+    if (src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0) {
+        return;
+    }
+
+    thread_local std::vector<int> x_offsets;
+    x_offsets.resize(dst_width);
+    for (int x = 0; x < dst_width; ++x) {
+        x_offsets[x] = std::min(static_cast<int>(static_cast<int64_t>(x) * src_width / dst_width),
+                                src_width - 1) * channels;
+    }
+
+    for (int y = 0; y < dst_height; ++y) {
+        int sy = std::min(static_cast<int>(static_cast<int64_t>(y) * src_height / dst_height), src_height - 1);
+        const uint8_t* s = src + static_cast<size_t>(sy) * src_stride;
+        uint8_t* out = dst + static_cast<size_t>(y) * dst_stride;
+        for (int x = 0; x < dst_width; ++x) {
+            for (int c = 0; c < channels; ++c) {
+                out[x * channels + c] = s[x_offsets[x] + c];
+            }
+        }
+    }
+}
+
+void packPlanar(const uint8_t* src, int width, int height, size_t src_stride, int channels,
+                bool swap_rb, const float* mean, float scale, float* dst) {
+    const size_t plane = static_cast<size_t>(width) * height;
+    for (int c = 0; c < channels; ++c) {
+        int src_c = (swap_rb && channels >= 3 && c < 3) ? 2 - c : c;
+        float m = mean ? mean[c] : 0.0f;
+        float* out = dst + c * plane;
+        for (int y = 0; y < height; ++y) {
+            const uint8_t* s = src + static_cast<size_t>(y) * src_stride + src_c;
+            float* o = out + static_cast<size_t>(y) * width;
+            for (int x = 0; x < width; ++x) {
+                o[x] = (s[x * channels] - m) * scale;
+            }
+        }
+    }
+}
+
+void unpackPlanar(const float* src, int width, int height, int channels, bool swap_rb,
+                  float scale, float offset, uint8_t* dst, size_t dst_stride) {
+    const size_t plane = static_cast<size_t>(width) * height;
+    for (int c = 0; c < channels; ++c) {
+        int dst_c = (swap_rb && channels >= 3 && c < 3) ? 2 - c : c;
+        const float* in = src + c * plane;
+        for (int y = 0; y < height; ++y) {
+            const float* s = in + static_cast<size_t>(y) * width;
+            uint8_t* o = dst + static_cast<size_t>(y) * dst_stride + dst_c;
+            for (int x = 0; x < width; ++x) {
+                o[x * channels] = saturate(s[x] * scale + offset);
+            }
+        }
+    }
+}
+
+void blendWeighted(const uint8_t* a, size_t a_stride, const uint8_t* b, size_t b_stride,
+                   int width, int height, int channels, float weight,
+                   uint8_t* dst, size_t dst_stride) {
+    const int wa = static_cast<int>(std::min(1.0f, std::max(0.0f, weight)) * 256.0f + 0.5f);
+    const int wb = 256 - wa;
+    const int row_elems = width * channels;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* ra = a + static_cast<size_t>(y) * a_stride;
+        const uint8_t* rb = b + static_cast<size_t>(y) * b_stride;
+        uint8_t* out = dst + static_cast<size_t>(y) * dst_stride;
+        for (int i = 0; i < row_elems; ++i) {
+            out[i] = static_cast<uint8_t>((ra[i] * wa + rb[i] * wb + 128) >> 8);
+        }
+    }
+}
+
+void blendMasked(const uint8_t* src, size_t src_stride, const uint8_t* alpha, size_t alpha_stride,
+                 int width, int height, int channels, uint8_t* dst, size_t dst_stride) {
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* s = src + static_cast<size_t>(y) * src_stride;
+        const uint8_t* m = alpha + static_cast<size_t>(y) * alpha_stride;
+        uint8_t* d = dst + static_cast<size_t>(y) * dst_stride;
+        for (int x = 0; x < width; ++x) {
+            const int a = m[x];
+            if (a == 0) {
+                continue;
+            }
+            for (int c = 0; c < channels; ++c) {
+                int value = s[x * channels + c] * a + d[x * channels + c] * (255 - a);
+                // Exact rounding of value / 255
+                d[x * channels + c] = static_cast<uint8_t>((value + 128 + ((value + 128) >> 8)) >> 8);
+            }
+        }
+    }
+}
+
+namespace {
+
+// Single-channel float image for the flow pyramid
+struct Plane {
+    int width = 0;
+    int height = 0;
+    std::vector<float> data;
+
+    float at(int x, int y) const { return data[static_cast<size_t>(y) * width + x]; }
+};
+
+Plane toPlane(const uint8_t* src, size_t stride, int width, int height) {
+    Plane plane{width, height, std::vector<float>(static_cast<size_t>(width) * height)};
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = src + static_cast<size_t>(y) * stride;
+        std::copy(row, row + width, plane.data.begin() + static_cast<size_t>(y) * width);
+    }
+    return plane;
+}
+
+Plane halve(const Plane& src) {
+    Plane dst{src.width / 2, src.height / 2, {}};
+    dst.data.resize(static_cast<size_t>(dst.width) * dst.height);
+    for (int y = 0; y < dst.height; ++y) {
+        for (int x = 0; x < dst.width; ++x) {
+            dst.data[static_cast<size_t>(y) * dst.width + x] =
+                0.25f * (src.at(2 * x, 2 * y) + src.at(2 * x + 1, 2 * y) +
+                         src.at(2 * x, 2 * y + 1) + src.at(2 * x + 1, 2 * y + 1));
+        }
+    }
+    return dst;
+}
+
+template <typename T>
+float sampleBilinear(const T* src, size_t stride, int width, int height, int channels, int c, float x, float y) {
+    x = std::min(std::max(x, 0.0f), static_cast<float>(width - 1));
+    y = std::min(std::max(y, 0.0f), static_cast<float>(height - 1));
+    const int x0 = static_cast<int>(x);
+    const int y0 = static_cast<int>(y);
+    const int x1 = std::min(x0 + 1, width - 1);
+    const int y1 = std::min(y0 + 1, height - 1);
+    const float fx = x - x0;
+    const float fy = y - y0;
+    const T* r0 = src + static_cast<size_t>(y0) * stride;
+    const T* r1 = src + static_cast<size_t>(y1) * stride;
+    const float top = r0[x0 * channels + c] + (r0[x1 * channels + c] - static_cast<float>(r0[x0 * channels + c])) * fx;
+    const float bottom = r1[x0 * channels + c] + (r1[x1 * channels + c] - static_cast<float>(r1[x0 * channels + c])) * fx;
+    return top + (bottom - top) * fy;
+}
+
+// (width + 1) x (height + 1) summed-area table of one product per pixel
+void integrate(const std::vector<float>& values, int width, int height, std::vector<double>& table) {
+    table.assign(static_cast<size_t>(width + 1) * (height + 1), 0.0);
+    for (int y = 0; y < height; ++y) {
+        double row = 0.0;
+        for (int x = 0; x < width; ++x) {
+            row += values[static_cast<size_t>(y) * width + x];
+            table[static_cast<size_t>(y + 1) * (width + 1) + x + 1] = table[static_cast<size_t>(y) * (width + 1) + x + 1] + row;
+        }
+    }
+}
+
+double boxSum(const std::vector<double>& table, int width, int x0, int y0, int x1, int y1) {
+    const size_t w = static_cast<size_t>(width + 1);
+    return table[y1 * w + x1] - table[y0 * w + x1] - table[y1 * w + x0] + table[y0 * w + x0];
+}
+
+// Lucas-Kanade refinement of `flow` on one pyramid level
+void refineFlow(const Plane& reference, const Plane& target, int radius, int iterations, std::vector<float>& flow) {
+    const int width = reference.width;
+    const int height = reference.height;
+    const size_t count = static_cast<size_t>(width) * height;
+    std::vector<float> ix(count), iy(count), products(count);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const size_t i = static_cast<size_t>(y) * width + x;
+            ix[i] = 0.5f * (reference.at(std::min(x + 1, width - 1), y) - reference.at(std::max(x - 1, 0), y));
+            iy[i] = 0.5f * (reference.at(x, std::min(y + 1, height - 1)) - reference.at(x, std::max(y - 1, 0)));
+        }
+    }
+
+    // The structure tensor depends on the reference only
+    std::vector<double> sxx, sxy, syy, sxt, syt;
+    for (size_t i = 0; i < count; ++i) products[i] = ix[i] * ix[i];
+    integrate(products, width, height, sxx);
+    for (size_t i = 0; i < count; ++i) products[i] = ix[i] * iy[i];
+    integrate(products, width, height, sxy);
+    for (size_t i = 0; i < count; ++i) products[i] = iy[i] * iy[i];
+    integrate(products, width, height, syy);
+
+    std::vector<float> it(count);
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const size_t i = static_cast<size_t>(y) * width + x;
+                it[i] = sampleBilinear(target.data.data(), width, width, height, 1, 0,
+                                       x + flow[2 * i], y + flow[2 * i + 1]) - reference.data[i];
+            }
+        }
+        for (size_t i = 0; i < count; ++i) products[i] = ix[i] * it[i];
+        integrate(products, width, height, sxt);
+        for (size_t i = 0; i < count; ++i) products[i] = iy[i] * it[i];
+        integrate(products, width, height, syt);
+
+        for (int y = 0; y < height; ++y) {
+            const int y0 = std::max(0, y - radius);
+            const int y1 = std::min(height, y + radius + 1);
+            for (int x = 0; x < width; ++x) {
+                const int x0 = std::max(0, x - radius);
+                const int x1 = std::min(width, x + radius + 1);
+                const double a = boxSum(sxx, width, x0, y0, x1, y1);
+                const double b = boxSum(sxy, width, x0, y0, x1, y1);
+                const double d = boxSum(syy, width, x0, y0, x1, y1);
+                const double det = a * d - b * b;
+                if (det < 1e-3 * (a + d + 1.0)) {
+                    continue;   // Flat or edge-only window: the aperture problem
+                }
+                const double ex = boxSum(sxt, width, x0, y0, x1, y1);
+                const double ey = boxSum(syt, width, x0, y0, x1, y1);
+                const size_t i = static_cast<size_t>(y) * width + x;
+                flow[2 * i] -= static_cast<float>((d * ex - b * ey) / det);
+                flow[2 * i + 1] -= static_cast<float>((a * ey - b * ex) / det);
+            }
+        }
+    }
+}
+
+template <typename T>
+void warpPlanes(const T* src, size_t src_stride, int width, int height, int channels,
+                const float* flow, T* dst, size_t dst_stride) {
+    for (int y = 0; y < height; ++y) {
+        T* out = dst + static_cast<size_t>(y) * dst_stride;
+        const float* f = flow + static_cast<size_t>(y) * width * 2;
+        for (int x = 0; x < width; ++x) {
+            for (int c = 0; c < channels; ++c) {
+                const float value = sampleBilinear(src, src_stride, width, height, channels, c,
+                                                   x + f[2 * x], y + f[2 * x + 1]);
+                out[x * channels + c] = std::is_same<T, uint8_t>::value ? static_cast<T>(saturate(value))
+                                                                        : static_cast<T>(value);
+            }
+        }
+    }
+}
+
+} // namespace
+
+void computeFlowLK(const uint8_t* reference, size_t reference_stride, const uint8_t* target, size_t target_stride,
+                   int width, int height, int levels, int radius, int iterations, float* flow) {
+    std::vector<Plane> references{toPlane(reference, reference_stride, width, height)};
+    std::vector<Plane> targets{toPlane(target, target_stride, width, height)};
+    while (static_cast<int>(references.size()) < levels &&
+           std::min(references.back().width, references.back().height) / 2 > 2 * radius + 1) {
+        references.push_back(halve(references.back()));
+        targets.push_back(halve(targets.back()));
+    }
+
+    std::vector<float> level_flow(static_cast<size_t>(references.back().width) * references.back().height * 2, 0.0f);
+    for (int level = static_cast<int>(references.size()) - 1; level >= 0; --level) {
+        const Plane& ref = references[level];
+        if (level_flow.size() != static_cast<size_t>(ref.width) * ref.height * 2) {
+            // Upsample the coarser estimate: twice the size, twice the motion
+            const Plane& coarse = references[level + 1];
+            std::vector<float> upsampled(static_cast<size_t>(ref.width) * ref.height * 2);
+            for (int y = 0; y < ref.height; ++y) {
+                for (int x = 0; x < ref.width; ++x) {
+                    const size_t i = static_cast<size_t>(y) * ref.width + x;
+                    for (int c = 0; c < 2; ++c) {
+                        upsampled[2 * i + c] = 2.0f * sampleBilinear(level_flow.data(), coarse.width * 2, coarse.width,
+                                                                     coarse.height, 2, c, (x - 0.5f) * 0.5f,
+                                                                     (y - 0.5f) * 0.5f);
+                    }
+                }
+            }
+            level_flow.swap(upsampled);
+        }
+        refineFlow(ref, targets[level], radius, iterations, level_flow);
+    }
+    std::copy(level_flow.begin(), level_flow.end(), flow);
+}
+
+void warpByFlow(const uint8_t* src, size_t src_stride, int width, int height, int channels,
+                const float* flow, uint8_t* dst, size_t dst_stride) {
+    warpPlanes(src, src_stride, width, height, channels, flow, dst, dst_stride);
+}
+
+void warpByFlow(const float* src, size_t src_stride, int width, int height, int channels,
+                const float* flow, float* dst, size_t dst_stride) {
+    warpPlanes(src, src_stride, width, height, channels, flow, dst, dst_stride);
+}
+
+float meanAbsDiff(const uint8_t* a, size_t a_stride, const uint8_t* b, size_t b_stride,
+                  int width, int height, int channels) {
+    const int row_elems = width * channels;
+    if (row_elems <= 0 || height <= 0) {
+        return 0.0f;
+    }
+    uint64_t total = 0;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* ra = a + static_cast<size_t>(y) * a_stride;
+        const uint8_t* rb = b + static_cast<size_t>(y) * b_stride;
+        int i = 0;
+#if defined(__SSE2__) || defined(__AVX2__)
+        for (; i + 16 <= row_elems; i += 16) {
+            __m128i sad = _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ra + i)),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(rb + i)));
+            total += static_cast<uint64_t>(_mm_cvtsi128_si32(sad)) +
+                     static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_srli_si128(sad, 8)));
+        }
+#endif
+        for (; i < row_elems; ++i) {
+            total += static_cast<uint64_t>(std::abs(ra[i] - rb[i]));
+        }
+    }
+    return static_cast<float>(static_cast<double>(total) / (static_cast<double>(row_elems) * height));
+}
+
+namespace {
+
+uint64_t sumBytes(const uint8_t* data, int count) {
+    uint64_t total = 0;
+    int i = 0;
+#if defined(__AVX2__)
+    const __m256i zero256 = _mm256_setzero_si256();
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 32 <= count; i += 32) {
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)),
+                                                    zero256));
+    }
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), zero));
+    }
+    total = static_cast<uint64_t>(_mm_cvtsi128_si32(acc)) +
+            static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#endif
+    for (; i < count; ++i) {
+        total += data[i];
+    }
+    return total;
+}
+
+} // namespace
+
+void cellMeans(const uint8_t* src, int width, int height, size_t stride, int channels,
+               int grid_width, int grid_height, int row_step, uint8_t* means) {
+    const size_t cells = static_cast<size_t>(grid_width) * grid_height;
+    std::vector<uint64_t> sums(cells, 0);
+    std::vector<uint32_t> counts(cells, 0);
+    std::vector<int> bounds(grid_width + 1);
+    for (int cx = 0; cx <= grid_width; ++cx) {
+        bounds[cx] = static_cast<int>(static_cast<int64_t>(cx) * width / grid_width) * channels;
+    }
+    row_step = std::max(1, row_step);
+    for (int y = row_step / 2; y < height; y += row_step) {
+        const uint8_t* row = src + static_cast<size_t>(y) * stride;
+        const int cy = static_cast<int>(static_cast<int64_t>(y) * grid_height / height);
+        for (int cx = 0; cx < grid_width; ++cx) {
+            const size_t cell = static_cast<size_t>(cy) * grid_width + cx;
+            sums[cell] += sumBytes(row + bounds[cx], bounds[cx + 1] - bounds[cx]);
+            counts[cell] += static_cast<uint32_t>(bounds[cx + 1] - bounds[cx]);
+        }
+    }
+    for (size_t cell = 0; cell < cells; ++cell) {
+        means[cell] = counts[cell] ? static_cast<uint8_t>((sums[cell] + counts[cell] / 2) / counts[cell]) : 0;
+    }
+}
+
+uint64_t contentHash(const uint8_t* src, size_t row_bytes, int height, size_t stride, uint64_t seed) {
+    // xxHash64-style: four independent lanes over 8-byte words, folded per
+    // row so the result does not depend on the stride
+    constexpr uint64_t kPrime1 = 11400714785074694791ULL;
+    constexpr uint64_t kPrime2 = 14029467366897019727ULL;
+    constexpr uint64_t kPrime3 = 1609587929392839161ULL;
+    auto rotl = [](uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); };
+    auto round = [&](uint64_t acc, uint64_t word) { return rotl(acc + word * kPrime2, 31) * kPrime1; };
+
+    uint64_t hash = round(seed, kPrime3) ^ (row_bytes * kPrime1) ^
+                    (static_cast<uint64_t>(std::max(0, height)) * kPrime2);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = src + static_cast<size_t>(y) * stride;
+        uint64_t lanes[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+        size_t i = 0;
+        for (; i + 32 <= row_bytes; i += 32) {
+            for (int lane = 0; lane < 4; ++lane) {
+                uint64_t word;
+                std::memcpy(&word, row + i + lane * 8, sizeof(word));
+                lanes[lane] = round(lanes[lane], word);
+            }
+        }
+        uint64_t row_hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+        for (; i + 8 <= row_bytes; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, row + i, sizeof(word));
+            row_hash = rotl(row_hash ^ round(0, word), 27) * kPrime1 + kPrime3;
+        }
+        for (; i < row_bytes; ++i) {
+            row_hash = rotl(row_hash ^ (row[i] * kPrime3), 11) * kPrime1;
+        }
+        hash = round(hash, row_hash);
+    }
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    return hash ^ (hash >> 32);
+}
+
+} // namespace kernels
+} // namespace ufra
@@ -0,0 +1,382 @@
+#include "ufra/inference_session.h"
+#include "ufra/stub_network.h"
+#include <opencv2/dnn.hpp>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+namespace ufra {
+
+namespace {
+
+void configureNet(cv::dnn::Net& net, GPUBackend backend, bool deterministic) {
+    if (backend == GPUBackend::CUDA) {
+        net.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
+        net.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
+    } else {
+        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    }
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 7)
+    if (deterministic) {
+        net.enableWinograd(false);   // Winograd tiles are chosen by shape and SIMD width
+    }
+#endif
+}
+
+// Process-wide registry so that several components or engines loading the
+// same file reuse a single weight copy.
+std::mutex g_registry_mutex;
+std::map<std::tuple<std::string, GPUBackend, bool>, std::weak_ptr<SharedModel>> g_registry;
+
+std::atomic<size_t> g_activation_bytes{0};
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// InferenceSession
+
+class InferenceSession::Impl {
+public:
+    // Re-estimates activation memory whenever the primary input shape changes
+    void trackInputShape(const cv::Mat& blob) {
+        cv::dnn::MatShape shape(blob.size.p, blob.size.p + blob.dims);
+        if (shape == input_shape_) {
+            return;
+        }
+        input_shape_ = shape;
+
+        size_t weights = 0, blobs = 0;
+        try {
+            net_.getMemoryConsumption(shape, weights, blobs);
+        } catch (const cv::Exception&) {
+            blobs = 0;
+        }
+        g_activation_bytes -= activation_bytes_;
+        activation_bytes_ = blobs;
+        g_activation_bytes += activation_bytes_;
+    }
+
+    ~Impl() {
+        g_activation_bytes -= activation_bytes_;
+    }
+
+    cv::dnn::Net net_;
+    std::vector<cv::String> output_names_;
+    std::shared_ptr<const StubNetwork> stub_;        // Set for "stub:" models instead of net_
+    std::map<std::string, cv::Mat> stub_inputs_;
+    cv::dnn::MatShape input_shape_;
+    size_t activation_bytes_ = 0;
+};
+
+InferenceSession::InferenceSession() : pImpl(std::make_unique<Impl>()) {}
+InferenceSession::~InferenceSession() = default;
+
+void InferenceSession::setInput(const cv::Mat& blob, const std::string& name) {
+    if (pImpl->stub_) {
+        pImpl->stub_inputs_[name] = blob;
+        return;
+    }
+    pImpl->net_.setInput(blob, name);
+    if (name.empty() || pImpl->input_shape_.empty()) {
+        pImpl->trackInputShape(blob);
+    }
+}
+
+cv::Mat InferenceSession::forward() {
+    if (pImpl->stub_) {
+        return pImpl->stub_->forward(pImpl->stub_inputs_);
+    }
+    return pImpl->net_.forward();
+}
+
+void InferenceSession::forward(std::vector<cv::Mat>& outputs) {
+    if (pImpl->stub_) {
+        outputs.assign(1, pImpl->stub_->forward(pImpl->stub_inputs_));
+        return;
+    }
+    pImpl->net_.forward(outputs, pImpl->output_names_);
+}
+
+cv::Mat blobItem(const cv::Mat& blob, int index) {
+    CV_Assert(blob.dims == 4 && blob.isContinuous() && index >= 0 && index < blob.size[0]);
+    const int shape[4] = {1, blob.size[1], blob.size[2], blob.size[3]};
+    return cv::Mat(4, shape, blob.type(), const_cast<uchar*>(blob.ptr(index)));
+}
+
+// ---------------------------------------------------------------------------
+// SharedModel
+
+class SharedModel::Impl {
+public:
+    std::string model_path_;
+    GPUBackend backend_ = GPUBackend::CPU_FALLBACK;
+    bool deterministic_ = false;
+
+    // Canonical weights. This net is never run, so its layer blobs stay
+    // pristine and can be handed to every session by reference.
+    cv::dnn::Net prototype_;
+    size_t weight_bytes_ = 0;
+
+    std::shared_ptr<const StubNetwork> stub_;   // No weights; see stub_network.h
+};
+
+SharedModel::SharedModel() : pImpl(std::make_unique<Impl>()) {}
+SharedModel::~SharedModel() = default;
+
+std::shared_ptr<SharedModel> SharedModel::load(const std::string& model_path, GPUBackend backend,
+                                               bool deterministic) {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    if (deterministic) {
+        backend = GPUBackend::CPU_FALLBACK;   // GPU kernels are not reproducible across devices
+    }
+
+    auto key = std::make_tuple(model_path, backend, deterministic);
+    auto it = g_registry.find(key);
+    if (it != g_registry.end()) {
+        if (auto existing = it->second.lock()) {
+            return existing;
+        }
+    }
+
+    try {
+        std::shared_ptr<SharedModel> model(new SharedModel());
+        model->pImpl->model_path_ = model_path;
+        model->pImpl->backend_ = backend;
+        model->pImpl->deterministic_ = deterministic;
+        if (isStubModelPath(model_path)) {
+            model->pImpl->stub_ = StubNetwork::create(model_path);
+            if (!model->pImpl->stub_) {
+                std::cerr << "Unknown stub model: " << model_path << std::endl;
+                return nullptr;
+            }
+            g_registry[key] = model;
+            return model;
+        }
+        model->pImpl->prototype_ = cv::dnn::readNet(model_path);
+        if (model->pImpl->prototype_.empty()) {
+            return nullptr;
+        }
+
+        for (const auto& layer_name : model->pImpl->prototype_.getLayerNames()) {
+            int layer_id = model->pImpl->prototype_.getLayerId(layer_name);
+            for (const auto& blob : model->pImpl->prototype_.getLayer(layer_id)->blobs) {
+                model->pImpl->weight_bytes_ += blob.total() * blob.elemSize();
+            }
+        }
+
+        g_registry[key] = model;
+        return model;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error loading shared model " << model_path << ": " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+std::unique_ptr<InferenceSession> SharedModel::createSession() const {
+    std::unique_ptr<InferenceSession> session(new InferenceSession());
+    if (pImpl->stub_) {
+        session->pImpl->stub_ = pImpl->stub_;
+        return session;
+    }
+    cv::dnn::Net& net = session->pImpl->net_;
+
+    // Re-import the graph, then point every layer at the prototype's blobs.
+    // cv::Mat is reference counted, so the freshly imported copies are freed
+    // here and the session keeps only its own activations.
+    net = cv::dnn::readNet(pImpl->model_path_);
+    for (const auto& layer_name : pImpl->prototype_.getLayerNames()) {
+        int layer_id = pImpl->prototype_.getLayerId(layer_name);
+        const auto& blobs = pImpl->prototype_.getLayer(layer_id)->blobs;
+        for (size_t i = 0; i < blobs.size(); ++i) {
+            net.setParam(layer_id, static_cast<int>(i), blobs[i]);
+        }
+    }
+
+    configureNet(net, pImpl->backend_, pImpl->deterministic_);
+    session->pImpl->output_names_ = net.getUnconnectedOutLayersNames();
+    return session;
+}
+
+const std::string& SharedModel::getModelPath() const {
+    return pImpl->model_path_;
+}
+
+GPUBackend SharedModel::getBackend() const {
+    return pImpl->backend_;
+}
+
+bool SharedModel::isDeterministic() const {
+    return pImpl->deterministic_;
+}
+
+size_t SharedModel::getWeightBytes() const {
+    return pImpl->weight_bytes_;
+}
+
+// ---------------------------------------------------------------------------
+// SessionPool
+
+namespace {
+
+struct PooledSession {
+    std::unique_ptr<InferenceSession> session;
+    std::mutex mutex;
+};
+
+// Sessions of one pool. Shared with the threads that hold thread-keyed
+// sessions, so a thread exiting after its pool is destroyed finds it gone.
+struct PoolSessions {
+    std::shared_ptr<const SharedModel> model;
+    std::mutex mutex;
+    std::map<uint64_t, std::shared_ptr<PooledSession>> thread_sessions;
+    std::map<uint64_t, std::shared_ptr<PooledSession>> request_sessions;
+    std::vector<std::shared_ptr<PooledSession>> idle;
+
+    // Moves a key's session to the idle list, for the next thread or request
+    void retire(std::map<uint64_t, std::shared_ptr<PooledSession>>& sessions, uint64_t key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = sessions.find(key);
+        if (it != sessions.end()) {
+            idle.push_back(it->second);
+            sessions.erase(it);
+        }
+    }
+};
+
+// Returns a thread's sessions to their pools when the thread exits, so pools
+// used from short-lived threads stay at one session per live thread
+struct ThreadSessionGuard {
+    std::vector<std::pair<std::weak_ptr<PoolSessions>, uint64_t>> pools;
+
+    ~ThreadSessionGuard() {
+        for (auto& pool : pools) {
+            if (auto sessions = pool.first.lock()) {
+                sessions->retire(sessions->thread_sessions, pool.second);
+            }
+        }
+    }
+};
+
+thread_local ThreadSessionGuard t_session_guard;
+
+} // namespace
+
+struct SessionPool::Lease::State {
+    std::shared_ptr<PooledSession> entry;
+    std::unique_lock<std::mutex> lock;
+};
+
+SessionPool::Lease::Lease(std::unique_ptr<State> state) : state_(std::move(state)) {}
+SessionPool::Lease::Lease(Lease&& other) noexcept = default;
+SessionPool::Lease::~Lease() = default;
+
+InferenceSession* SessionPool::Lease::operator->() const {
+    return state_->entry->session.get();
+}
+
+InferenceSession& SessionPool::Lease::operator*() const {
+    return *state_->entry->session;
+}
+
+class SessionPool::Impl {
+public:
+    // `created` is set when the key had no session yet
+    std::shared_ptr<PooledSession> entryFor(std::map<uint64_t, std::shared_ptr<PooledSession>>& sessions,
+                                            uint64_t key, bool* created = nullptr) {
+        std::lock_guard<std::mutex> lock(sessions_->mutex);
+        auto it = sessions.find(key);
+        if (it != sessions.end()) {
+            return it->second;
+        }
+
+        std::shared_ptr<PooledSession> entry;
+        if (!sessions_->idle.empty()) {
+            entry = sessions_->idle.back();
+            sessions_->idle.pop_back();
+        } else {
+            entry = std::make_shared<PooledSession>();
+            entry->session = sessions_->model->createSession();
+        }
+        sessions[key] = entry;
+        if (created) {
+            *created = true;
+        }
+        return entry;
+    }
+
+    std::shared_ptr<PoolSessions> sessions_ = std::make_shared<PoolSessions>();
+};
+
+SessionPool::SessionPool(std::shared_ptr<const SharedModel> model) : pImpl(std::make_unique<Impl>()) {
+    pImpl->sessions_->model = std::move(model);
+}
+
+SessionPool::~SessionPool() = default;
+
+SessionPool::Lease SessionPool::acquire() {
+    uint64_t key = std::hash<std::thread::id>()(std::this_thread::get_id());
+    auto state = std::make_unique<Lease::State>();
+    bool created = false;
+    state->entry = pImpl->entryFor(pImpl->sessions_->thread_sessions, key, &created);
+    if (created) {
+        auto& pools = t_session_guard.pools;
+        pools.erase(std::remove_if(pools.begin(), pools.end(), [](const auto& pool) { return pool.first.expired(); }),
+                    pools.end());
+        const bool guarded = std::any_of(pools.begin(), pools.end(), [this](const auto& pool) {
+            return pool.first.lock() == pImpl->sessions_;
+        });
+        if (!guarded) {   // After clear(), the thread is already registered
+            pools.emplace_back(pImpl->sessions_, key);
+        }
+    }
+    state->lock = std::unique_lock<std::mutex>(state->entry->mutex);
+    return Lease(std::move(state));
+}
+
+SessionPool::Lease SessionPool::acquire(uint64_t request_key) {
+    auto state = std::make_unique<Lease::State>();
+    state->entry = pImpl->entryFor(pImpl->sessions_->request_sessions, request_key);
+    state->lock = std::unique_lock<std::mutex>(state->entry->mutex);
+    return Lease(std::move(state));
+}
+
+void SessionPool::release(uint64_t request_key) {
+    pImpl->sessions_->retire(pImpl->sessions_->request_sessions, request_key);
+}
+
+size_t SessionPool::getSessionCount() const {
+    std::lock_guard<std::mutex> lock(pImpl->sessions_->mutex);
+    return pImpl->sessions_->thread_sessions.size() + pImpl->sessions_->request_sessions.size() +
+           pImpl->sessions_->idle.size();
+}
+
+void SessionPool::clear() {
+    std::lock_guard<std::mutex> lock(pImpl->sessions_->mutex);
+    pImpl->sessions_->thread_sessions.clear();
+    pImpl->sessions_->request_sessions.clear();
+    pImpl->sessions_->idle.clear();
+}
+
+size_t getLoadedModelBytes() {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    size_t bytes = 0;
+    for (const auto& entry : g_registry) {
+        if (auto model = entry.second.lock()) {
+            bytes += model->getWeightBytes();
+        }
+    }
+    return bytes;
+}
+
+size_t getSessionActivationBytes() {
+    return g_activation_bytes.load();
+}
+
+} // namespace ufra
@@ -0,0 +1,227 @@
+#include "ufra/keyframe_propagator.h"
+#include "ufra/image_kernels.h"
+#include "ufra/optical_flow.h"
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace ufra {
+
+namespace {
+
+constexpr int kFlowResolution = 128;   // Longest side alignment is estimated at
+
+cv::Mat smallGray(const ImageData& image, const cv::Size& size) {
+    cv::Mat gray;
+    if (image.channels() == 3) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    } else if (image.channels() == 4) {
+        cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY);
+    } else {
+        gray = image;
+    }
+    if (gray.size() != size) {
+        cv::resize(gray, gray, size, 0, 0, cv::INTER_AREA);
+    }
+    return gray.isContinuous() ? gray : gray.clone();
+}
+
+} // namespace
+
+class KeyframePropagator::Keyframe {
+public:
+    int track_id = 0;
+    int frame_number = 0;
+    cv::Mat crop;
+    std::vector<cv::Point2f> landmarks;
+    cv::Mat residual;   // generated - crop (CV_32FC3), set once generated
+};
+
+class KeyframePropagator::Impl {
+public:
+    Plan plan(int track_id, const ImageData& crop, const std::vector<cv::Point2f>& landmarks, int frame_number) {
+        std::shared_ptr<Keyframe> key;
+        KeyframePolicy policy;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = keyframes_.find(track_id);
+            if (it != keyframes_.end()) {
+                key = it->second;
+            }
+            policy = policy_;
+        }
+
+        Plan plan;
+        const bool candidate = key && key->crop.size() == crop.size() && key->crop.type() == crop.type() &&
+                               frame_number > key->frame_number &&
+                               frame_number - key->frame_number < std::max(1, policy.max_interval);
+        if (candidate) {
+            align(*key, crop, landmarks, plan);
+            plan.keyframe = plan.motion > policy.max_motion || plan.change > policy.max_change;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (plan.keyframe) {
+            key = std::make_shared<Keyframe>();
+            key->track_id = track_id;
+            key->frame_number = frame_number;
+            key->crop = crop.clone();
+            key->landmarks = landmarks;
+            keyframes_[track_id] = key;
+            ++keyframe_count_;
+        } else {
+            ++propagated_count_;
+        }
+        plan.key = key;
+        return plan;
+    }
+
+    // Affine from landmarks, then flow between the crop and the pre-aligned
+    // keyframe crop at low resolution
+    void align(const Keyframe& key, const ImageData& crop, const std::vector<cv::Point2f>& landmarks,
+               Plan& plan) const {
+        const cv::Size size = crop.size();
+        plan.affine = cv::Mat::eye(2, 3, CV_64F);
+        if (landmarks.size() >= 3 && landmarks.size() == key.landmarks.size()) {
+            cv::Mat fitted = cv::estimateAffinePartial2D(landmarks, key.landmarks);
+            if (!fitted.empty()) {
+                plan.affine = fitted;
+            }
+        }
+        cv::Mat aligned_key;
+        cv::warpAffine(key.crop, aligned_key, plan.affine, size, cv::INTER_LINEAR | cv::WARP_INVERSE_MAP,
+                       cv::BORDER_REPLICATE);
+
+        const double scale = std::min(1.0, static_cast<double>(kFlowResolution) / std::max(size.width, size.height));
+        const cv::Size flow_size(std::max(1, static_cast<int>(size.width * scale)),
+                                 std::max(1, static_cast<int>(size.height * scale)));
+        cv::Mat current_small = smallGray(crop, flow_size);
+        cv::Mat key_small = smallGray(aligned_key, flow_size);
+        cv::Mat flow = flow_.computeFlow(current_small, key_small);
+        cv::Mat warped_small = flow_.warpImage(key_small, flow);
+        plan.change = kernels::meanAbsDiff(current_small.data, current_small.step[0], warped_small.data,
+                                           warped_small.step[0], flow_size.width, flow_size.height, 1) / 255.0f;
+
+        // Landmark displacement plus remaining flow, relative to crop width
+        double affine_motion = 0.0;
+        for (const cv::Point2f& point : landmarks) {
+            const double x = plan.affine.at<double>(0, 0) * point.x + plan.affine.at<double>(0, 1) * point.y +
+                             plan.affine.at<double>(0, 2);
+            const double y = plan.affine.at<double>(1, 0) * point.x + plan.affine.at<double>(1, 1) * point.y +
+                             plan.affine.at<double>(1, 2);
+            affine_motion += std::hypot(x - point.x, y - point.y);
+        }
+        if (!landmarks.empty()) {
+            affine_motion /= landmarks.size();
+        }
+        double flow_motion = 0.0;
+        for (auto it = flow.begin<cv::Vec2f>(); it != flow.end<cv::Vec2f>(); ++it) {
+            flow_motion += std::hypot((*it)[0], (*it)[1]);
+        }
+        flow_motion /= std::max<size_t>(1, flow.total()) * scale;
+        plan.motion = static_cast<float>((affine_motion + flow_motion) / size.width);
+
+        if (flow_size != size) {
+            cv::resize(flow, flow, size, 0, 0, cv::INTER_LINEAR);
+            flow *= 1.0 / scale;
+        }
+        plan.flow = flow;
+    }
+
+    ImageData propagate(const Plan& plan, const cv::Mat& key_residual, const ImageData& crop) const {
+        if (key_residual.empty() || key_residual.size() != crop.size() ||
+            key_residual.channels() != crop.channels() || plan.flow.empty()) {
+            return crop.clone();   // Keyframe failed: leave the face untouched
+        }
+        cv::Mat residual;
+        cv::warpAffine(key_residual, residual, plan.affine, crop.size(), cv::INTER_LINEAR | cv::WARP_INVERSE_MAP,
+                       cv::BORDER_REPLICATE);
+        residual = flow_.warpImage(residual, plan.flow);
+        cv::Mat output;
+        crop.convertTo(output, CV_32F);
+        output += residual;
+        output.convertTo(output, crop.type());
+        return output;
+    }
+
+    mutable std::mutex mutex_;
+    std::map<int, std::shared_ptr<Keyframe>> keyframes_;
+    KeyframePolicy policy_;
+    mutable OpticalFlow flow_;
+    size_t keyframe_count_ = 0;
+    size_t propagated_count_ = 0;
+};
+
+KeyframePropagator::KeyframePropagator() : pImpl(std::make_unique<Impl>()) {}
+
+KeyframePropagator::~KeyframePropagator() = default;
+
+void KeyframePropagator::setPolicy(const KeyframePolicy& policy) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->policy_ = policy;
+}
+
+KeyframePolicy KeyframePropagator::getPolicy() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->policy_;
+}
+
+KeyframePropagator::Plan KeyframePropagator::plan(int track_id, const ImageData& crop,
+                                                  const std::vector<cv::Point2f>& landmarks, int frame_number) {
+    return pImpl->plan(track_id, crop, landmarks, frame_number);
+}
+
+void KeyframePropagator::setKeyframe(const Plan& plan, const ImageData& crop, const ImageData& generated) {
+    if (!plan.key || generated.size() != crop.size() || generated.type() != crop.type()) {
+        return;
+    }
+    cv::Mat residual;
+    cv::subtract(generated, crop, residual, cv::noArray(), CV_32F);
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    plan.key->residual = residual;
+}
+
+ImageData KeyframePropagator::propagate(const Plan& plan, const ImageData& crop) const {
+    cv::Mat residual;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex_);
+        if (plan.key) {
+            residual = plan.key->residual;
+        }
+    }
+    return pImpl->propagate(plan, residual, crop);
+}
+
+void KeyframePropagator::invalidate(int track_id) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->keyframes_.erase(track_id);
+}
+
+void KeyframePropagator::reset() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->keyframes_.clear();
+}
+
+size_t KeyframePropagator::getMemoryBytes() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    size_t bytes = 0;
+    for (const auto& entry : pImpl->keyframes_) {
+        const Keyframe& key = *entry.second;
+        bytes += key.crop.total() * key.crop.elemSize() + key.residual.total() * key.residual.elemSize();
+    }
+    return bytes;
+}
+
+std::map<std::string, float> KeyframePropagator::getStats() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    std::map<std::string, float> stats;
+    const size_t total = pImpl->keyframe_count_ + pImpl->propagated_count_;
+    stats["keyframes"] = static_cast<float>(pImpl->keyframe_count_);
+    stats["propagated"] = static_cast<float>(pImpl->propagated_count_);
+    stats["keyframe_ratio"] = total ? static_cast<float>(pImpl->keyframe_count_) / total : 0.0f;
+    return stats;
+}
+
+} // namespace ufra
@@ -0,0 +1,113 @@
+#include "ufra/memory_budget.h"
+#include <algorithm>
+#include <array>
+#include <mutex>
+
+namespace ufra {
+
+namespace {
+
+constexpr size_t kCategoryCount = 4;
+constexpr float kBytesPerMB = 1024.0f * 1024.0f;
+
+const char* categoryName(size_t index) {
+    static const char* names[kCategoryCount] = {"models", "tensor_arenas", "caches", "frames"};
+    return names[index];
+}
+
+} // namespace
+
+class MemoryBudget::Impl {
+public:
+    size_t total() const {
+        size_t sum = 0;
+        for (size_t bytes : usage_) {
+            sum += bytes;
+        }
+        return sum;
+    }
+
+    mutable std::mutex mutex_;
+    size_t limit_ = 0;
+    float soft_threshold_ = 0.8f;
+    std::array<size_t, kCategoryCount> usage_{};
+};
+
+MemoryBudget::MemoryBudget() : pImpl(std::make_unique<Impl>()) {}
+MemoryBudget::~MemoryBudget() = default;
+
+void MemoryBudget::setLimit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->limit_ = bytes;
+}
+
+size_t MemoryBudget::getLimit() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->limit_;
+}
+
+void MemoryBudget::setSoftThreshold(float fraction) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->soft_threshold_ = std::max(0.0f, std::min(1.0f, fraction));
+}
+
+void MemoryBudget::setUsage(MemoryCategory category, size_t bytes) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->usage_[static_cast<size_t>(category)] = bytes;
+}
+
+bool MemoryBudget::tryReserve(MemoryCategory category, size_t bytes) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    if (pImpl->limit_ > 0 && pImpl->total() + bytes > pImpl->limit_) {
+        return false;
+    }
+    pImpl->usage_[static_cast<size_t>(category)] += bytes;
+    return true;
+}
+
+void MemoryBudget::release(MemoryCategory category, size_t bytes) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    size_t& usage = pImpl->usage_[static_cast<size_t>(category)];
+    usage -= std::min(usage, bytes);
+}
+
+size_t MemoryBudget::getUsage(MemoryCategory category) const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->usage_[static_cast<size_t>(category)];
+}
+
+size_t MemoryBudget::getTotalUsage() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->total();
+}
+
+MemoryPressure MemoryBudget::getPressure() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    if (pImpl->limit_ == 0) {
+        return MemoryPressure::NORMAL;
+    }
+    size_t used = pImpl->total();
+    if (used >= pImpl->limit_) {
+        return MemoryPressure::CRITICAL;
+    }
+    if (used >= static_cast<size_t>(pImpl->limit_ * pImpl->soft_threshold_)) {
+        return MemoryPressure::HIGH;
+    }
+    return MemoryPressure::NORMAL;
+}
+
+std::map<std::string, float> MemoryBudget::getMetrics() const {
+    std::map<std::string, float> metrics;
+    MemoryPressure pressure = getPressure();
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    for (size_t i = 0; i < kCategoryCount; ++i) {
+        metrics[std::string("memory_") + categoryName(i) + "_mb"] = pImpl->usage_[i] / kBytesPerMB;
+    }
+    metrics["memory_used_mb"] = pImpl->total() / kBytesPerMB;
+    metrics["memory_budget_mb"] = pImpl->limit_ / kBytesPerMB;
+    metrics["memory_pressure"] = static_cast<float>(pressure);
+    return metrics;
+}
+
+} // namespace ufra
@@ -0,0 +1,489 @@
+#include "ufra/metrics_exporter.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <netinet/in.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace ufra {
+
+namespace {
+
+constexpr size_t kMaxBuckets = 16;
+constexpr double kBytesPerMB = 1024.0 * 1024.0;
+
+// Written only by the owning thread; atomics so a concurrent scrape reads
+// whole values
+struct alignas(64) Shard {
+    std::atomic<uint64_t> buckets[kMaxBuckets] = {};
+    std::atomic<uint64_t> sum_ns{0};
+};
+
+void bump(std::atomic<uint64_t>& value, uint64_t amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+// Histogram ids are never reused, so a thread's cached shard of a destroyed
+// histogram is never looked up again
+std::atomic<uint64_t> g_next_histogram_id{1};
+
+std::string formatValue(double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.9g", value);
+    return text;
+}
+
+// Gauges copied from the engine's metrics map of the latest frame
+struct GaugeSpec {
+    const char* family;
+    const char* labels;
+    const char* metric;
+    double scale;
+    const char* help;
+};
+
+const GaugeSpec kGauges[] = {
+    {"ufra_memory_bytes", "category=\"models\"", "memory_models_mb", kBytesPerMB,
+     "Engine memory in use by category."},
+    {"ufra_memory_bytes", "category=\"tensor_arenas\"", "memory_tensor_arenas_mb", kBytesPerMB, nullptr},
+    {"ufra_memory_bytes", "category=\"caches\"", "memory_caches_mb", kBytesPerMB, nullptr},
+    {"ufra_memory_bytes", "category=\"frames\"", "memory_frames_mb", kBytesPerMB, nullptr},
+    {"ufra_memory_budget_bytes", "", "memory_budget_mb", kBytesPerMB, "Engine memory budget, 0 when unlimited."},
+    {"ufra_memory_pressure", "", "memory_pressure", 1.0, "0 normal, 1 high, 2 critical."},
+};
+constexpr size_t kGaugeCount = sizeof(kGauges) / sizeof(kGauges[0]);
+
+// Hit ratios from the cumulative <prefix>hits and <prefix>misses metrics
+struct CacheSpec {
+    const char* label;
+    const char* prefix;
+};
+
+const CacheSpec kCaches[] = {
+    {"result", "result_cache_"},
+    {"roi_skip", "roi_skip_"},
+    {"temporal", "temporal_"},
+};
+constexpr size_t kCacheCount = sizeof(kCaches) / sizeof(kCaches[0]);
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// LatencyHistogram
+
+class LatencyHistogram::Impl {
+public:
+    Impl() : id_(g_next_histogram_id++) {}
+
+    Shard& localShard() {
+        thread_local std::unordered_map<uint64_t, Shard*> shards;
+        Shard*& shard = shards[id_];
+        if (!shard) {
+            std::lock_guard<std::mutex> lock(mutex_);   // Once per thread
+            shards_.push_back(std::make_unique<Shard>());
+            shard = shards_.back().get();
+        }
+        return *shard;
+    }
+
+    const uint64_t id_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+LatencyHistogram::LatencyHistogram() : pImpl(std::make_unique<Impl>()) {}
+LatencyHistogram::~LatencyHistogram() = default;
+
+const std::vector<double>& LatencyHistogram::bucketBounds() {
+    static const std::vector<double> bounds = {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+                                               0.1,    0.25,  0.5,    1.0,   2.5,  5.0,   10.0};
+    return bounds;
+}
+
+void LatencyHistogram::observe(double seconds) {
+    seconds = std::max(0.0, seconds);
+    const std::vector<double>& bounds = bucketBounds();
+    const size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), seconds) - bounds.begin();
+    Shard& shard = pImpl->localShard();
+    bump(shard.buckets[bucket], 1);
+    bump(shard.sum_ns, static_cast<uint64_t>(seconds * 1e9));
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot result;
+    result.buckets.assign(bucketBounds().size() + 1, 0);
+    uint64_t sum_ns = 0;
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    for (const auto& shard : pImpl->shards_) {
+        for (size_t b = 0; b < result.buckets.size(); ++b) {
+            result.buckets[b] += shard->buckets[b].load(std::memory_order_relaxed);
+        }
+        sum_ns += shard->sum_ns.load(std::memory_order_relaxed);
+    }
+    for (uint64_t count : result.buckets) {
+        result.count += count;
+    }
+    result.sum = sum_ns / 1e9;
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// MetricsExporter
+
+class MetricsExporter::Impl {
+public:
+    explicit Impl(const std::vector<std::string>& stages) : stages_(stages) {
+        for (size_t i = 0; i < stages_.size(); ++i) {
+            stage_latency_.push_back(std::make_unique<LatencyHistogram>());
+        }
+        for (auto& gauge : gauges_) {
+            gauge = std::nan("");
+        }
+        for (auto& ratio : cache_ratios_) {
+            ratio = std::nan("");
+        }
+        rate_time_ = std::chrono::steady_clock::now();
+    }
+
+    double framesPerSecond() {
+        std::lock_guard<std::mutex> lock(rate_mutex_);
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - rate_time_).count();
+        if (elapsed >= 1.0) {
+            const uint64_t frames = frames_.load();
+            rate_fps_ = (frames - rate_frames_) / elapsed;
+            rate_frames_ = frames;
+            rate_time_ = now;
+        }
+        return rate_fps_;
+    }
+
+    bool writeFile() const;
+    void writeLoop();
+    void serve();
+
+    const std::vector<std::string> stages_;
+    std::vector<std::unique_ptr<LatencyHistogram>> stage_latency_;
+    LatencyHistogram frame_latency_;
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> errors_{0};
+    std::atomic<uint64_t> faces_{0};
+    std::atomic<double> gauges_[kGaugeCount];
+    std::atomic<double> cache_ratios_[kCacheCount];
+
+    // frames/sec over the interval between reads at least a second apart
+    std::mutex rate_mutex_;
+    std::chrono::steady_clock::time_point rate_time_;
+    uint64_t rate_frames_ = 0;
+    double rate_fps_ = 0.0;
+
+    MetricsExporter* owner_ = nullptr;
+
+    // File output
+    std::string path_;
+    int interval_ms_ = 5000;
+    std::thread writer_thread_;
+    std::mutex writer_mutex_;
+    std::condition_variable writer_wakeup_;
+    bool stopping_ = false;
+
+    // HTTP output
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::thread accept_thread_;
+};
+
+// Written to a temporary name and renamed, so a reader never sees half a file
+bool MetricsExporter::Impl::writeFile() const {
+    const std::string temp_path = path_ + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        file << owner_->render();
+        if (!file) {
+            return false;
+        }
+    }
+    return std::rename(temp_path.c_str(), path_.c_str()) == 0;
+}
+
+void MetricsExporter::Impl::writeLoop() {
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    for (;;) {
+        const bool stopping =
+            writer_wakeup_.wait_for(lock, std::chrono::milliseconds(interval_ms_), [this] { return stopping_; });
+        writeFile();
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+void MetricsExporter::Impl::serve() {
+    for (;;) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return;   // Listening socket shut down
+        }
+
+        // A stalled client must not hold up the next scrape for long
+        timeval timeout{1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                break;
+            }
+            request.append(buffer, static_cast<size_t>(received));
+        }
+
+        std::istringstream request_line(request.substr(0, request.find("\r\n")));
+        std::string method, target;
+        request_line >> method >> target;
+        target = target.substr(0, target.find('?'));
+
+        std::string response;
+        if (method == "GET" && (target == "/metrics" || target == "/")) {
+            const std::string body = owner_->render();
+            response = "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                       "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                       "Connection: close\r\n\r\n" + body;
+        } else {
+            response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        }
+        size_t sent = 0;
+        while (sent < response.size()) {
+            ssize_t written = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (written <= 0) {
+                break;
+            }
+            sent += static_cast<size_t>(written);
+        }
+        close(fd);
+    }
+}
+
+MetricsExporter::MetricsExporter(const std::vector<std::string>& stages)
+    : pImpl(std::make_unique<Impl>(stages)) {
+    pImpl->owner_ = this;
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::writeToFile(const std::string& path, int interval_ms) {
+    if (pImpl->writer_thread_.joinable()) {
+        return false;
+    }
+    pImpl->path_ = path;
+    pImpl->interval_ms_ = std::max(1, interval_ms);
+    if (!pImpl->writeFile()) {
+        std::cerr << "Failed to write metrics to " << path << std::endl;
+        return false;
+    }
+    pImpl->stopping_ = false;
+    pImpl->writer_thread_ = std::thread([this] { pImpl->writeLoop(); });
+    return true;
+}
+
+bool MetricsExporter::listen(int port) {
+    if (pImpl->listen_fd_ >= 0) {
+        return false;
+    }
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    const int reuse = 1;
+    socklen_t length = sizeof(address);
+    if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+        bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 16) != 0 ||
+        getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        std::cerr << "Failed to serve metrics on port " << port << ": " << std::strerror(errno) << std::endl;
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+    pImpl->listen_fd_ = fd;
+    pImpl->port_ = ntohs(address.sin_port);
+    pImpl->accept_thread_ = std::thread([this] { pImpl->serve(); });
+    return true;
+}
+
+int MetricsExporter::getPort() const {
+    return pImpl->port_;
+}
+
+void MetricsExporter::stop() {
+    if (pImpl->writer_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(pImpl->writer_mutex_);
+            pImpl->stopping_ = true;
+        }
+        pImpl->writer_wakeup_.notify_all();
+        pImpl->writer_thread_.join();   // Writes the final totals
+    }
+    if (pImpl->listen_fd_ >= 0) {
+        // shutdown() wakes the thread blocked in accept()
+        shutdown(pImpl->listen_fd_, SHUT_RDWR);
+        pImpl->accept_thread_.join();
+        close(pImpl->listen_fd_);
+        pImpl->listen_fd_ = -1;
+        pImpl->port_ = 0;
+    }
+}
+
+void MetricsExporter::observeStage(const char* stage, double seconds) {
+    for (size_t i = 0; i < pImpl->stages_.size(); ++i) {
+        if (pImpl->stages_[i] == stage) {
+            pImpl->stage_latency_[i]->observe(seconds);
+            return;
+        }
+    }
+}
+
+void MetricsExporter::recordFrame(double seconds, const std::map<std::string, float>& metrics) {
+    pImpl->frame_latency_.observe(seconds);
+    pImpl->frames_.fetch_add(1, std::memory_order_relaxed);
+    auto faces = metrics.find("faces_processed");
+    if (faces != metrics.end()) {
+        pImpl->faces_.fetch_add(static_cast<uint64_t>(faces->second), std::memory_order_relaxed);
+    }
+
+    for (size_t g = 0; g < kGaugeCount; ++g) {
+        auto it = metrics.find(kGauges[g].metric);
+        if (it != metrics.end()) {
+            pImpl->gauges_[g].store(it->second * kGauges[g].scale, std::memory_order_relaxed);
+        }
+    }
+    for (size_t c = 0; c < kCacheCount; ++c) {
+        const std::string prefix = kCaches[c].prefix;
+        auto hits = metrics.find(prefix + "hits");
+        auto misses = metrics.find(prefix + "misses");
+        if (hits != metrics.end() && misses != metrics.end() && hits->second + misses->second > 0.0f) {
+            pImpl->cache_ratios_[c].store(hits->second / (hits->second + misses->second),
+                                          std::memory_order_relaxed);
+        }
+    }
+}
+
+void MetricsExporter::recordError() {
+    pImpl->errors_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string MetricsExporter::render() const {
+    std::ostringstream out;
+    auto counter = [&out](const char* family, const char* help, uint64_t value) {
+        out << "# TYPE " << family << " counter\n# HELP " << family << " " << help << "\n"
+            << family << "_total " << value << "\n";
+    };
+    counter("ufra_frames", "Frames processed successfully.", pImpl->frames_.load());
+    counter("ufra_frame_errors", "Frames that failed to process.", pImpl->errors_.load());
+    counter("ufra_faces", "Faces processed.", pImpl->faces_.load());
+
+    out << "# TYPE ufra_frames_per_second gauge\n"
+        << "# HELP ufra_frames_per_second Frame rate since the previous read at least a second earlier.\n"
+        << "ufra_frames_per_second " << formatValue(pImpl->framesPerSecond()) << "\n";
+
+    const std::vector<double>& bounds = LatencyHistogram::bucketBounds();
+    auto histogram = [&out, &bounds](const std::string& family, const std::string& labels,
+                                     const LatencyHistogram::Snapshot& snapshot) {
+        const std::string prefix = labels.empty() ? "{" : "{" + labels + ",";
+        const std::string plain = labels.empty() ? "" : "{" + labels + "}";
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b <= bounds.size(); ++b) {
+            cumulative += snapshot.buckets[b];
+            out << family << "_bucket" << prefix << "le=\""
+                << (b < bounds.size() ? formatValue(bounds[b]) : "+Inf") << "\"} " << cumulative << "\n";
+        }
+        out << family << "_count" << plain << " " << snapshot.count << "\n"
+            << family << "_sum" << plain << " " << formatValue(snapshot.sum) << "\n";
+    };
+    out << "# TYPE ufra_frame_latency_seconds histogram\n# UNIT ufra_frame_latency_seconds seconds\n"
+        << "# HELP ufra_frame_latency_seconds Time from admission to a finished frame.\n";
+    histogram("ufra_frame_latency_seconds", "", pImpl->frame_latency_.snapshot());
+    out << "# TYPE ufra_stage_latency_seconds histogram\n# UNIT ufra_stage_latency_seconds seconds\n"
+        << "# HELP ufra_stage_latency_seconds Time spent per pipeline stage call.\n";
+    for (size_t i = 0; i < pImpl->stages_.size(); ++i) {
+        histogram("ufra_stage_latency_seconds", "stage=\"" + pImpl->stages_[i] + "\"",
+                  pImpl->stage_latency_[i]->snapshot());
+    }
+
+    bool ratio_header = false;
+    for (size_t c = 0; c < kCacheCount; ++c) {
+        const double ratio = pImpl->cache_ratios_[c].load();
+        if (std::isnan(ratio)) {
+            continue;
+        }
+        if (!ratio_header) {
+            out << "# TYPE ufra_cache_hit_ratio gauge\n"
+                << "# HELP ufra_cache_hit_ratio Lookups answered from the cache since the engine started.\n";
+            ratio_header = true;
+        }
+        out << "ufra_cache_hit_ratio{cache=\"" << kCaches[c].label << "\"} " << formatValue(ratio) << "\n";
+    }
+
+    const char* family = nullptr;
+    for (size_t g = 0; g < kGaugeCount; ++g) {
+        const double value = pImpl->gauges_[g].load();
+        if (std::isnan(value)) {
+            continue;
+        }
+        if (!family || std::strcmp(family, kGauges[g].family) != 0) {
+            family = kGauges[g].family;
+            out << "# TYPE " << family << " gauge\n";
+            if (kGauges[g].help) {
+                out << "# HELP " << family << " " << kGauges[g].help << "\n";
+            }
+        }
+        out << family;
+        if (*kGauges[g].labels) {
+            out << "{" << kGauges[g].labels << "}";
+        }
+        out << " " << formatValue(value) << "\n";
+    }
+
+    out << "# EOF\n";
+    return out.str();
+}
+
+MetricsExporter::StageTimer::StageTimer(MetricsExporter* exporter, const char* stage)
+    : exporter_(exporter), stage_(stage) {
+    if (exporter_) {
+        start_ = std::chrono::steady_clock::now();
+    }
+}
+
+MetricsExporter::StageTimer::~StageTimer() {
+    if (exporter_) {
+        exporter_->observeStage(
+            stage_, std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count());
+    }
+}
+
+} // namespace ufra
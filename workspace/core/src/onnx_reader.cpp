@@ -0,0 +1,413 @@
+#include "ufra/tensor_runtime.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace ufra {
+namespace runtime {
+
+namespace {
+
+// Just enough of the protobuf wire format to walk an onnx.ModelProto.
+// Field numbers follow onnx/onnx.proto.
+class WireReader {
+public:
+    WireReader(const uint8_t* data, size_t size) : pos_(data), end_(data + size) {}
+
+    bool done() const { return pos_ >= end_; }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos_ >= end_) {
+                throw std::runtime_error("truncated varint");
+            }
+            uint8_t byte = *pos_++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        throw std::runtime_error("malformed varint");
+    }
+
+    // Returns false at end of message
+    bool next(int& field, int& wire_type) {
+        if (done()) {
+            return false;
+        }
+        uint64_t key = varint();
+        field = static_cast<int>(key >> 3);
+        wire_type = static_cast<int>(key & 7);
+        return true;
+    }
+
+    WireReader message() {
+        size_t size = length();
+        WireReader sub(pos_, size);
+        pos_ += size;
+        return sub;
+    }
+
+    std::string bytes() {
+        size_t size = length();
+        std::string value(reinterpret_cast<const char*>(pos_), size);
+        pos_ += size;
+        return value;
+    }
+
+    float fixed32() {
+        need(4);
+        float value;
+        std::memcpy(&value, pos_, 4);
+        pos_ += 4;
+        return value;
+    }
+
+    double fixed64() {
+        need(8);
+        double value;
+        std::memcpy(&value, pos_, 8);
+        pos_ += 8;
+        return value;
+    }
+
+    void skip(int wire_type) {
+        switch (wire_type) {
+            case 0: varint(); break;
+            case 1: need(8); pos_ += 8; break;
+            case 2: pos_ += length(); break;
+            case 5: need(4); pos_ += 4; break;
+            default: throw std::runtime_error("unsupported wire type");
+        }
+    }
+
+    // Repeated scalars may be packed (wire type 2) or one per tag
+    void int64s(int wire_type, std::vector<int64_t>& values) {
+        if (wire_type == 2) {
+            WireReader packed = message();
+            while (!packed.done()) {
+                values.push_back(static_cast<int64_t>(packed.varint()));
+            }
+        } else {
+            values.push_back(static_cast<int64_t>(varint()));
+        }
+    }
+
+    void floats(int wire_type, std::vector<float>& values) {
+        if (wire_type == 2) {
+            WireReader packed = message();
+            while (!packed.done()) {
+                values.push_back(packed.fixed32());
+            }
+        } else {
+            values.push_back(fixed32());
+        }
+    }
+
+    void doubles(int wire_type, std::vector<double>& values) {
+        if (wire_type == 2) {
+            WireReader packed = message();
+            while (!packed.done()) {
+                values.push_back(packed.fixed64());
+            }
+        } else {
+            values.push_back(fixed64());
+        }
+    }
+
+private:
+    size_t length() {
+        uint64_t size = varint();
+        need(size);
+        return static_cast<size_t>(size);
+    }
+
+    void need(uint64_t bytes) const {
+        if (bytes > static_cast<uint64_t>(end_ - pos_)) {
+            throw std::runtime_error("truncated message");
+        }
+    }
+
+    const uint8_t* pos_;
+    const uint8_t* end_;
+};
+
+// onnx.TensorProto.DataType
+enum DataType {
+    FLOAT = 1, UINT8 = 2, INT8 = 3, INT32 = 6, INT64 = 7, BOOL = 9, FLOAT16 = 10, DOUBLE = 11
+};
+
+float halfToFloat(uint16_t h) {
+    uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1F;
+    uint32_t mantissa = h & 0x3FF;
+    uint32_t bits;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // Subnormal: renormalize
+            exponent = 127 - 15 + 1;
+            while (!(mantissa & 0x400)) {
+                mantissa <<= 1;
+                --exponent;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    float value;
+    std::memcpy(&value, &bits, 4);
+    return value;
+}
+
+template <typename T>
+void decodeRaw(const std::string& raw, std::vector<float>& out) {
+    size_t count = raw.size() / sizeof(T);
+    out.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        T value;
+        std::memcpy(&value, raw.data() + i * sizeof(T), sizeof(T));
+        out[i] = static_cast<float>(value);
+    }
+}
+
+Tensor parseTensor(WireReader reader, std::string& name) {
+    Tensor tensor;
+    int data_type = FLOAT;
+    std::string raw;
+    bool external = false;
+    std::vector<float> float_data;
+    std::vector<int64_t> int_data;
+    std::vector<double> double_data;
+
+    int field, wire_type;
+    while (reader.next(field, wire_type)) {
+        switch (field) {
+            case 1: reader.int64s(wire_type, tensor.shape); break;
+            case 2: data_type = static_cast<int>(reader.varint()); break;
+            case 4: reader.floats(wire_type, float_data); break;
+            case 5: reader.int64s(wire_type, int_data); break;       // int32_data
+            case 7: reader.int64s(wire_type, int_data); break;       // int64_data
+            case 8: name = reader.bytes(); break;
+            case 9: raw = reader.bytes(); break;
+            case 10: reader.doubles(wire_type, double_data); break;
+            case 14: external = (reader.varint() == 1); break;        // data_location
+            default: reader.skip(wire_type); break;
+        }
+    }
+
+    if (external) {
+        throw std::runtime_error("external tensor data is not supported: " + name);
+    }
+
+    if (!raw.empty()) {
+        switch (data_type) {
+            case FLOAT: decodeRaw<float>(raw, tensor.data); break;
+            case DOUBLE: decodeRaw<double>(raw, tensor.data); break;
+            case INT64: decodeRaw<int64_t>(raw, tensor.data); break;
+            case INT32: decodeRaw<int32_t>(raw, tensor.data); break;
+            case INT8: decodeRaw<int8_t>(raw, tensor.data); break;
+            case UINT8:
+            case BOOL: decodeRaw<uint8_t>(raw, tensor.data); break;
+            case FLOAT16: {
+                std::vector<float> halves(raw.size() / 2);
+                for (size_t i = 0; i < halves.size(); ++i) {
+                    uint16_t h;
+                    std::memcpy(&h, raw.data() + i * 2, 2);
+                    halves[i] = halfToFloat(h);
+                }
+                tensor.data = std::move(halves);
+                break;
+            }
+            default:
+                throw std::runtime_error("unsupported tensor data type " + std::to_string(data_type));
+        }
+    } else if (!float_data.empty()) {
+        tensor.data = std::move(float_data);
+    } else if (!double_data.empty()) {
+        tensor.data.assign(double_data.begin(), double_data.end());
+    } else if (data_type == FLOAT16) {
+        // Halves are stored bit-wise in int32_data
+        for (int64_t bits : int_data) {
+            tensor.data.push_back(halfToFloat(static_cast<uint16_t>(bits)));
+        }
+    } else {
+        tensor.data.assign(int_data.begin(), int_data.end());
+    }
+
+    if (tensor.data.size() != shapeSize(tensor.shape)) {
+        throw std::runtime_error("tensor size does not match its shape: " + name);
+    }
+    return tensor;
+}
+
+ValueInfo parseValueInfo(WireReader reader) {
+    ValueInfo info;
+    int field, wire_type;
+    while (reader.next(field, wire_type)) {
+        if (field == 1) {
+            info.name = reader.bytes();
+        } else if (field == 2) {
+            // TypeProto.tensor_type(1).shape(2).dim(1).dim_value(1)
+            WireReader type = reader.message();
+            while (type.next(field, wire_type)) {
+                if (field != 1) {
+                    type.skip(wire_type);
+                    continue;
+                }
+                WireReader tensor_type = type.message();
+                while (tensor_type.next(field, wire_type)) {
+                    if (field != 2) {
+                        tensor_type.skip(wire_type);
+                        continue;
+                    }
+                    WireReader shape = tensor_type.message();
+                    while (shape.next(field, wire_type)) {
+                        if (field != 1) {
+                            shape.skip(wire_type);
+                            continue;
+                        }
+                        WireReader dim = shape.message();
+                        int64_t value = -1;
+                        while (dim.next(field, wire_type)) {
+                            if (field == 1) {
+                                value = static_cast<int64_t>(dim.varint());
+                            } else {
+                                dim.skip(wire_type);
+                            }
+                        }
+                        info.shape.push_back(value > 0 ? value : -1);
+                    }
+                }
+            }
+        } else {
+            reader.skip(wire_type);
+        }
+    }
+    return info;
+}
+
+void parseAttribute(WireReader reader, Node& node) {
+    std::string name;
+    int type = 0;
+    float f = 0.0f;
+    int64_t i = 0;
+    std::string s;
+    Tensor t;
+    std::vector<float> floats;
+    std::vector<int64_t> ints;
+
+    int field, wire_type;
+    while (reader.next(field, wire_type)) {
+        switch (field) {
+            case 1: name = reader.bytes(); break;
+            case 2: f = reader.fixed32(); break;
+            case 3: i = static_cast<int64_t>(reader.varint()); break;
+            case 4: s = reader.bytes(); break;
+            case 5: { std::string unused; t = parseTensor(reader.message(), unused); break; }
+            case 7: reader.floats(wire_type, floats); break;
+            case 8: reader.int64s(wire_type, ints); break;
+            case 20: type = static_cast<int>(reader.varint()); break;
+            default: reader.skip(wire_type); break;
+        }
+    }
+
+    // onnx.AttributeProto.AttributeType
+    switch (type) {
+        case 1: node.floats[name] = f; break;
+        case 2: node.ints[name] = i; break;
+        case 3: node.strings[name] = s; break;
+        case 4: node.tensors[name] = std::move(t); break;
+        case 6: node.float_lists[name] = std::move(floats); break;
+        case 7: node.int_lists[name] = std::move(ints); break;
+        default: break;   // Graphs, sparse tensors and string lists are unused
+    }
+}
+
+Node parseNode(WireReader reader) {
+    Node node;
+    int field, wire_type;
+    while (reader.next(field, wire_type)) {
+        switch (field) {
+            case 1: node.inputs.push_back(reader.bytes()); break;
+            case 2: node.outputs.push_back(reader.bytes()); break;
+            case 3: node.name = reader.bytes(); break;
+            case 4: node.op_type = reader.bytes(); break;
+            case 5: parseAttribute(reader.message(), node); break;
+            default: reader.skip(wire_type); break;
+        }
+    }
+    return node;
+}
+
+void parseGraph(WireReader reader, Graph& graph) {
+    std::vector<ValueInfo> inputs;
+    int field, wire_type;
+    while (reader.next(field, wire_type)) {
+        switch (field) {
+            case 1: graph.nodes.push_back(parseNode(reader.message())); break;
+            case 5: {
+                std::string name;
+                Tensor tensor = parseTensor(reader.message(), name);
+                graph.initializers[name] = std::move(tensor);
+                break;
+            }
+            case 11: inputs.push_back(parseValueInfo(reader.message())); break;
+            case 12: graph.outputs.push_back(parseValueInfo(reader.message())); break;
+            default: reader.skip(wire_type); break;
+        }
+    }
+
+    // Older exporters list initializers among the graph inputs
+    for (auto& input : inputs) {
+        if (!graph.initializers.count(input.name)) {
+            graph.inputs.push_back(std::move(input));
+        }
+    }
+}
+
+} // namespace
+
+bool parseOnnxModel(const uint8_t* data, size_t size, Graph& graph, std::string& error) {
+    graph = Graph();
+    try {
+        WireReader reader(data, size);
+        bool has_graph = false;
+        int field, wire_type;
+        while (reader.next(field, wire_type)) {
+            if (field == 7) {   // ModelProto.graph
+                parseGraph(reader.message(), graph);
+                has_graph = true;
+            } else {
+                reader.skip(wire_type);
+            }
+        }
+        if (!has_graph) {
+            error = "no graph in model";
+            return false;
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        error = e.what();
+        return false;
+    }
+}
+
+bool readOnnxModel(const std::string& path, Graph& graph, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return parseOnnxModel(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size(), graph, error);
+}
+
+} // namespace runtime
+} // namespace ufra
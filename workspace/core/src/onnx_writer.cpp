@@ -0,0 +1,172 @@
+#include "ufra/tensor_runtime.h"
+#include <cstring>
+#include <fstream>
+#include <functional>
+
+namespace ufra {
+namespace runtime {
+
+namespace {
+
+// Counterpart of the reader's WireReader; emits the same onnx.proto fields
+class WireWriter {
+public:
+    std::string bytes;
+
+    void varint(int field, uint64_t value) {
+        key(field, 0);
+        raw(value);
+    }
+
+    void fixed32(int field, float value) {
+        key(field, 5);
+        char buf[4];
+        std::memcpy(buf, &value, 4);
+        bytes.append(buf, 4);
+    }
+
+    void string(int field, const std::string& value) {
+        key(field, 2);
+        raw(value.size());
+        bytes += value;
+    }
+
+    void message(int field, const WireWriter& value) { string(field, value.bytes); }
+
+    void packedInts(int field, const std::vector<int64_t>& values) {
+        WireWriter body;
+        for (int64_t v : values) {
+            body.raw(static_cast<uint64_t>(v));
+        }
+        string(field, body.bytes);
+    }
+
+    void packedFloats(int field, const std::vector<float>& values) {
+        string(field, std::string(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float)));
+    }
+
+private:
+    void key(int field, int wire_type) { raw(static_cast<uint64_t>(field) << 3 | wire_type); }
+
+    void raw(uint64_t value) {
+        do {
+            uint8_t byte = value & 0x7F;
+            value >>= 7;
+            bytes.push_back(static_cast<char>(value ? byte | 0x80 : byte));
+        } while (value);
+    }
+};
+
+WireWriter tensorProto(const std::string& name, const Tensor& tensor) {
+    WireWriter t;
+    t.packedInts(1, tensor.shape);
+    t.varint(2, 1);   // FLOAT
+    t.string(8, name);
+    t.string(9, std::string(reinterpret_cast<const char*>(tensor.data.data()), tensor.size() * sizeof(float)));
+    return t;
+}
+
+WireWriter valueInfo(const ValueInfo& info) {
+    WireWriter shape;
+    for (int64_t d : info.shape) {
+        WireWriter dim;
+        if (d >= 0) {
+            dim.varint(1, static_cast<uint64_t>(d));
+        } else {
+            dim.string(2, "?");
+        }
+        shape.message(1, dim);
+    }
+    WireWriter tensor_type;
+    tensor_type.varint(1, 1);
+    if (!info.shape.empty()) {
+        tensor_type.message(2, shape);
+    }
+    WireWriter type;
+    type.message(1, tensor_type);
+
+    WireWriter value;
+    value.string(1, info.name);
+    value.message(2, type);
+    return value;
+}
+
+WireWriter nodeProto(const Node& node) {
+    WireWriter n;
+    for (const auto& name : node.inputs) {
+        n.string(1, name);
+    }
+    for (const auto& name : node.outputs) {
+        n.string(2, name);
+    }
+    n.string(3, node.name);
+    n.string(4, node.op_type);
+
+    auto attribute = [&n](const std::string& name, int type, const std::function<void(WireWriter&)>& body) {
+        WireWriter a;
+        a.string(1, name);
+        body(a);
+        a.varint(20, static_cast<uint64_t>(type));
+        n.message(5, a);
+    };
+    for (const auto& a : node.floats) {
+        attribute(a.first, 1, [&](WireWriter& w) { w.fixed32(2, a.second); });
+    }
+    for (const auto& a : node.ints) {
+        attribute(a.first, 2, [&](WireWriter& w) { w.varint(3, static_cast<uint64_t>(a.second)); });
+    }
+    for (const auto& a : node.strings) {
+        attribute(a.first, 3, [&](WireWriter& w) { w.string(4, a.second); });
+    }
+    for (const auto& a : node.tensors) {
+        attribute(a.first, 4, [&](WireWriter& w) { w.message(5, tensorProto("", a.second)); });
+    }
+    for (const auto& a : node.float_lists) {
+        attribute(a.first, 6, [&](WireWriter& w) { w.packedFloats(7, a.second); });
+    }
+    for (const auto& a : node.int_lists) {
+        attribute(a.first, 7, [&](WireWriter& w) { w.packedInts(8, a.second); });
+    }
+    return n;
+}
+
+} // namespace
+
+void serializeOnnxModel(const Graph& graph, std::string& bytes) {
+    WireWriter g;
+    for (const auto& node : graph.nodes) {
+        g.message(1, nodeProto(node));
+    }
+    g.string(2, "ufra");
+    for (const auto& entry : graph.initializers) {
+        g.message(5, tensorProto(entry.first, entry.second));
+    }
+    for (const auto& info : graph.inputs) {
+        g.message(11, valueInfo(info));
+    }
+    for (const auto& info : graph.outputs) {
+        g.message(12, valueInfo(info));
+    }
+
+    WireWriter opset;
+    opset.string(1, "");
+    opset.varint(2, 13);
+
+    WireWriter model;
+    model.varint(1, 8);   // ir_version
+    model.string(2, "ufra");
+    model.message(7, g);
+    model.message(8, opset);
+    bytes = std::move(model.bytes);
+}
+
+bool writeOnnxModel(const std::string& path, const Graph& graph) {
+    std::string bytes;
+    serializeOnnxModel(graph, bytes);
+    std::ofstream file(path, std::ios::binary);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(file);
+}
+
+} // namespace runtime
+} // namespace ufra
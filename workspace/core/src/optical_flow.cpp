@@ -0,0 +1,108 @@
+#include "ufra/optical_flow.h"
+#include "ufra/image_kernels.h"
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+#include <algorithm>
+#include <iostream>
+
+namespace ufra {
+
+class OpticalFlow::Impl {
+public:
+    // Flow is CV_32FC2 with frame2(p + flow(p)) ~ frame1(p), as from
+    // cv::calcOpticalFlowFarneback
+    cv::Mat computeFlow(const ImageData& frame1, const ImageData& frame2) {
+        if (frame1.empty() || frame1.size() != frame2.size()) {
+            return cv::Mat();
+        }
+        cv::Mat gray1 = toGray(frame1);
+        cv::Mat gray2 = toGray(frame2);
+        cv::Mat flow(frame1.size(), CV_32FC2);
+        if (algorithm_ == "farneback") {
+            cv::calcOpticalFlowFarneback(gray1, gray2, flow, 0.5, levels(), 2 * radius() + 1, iterations(), 5, 1.1, 0);
+        } else {
+            kernels::computeFlowLK(gray1.data, gray1.step[0], gray2.data, gray2.step[0], gray1.cols, gray1.rows,
+                                   levels(), radius(), iterations(), flow.ptr<float>());
+        }
+        return flow;
+    }
+
+    cv::Mat warpImage(const ImageData& source, const cv::Mat& flow) {
+        if (source.empty() || flow.type() != CV_32FC2 || flow.size() != source.size() || !flow.isContinuous()) {
+            return source.clone();
+        }
+        cv::Mat warped(source.size(), source.type());
+        if (source.depth() == CV_8U) {
+            kernels::warpByFlow(source.data, source.step[0], source.cols, source.rows, source.channels(),
+                                flow.ptr<float>(), warped.data, warped.step[0]);
+        } else if (source.depth() == CV_32F) {
+            kernels::warpByFlow(source.ptr<float>(), source.step[0] / sizeof(float), source.cols, source.rows,
+                                source.channels(), flow.ptr<float>(), warped.ptr<float>(),
+                                warped.step[0] / sizeof(float));
+        } else {
+            return source.clone();
+        }
+        return warped;
+    }
+
+    void setFlowAlgorithm(const std::string& algorithm) {
+        if (algorithm != "lucas_kanade" && algorithm != "farneback") {
+            std::cerr << "Optical flow algorithm '" << algorithm << "' is not available, using lucas_kanade"
+                      << std::endl;
+            algorithm_ = "lucas_kanade";
+            return;
+        }
+        algorithm_ = algorithm;
+    }
+
+    std::string algorithm_ = "lucas_kanade";
+    float quality_ = 0.5f;
+    bool gpu_acceleration_ = false;
+
+private:
+    static cv::Mat toGray(const ImageData& frame) {
+        cv::Mat gray;
+        if (frame.channels() == 3) {
+            cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+        } else if (frame.channels() == 4) {
+            cv::cvtColor(frame, gray, cv::COLOR_BGRA2GRAY);
+        } else {
+            gray = frame;
+        }
+        if (gray.depth() != CV_8U) {
+            gray.convertTo(gray, CV_8U);
+        }
+        return gray;
+    }
+
+    // Quality trades window size and iterations against speed
+    int levels() const { return 3; }
+    int radius() const { return 2 + static_cast<int>(quality_ * 3.0f + 0.5f); }
+    int iterations() const { return 2 + static_cast<int>(quality_ * 4.0f + 0.5f); }
+};
+
+OpticalFlow::OpticalFlow() : pImpl(std::make_unique<Impl>()) {}
+
+OpticalFlow::~OpticalFlow() = default;
+
+cv::Mat OpticalFlow::computeFlow(const ImageData& frame1, const ImageData& frame2) {
+    return pImpl->computeFlow(frame1, frame2);
+}
+
+cv::Mat OpticalFlow::warpImage(const ImageData& source, const cv::Mat& flow) {
+    return pImpl->warpImage(source, flow);
+}
+
+void OpticalFlow::setFlowAlgorithm(const std::string& algorithm) {
+    pImpl->setFlowAlgorithm(algorithm);
+}
+
+void OpticalFlow::setQualityLevel(float quality) {
+    pImpl->quality_ = std::min(1.0f, std::max(0.0f, quality));
+}
+
+void OpticalFlow::enableGPUAcceleration(bool enable) {
+    pImpl->gpu_acceleration_ = enable;
+}
+
+} // namespace ufra
@@ -0,0 +1,278 @@
+#include "ufra/perf_counters.h"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ufra {
+
+namespace {
+
+constexpr int kEventCount = 5;
+
+// Events any thread managed to open, so metrics of unsupported events are
+// left out rather than reported as zero
+std::atomic<unsigned> g_opened_events{0};
+
+bool eventOpened(int event) {
+    return (g_opened_events.load() >> event) & 1u;
+}
+
+#ifdef __linux__
+
+struct EventSpec {
+    uint32_t type;
+    uint64_t config;
+};
+
+// Same order as the CounterSample fields
+const EventSpec kEvents[kEventCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},   // Last-level misses on x86 and Arm
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+int openEvent(const EventSpec& spec, int group_fd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec.type;
+    attr.config = spec.config;
+    attr.disabled = group_fd < 0 ? 1 : 0;   // The leader starts the group
+    attr.exclude_kernel = 1;                // Allowed up to perf_event_paranoid 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+std::string describeError(int error) {
+    switch (error) {
+        case EACCES:
+        case EPERM:
+            return "perf_event_open not permitted (container seccomp profile or perf_event_paranoid > 2)";
+        case ENOENT:
+        case ENODEV:
+        case EOPNOTSUPP:
+            return "no hardware performance counters (virtual machine without PMU passthrough)";
+        case ENOSYS:
+            return "kernel built without perf events";
+        default:
+            return std::string("perf_event_open failed: ") + std::strerror(error);
+    }
+}
+
+// One counter group per thread; members that fail to open are left out
+class ThreadCounters {
+public:
+    ThreadCounters() {
+        leader_ = openEvent(kEvents[0], -1);
+        if (leader_ < 0) {
+            return;
+        }
+        slots_.push_back(0);
+        unsigned opened = 1u;
+        for (int e = 1; e < kEventCount; ++e) {
+            int fd = openEvent(kEvents[e], leader_);
+            if (fd >= 0) {
+                members_.push_back(fd);
+                slots_.push_back(e);
+                opened |= 1u << e;
+            }
+        }
+        g_opened_events |= opened;
+        ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    ~ThreadCounters() {
+        for (int fd : members_) {
+            close(fd);
+        }
+        if (leader_ >= 0) {
+            close(leader_);
+        }
+    }
+
+    CounterSample read() const {
+        CounterSample sample;
+        if (leader_ < 0) {
+            return sample;
+        }
+        uint64_t buffer[3 + kEventCount];
+        const ssize_t expected = static_cast<ssize_t>((3 + slots_.size()) * sizeof(uint64_t));
+        if (::read(leader_, buffer, sizeof(buffer)) < expected || buffer[0] != slots_.size()) {
+            return sample;
+        }
+        const uint64_t enabled = buffer[1], running = buffer[2];
+        uint64_t* fields[kEventCount] = {&sample.cycles, &sample.instructions, &sample.l1d_misses,
+                                         &sample.llc_misses, &sample.branch_misses};
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            uint64_t value = buffer[3 + i];
+            if (running > 0 && running < enabled) {
+                value = static_cast<uint64_t>(static_cast<double>(value) * enabled / running);
+            }
+            *fields[slots_[i]] = value;
+        }
+        return sample;
+    }
+
+private:
+    int leader_ = -1;
+    std::vector<int> members_;
+    std::vector<int> slots_;   // Event index of each value in the group read
+};
+
+#endif // __linux__
+
+struct Probe {
+    bool available = false;
+    std::string reason;
+};
+
+// Tried once per process so that threads in a container without perf
+// events do not each retry the syscall
+const Probe& probe() {
+    static const Probe result = [] {
+        Probe p;
+#ifdef __linux__
+        int fd = openEvent(kEvents[0], -1);
+        if (fd >= 0) {
+            close(fd);
+            p.available = true;
+        } else {
+            p.reason = describeError(errno);
+        }
+#else
+        p.reason = "hardware counters need Linux perf events";
+#endif
+        return p;
+    }();
+    return result;
+}
+
+} // namespace
+
+CounterSample& CounterSample::operator+=(const CounterSample& other) {
+    cycles += other.cycles;
+    instructions += other.instructions;
+    l1d_misses += other.l1d_misses;
+    llc_misses += other.llc_misses;
+    branch_misses += other.branch_misses;
+    return *this;
+}
+
+CounterSample CounterSample::operator-(const CounterSample& other) const {
+    // Multiplexing estimates can step backwards slightly; clamp at zero
+    auto delta = [](uint64_t a, uint64_t b) { return a > b ? a - b : 0; };
+    CounterSample result;
+    result.cycles = delta(cycles, other.cycles);
+    result.instructions = delta(instructions, other.instructions);
+    result.l1d_misses = delta(l1d_misses, other.l1d_misses);
+    result.llc_misses = delta(llc_misses, other.llc_misses);
+    result.branch_misses = delta(branch_misses, other.branch_misses);
+    return result;
+}
+
+bool perfCountersAvailable() {
+    return probe().available;
+}
+
+std::string perfCountersUnavailableReason() {
+    return probe().reason;
+}
+
+CounterSample readThreadCounters() {
+#ifdef __linux__
+    if (!probe().available) {
+        return CounterSample();
+    }
+    thread_local ThreadCounters counters;
+    return counters.read();
+#else
+    return CounterSample();
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// StageProfiler
+
+class StageProfiler::Impl {
+public:
+    mutable std::mutex mutex_;
+    std::map<std::string, CounterSample> totals_;
+};
+
+StageProfiler::StageProfiler() : pImpl(std::make_unique<Impl>()) {}
+StageProfiler::~StageProfiler() = default;
+
+StageProfiler::Scope::Scope(StageProfiler* profiler, const char* stage)
+    : profiler_(profiler && perfCountersAvailable() ? profiler : nullptr), stage_(stage) {
+    if (profiler_) {
+        start_ = readThreadCounters();
+    }
+}
+
+StageProfiler::Scope::~Scope() {
+    if (profiler_) {
+        profiler_->add(stage_, readThreadCounters() - start_);
+    }
+}
+
+bool StageProfiler::isAvailable() const {
+    return perfCountersAvailable();
+}
+
+void StageProfiler::add(const std::string& stage, const CounterSample& delta) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->totals_[stage] += delta;
+}
+
+CounterSample StageProfiler::getTotals(const std::string& stage) const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    auto it = pImpl->totals_.find(stage);
+    return it == pImpl->totals_.end() ? CounterSample() : it->second;
+}
+
+std::map<std::string, float> StageProfiler::getMetrics() const {
+    std::map<std::string, float> metrics;
+    metrics["perf_counters"] = isAvailable() ? 1.0f : 0.0f;
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    for (const auto& entry : pImpl->totals_) {
+        const CounterSample& t = entry.second;
+        const std::string prefix = "perf_" + entry.first + "_";
+        metrics[prefix + "gcycles"] = static_cast<float>(t.cycles / 1e9);
+        if (t.cycles > 0 && t.instructions > 0) {
+            metrics[prefix + "ipc"] = static_cast<float>(static_cast<double>(t.instructions) / t.cycles);
+        }
+        if (t.instructions > 0) {
+            const double kilo_instructions = t.instructions / 1000.0;
+            const std::pair<const char*, uint64_t> misses[] = {
+                {"l1d_mpki", t.l1d_misses}, {"llc_mpki", t.llc_misses}, {"branch_mpki", t.branch_misses}};
+            for (int m = 0; m < 3; ++m) {
+                if (eventOpened(2 + m)) {
+                    metrics[prefix + misses[m].first] = static_cast<float>(misses[m].second / kilo_instructions);
+                }
+            }
+        }
+    }
+    return metrics;
+}
+
+void StageProfiler::reset() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->totals_.clear();
+}
+
+} // namespace ufra
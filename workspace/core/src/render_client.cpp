@@ -0,0 +1,386 @@
+#include "ufra/render_service.h"
+#include "render_protocol.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace ufra {
+namespace service {
+
+class RenderClient::Impl {
+public:
+    ~Impl() { disconnect(); }
+
+    bool connect(const std::string& path) {
+        disconnect();
+        const std::string socket_path = path.empty() ? defaultSocketPath() : path;
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (socket_path.size() >= sizeof(address.sun_path)) {
+            last_error_ = "socket path too long: " + socket_path;
+            return false;
+        }
+        std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+        fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (fd_ < 0 || ::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            last_error_ = "cannot connect to render service at " + socket_path + ": " + std::strerror(errno);
+            disconnect();
+            return false;
+        }
+        return true;
+    }
+
+    void disconnect() {
+        if (fd_ >= 0) {
+            requests_.close();
+            close(fd_);
+            fd_ = -1;
+        }
+        buffer_.reset();
+        requests_.reset();
+        results_.reset();
+        acquired_ = nullptr;
+        holding_result_ = false;
+        in_flight_ = 0;
+    }
+
+    // Replaces the shared buffer when a frame outgrows it
+    bool ensureBuffer(size_t frame_bytes) {
+        const size_t required = SharedBuffer::requiredBytes(frame_bytes);
+        if (buffer_.size() >= required) {
+            return true;
+        }
+        SharedBuffer buffer;
+        if (!buffer.create(required, last_error_)) {
+            return false;
+        }
+        Message request;
+        request.type = MessageType::MAP_BUFFER;
+        request.buffer_bytes = required;
+        Message reply;
+        if (!roundTrip(request, buffer.fd(), reply)) {
+            return false;
+        }
+        if (!reply.success) {
+            last_error_ = reply.error;
+            return false;
+        }
+        buffer_.swap(buffer);
+        return true;
+    }
+
+    bool roundTrip(Message& request, int pass_fd, Message& reply) {
+        if (fd_ < 0) {
+            last_error_ = "not connected to a render service";
+            return false;
+        }
+        if (requests_.fd() >= 0) {
+            last_error_ = "buffer requests are unavailable while a stream is open";
+            return false;
+        }
+        request.sequence = ++sequence_;
+        if (!sendMessage(fd_, request, pass_fd) || !receiveMessage(fd_, reply)) {
+            last_error_ = "render service connection lost";
+            disconnect();
+            return false;
+        }
+        if (reply.type != MessageType::RESULT || reply.sequence != request.sequence) {
+            last_error_ = "unexpected reply from render service";
+            disconnect();
+            return false;
+        }
+        return true;
+    }
+
+    FrameView inputBuffer(int width, int height, int channels) {
+        if (width <= 0 || height <= 0 || channels <= 0) {
+            last_error_ = "invalid frame size";
+            return FrameView();
+        }
+        const size_t stride = static_cast<size_t>(width) * channels;
+        if (!ensureBuffer(stride * height)) {
+            return FrameView();
+        }
+        return FrameView{buffer_.data(), width, height, channels, stride};
+    }
+
+    bool render(const FrameView& input, const JobSettings& settings, FrameView& output,
+                std::map<std::string, float>* metrics) {
+        const auto start = std::chrono::steady_clock::now();
+        FrameView shared = inputBuffer(input.width, input.height, input.channels);
+        if (shared.empty() || input.empty()) {
+            return false;
+        }
+        if (input.data != shared.data) {
+            const size_t row = shared.stride;
+            for (int y = 0; y < input.height; ++y) {
+                std::memcpy(shared.data + y * row, input.data + y * input.stride, row);
+            }
+        }
+
+        Message request;
+        request.type = MessageType::RENDER;
+        request.width = shared.width;
+        request.height = shared.height;
+        request.channels = shared.channels;
+        request.stride = static_cast<uint32_t>(shared.stride);
+        request.settings = settings;
+        Message reply;
+        if (!roundTrip(request, -1, reply)) {
+            return false;
+        }
+        if (metrics) {
+            unpackMetrics(reply, *metrics);
+            // What running out of process costs on top of queueing and
+            // rendering: the input copy, two socket messages and wake-ups
+            const float round_trip_ms =
+                std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            (*metrics)["client_round_trip_ms"] = round_trip_ms;
+            (*metrics)["transport_overhead_ms"] =
+                round_trip_ms - (*metrics)["server_queue_ms"] - (*metrics)["server_processing_ms"];
+        }
+        if (!reply.success) {
+            last_error_ = reply.error;
+            return false;
+        }
+        output = shared;
+        output.data = buffer_.data() + SharedBuffer::outputOffset(shared.bytes());
+        return true;
+    }
+
+    bool openStream(int depth, size_t max_frame_bytes) {
+        if (fd_ < 0) {
+            last_error_ = "not connected to a render service";
+            return false;
+        }
+        if (requests_.fd() >= 0) {
+            last_error_ = "stream already open";
+            return false;
+        }
+        if (depth <= 0 || max_frame_bytes == 0 || !requests_.create(static_cast<size_t>(depth), max_frame_bytes)) {
+            last_error_ = depth <= 0 || max_frame_bytes == 0 ? "invalid stream geometry" : requests_.getLastError();
+            return false;
+        }
+
+        Message request;
+        request.type = MessageType::OPEN_STREAM;
+        request.sequence = ++sequence_;
+        Message reply;
+        int result_fd = -1;
+        if (!sendMessage(fd_, request, requests_.fd()) || !receiveMessage(fd_, reply, &result_fd)) {
+            last_error_ = "render service connection lost";
+            disconnect();
+            return false;
+        }
+        if (reply.type != MessageType::RESULT || reply.sequence != request.sequence || !reply.success ||
+            result_fd < 0) {
+            last_error_ = reply.error[0] ? reply.error : "render service refused the stream";
+            if (result_fd >= 0) {
+                close(result_fd);
+            }
+            requests_.reset();
+            return false;
+        }
+        if (!results_.attach(result_fd, FrameRing::Role::CONSUMER)) {
+            last_error_ = results_.getLastError();
+            requests_.close();
+            requests_.reset();
+            return false;
+        }
+        depth_ = depth;
+        return true;
+    }
+
+    FrameView streamInputBuffer(int width, int height, int channels) {
+        if (requests_.fd() < 0) {
+            last_error_ = "no stream open";
+            return FrameView();
+        }
+        const size_t stride = static_cast<size_t>(std::max(width, 0)) * std::max(channels, 0);
+        if (width <= 0 || height <= 0 || channels <= 0 || stride * height > requests_.slotBytes()) {
+            last_error_ = "frame does not fit the stream slots";
+            return FrameView();
+        }
+        if (!acquired_) {
+            if (in_flight_ >= depth_) {
+                last_error_ = "stream is full; receive a result first";
+                return FrameView();
+            }
+            // Results are bounded by depth, so the server holds at most
+            // depth request slots and this never waits
+            acquired_ = requests_.acquire(0);
+            if (!acquired_) {
+                last_error_ = requests_.getLastError();
+                return FrameView();
+            }
+        }
+        return FrameView{acquired_, width, height, channels, stride};
+    }
+
+    bool submit(const FrameView& input, const JobSettings& settings) {
+        if (input.empty()) {
+            last_error_ = "empty frame";
+            return false;
+        }
+        FrameView slot = streamInputBuffer(input.width, input.height, input.channels);
+        if (slot.empty()) {
+            return false;
+        }
+        if (input.data != slot.data) {
+            for (int y = 0; y < input.height; ++y) {
+                std::memcpy(slot.data + y * slot.stride, input.data + y * input.stride, slot.stride);
+            }
+        }
+
+        Message request;
+        request.type = MessageType::RENDER;
+        request.sequence = ++sequence_;
+        request.width = slot.width;
+        request.height = slot.height;
+        request.channels = slot.channels;
+        request.stride = static_cast<uint32_t>(slot.stride);
+        request.settings = settings;
+        RingSlot header;
+        storeInSlot(request, header);
+        if (!requests_.publish(header)) {
+            last_error_ = requests_.getLastError();
+            return false;
+        }
+        acquired_ = nullptr;
+        in_flight_++;
+        return true;
+    }
+
+    bool receive(FrameView& output, std::map<std::string, float>* metrics, int timeout_ms) {
+        if (in_flight_ == 0) {
+            last_error_ = "no frame in flight";
+            return false;
+        }
+        if (holding_result_) {
+            results_.release();
+            holding_result_ = false;
+        }
+
+        // Waits in slices so a crashed server is noticed: in stream mode
+        // the socket only ever becomes readable on hang-up
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        RingSlot header;
+        const uint8_t* data = nullptr;
+        for (;;) {
+            int slice = 100;
+            if (timeout_ms >= 0) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                slice = static_cast<int>(std::max<long long>(0, std::min<long long>(slice, left)));
+            }
+            if (results_.receive(header, data, slice)) {
+                break;
+            }
+            pollfd hangup{fd_, POLLIN | POLLRDHUP, 0};
+            if (results_.isClosed() || poll(&hangup, 1, 0) != 0) {
+                last_error_ = "render service connection lost";
+                disconnect();
+                return false;
+            }
+            if (timeout_ms >= 0 && std::chrono::steady_clock::now() >= deadline) {
+                last_error_ = "timed out waiting for a result";
+                return false;
+            }
+        }
+        holding_result_ = true;
+        in_flight_--;
+
+        Message reply;
+        if (!loadFromSlot(header, reply)) {
+            last_error_ = "malformed result from render service";
+            return false;
+        }
+        if (metrics) {
+            unpackMetrics(reply, *metrics);
+        }
+        if (!reply.success) {
+            last_error_ = reply.error;
+            return false;
+        }
+        const size_t frame_bytes = static_cast<size_t>(reply.stride) * std::max(reply.height, 0);
+        if (reply.width <= 0 || reply.channels <= 0 || frame_bytes > results_.slotBytes()) {
+            last_error_ = "malformed result from render service";
+            return false;
+        }
+        output = FrameView{const_cast<uint8_t*>(data), reply.width, reply.height, reply.channels, reply.stride};
+        return true;
+    }
+
+    int fd_ = -1;
+    SharedBuffer buffer_;
+    FrameRing requests_;               // Client produces
+    FrameRing results_;                // Server produces, mapped read-only here
+    uint8_t* acquired_ = nullptr;      // Request slot handed out by streamInputBuffer()
+    bool holding_result_ = false;
+    int depth_ = 0;
+    int in_flight_ = 0;
+    uint64_t sequence_ = 0;
+    std::string last_error_;
+};
+
+RenderClient::RenderClient() : pImpl(std::make_unique<Impl>()) {}
+RenderClient::~RenderClient() = default;
+
+bool RenderClient::connect(const std::string& socket_path) {
+    return pImpl->connect(socket_path);
+}
+
+void RenderClient::disconnect() {
+    pImpl->disconnect();
+}
+
+bool RenderClient::isConnected() const {
+    return pImpl->fd_ >= 0;
+}
+
+FrameView RenderClient::inputBuffer(int width, int height, int channels) {
+    return pImpl->inputBuffer(width, height, channels);
+}
+
+bool RenderClient::render(const FrameView& input, const JobSettings& settings, FrameView& output,
+                          std::map<std::string, float>* metrics) {
+    return pImpl->render(input, settings, output, metrics);
+}
+
+bool RenderClient::openStream(int depth, size_t max_frame_bytes) {
+    return pImpl->openStream(depth, max_frame_bytes);
+}
+
+bool RenderClient::isStreaming() const {
+    return pImpl->requests_.fd() >= 0 && pImpl->results_.fd() >= 0;
+}
+
+int RenderClient::inFlight() const {
+    return pImpl->in_flight_;
+}
+
+FrameView RenderClient::streamInputBuffer(int width, int height, int channels) {
+    return pImpl->streamInputBuffer(width, height, channels);
+}
+
+bool RenderClient::submit(const FrameView& input, const JobSettings& settings) {
+    return pImpl->submit(input, settings);
+}
+
+bool RenderClient::receive(FrameView& output, std::map<std::string, float>* metrics, int timeout_ms) {
+    return pImpl->receive(output, metrics, timeout_ms);
+}
+
+const std::string& RenderClient::getLastError() const {
+    return pImpl->last_error_;
+}
+
+} // namespace service
+} // namespace ufra
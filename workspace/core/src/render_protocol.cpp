@@ -0,0 +1,195 @@
+#include "render_protocol.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <utility>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace ufra {
+namespace service {
+
+std::string defaultSocketPath() {
+    if (const char* path = std::getenv("UFRA_SOCKET")) {
+        return path;
+    }
+    if (const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR")) {
+        return std::string(runtime_dir) + "/ufra.sock";
+    }
+    return "/tmp/ufra-" + std::to_string(getuid()) + ".sock";
+}
+
+bool sendMessage(int socket_fd, const Message& message, int pass_fd) {
+    iovec iov{const_cast<Message*>(&message), sizeof(Message)};
+    msghdr header{};
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    if (pass_fd >= 0) {
+        header.msg_control = control;
+        header.msg_controllen = sizeof(control);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&header);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &pass_fd, sizeof(int));
+    }
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(socket_fd, &header, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    return sent == static_cast<ssize_t>(sizeof(Message));
+}
+
+bool receiveMessage(int socket_fd, Message& message, int* received_fd) {
+    iovec iov{&message, sizeof(Message)};
+    msghdr header{};
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+
+    ssize_t received;
+    do {
+        received = recvmsg(socket_fd, &header, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+
+    int fd = -1;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+    if (received_fd) {
+        *received_fd = fd;
+    } else if (fd >= 0) {
+        close(fd);
+    }
+
+    if (received != static_cast<ssize_t>(sizeof(Message)) || message.magic != kProtocolMagic) {
+        if (received_fd && *received_fd >= 0) {
+            close(*received_fd);
+            *received_fd = -1;
+        }
+        return false;
+    }
+    message.error[sizeof(message.error) - 1] = '\0';
+    return true;
+}
+
+void storeInSlot(const Message& message, RingSlot& slot) {
+    std::memcpy(slot.meta, &message, sizeof(Message));
+    slot.meta_bytes = sizeof(Message);
+    slot.sequence = message.sequence;
+    slot.width = message.width;
+    slot.height = message.height;
+    slot.channels = message.channels;
+    slot.stride = message.stride;
+}
+
+bool loadFromSlot(const RingSlot& slot, Message& message) {
+    if (slot.meta_bytes != sizeof(Message)) {
+        return false;
+    }
+    std::memcpy(&message, slot.meta, sizeof(Message));
+    if (message.magic != kProtocolMagic) {
+        return false;
+    }
+    message.error[sizeof(message.error) - 1] = '\0';
+    return true;
+}
+
+void packMetrics(const std::map<std::string, float>& metrics, Message& message) {
+    message.metric_count = 0;
+    for (const auto& entry : metrics) {
+        if (message.metric_count == kMaxMetrics) {
+            break;
+        }
+        MetricEntry& out = message.metrics[message.metric_count++];
+        std::strncpy(out.name, entry.first.c_str(), sizeof(out.name) - 1);
+        out.name[sizeof(out.name) - 1] = '\0';
+        out.value = entry.second;
+    }
+}
+
+void unpackMetrics(const Message& message, std::map<std::string, float>& metrics) {
+    const uint32_t count = message.metric_count < kMaxMetrics ? message.metric_count : kMaxMetrics;
+    for (uint32_t i = 0; i < count; ++i) {
+        std::string name(message.metrics[i].name, strnlen(message.metrics[i].name, sizeof(message.metrics[i].name)));
+        metrics[name] = message.metrics[i].value;
+    }
+}
+
+void setError(Message& message, const std::string& error) {
+    std::strncpy(message.error, error.c_str(), sizeof(message.error) - 1);
+    message.error[sizeof(message.error) - 1] = '\0';
+}
+
+// ---------------------------------------------------------------------------
+// SharedBuffer
+
+SharedBuffer::~SharedBuffer() {
+    reset();
+}
+
+bool SharedBuffer::create(size_t bytes, std::string& error) {
+    reset();
+    int fd = memfd_create("ufra-frames", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        error = std::string("memfd_create failed: ") + std::strerror(errno);
+        return false;
+    }
+    // Sealed so the peer can map it without risking SIGBUS from a truncate
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0 ||
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_SEAL) != 0) {
+        error = std::string("cannot size shared buffer: ") + std::strerror(errno);
+        close(fd);
+        return false;
+    }
+    return map(fd, bytes, error);
+}
+
+bool SharedBuffer::map(int fd, size_t bytes, std::string& error) {
+    reset();
+    void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        error = std::string("mmap failed: ") + std::strerror(errno);
+        close(fd);
+        return false;
+    }
+    data_ = static_cast<uint8_t*>(data);
+    size_ = bytes;
+    fd_ = fd;
+    return true;
+}
+
+void SharedBuffer::reset() {
+    if (data_) {
+        munmap(data_, size_);
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    fd_ = -1;
+}
+
+void SharedBuffer::swap(SharedBuffer& other) {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(fd_, other.fd_);
+}
+
+size_t SharedBuffer::outputOffset(size_t frame_bytes) {
+    const size_t page = 4096;
+    return (frame_bytes + page - 1) / page * page;
+}
+
+} // namespace service
+} // namespace ufra
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "ufra/frame_ring.h"
+#include "ufra/render_service.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ufra {
+namespace service {
+
+// Wire format shared by RenderServer and RenderClient. Messages are fixed
+// size and sent over SOCK_SEQPACKET, which keeps message boundaries and can
+// carry a file descriptor (SCM_RIGHTS) alongside.
+
+constexpr uint32_t kProtocolMagic = 0x55465241;   // "UFRA"
+constexpr int kMaxMetrics = 24;
+
+enum class MessageType : uint32_t {
+    MAP_BUFFER = 1,   // Client -> server, carries the shared memory fd
+    RENDER,           // Client -> server, frame is in the input region
+    RESULT,           // Server -> client, frame is in the output region
+    OPEN_STREAM       // Client -> server, carries the request ring fd; the
+                      // reply carries the result ring fd
+};
+
+struct MetricEntry {
+    char name[40];
+    float value;
+};
+
+struct Message {
+    uint32_t magic = kProtocolMagic;
+    MessageType type = MessageType::RENDER;
+    uint64_t sequence = 0;
+
+    uint64_t buffer_bytes = 0;    // MAP_BUFFER
+
+    int32_t width = 0;            // RENDER
+    int32_t height = 0;
+    int32_t channels = 0;
+    uint32_t stride = 0;
+    JobSettings settings;
+
+    int32_t success = 0;          // RESULT
+    uint32_t metric_count = 0;
+    MetricEntry metrics[kMaxMetrics];
+    char error[128] = {};
+};
+
+// Streamed frames carry their Message in the ring slot instead of the socket
+static_assert(sizeof(Message) <= kRingMetaBytes, "Message must fit a ring slot");
+
+bool sendMessage(int socket_fd, const Message& message, int pass_fd = -1);
+// False on disconnect or a malformed message. A received fd is returned in
+// `received_fd` (caller owns it), else -1.
+bool receiveMessage(int socket_fd, Message& message, int* received_fd = nullptr);
+
+// Stores or loads a Message in a ring slot's meta area
+void storeInSlot(const Message& message, RingSlot& slot);
+bool loadFromSlot(const RingSlot& slot, Message& message);
+
+void packMetrics(const std::map<std::string, float>& metrics, Message& message);
+void unpackMetrics(const Message& message, std::map<std::string, float>& metrics);
+void setError(Message& message, const std::string& error);
+
+// memfd-backed mapping. The client creates it (sealed against shrinking),
+// the server maps the same fd.
+// Frames live at fixed offsets: input at 0, output at outputOffset().
+class SharedBuffer {
+public:
+    SharedBuffer() = default;
+    ~SharedBuffer();
+    SharedBuffer(const SharedBuffer&) = delete;
+    SharedBuffer& operator=(const SharedBuffer&) = delete;
+
+    bool create(size_t bytes, std::string& error);
+    bool map(int fd, size_t bytes, std::string& error);   // Takes ownership of fd
+    void reset();
+    void swap(SharedBuffer& other);
+
+    uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    int fd() const { return fd_; }
+
+    static size_t outputOffset(size_t frame_bytes);
+    static size_t requiredBytes(size_t frame_bytes) { return 2 * outputOffset(frame_bytes); }
+
+private:
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    int fd_ = -1;
+};
+
+} // namespace service
+} // namespace ufra
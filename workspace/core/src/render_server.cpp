@@ -0,0 +1,560 @@
+#include "ufra/render_service.h"
+#include "render_protocol.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace ufra {
+namespace service {
+
+namespace {
+
+bool makeAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// A client may not shrink the buffer under the server's mapping, or reads
+// past the new end would fault the whole service
+bool sealedAgainstShrinking(int fd, size_t bytes) {
+    struct stat info;
+    const int seals = fcntl(fd, F_GET_SEALS);
+    return seals >= 0 && (seals & F_SEAL_SHRINK) && fstat(fd, &info) == 0 &&
+           static_cast<size_t>(info.st_size) >= bytes;
+}
+
+// Bytes covered by the frame a RENDER message describes; 0 if malformed
+size_t frameBytes(const Message& request) {
+    const bool valid = request.width > 0 && request.height > 0 &&
+                       (request.channels == 1 || request.channels == 3 || request.channels == 4) &&
+                       request.stride >= static_cast<size_t>(request.width) * request.channels;
+    return valid ? static_cast<size_t>(request.stride) * request.height : 0;
+}
+
+// How often a streaming connection checks for hang-up and shutdown
+constexpr int kStreamPollMs = 50;
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+class RenderServer::Impl {
+public:
+    struct Connection {
+        uint64_t id = 0;
+        int fd = -1;
+        SharedBuffer buffer;
+        std::atomic<bool> busy{false};   // A job is queued; the buffer must stay mapped as is
+        std::mutex send_mutex;
+        // Stream mode: requests are received on the connection thread and
+        // released by the scheduler, which alone produces results
+        FrameRing requests;
+        FrameRing results;
+
+        ~Connection() {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        bool send(const Message& message, int pass_fd = -1) {
+            std::lock_guard<std::mutex> lock(send_mutex);
+            return sendMessage(fd, message, pass_fd);
+        }
+    };
+
+    struct Pending {
+        std::shared_ptr<Connection> connection;
+        uint64_t sequence = 0;
+        RenderJob job;
+        std::chrono::steady_clock::time_point queued;
+        bool streamed = false;
+    };
+
+    bool start(const ServerOptions& options, BatchHandler handler) {
+        options_ = options;
+        options_.max_batch = std::max(1, options_.max_batch);
+        options_.batch_window_us = std::max(0, options_.batch_window_us);
+        socket_path_ = options.socket_path.empty() ? defaultSocketPath() : options.socket_path;
+        handler_ = std::move(handler);
+
+        sockaddr_un address;
+        if (!makeAddress(socket_path_, address)) {
+            std::cerr << "Invalid render service socket path: " << socket_path_ << std::endl;
+            return false;
+        }
+
+        // A socket file nobody answers on is left over from a crashed server
+        int probe = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (probe >= 0) {
+            bool live = ::connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+            close(probe);
+            if (live) {
+                std::cerr << "Render service already running at " << socket_path_ << std::endl;
+                return false;
+            }
+        }
+        unlink(socket_path_.c_str());
+
+        listen_fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0 ||
+            bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            chmod(socket_path_.c_str(), 0600) != 0 || listen(listen_fd_, 64) != 0) {
+            std::cerr << "Failed to listen on " << socket_path_ << ": " << std::strerror(errno) << std::endl;
+            if (listen_fd_ >= 0) {
+                close(listen_fd_);
+                listen_fd_ = -1;
+            }
+            return false;
+        }
+
+        stopping_ = false;
+        running_ = true;
+        scheduler_thread_ = std::thread([this] { schedule(); });
+        accept_thread_ = std::thread([this] { acceptClients(); });
+        return true;
+    }
+
+    void stop() {
+        if (!running_) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            stopping_ = true;
+        }
+        queue_cv_.notify_all();
+
+        // shutdown() wakes the threads blocked in accept() and recvmsg()
+        shutdown(listen_fd_, SHUT_RDWR);
+        accept_thread_.join();
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            for (auto& entry : connections_) {
+                shutdown(entry.connection->fd, SHUT_RDWR);
+            }
+        }
+        for (auto& entry : connections_) {
+            entry.thread.join();
+        }
+        connections_.clear();
+        scheduler_thread_.join();
+        queue_.clear();
+
+        close(listen_fd_);
+        listen_fd_ = -1;
+        unlink(socket_path_.c_str());
+        running_ = false;
+    }
+
+    void acceptClients() {
+        for (;;) {
+            int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                return;   // Listening socket shut down
+            }
+
+            auto connection = std::make_shared<Connection>();
+            connection->id = ++next_client_id_;
+            connection->fd = fd;
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            reapFinished();
+            if (stopping_) {
+                return;
+            }
+            connections_.push_back({connection, std::thread([this, connection] { serve(connection); })});
+        }
+    }
+
+    // Joins threads of clients that have disconnected. Requires connections_mutex_.
+    void reapFinished() {
+        for (auto it = connections_.begin(); it != connections_.end();) {
+            if (std::find(finished_.begin(), finished_.end(), it->connection->id) != finished_.end()) {
+                it->thread.join();
+                it = connections_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        finished_.clear();
+    }
+
+    void serve(std::shared_ptr<Connection> connection) {
+        Message request;
+        int fd = -1;
+        while (receiveMessage(connection->fd, request, &fd)) {
+            Message reply;
+            reply.type = MessageType::RESULT;
+            reply.sequence = request.sequence;
+
+            if (request.type == MessageType::MAP_BUFFER) {
+                std::string error;
+                if (fd < 0 || connection->busy) {
+                    setError(reply, "buffer update without a descriptor or while a job is queued");
+                } else if (!sealedAgainstShrinking(fd, request.buffer_bytes)) {
+                    setError(reply, "shared buffer must be sealed against shrinking");
+                } else {
+                    const int owned = fd;
+                    fd = -1;   // map() takes ownership either way
+                    if (connection->buffer.map(owned, request.buffer_bytes, error)) {
+                        reply.success = 1;
+                    } else {
+                        setError(reply, error);
+                    }
+                }
+                if (fd >= 0) {
+                    close(fd);
+                    fd = -1;
+                }
+                connection->send(reply);
+                continue;
+            }
+            if (request.type == MessageType::OPEN_STREAM) {
+                const int owned = fd;
+                fd = -1;
+                if (openStream(*connection, owned, reply)) {
+                    streamFrames(connection);
+                    break;
+                }
+                connection->send(reply);
+                continue;
+            }
+            if (fd >= 0) {
+                close(fd);
+                fd = -1;
+            }
+
+            if (request.type != MessageType::RENDER || !enqueue(connection, request, reply)) {
+                if (!reply.error[0]) {
+                    setError(reply, "unexpected message");
+                }
+                connection->send(reply);
+            }
+        }
+
+        // The connection object lives on while a queued job still refers to it
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        finished_.push_back(connection->id);
+    }
+
+    // Attaches the client's request ring and answers with a result ring one
+    // slot deeper, so a client holding its latest result never stalls the
+    // scheduler. Takes ownership of fd.
+    bool openStream(Connection& connection, int fd, Message& reply) {
+        if (fd < 0 || connection.busy) {
+            if (fd >= 0) {
+                close(fd);
+            }
+            setError(reply, "stream request without a descriptor or while a job is queued");
+            return false;
+        }
+        if (!connection.requests.attach(fd, FrameRing::Role::CONSUMER)) {
+            setError(reply, connection.requests.getLastError());
+            return false;
+        }
+        if (!connection.results.create(connection.requests.slotCount() + 1, connection.requests.slotBytes())) {
+            setError(reply, connection.results.getLastError());
+            connection.requests.reset();
+            return false;
+        }
+        reply.success = 1;
+        if (!connection.send(reply, connection.results.fd())) {
+            connection.requests.reset();
+            connection.results.reset();
+            return false;
+        }
+        return true;
+    }
+
+    // Queues frames as they are published into the request ring. The socket
+    // carries nothing more in stream mode; it is only watched for hang-up.
+    void streamFrames(const std::shared_ptr<Connection>& connection) {
+        open_streams_++;
+        while (!stopping_) {
+            RingSlot header;
+            const uint8_t* data = nullptr;
+            if (connection->requests.receive(header, data, kStreamPollMs)) {
+                enqueueStreamed(connection, header, data);
+                continue;
+            }
+            pollfd hangup{connection->fd, POLLIN | POLLRDHUP, 0};
+            if (connection->requests.isClosed() || poll(&hangup, 1, 0) != 0) {
+                break;
+            }
+        }
+        connection->requests.close();
+        connection->results.close();
+        open_streams_--;
+    }
+
+    void enqueueStreamed(const std::shared_ptr<Connection>& connection, const RingSlot& header,
+                         const uint8_t* data) {
+        Pending pending;
+        pending.connection = connection;
+        pending.queued = std::chrono::steady_clock::now();
+        pending.streamed = true;
+        Message request;
+        if (!loadFromSlot(header, request)) {
+            pending.job.error = "malformed stream request";
+        } else {
+            pending.sequence = request.sequence;
+            const size_t frame_bytes = frameBytes(request);
+            if (frame_bytes == 0 || frame_bytes > connection->requests.slotBytes()) {
+                pending.job.error = "frame does not fit the stream slots";
+            }
+        }
+        RenderJob& job = pending.job;
+        job.client_id = connection->id;
+        job.settings = request.settings;
+        if (job.error.empty()) {
+            // The request ring is mapped read-only; handlers only read `input`
+            job.input = FrameView{const_cast<uint8_t*>(data), request.width, request.height, request.channels,
+                                  request.stride};
+            job.output = job.input;
+            job.output.data = nullptr;   // Result slot is acquired when the batch runs
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            queue_.push_back(std::move(pending));
+        }
+        queue_cv_.notify_all();
+    }
+
+    bool enqueue(const std::shared_ptr<Connection>& connection, const Message& request, Message& reply) {
+        const size_t frame_bytes = frameBytes(request);
+        if (frame_bytes == 0 || SharedBuffer::requiredBytes(frame_bytes) > connection->buffer.size()) {
+            setError(reply, "frame does not fit the shared buffer");
+            return false;
+        }
+        if (connection->busy.exchange(true)) {
+            setError(reply, "a frame from this client is already queued");
+            return false;
+        }
+
+        Pending pending;
+        pending.connection = connection;
+        pending.sequence = request.sequence;
+        pending.queued = std::chrono::steady_clock::now();
+        RenderJob& job = pending.job;
+        job.client_id = connection->id;
+        job.settings = request.settings;
+        job.input = FrameView{connection->buffer.data(), request.width, request.height, request.channels,
+                              request.stride};
+        job.output = job.input;
+        job.output.data = connection->buffer.data() + SharedBuffer::outputOffset(frame_bytes);
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            queue_.push_back(std::move(pending));
+        }
+        queue_cv_.notify_all();
+        return true;
+    }
+
+    // Single consumer: gathers jobs from all clients into batches, so faces
+    // from concurrent clients share network passes in the handler
+    void schedule() {
+        const auto window = std::chrono::microseconds(options_.batch_window_us);
+        const size_t max_batch = static_cast<size_t>(options_.max_batch);
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        for (;;) {
+            queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            queue_cv_.wait_until(lock, queue_.front().queued + window,
+                                 [&] { return stopping_ || queue_.size() >= max_batch; });
+            if (stopping_) {
+                return;
+            }
+
+            std::vector<Pending> batch;
+            while (!queue_.empty() && batch.size() < max_batch) {
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+            lock.unlock();
+            runBatch(batch);
+            lock.lock();
+        }
+    }
+
+    void runBatch(std::vector<Pending>& batch) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<RenderJob*> jobs;
+        std::vector<bool> dropped(batch.size(), false);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            Pending& pending = batch[i];
+            if (pending.streamed) {
+                // Never waits for a client within its depth; one that is
+                // not draining results loses its stream instead of
+                // stalling every other client
+                uint8_t* slot = pending.connection->results.acquire(0);
+                if (!slot) {
+                    dropped[i] = true;
+                    continue;
+                }
+                pending.job.output.data = slot;
+            }
+            if (pending.job.error.empty()) {
+                jobs.push_back(&pending.job);
+            }
+        }
+        try {
+            if (!jobs.empty()) {
+                handler_(jobs);
+            }
+        }
+        catch (const std::exception& e) {
+            for (RenderJob* job : jobs) {
+                job->success = false;
+                job->error = std::string("render handler failed: ") + e.what();
+            }
+        }
+        const float processing_ms = static_cast<float>(millisecondsSince(start));
+
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            jobs_ += batch.size();
+            batches_ += 1;
+            max_batch_size_ = std::max(max_batch_size_, batch.size());
+        }
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            Pending& pending = batch[i];
+            Message reply;
+            reply.type = MessageType::RESULT;
+            reply.sequence = pending.sequence;
+            reply.success = pending.job.success ? 1 : 0;
+            setError(reply, pending.job.error);
+            auto metrics = pending.job.metrics;
+            metrics["server_batch_size"] = static_cast<float>(batch.size());
+            metrics["server_queue_ms"] =
+                std::chrono::duration<float, std::milli>(start - pending.queued).count();
+            metrics["server_processing_ms"] = processing_ms;
+            packMetrics(metrics, reply);
+
+            Connection& connection = *pending.connection;
+            if (!pending.streamed) {
+                connection.busy = false;
+                connection.send(reply);
+                continue;
+            }
+            // The input slot is released before the result is published, so
+            // a client that just received its result can always submit again
+            connection.requests.release();
+            if (dropped[i]) {
+                connection.results.close();
+                continue;
+            }
+            reply.width = pending.job.output.width;
+            reply.height = pending.job.output.height;
+            reply.channels = pending.job.output.channels;
+            reply.stride = static_cast<uint32_t>(pending.job.output.stride);
+            RingSlot header;
+            storeInSlot(reply, header);
+            connection.results.publish(header);
+        }
+    }
+
+    std::map<std::string, float> getStats() const {
+        std::map<std::string, float> stats;
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            stats["clients"] = static_cast<float>(connections_.size() - finished_.size());
+        }
+        stats["streams"] = static_cast<float>(open_streams_.load());
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats["jobs"] = static_cast<float>(jobs_);
+        stats["batches"] = static_cast<float>(batches_);
+        stats["mean_batch_size"] = batches_ ? static_cast<float>(jobs_) / batches_ : 0.0f;
+        stats["max_batch_size"] = static_cast<float>(max_batch_size_);
+        return stats;
+    }
+
+    struct ClientThread {
+        std::shared_ptr<Connection> connection;
+        std::thread thread;
+    };
+
+    ServerOptions options_;
+    std::string socket_path_;
+    BatchHandler handler_;
+    int listen_fd_ = -1;
+    std::atomic<bool> running_{false};
+    uint64_t next_client_id_ = 0;
+
+    std::thread accept_thread_;
+    std::thread scheduler_thread_;
+    mutable std::mutex connections_mutex_;
+    std::list<ClientThread> connections_;
+    std::vector<uint64_t> finished_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<Pending> queue_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<int> open_streams_{0};
+
+    mutable std::mutex stats_mutex_;
+    size_t jobs_ = 0;
+    size_t batches_ = 0;
+    size_t max_batch_size_ = 0;
+};
+
+RenderServer::RenderServer() : pImpl(std::make_unique<Impl>()) {}
+
+RenderServer::~RenderServer() {
+    stop();
+}
+
+bool RenderServer::start(const ServerOptions& options, BatchHandler handler) {
+    if (pImpl->running_) {
+        return false;
+    }
+    return pImpl->start(options, std::move(handler));
+}
+
+void RenderServer::stop() {
+    pImpl->stop();
+}
+
+bool RenderServer::isRunning() const {
+    return pImpl->running_;
+}
+
+const std::string& RenderServer::getSocketPath() const {
+    return pImpl->socket_path_;
+}
+
+std::map<std::string, float> RenderServer::getStats() const {
+    return pImpl->getStats();
+}
+
+} // namespace service
+} // namespace ufra
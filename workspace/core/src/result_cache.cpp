@@ -0,0 +1,324 @@
+#include "ufra/result_cache.h"
+#include "ufra/image_kernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace ufra {
+
+namespace {
+
+constexpr char kMagic[4] = {'U', 'F', 'R', 'C'};
+constexpr uint32_t kFormatVersion = 1;
+constexpr const char* kExtension = ".ufrc";
+constexpr size_t kFileChunk = 16 << 20;
+
+struct MatHeader {
+    int32_t rows = 0;
+    int32_t cols = 0;
+    int32_t type = 0;
+};
+
+// Entries hold 8-bit images and masks only
+bool storableType(int type) {
+    return type == CV_8UC1 || type == CV_8UC3;
+}
+
+bool writeMat(std::ofstream& out, const cv::Mat& mat) {
+    if (!mat.empty() && !storableType(mat.type())) {
+        return false;
+    }
+    MatHeader header{mat.rows, mat.cols, mat.type()};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    const size_t row_bytes = mat.cols * mat.elemSize();
+    for (int y = 0; y < mat.rows; ++y) {
+        out.write(reinterpret_cast<const char*>(mat.ptr(y)), row_bytes);
+    }
+    return static_cast<bool>(out);
+}
+
+// Unique per process and write, so concurrent writers never share a file
+std::string temporarySuffix() {
+    static const uint64_t process_token =
+        (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+    static std::atomic<uint64_t> counter{0};
+    return ".tmp" + std::to_string(process_token) + "." + std::to_string(counter++);
+}
+
+// Bytes left between the read position and the end of the file
+uint64_t remainingBytes(std::ifstream& in) {
+    const std::streampos position = in.tellg();
+    in.seekg(0, std::ios::end);
+    const std::streampos end = in.tellg();
+    in.seekg(position);
+    return position < 0 || end < position ? 0 : static_cast<uint64_t>(end - position);
+}
+
+// Rejects headers a truncated or corrupt file could carry before allocating
+bool readMat(std::ifstream& in, cv::Mat& mat) {
+    MatHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.rows < 0 || header.cols < 0) {
+        return false;
+    }
+    if (header.rows == 0 || header.cols == 0) {
+        mat.release();
+        return true;
+    }
+    if (!storableType(header.type)) {
+        return false;
+    }
+    const uint64_t bytes = static_cast<uint64_t>(header.rows) * static_cast<uint64_t>(header.cols) *
+                           static_cast<uint64_t>(CV_ELEM_SIZE(header.type));
+    if (bytes > remainingBytes(in)) {
+        return false;
+    }
+    mat.create(header.rows, header.cols, header.type);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(mat.data), mat.total() * mat.elemSize()));
+}
+
+} // namespace
+
+std::string ResultKey::hex() const {
+    char text[33];
+    std::snprintf(text, sizeof(text), "%016llx%016llx", static_cast<unsigned long long>(high),
+                  static_cast<unsigned long long>(low));
+    return text;
+}
+
+class ResultCache::Impl {
+public:
+    struct Entry {
+        size_t bytes = 0;
+        uint64_t last_use = 0;   // Key into order_
+    };
+
+    // Entries fan out over 256 subdirectories by their first byte
+    fs::path pathFor(const std::string& name) const {
+        return directory_ / name.substr(0, 2) / (name + kExtension);
+    }
+
+    void touch(const std::string& name, size_t bytes) {
+        Entry& entry = entries_[name];
+        order_.erase(entry.last_use);
+        total_bytes_ += bytes - entry.bytes;
+        entry.bytes = bytes;
+        entry.last_use = ++clock_;
+        order_[entry.last_use] = name;
+    }
+
+    void erase(const std::string& name) {
+        auto it = entries_.find(name);
+        if (it == entries_.end()) {
+            return;
+        }
+        std::error_code error;
+        fs::remove(pathFor(name), error);
+        total_bytes_ -= it->second.bytes;
+        order_.erase(it->second.last_use);
+        entries_.erase(it);
+    }
+
+    void evict() {
+        while (total_bytes_ > max_bytes_ && !order_.empty()) {
+            erase(order_.begin()->second);
+            ++evictions_;
+        }
+    }
+
+    // Entries written by other processes since open() are picked up on demand
+    bool indexed(const std::string& name) {
+        if (entries_.count(name)) {
+            return true;
+        }
+        std::error_code error;
+        const size_t bytes = fs::file_size(pathFor(name), error);
+        if (error) {
+            return false;
+        }
+        touch(name, bytes);
+        evict();
+        return entries_.count(name) > 0;
+    }
+
+    mutable std::mutex mutex_;
+    fs::path directory_;
+    bool open_ = false;
+    size_t max_bytes_ = 0;
+    size_t total_bytes_ = 0;
+    uint64_t clock_ = 0;
+    std::map<std::string, Entry> entries_;
+    std::map<uint64_t, std::string> order_;   // Least recently used first
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    size_t bytes_saved_ = 0;
+    size_t evictions_ = 0;
+};
+
+ResultCache::ResultCache() : pImpl(std::make_unique<Impl>()) {}
+
+ResultCache::~ResultCache() = default;
+
+bool ResultCache::open(const std::string& directory, size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Failed to create result cache directory " << directory << ": " << error.message() << std::endl;
+        return false;
+    }
+    pImpl->directory_ = directory;
+    pImpl->max_bytes_ = max_bytes;
+    pImpl->entries_.clear();
+    pImpl->order_.clear();
+    pImpl->total_bytes_ = 0;
+
+    // Existing entries join the LRU order oldest first, by modification time
+    std::vector<std::pair<fs::file_time_type, std::pair<std::string, size_t>>> found;
+    for (fs::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        if (it->is_regular_file(error) && it->path().extension() == kExtension) {
+            found.push_back({it->last_write_time(error), {it->path().stem().string(), it->file_size(error)}});
+        }
+    }
+    std::sort(found.begin(), found.end());
+    for (const auto& file : found) {
+        pImpl->touch(file.second.first, file.second.second);
+    }
+    pImpl->evict();
+    pImpl->open_ = true;
+    return true;
+}
+
+bool ResultCache::isOpen() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    return pImpl->open_;
+}
+
+ResultKey ResultCache::makeKey(const ImageData& roi, uint64_t context) {
+    ResultKey key;
+    const size_t row_bytes = roi.cols * roi.elemSize();
+    const size_t stride = roi.rows > 1 ? roi.step[0] : row_bytes;
+    key.high = kernels::contentHash(roi.data, row_bytes, roi.rows, stride, context);
+    key.low = kernels::contentHash(roi.data, row_bytes, roi.rows, stride, ~context) ^ static_cast<uint64_t>(roi.type());
+    return key;
+}
+
+uint64_t ResultCache::hashFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return 0;
+    }
+    std::vector<uint8_t> chunk(kFileChunk);
+    uint64_t hash = 0;
+    while (in) {
+        in.read(reinterpret_cast<char*>(chunk.data()), chunk.size());
+        const size_t count = static_cast<size_t>(in.gcount());
+        if (count == 0) {
+            break;
+        }
+        hash = kernels::contentHash(chunk.data(), count, 1, count, hash);
+    }
+    return hash;
+}
+
+bool ResultCache::load(const ResultKey& key, ImageData& result, MaskImage& parsing_mask) {
+    const std::string name = key.hex();
+    fs::path path;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex_);
+        if (!pImpl->open_ || !pImpl->indexed(name)) {
+            ++pImpl->misses_;
+            return false;
+        }
+        path = pImpl->pathFor(name);
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    char magic[4] = {};
+    uint32_t version = 0;
+    bool valid = in.read(magic, sizeof(magic)) && std::equal(magic, magic + 4, kMagic) &&
+                 in.read(reinterpret_cast<char*>(&version), sizeof(version)) && version == kFormatVersion &&
+                 readMat(in, result) && readMat(in, parsing_mask);
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    if (!valid) {
+        pImpl->erase(name);   // Truncated or from another format version
+        ++pImpl->misses_;
+        return false;
+    }
+    auto it = pImpl->entries_.find(name);
+    if (it != pImpl->entries_.end()) {
+        pImpl->touch(name, it->second.bytes);
+    }
+    ++pImpl->hits_;
+    pImpl->bytes_saved_ += result.total() * result.elemSize();
+    return true;
+}
+
+bool ResultCache::store(const ResultKey& key, const ImageData& result, const MaskImage& parsing_mask) {
+    const std::string name = key.hex();
+    fs::path path;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex_);
+        if (!pImpl->open_ || pImpl->indexed(name)) {
+            return pImpl->open_;
+        }
+        path = pImpl->pathFor(name);
+    }
+
+    std::error_code error;
+    fs::create_directories(path.parent_path(), error);
+    fs::path temporary = path;
+    temporary += temporarySuffix();
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(kMagic, sizeof(kMagic));
+        out.write(reinterpret_cast<const char*>(&kFormatVersion), sizeof(kFormatVersion));
+        if (!out || !writeMat(out, result) || !writeMat(out, parsing_mask)) {
+            fs::remove(temporary, error);
+            return false;
+        }
+    }
+    const size_t bytes = fs::file_size(temporary, error);
+    fs::rename(temporary, path, error);
+    if (error) {
+        fs::remove(temporary, error);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->touch(name, bytes);
+    pImpl->evict();
+    return true;
+}
+
+void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    while (!pImpl->entries_.empty()) {
+        pImpl->erase(pImpl->entries_.begin()->first);
+    }
+}
+
+std::map<std::string, float> ResultCache::getStats() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    std::map<std::string, float> stats;
+    const size_t lookups = pImpl->hits_ + pImpl->misses_;
+    stats["hits"] = static_cast<float>(pImpl->hits_);
+    stats["misses"] = static_cast<float>(pImpl->misses_);
+    stats["hit_rate"] = lookups ? static_cast<float>(pImpl->hits_) / lookups : 0.0f;
+    stats["bytes_saved"] = static_cast<float>(pImpl->bytes_saved_);
+    stats["bytes"] = static_cast<float>(pImpl->total_bytes_);
+    stats["entries"] = static_cast<float>(pImpl->entries_.size());
+    stats["evictions"] = static_cast<float>(pImpl->evictions_);
+    return stats;
+}
+
+} // namespace ufra
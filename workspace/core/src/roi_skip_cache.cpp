@@ -0,0 +1,153 @@
+#include "ufra/roi_skip_cache.h"
+#include "ufra/image_kernels.h"
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+
+namespace ufra {
+
+RoiSignature computeRoiSignature(const uint8_t* roi, int width, int height, size_t stride, int channels) {
+    RoiSignature signature;
+    if (!roi || width < RoiSignature::kGrid || height < RoiSignature::kGrid || channels <= 0) {
+        return signature;
+    }
+    signature.width = width;
+    signature.height = height;
+    kernels::cellMeans(roi, width, height, stride, channels, RoiSignature::kGrid, RoiSignature::kGrid, 1,
+                       signature.cells.data());
+
+    // FNV-1a over the size and cells
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](uint8_t byte) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    };
+    for (int value : {width, height, channels}) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            mix(static_cast<uint8_t>(value >> shift));
+        }
+    }
+    for (uint8_t cell : signature.cells) {
+        mix(cell);
+    }
+    signature.hash = hash;
+    return signature;
+}
+
+class RoiSkipCache::Impl {
+public:
+    struct Entry {
+        RoiSignature signature;
+        uint64_t controls_key = 0;
+        ImageData result;
+        MaskImage parsing_mask;
+    };
+
+    bool matches(const RoiSignature& stored, const RoiSignature& current, bool& exact) const {
+        exact = false;
+        if (stored.width != current.width || stored.height != current.height || stored.width == 0) {
+            return false;
+        }
+        if (stored.hash == current.hash && stored.cells == current.cells) {
+            exact = true;
+            return true;
+        }
+        int total = 0;
+        for (size_t i = 0; i < current.cells.size(); ++i) {
+            const int difference = std::abs(static_cast<int>(stored.cells[i]) - current.cells[i]);
+            if (difference > max_difference_) {
+                return false;   // A local change, e.g. a blink
+            }
+            total += difference;
+        }
+        return total <= mean_difference_ * static_cast<float>(current.cells.size());
+    }
+
+    mutable std::mutex mutex_;
+    std::map<int, Entry> entries_;
+    float mean_difference_ = 0.5f;
+    int max_difference_ = 2;
+    size_t hits_ = 0;
+    size_t exact_hits_ = 0;
+    size_t misses_ = 0;
+};
+
+RoiSkipCache::RoiSkipCache() : pImpl(std::make_unique<Impl>()) {}
+
+RoiSkipCache::~RoiSkipCache() = default;
+
+bool RoiSkipCache::lookup(int track_id, const RoiSignature& signature, uint64_t controls_key,
+                          ImageData& result, MaskImage& parsing_mask, bool* exact) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    auto it = pImpl->entries_.find(track_id);
+    bool exact_match = false;
+    if (it == pImpl->entries_.end() || it->second.controls_key != controls_key ||
+        !pImpl->matches(it->second.signature, signature, exact_match)) {
+        ++pImpl->misses_;
+        return false;
+    }
+    result = it->second.result;
+    parsing_mask = it->second.parsing_mask;
+    ++pImpl->hits_;
+    pImpl->exact_hits_ += exact_match ? 1 : 0;
+    if (exact) {
+        *exact = exact_match;
+    }
+    return true;
+}
+
+void RoiSkipCache::store(int track_id, const RoiSignature& signature, uint64_t controls_key,
+                         const ImageData& result, const MaskImage& parsing_mask) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    Impl::Entry& entry = pImpl->entries_[track_id];
+    entry.signature = signature;
+    entry.controls_key = controls_key;
+    entry.result = result;
+    entry.parsing_mask = parsing_mask;
+}
+
+bool RoiSkipCache::matches(const RoiSignature& previous, const RoiSignature& current) const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    bool exact = false;
+    return pImpl->matches(previous, current, exact);
+}
+
+void RoiSkipCache::invalidate(int track_id) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->entries_.erase(track_id);
+}
+
+void RoiSkipCache::clear() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->entries_.clear();
+}
+
+void RoiSkipCache::setTolerance(float mean_difference, int max_difference) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->mean_difference_ = std::max(0.0f, mean_difference);
+    pImpl->max_difference_ = std::max(0, max_difference);
+}
+
+std::map<std::string, float> RoiSkipCache::getStats() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    std::map<std::string, float> stats;
+    const size_t lookups = pImpl->hits_ + pImpl->misses_;
+    stats["hits"] = static_cast<float>(pImpl->hits_);
+    stats["exact_hits"] = static_cast<float>(pImpl->exact_hits_);
+    stats["misses"] = static_cast<float>(pImpl->misses_);
+    stats["hit_rate"] = lookups ? static_cast<float>(pImpl->hits_) / lookups : 0.0f;
+    return stats;
+}
+
+size_t RoiSkipCache::getMemoryBytes() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    size_t bytes = 0;
+    for (const auto& entry : pImpl->entries_) {
+        const Impl::Entry& stored = entry.second;
+        bytes += sizeof(Impl::Entry) + stored.result.total() * stored.result.elemSize() +
+                 stored.parsing_mask.total() * stored.parsing_mask.elemSize();
+    }
+    return bytes;
+}
+
+} // namespace ufra
@@ -0,0 +1,135 @@
+#include "ufra/scene_cut_detector.h"
+#include "ufra/image_kernels.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <vector>
+
+namespace ufra {
+
+namespace {
+
+constexpr int kGridWidth = 64;
+constexpr int kGridHeight = 36;
+constexpr int kRowStep = 8;
+constexpr int kBins = 32;
+constexpr int kMaxRepeatDifference = 1;   // Largest cell change in a repeated frame (codec noise)
+constexpr int kPulldownCycle = 5;
+constexpr int kPulldownRepeats = 3;       // Consecutive on-cadence repeats before pulldown is reported
+
+} // namespace
+
+class SceneCutDetector::Impl {
+public:
+    bool update(const uint8_t* frame, int width, int height, size_t stride, int channels) {
+        if (!frame || width < kGridWidth || height < kGridHeight || channels <= 0) {
+            last_score_ = 0.0f;
+            repeat_ = false;
+            return false;
+        }
+        const int frame_index = frames_++;
+        std::vector<uint8_t>& current = signatures_[current_];
+        current.resize(static_cast<size_t>(kGridWidth) * kGridHeight);
+        kernels::cellMeans(frame, width, height, stride, channels, kGridWidth, kGridHeight, kRowStep,
+                           current.data());
+        std::array<int, kBins> histogram{};
+        for (uint8_t value : current) {
+            ++histogram[value * kBins / 256];
+        }
+
+        const std::vector<uint8_t>& previous = signatures_[1 - current_];
+        bool cut = false;
+        if (has_previous_) {
+            // Grid difference catches layout changes, the histogram one
+            // keeps camera motion over similar content from triggering
+            const float grid = kernels::meanAbsDiff(current.data(), current.size(), previous.data(),
+                                                    previous.size(), static_cast<int>(current.size()), 1, 1) / 255.0f;
+            int moved = 0;
+            for (int bin = 0; bin < kBins; ++bin) {
+                moved += std::abs(histogram[bin] - histogram_[bin]);
+            }
+            const float spread = static_cast<float>(moved) / (2.0f * current.size());
+            last_score_ = 0.5f * std::min(1.0f, 3.0f * grid) + 0.5f * spread;
+            cut = last_score_ > threshold_;
+            cuts_ += cut ? 1 : 0;
+            repeat_ = true;
+            for (size_t i = 0; i < current.size() && repeat_; ++i) {
+                repeat_ = std::abs(static_cast<int>(current[i]) - previous[i]) <= kMaxRepeatDifference;
+            }
+        } else {
+            last_score_ = 0.0f;
+            repeat_ = false;
+        }
+        if (repeat_) {
+            ++repeats_;
+            cadence_ = last_repeat_ >= 0 && frame_index - last_repeat_ == kPulldownCycle ? cadence_ + 1 : 1;
+            last_repeat_ = frame_index;
+        } else if (last_repeat_ >= 0 && frame_index - last_repeat_ >= kPulldownCycle) {
+            cadence_ = 0;   // A repeat was due and did not come
+        }
+        histogram_ = histogram;
+        has_previous_ = true;
+        current_ = 1 - current_;
+        return cut;
+    }
+
+    std::vector<uint8_t> signatures_[2];
+    int current_ = 0;
+    std::array<int, kBins> histogram_{};
+    bool has_previous_ = false;
+    float threshold_ = 0.35f;
+    float last_score_ = 0.0f;
+    size_t cuts_ = 0;
+    int frames_ = 0;
+    bool repeat_ = false;
+    int last_repeat_ = -1;
+    int cadence_ = 0;
+    size_t repeats_ = 0;
+};
+
+SceneCutDetector::SceneCutDetector() : pImpl(std::make_unique<Impl>()) {}
+
+SceneCutDetector::~SceneCutDetector() = default;
+
+bool SceneCutDetector::update(const uint8_t* frame, int width, int height, size_t stride, int channels) {
+    return pImpl->update(frame, width, height, stride, channels);
+}
+
+void SceneCutDetector::reset() {
+    pImpl->has_previous_ = false;
+    pImpl->last_score_ = 0.0f;
+    pImpl->frames_ = 0;
+    pImpl->repeat_ = false;
+    pImpl->last_repeat_ = -1;
+    pImpl->cadence_ = 0;
+}
+
+void SceneCutDetector::setThreshold(float threshold) {
+    pImpl->threshold_ = threshold;
+}
+
+float SceneCutDetector::getThreshold() const {
+    return pImpl->threshold_;
+}
+
+float SceneCutDetector::getLastScore() const {
+    return pImpl->last_score_;
+}
+
+size_t SceneCutDetector::getCutCount() const {
+    return pImpl->cuts_;
+}
+
+bool SceneCutDetector::isRepeat() const {
+    return pImpl->repeat_;
+}
+
+int SceneCutDetector::getPulldownPhase() const {
+    return pImpl->cadence_ >= kPulldownRepeats ? pImpl->last_repeat_ % kPulldownCycle : -1;
+}
+
+size_t SceneCutDetector::getRepeatCount() const {
+    return pImpl->repeats_;
+}
+
+} // namespace ufra
@@ -0,0 +1,341 @@
+#include "ufra/stub_network.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace ufra {
+
+namespace {
+
+const char kStubPrefix[] = "stub:";
+constexpr int kParseClasses = 19;   // CelebAMask-HQ labels, as FaceParser expects
+
+// Busy work for the configured cost, so threads contend for cores as they
+// would under real inference
+void spin(double ms) {
+    if (ms <= 0.0) {
+        return;
+    }
+    const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(ms);
+    volatile double sink = 1.0;
+    while (std::chrono::steady_clock::now() < end) {
+        for (int i = 0; i < 1000; ++i) {
+            sink = sink * 1.0000001 + 1e-7;
+        }
+    }
+}
+
+const cv::Mat& primaryInput(const std::map<std::string, cv::Mat>& inputs, const std::string& name) {
+    static const cv::Mat empty;
+    auto it = inputs.find(name);
+    if (it == inputs.end()) {
+        it = inputs.find("");
+    }
+    if (it == inputs.end()) {
+        return inputs.empty() ? empty : inputs.begin()->second;
+    }
+    return it->second;
+}
+
+// Planes of a 1xCxHxW float blob
+const float* plane(const cv::Mat& blob, int channel) {
+    return blob.ptr<float>() + static_cast<size_t>(channel) * blob.size[2] * blob.size[3];
+}
+
+bool isImageBlob(const cv::Mat& blob) {
+    return blob.dims == 4 && blob.type() == CV_32F && blob.size[1] >= 1 && blob.size[2] > 0 && blob.size[3] > 0;
+}
+
+// Detection rows [image, class, confidence, x1, y1, x2, y2] (normalized),
+// one per bright run along the middle row, extended vertically through the
+// run's centre column
+cv::Mat detect(const cv::Mat& blob) {
+    if (!isImageBlob(blob)) {
+        return cv::Mat(0, 7, CV_32F);
+    }
+    const int channels = blob.size[1], height = blob.size[2], width = blob.size[3];
+    auto brightness = [&](int x, int y) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            sum += plane(blob, c)[static_cast<size_t>(y) * width + x];
+        }
+        return sum;
+    };
+
+    const int middle = height / 2;
+    float lo = brightness(0, middle), hi = lo;
+    for (int x = 1; x < width; ++x) {
+        lo = std::min(lo, brightness(x, middle));
+        hi = std::max(hi, brightness(x, middle));
+    }
+    cv::Mat detections(0, 7, CV_32F);
+    if (hi - lo < 1e-3f) {
+        return detections;
+    }
+    const float threshold = 0.5f * (lo + hi);
+    const int min_run = std::max(2, width / 50);
+
+    for (int x = 0; x < width;) {
+        if (brightness(x, middle) <= threshold) {
+            ++x;
+            continue;
+        }
+        int end = x;
+        while (end < width && brightness(end, middle) > threshold) {
+            ++end;
+        }
+        if (end - x >= min_run) {
+            const int centre = (x + end) / 2;
+            int top = middle, bottom = middle;
+            while (top > 0 && brightness(centre, top - 1) > threshold) {
+                --top;
+            }
+            while (bottom + 1 < height && brightness(centre, bottom + 1) > threshold) {
+                ++bottom;
+            }
+            const float row[7] = {0.0f, 1.0f, 0.99f,
+                                  static_cast<float>(x) / width, static_cast<float>(top) / height,
+                                  static_cast<float>(end) / width, static_cast<float>(bottom + 1) / height};
+            detections.push_back(cv::Mat(1, 7, CV_32F, const_cast<float*>(row)));
+        }
+        x = end;
+    }
+    return detections;
+}
+
+bool inEllipse(float u, float v, float cu, float cv_, float ru, float rv) {
+    const float du = (u - cu) / ru, dv = (v - cv_) / rv;
+    return du * du + dv * dv <= 1.0f;
+}
+
+// Label of a crop position for a face centred in the crop, as the detector's
+// padded boxes produce
+int parseLabel(float u, float v) {
+    int label = 0;
+    if (std::abs(u - 0.5f) < 0.15f && v > 0.85f) {
+        label = 17;   // neck
+    }
+    if (inEllipse(u, v, 0.5f, 0.52f, 0.36f, 0.42f)) {
+        label = 1;    // skin
+    }
+    if (v < 0.24f && inEllipse(u, v, 0.5f, 0.45f, 0.42f, 0.45f)) {
+        label = 13;   // hair
+    }
+    if (v > 0.34f && v < 0.38f && u > 0.28f && u < 0.45f) {
+        label = 6;    // left brow
+    }
+    if (v > 0.34f && v < 0.38f && u > 0.55f && u < 0.72f) {
+        label = 7;    // right brow
+    }
+    if (inEllipse(u, v, 0.38f, 0.42f, 0.06f, 0.03f)) {
+        label = 4;    // left eye
+    }
+    if (inEllipse(u, v, 0.62f, 0.42f, 0.06f, 0.03f)) {
+        label = 5;    // right eye
+    }
+    if (std::abs(u - 0.5f) < 0.05f && v > 0.45f && v < 0.62f) {
+        label = 2;    // nose
+    }
+    if (std::abs(u - 0.5f) < 0.12f && v > 0.68f && v < 0.72f) {
+        label = 11;   // upper lip
+    }
+    if (std::abs(u - 0.5f) < 0.12f && v >= 0.72f && v < 0.76f) {
+        label = 12;   // lower lip
+    }
+    return label;
+}
+
+// One-hot N x 19 x H x W scores at the input resolution
+cv::Mat parse(const cv::Mat& blob) {
+    if (!isImageBlob(blob)) {
+        return cv::Mat();
+    }
+    const int items = blob.size[0], height = blob.size[2], width = blob.size[3];
+    const int shape[4] = {items, kParseClasses, height, width};
+    cv::Mat scores(4, shape, CV_32F, cv::Scalar(0));
+    for (int n = 0; n < items; ++n) {
+        float* data = scores.ptr<float>(n);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const int label = parseLabel((x + 0.5f) / width, (y + 0.5f) / height);
+                data[(static_cast<size_t>(label) * height + y) * width + x] = 1.0f;
+            }
+        }
+    }
+    return scores;
+}
+
+// Faces in [-1, 1], each desaturated and darkened with its normalized target
+// age (one age per face, or one for all)
+cv::Mat generate(const cv::Mat& face, const cv::Mat& age_input) {
+    if (!isImageBlob(face)) {
+        return cv::Mat();
+    }
+    const int channels = face.size[1];
+    const size_t pixels = static_cast<size_t>(face.size[2]) * face.size[3];
+    cv::Mat output(face.dims, face.size.p, CV_32F);
+    for (int n = 0; n < face.size[0]; ++n) {
+        const size_t age_index = static_cast<size_t>(n) < age_input.total() ? n : 0;
+        const float age = age_input.empty() ? 0.5f
+                                            : std::min(1.0f, std::max(0.0f, age_input.ptr<float>()[age_index]));
+        const float* src = face.ptr<float>() + static_cast<size_t>(n) * channels * pixels;
+        float* dst = output.ptr<float>() + static_cast<size_t>(n) * channels * pixels;
+        for (size_t i = 0; i < pixels; ++i) {
+            float gray = 0.0f;
+            for (int c = 0; c < channels; ++c) {
+                gray += src[c * pixels + i];
+            }
+            gray /= channels;
+            for (int c = 0; c < channels; ++c) {
+                const float value = src[c * pixels + i] * (1.0f - 0.4f * age) + gray * 0.4f * age - 0.15f * age;
+                dst[c * pixels + i] = std::min(1.0f, std::max(-1.0f, value));
+            }
+        }
+    }
+    return output;
+}
+
+cv::Mat estimateAge(const cv::Mat& blob) {
+    double sum = 0.0;
+    if (blob.type() == CV_32F && blob.isContinuous()) {
+        const float* data = blob.ptr<float>();
+        for (size_t i = 0; i < blob.total(); ++i) {
+            sum += data[i];
+        }
+    }
+    const float mean = blob.total() > 0 ? static_cast<float>(sum / blob.total()) : 0.0f;
+    cv::Mat age(1, 1, CV_32F);
+    age.at<float>(0, 0) = std::min(95.0f, std::max(1.0f, 30.0f + 40.0f * mean));
+    return age;
+}
+
+} // namespace
+
+std::string stubModelDir(const StubCost& cost) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%s%g,%g", kStubPrefix, cost.call_ms, cost.item_ms);
+    return buffer;
+}
+
+bool isStubModelPath(const std::string& path) {
+    return path.compare(0, sizeof(kStubPrefix) - 1, kStubPrefix) == 0;
+}
+
+std::vector<FaceBox> stubFaceLayout(int width, int height, int face_count) {
+    std::vector<FaceBox> boxes;
+    face_count = std::max(0, face_count);
+    const float box_width = std::min(0.3f, 0.6f / std::max(1, face_count)) * width;
+    const float box_height = 0.5f * height;
+    for (int i = 0; i < face_count; ++i) {
+        FaceBox box;
+        box.x = (i + 0.5f) * width / face_count - 0.5f * box_width;
+        box.y = 0.5f * height - 0.5f * box_height;
+        box.width = box_width;
+        box.height = box_height;
+        box.confidence = 1.0f;
+        box.face_id = i;
+        boxes.push_back(box);
+    }
+    return boxes;
+}
+
+ImageData renderStubFrame(int width, int height, int face_count) {
+    cv::Mat frame(height, width, CV_8UC3);
+    for (int y = 0; y < height; ++y) {
+        frame.row(y).setTo(cv::Scalar::all(30 + 30 * y / std::max(1, height)));
+    }
+    for (const FaceBox& box : stubFaceLayout(width, height, face_count)) {
+        const cv::Point centre(cvRound(box.x + 0.5f * box.width), cvRound(box.y + 0.5f * box.height));
+        const cv::Size axes(cvRound(0.5f * box.width), cvRound(0.5f * box.height));
+        cv::ellipse(frame, centre, axes, 0, 0, 360, cv::Scalar(150, 170, 210), cv::FILLED);
+
+        const int eye_radius = std::max(1, cvRound(0.06f * box.width));
+        const int eye_dx = cvRound(0.2f * box.width), eye_dy = cvRound(0.1f * box.height);
+        cv::circle(frame, centre + cv::Point(-eye_dx, -eye_dy), eye_radius, cv::Scalar(60, 60, 60), cv::FILLED);
+        cv::circle(frame, centre + cv::Point(eye_dx, -eye_dy), eye_radius, cv::Scalar(60, 60, 60), cv::FILLED);
+        cv::ellipse(frame, centre + cv::Point(0, cvRound(0.25f * box.height)),
+                    cv::Size(std::max(1, cvRound(0.15f * box.width)), std::max(1, cvRound(0.05f * box.height))),
+                    0, 0, 360, cv::Scalar(120, 120, 200), cv::FILLED);
+    }
+    return frame;
+}
+
+// ---------------------------------------------------------------------------
+// StubNetwork
+
+class StubNetwork::Impl {
+public:
+    std::string kind_;
+    StubCost cost_;
+};
+
+StubNetwork::StubNetwork() : pImpl(std::make_unique<Impl>()) {}
+StubNetwork::~StubNetwork() = default;
+
+std::shared_ptr<StubNetwork> StubNetwork::create(const std::string& model_path) {
+    if (!isStubModelPath(model_path)) {
+        return nullptr;
+    }
+
+    // stub:<call_ms>,<item_ms>/<dirs>/<kind>.onnx
+    const size_t prefix = sizeof(kStubPrefix) - 1;
+    const size_t slash = model_path.find('/', prefix);
+    const std::string params = model_path.substr(prefix, slash == std::string::npos ? std::string::npos : slash - prefix);
+    std::string kind = model_path.substr(model_path.find_last_of('/') == std::string::npos
+                                             ? prefix : model_path.find_last_of('/') + 1);
+    const size_t extension = kind.rfind(".onnx");
+    if (extension != std::string::npos) {
+        kind.erase(extension);
+    }
+
+    static const char* const kKinds[] = {"face_detector", "face_parser", "feedforward_generator",
+                                         "age_estimator", "unet"};
+    if (std::find(std::begin(kKinds), std::end(kKinds), kind) == std::end(kKinds)) {
+        return nullptr;
+    }
+
+    std::shared_ptr<StubNetwork> network(new StubNetwork());
+    network->pImpl->kind_ = kind;
+    char* end = nullptr;
+    network->pImpl->cost_.call_ms = std::max(0.0, std::strtod(params.c_str(), &end));
+    if (end && *end == ',') {
+        network->pImpl->cost_.item_ms = std::max(0.0, std::strtod(end + 1, nullptr));
+    }
+    return network;
+}
+
+cv::Mat StubNetwork::forward(const std::map<std::string, cv::Mat>& inputs) const {
+    const std::string& kind = pImpl->kind_;
+    const cv::Mat& input = primaryInput(inputs, kind == "feedforward_generator" ? "face_input"
+                                                : kind == "unet" ? "sample" : "");
+    const int items = input.dims >= 1 && !input.empty() ? input.size[0] : 1;
+    spin(pImpl->cost_.call_ms + pImpl->cost_.item_ms * items);
+
+    if (kind == "face_detector") {
+        return detect(input);
+    }
+    if (kind == "face_parser") {
+        return parse(input);
+    }
+    if (kind == "feedforward_generator") {
+        auto age = inputs.find("age_input");
+        return generate(input, age == inputs.end() ? cv::Mat() : age->second);
+    }
+    if (kind == "age_estimator") {
+        return estimateAge(input);
+    }
+    return input.empty() ? cv::Mat() : cv::Mat(input.dims, input.size.p, CV_32F, cv::Scalar(0));
+}
+
+const std::string& StubNetwork::getKind() const {
+    return pImpl->kind_;
+}
+
+StubCost StubNetwork::getCost() const {
+    return pImpl->cost_;
+}
+
+} // namespace ufra
@@ -0,0 +1,176 @@
+#include "ufra/temporal_cache.h"
+#include "ufra/optical_flow.h"
+#include "ufra/image_kernels.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <mutex>
+
+namespace ufra {
+
+class TemporalCache::Impl {
+public:
+    struct Entry {
+        cv::Mat crop;
+        cv::Mat result;
+        cv::Mat state;
+        int frame_number = 0;
+    };
+
+    TemporalPrior lookup(int track_id, const ImageData& crop, int frame_number) {
+        Entry entry;
+        int flow_resolution = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(track_id);
+            const bool usable = it != entries_.end() && it->second.crop.size() == crop.size() &&
+                                it->second.crop.type() == crop.type() && frame_number > it->second.frame_number &&
+                                frame_number - it->second.frame_number <= max_frame_gap_;
+            if (!usable) {
+                ++misses_;
+                return TemporalPrior();
+            }
+            entry = it->second;   // Stored Mats are never written in place
+            flow_resolution = flow_resolution_;
+        }
+
+        // Flow is estimated on small gray copies and scaled up: tracked
+        // crops differ by small, smooth motion
+        const double scale = std::min(1.0, static_cast<double>(flow_resolution) / std::max(crop.cols, crop.rows));
+        const cv::Size flow_size(std::max(1, static_cast<int>(crop.cols * scale)),
+                                 std::max(1, static_cast<int>(crop.rows * scale)));
+        cv::Mat current_small = smallGray(crop, flow_size);
+        cv::Mat previous_small = smallGray(entry.crop, flow_size);
+        cv::Mat flow = flow_.computeFlow(current_small, previous_small);
+        if (flow.empty()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++misses_;
+            return TemporalPrior();
+        }
+
+        TemporalPrior prior;
+        cv::Mat warped_small = flow_.warpImage(previous_small, flow);
+        prior.residual = kernels::meanAbsDiff(current_small.data, current_small.step[0], warped_small.data,
+                                              warped_small.step[0], flow_size.width, flow_size.height, 1) / 255.0f;
+        if (flow_size != crop.size()) {
+            cv::resize(flow, flow, crop.size(), 0, 0, cv::INTER_LINEAR);
+            flow *= 1.0 / scale;
+        }
+        prior.result = flow_.warpImage(entry.result, flow);
+        if (!entry.state.empty()) {
+            prior.state = flow_.warpImage(entry.state, flow);
+        }
+        prior.frame_gap = frame_number - entry.frame_number;
+        prior.valid = true;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++hits_;
+        residual_sum_ += prior.residual;
+        return prior;
+    }
+
+    void store(int track_id, const ImageData& crop, const ImageData& result, const cv::Mat& state, int frame_number) {
+        Entry entry{crop.clone(), result.clone(), state.clone(), frame_number};
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_[track_id] = std::move(entry);
+        // Tracks that ended are dropped once they can no longer be reused
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (frame_number - it->second.frame_number > max_frame_gap_) {
+                it = entries_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    static cv::Mat smallGray(const ImageData& image, const cv::Size& size) {
+        cv::Mat gray;
+        if (image.channels() == 3) {
+            cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+        } else if (image.channels() == 4) {
+            cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY);
+        } else {
+            gray = image;
+        }
+        if (gray.size() != size) {
+            cv::resize(gray, gray, size, 0, 0, cv::INTER_AREA);
+        }
+        return gray.isContinuous() ? gray : gray.clone();
+    }
+
+    mutable std::mutex mutex_;
+    std::map<int, Entry> entries_;
+    OpticalFlow flow_;
+    int max_frame_gap_ = 2;
+    int flow_resolution_ = 128;
+
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    size_t frames_ = 0;
+    size_t steps_ = 0;
+    double residual_sum_ = 0.0;
+};
+
+TemporalCache::TemporalCache() : pImpl(std::make_unique<Impl>()) {}
+
+TemporalCache::~TemporalCache() = default;
+
+TemporalPrior TemporalCache::lookup(int track_id, const ImageData& crop, int frame_number) {
+    return pImpl->lookup(track_id, crop, frame_number);
+}
+
+void TemporalCache::store(int track_id, const ImageData& crop, const ImageData& result, const cv::Mat& state,
+                          int frame_number) {
+    pImpl->store(track_id, crop, result, state, frame_number);
+}
+
+void TemporalCache::invalidate(int track_id) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->entries_.erase(track_id);
+}
+
+void TemporalCache::clear() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->entries_.clear();
+}
+
+void TemporalCache::setMaxFrameGap(int frames) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->max_frame_gap_ = std::max(1, frames);
+}
+
+void TemporalCache::setFlowResolution(int size) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    pImpl->flow_resolution_ = std::max(16, size);
+}
+
+void TemporalCache::recordFrameSteps(int steps) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    ++pImpl->frames_;
+    pImpl->steps_ += static_cast<size_t>(std::max(0, steps));
+}
+
+std::map<std::string, float> TemporalCache::getStats() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    std::map<std::string, float> stats;
+    stats["hits"] = static_cast<float>(pImpl->hits_);
+    stats["misses"] = static_cast<float>(pImpl->misses_);
+    stats["tracks"] = static_cast<float>(pImpl->entries_.size());
+    stats["frames"] = static_cast<float>(pImpl->frames_);
+    stats["mean_steps_per_frame"] =
+        pImpl->frames_ ? static_cast<float>(pImpl->steps_) / pImpl->frames_ : 0.0f;
+    stats["mean_residual"] = pImpl->hits_ ? static_cast<float>(pImpl->residual_sum_ / pImpl->hits_) : 0.0f;
+    return stats;
+}
+
+size_t TemporalCache::getMemoryBytes() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex_);
+    size_t bytes = 0;
+    for (const auto& entry : pImpl->entries_) {
+        for (const cv::Mat* mat : {&entry.second.crop, &entry.second.result, &entry.second.state}) {
+            bytes += mat->total() * mat->elemSize();
+        }
+    }
+    return bytes;
+}
+
+} // namespace ufra
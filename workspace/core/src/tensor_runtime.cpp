@@ -0,0 +1,1713 @@
+#include "ufra/tensor_runtime.h"
+#include "conv_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace ufra {
+namespace runtime {
+
+// ---------------------------------------------------------------------------
+// Tensor / Node
+
+Tensor::Tensor(std::vector<int64_t> tensor_shape)
+    : shape(std::move(tensor_shape)), data(shapeSize(shape), 0.0f) {}
+
+Tensor::Tensor(std::vector<int64_t> tensor_shape, std::vector<float> values)
+    : shape(std::move(tensor_shape)), data(std::move(values)) {}
+
+int64_t Tensor::dim(int axis) const {
+    if (axis < 0) {
+        axis += rank();
+    }
+    return (axis >= 0 && axis < rank()) ? shape[axis] : 1;
+}
+
+size_t shapeSize(const std::vector<int64_t>& shape) {
+    size_t size = 1;
+    for (int64_t d : shape) {
+        size *= static_cast<size_t>(std::max<int64_t>(d, 0));
+    }
+    return size;
+}
+
+int64_t Node::getInt(const std::string& key, int64_t fallback) const {
+    auto it = ints.find(key);
+    return it != ints.end() ? it->second : fallback;
+}
+
+float Node::getFloat(const std::string& key, float fallback) const {
+    auto it = floats.find(key);
+    return it != floats.end() ? it->second : fallback;
+}
+
+std::string Node::getString(const std::string& key, const std::string& fallback) const {
+    auto it = strings.find(key);
+    return it != strings.end() ? it->second : fallback;
+}
+
+std::vector<int64_t> Node::getInts(const std::string& key) const {
+    auto it = int_lists.find(key);
+    return it != int_lists.end() ? it->second : std::vector<int64_t>();
+}
+
+// ---------------------------------------------------------------------------
+// Reference kernels
+
+namespace {
+
+using Inputs = std::vector<const Tensor*>;
+using Outputs = std::vector<Tensor>;
+using OpFunction = void (*)(const Node&, const Inputs&, Outputs&);
+
+[[noreturn]] void fail(const Node& node, const std::string& message) {
+    throw std::runtime_error(node.op_type + " '" + node.name + "': " + message);
+}
+
+const Tensor& input(const Node& node, const Inputs& in, size_t index) {
+    if (index >= in.size() || !in[index]) {
+        fail(node, "missing input " + std::to_string(index));
+    }
+    return *in[index];
+}
+
+const Tensor* optionalInput(const Inputs& in, size_t index) {
+    return index < in.size() ? in[index] : nullptr;
+}
+
+int normalizeAxis(const Node& node, int64_t axis, int rank) {
+    if (axis < 0) {
+        axis += rank;
+    }
+    if (axis < 0 || axis >= rank) {
+        fail(node, "axis out of range");
+    }
+    return static_cast<int>(axis);
+}
+
+std::vector<int64_t> toInts(const Tensor& tensor) {
+    std::vector<int64_t> values(tensor.data.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<int64_t>(tensor.data[i]);
+    }
+    return values;
+}
+
+// Attribute or (newer opsets) input tensor
+std::vector<int64_t> intsFrom(const Node& node, const Inputs& in, const std::string& key, size_t index) {
+    if (node.int_lists.count(key)) {
+        return node.getInts(key);
+    }
+    const Tensor* t = optionalInput(in, index);
+    return t ? toInts(*t) : std::vector<int64_t>();
+}
+
+std::vector<size_t> stridesOf(const std::vector<int64_t>& shape) {
+    std::vector<size_t> strides(shape.size(), 1);
+    for (int i = static_cast<int>(shape.size()) - 2; i >= 0; --i) {
+        strides[i] = strides[i + 1] * static_cast<size_t>(shape[i + 1]);
+    }
+    return strides;
+}
+
+// --- Elementwise --------------------------------------------------------------
+
+template <typename F>
+void unary(const Node& node, const Inputs& in, Outputs& out, F f) {
+    const Tensor& x = input(node, in, 0);
+    out[0].shape = x.shape;
+    out[0].data.resize(x.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+        out[0].data[i] = f(x.data[i]);
+    }
+}
+
+std::vector<int64_t> broadcastShape(const Node& node, const std::vector<int64_t>& a,
+                                    const std::vector<int64_t>& b) {
+    size_t rank = std::max(a.size(), b.size());
+    std::vector<int64_t> shape(rank);
+    for (size_t i = 0; i < rank; ++i) {
+        int64_t da = i < rank - a.size() ? 1 : a[i - (rank - a.size())];
+        int64_t db = i < rank - b.size() ? 1 : b[i - (rank - b.size())];
+        if (da != db && da != 1 && db != 1) {
+            fail(node, "shapes are not broadcastable");
+        }
+        shape[i] = (da == 1) ? db : da;
+    }
+    return shape;
+}
+
+// Strides of `shape` laid out in the (right-aligned) broadcast shape; 0 on
+// broadcast dimensions
+std::vector<size_t> broadcastStrides(const std::vector<int64_t>& shape, const std::vector<int64_t>& out_shape) {
+    std::vector<size_t> own = stridesOf(shape);
+    std::vector<size_t> strides(out_shape.size(), 0);
+    size_t offset = out_shape.size() - shape.size();
+    for (size_t i = 0; i < shape.size(); ++i) {
+        strides[offset + i] = (shape[i] == 1) ? 0 : own[i];
+    }
+    return strides;
+}
+
+template <typename F>
+Tensor broadcastBinary(const Node& node, const Tensor& a, const Tensor& b, F f) {
+    Tensor out(broadcastShape(node, a.shape, b.shape));
+    const size_t total = out.size();
+
+    if (a.shape == b.shape) {
+        for (size_t i = 0; i < total; ++i) {
+            out.data[i] = f(a.data[i], b.data[i]);
+        }
+        return out;
+    }
+    if (b.size() == 1) {
+        const float bv = b.data[0];
+        for (size_t i = 0; i < total; ++i) {
+            out.data[i] = f(a.data[i], bv);
+        }
+        return out;
+    }
+
+    // Walk the output with a multi-index, innermost dimension as a tight loop
+    const int rank = out.rank();
+    if (rank == 0) {
+        out.data[0] = f(a.data[0], b.data[0]);
+        return out;
+    }
+    std::vector<size_t> sa = broadcastStrides(a.shape, out.shape);
+    std::vector<size_t> sb = broadcastStrides(b.shape, out.shape);
+    const size_t inner = static_cast<size_t>(out.shape[rank - 1]);
+    const size_t ia = sa[rank - 1], ib = sb[rank - 1];
+    std::vector<int64_t> index(rank, 0);
+
+    for (size_t base = 0; base < total; base += inner) {
+        size_t oa = 0, ob = 0;
+        for (int d = 0; d < rank - 1; ++d) {
+            oa += index[d] * sa[d];
+            ob += index[d] * sb[d];
+        }
+        for (size_t i = 0; i < inner; ++i) {
+            out.data[base + i] = f(a.data[oa + i * ia], b.data[ob + i * ib]);
+        }
+        for (int d = rank - 2; d >= 0; --d) {
+            if (++index[d] < out.shape[d]) {
+                break;
+            }
+            index[d] = 0;
+        }
+    }
+    return out;
+}
+
+template <typename F>
+void binary(const Node& node, const Inputs& in, Outputs& out, F f) {
+    Tensor result = input(node, in, 0);
+    for (size_t i = 1; i < in.size(); ++i) {
+        result = broadcastBinary(node, result, input(node, in, i), f);
+    }
+    out[0] = std::move(result);
+}
+
+void opAdd(const Node& n, const Inputs& in, Outputs& out) { binary(n, in, out, [](float a, float b) { return a + b; }); }
+void opSub(const Node& n, const Inputs& in, Outputs& out) { binary(n, in, out, [](float a, float b) { return a - b; }); }
+void opMul(const Node& n, const Inputs& in, Outputs& out) { binary(n, in, out, [](float a, float b) { return a * b; }); }
+void opDiv(const Node& n, const Inputs& in, Outputs& out) { binary(n, in, out, [](float a, float b) { return a / b; }); }
+void opPow(const Node& n, const Inputs& in, Outputs& out) { binary(n, in, out, [](float a, float b) { return std::pow(a, b); }); }
+void opMax(const Node& n, const Inputs& in, Outputs& out) { binary(n, in, out, [](float a, float b) { return std::max(a, b); }); }
+void opMin(const Node& n, const Inputs& in, Outputs& out) { binary(n, in, out, [](float a, float b) { return std::min(a, b); }); }
+void opPRelu(const Node& n, const Inputs& in, Outputs& out) {
+    binary(n, in, out, [](float x, float slope) { return x < 0.0f ? x * slope : x; });
+}
+
+void opRelu(const Node& n, const Inputs& in, Outputs& out) { unary(n, in, out, [](float x) { return std::max(x, 0.0f); }); }
+void opSigmoid(const Node& n, const Inputs& in, Outputs& out) { unary(n, in, out, [](float x) { return 1.0f / (1.0f + std::exp(-x)); }); }
+void opTanh(const Node& n, const Inputs& in, Outputs& out) { unary(n, in, out, [](float x) { return std::tanh(x); }); }
+void opExp(const Node& n, const Inputs& in, Outputs& out) { unary(n, in, out, [](float x) { return std::exp(x); }); }
+void opSqrt(const Node& n, const Inputs& in, Outputs& out) { unary(n, in, out, [](float x) { return std::sqrt(x); }); }
+void opNeg(const Node& n, const Inputs& in, Outputs& out) { unary(n, in, out, [](float x) { return -x; }); }
+void opAbs(const Node& n, const Inputs& in, Outputs& out) { unary(n, in, out, [](float x) { return std::fabs(x); }); }
+void opFloor(const Node& n, const Inputs& in, Outputs& out) { unary(n, in, out, [](float x) { return std::floor(x); }); }
+void opErf(const Node& n, const Inputs& in, Outputs& out) { unary(n, in, out, [](float x) { return std::erf(x); }); }
+void opSoftplus(const Node& n, const Inputs& in, Outputs& out) { unary(n, in, out, [](float x) { return std::log1p(std::exp(x)); }); }
+void opIdentity(const Node& n, const Inputs& in, Outputs& out) { out[0] = input(n, in, 0); }
+
+void opLeakyRelu(const Node& n, const Inputs& in, Outputs& out) {
+    const float alpha = n.getFloat("alpha", 0.01f);
+    unary(n, in, out, [alpha](float x) { return x < 0.0f ? x * alpha : x; });
+}
+
+void opElu(const Node& n, const Inputs& in, Outputs& out) {
+    const float alpha = n.getFloat("alpha", 1.0f);
+    unary(n, in, out, [alpha](float x) { return x < 0.0f ? alpha * (std::exp(x) - 1.0f) : x; });
+}
+
+void opHardSigmoid(const Node& n, const Inputs& in, Outputs& out) {
+    const float alpha = n.getFloat("alpha", 0.2f), beta = n.getFloat("beta", 0.5f);
+    unary(n, in, out, [alpha, beta](float x) { return std::min(1.0f, std::max(0.0f, alpha * x + beta)); });
+}
+
+void opHardSwish(const Node& n, const Inputs& in, Outputs& out) {
+    unary(n, in, out, [](float x) { return x * std::min(1.0f, std::max(0.0f, x / 6.0f + 0.5f)); });
+}
+
+void opClip(const Node& n, const Inputs& in, Outputs& out) {
+    float lo = n.getFloat("min", -std::numeric_limits<float>::infinity());
+    float hi = n.getFloat("max", std::numeric_limits<float>::infinity());
+    if (const Tensor* t = optionalInput(in, 1)) {
+        lo = t->data.at(0);
+    }
+    if (const Tensor* t = optionalInput(in, 2)) {
+        hi = t->data.at(0);
+    }
+    unary(n, in, out, [lo, hi](float x) { return std::min(hi, std::max(lo, x)); });
+}
+
+void opCast(const Node& n, const Inputs& in, Outputs& out) {
+    const int64_t to = n.getInt("to", 1);
+    if (to == 9) {          // BOOL
+        unary(n, in, out, [](float x) { return x != 0.0f ? 1.0f : 0.0f; });
+    } else if (to == 1 || to == 10 || to == 11) {
+        opIdentity(n, in, out);
+    } else {                // Integer types truncate toward zero
+        unary(n, in, out, [](float x) { return std::trunc(x); });
+    }
+}
+
+// --- Convolution and pooling --------------------------------------------------
+
+// Spatial geometry shared by Conv, ConvTranspose and the pooling ops. 1-D
+// operators are mapped onto 2-D with a unit height.
+ConvWindow readWindow(const Node& node, int spatial_rank, const std::vector<int64_t>& kernel,
+                      int in_h, int in_w, bool transposed) {
+    if (spatial_rank != 1 && spatial_rank != 2) {
+        fail(node, "only 1-D and 2-D spatial inputs are supported");
+    }
+    // Height entries are absent for 1-D operators
+    auto pick = [spatial_rank](const std::vector<int64_t>& values, int axis) {
+        if (spatial_rank == 1) {
+            return (axis == 1 && !values.empty()) ? static_cast<int>(values[0]) : 1;
+        }
+        return values.size() == 2 ? static_cast<int>(values[axis]) : 1;
+    };
+
+    ConvWindow w;
+    std::vector<int64_t> strides = node.getInts("strides");
+    std::vector<int64_t> dilations = node.getInts("dilations");
+    w.kernel_h = pick(kernel, 0);
+    w.kernel_w = pick(kernel, 1);
+    w.stride_h = pick(strides, 0);
+    w.stride_w = pick(strides, 1);
+    w.dilation_h = pick(dilations, 0);
+    w.dilation_w = pick(dilations, 1);
+
+    std::vector<int64_t> pads = node.getInts("pads");
+    if (pads.size() == 4) {
+        w.pad_top = static_cast<int>(pads[0]);
+        w.pad_left = static_cast<int>(pads[1]);
+        w.pad_bottom = static_cast<int>(pads[2]);
+        w.pad_right = static_cast<int>(pads[3]);
+    } else if (pads.size() == 2) {
+        w.pad_left = static_cast<int>(pads[0]);
+        w.pad_right = static_cast<int>(pads[1]);
+    }
+
+    std::string auto_pad = node.getString("auto_pad", "NOTSET");
+    if (auto_pad == "SAME_UPPER" || auto_pad == "SAME_LOWER") {
+        auto same = [&](int in, int k, int s, int d, int& before, int& after) {
+            int out = transposed ? in * s : (in + s - 1) / s;
+            int total = transposed ? std::max(0, s * (in - 1) + (k - 1) * d + 1 - out)
+                                   : std::max(0, (out - 1) * s + (k - 1) * d + 1 - in);
+            before = (auto_pad == "SAME_UPPER") ? total / 2 : total - total / 2;
+            after = total - before;
+        };
+        same(in_h, w.kernel_h, w.stride_h, w.dilation_h, w.pad_top, w.pad_bottom);
+        same(in_w, w.kernel_w, w.stride_w, w.dilation_w, w.pad_left, w.pad_right);
+    } else if (auto_pad == "VALID") {
+        w.pad_top = w.pad_left = w.pad_bottom = w.pad_right = 0;
+    }
+    return w;
+}
+
+// [N, C, H, W] view of a rank-3 or rank-4 tensor
+void spatialDims(const Node& node, const Tensor& x, int& n, int& c, int& h, int& w) {
+    if (x.rank() == 4) {
+        n = static_cast<int>(x.shape[0]);
+        c = static_cast<int>(x.shape[1]);
+        h = static_cast<int>(x.shape[2]);
+        w = static_cast<int>(x.shape[3]);
+    } else if (x.rank() == 3) {
+        n = static_cast<int>(x.shape[0]);
+        c = static_cast<int>(x.shape[1]);
+        h = 1;
+        w = static_cast<int>(x.shape[2]);
+    } else {
+        fail(node, "expected a rank 3 or 4 input");
+    }
+}
+
+std::vector<int64_t> spatialShape(const Tensor& x, int n, int c, int h, int w) {
+    return x.rank() == 4 ? std::vector<int64_t>{n, c, h, w} : std::vector<int64_t>{n, c, w};
+}
+
+// First/last output index whose input tap o * stride - pad + offset lies in [0, size)
+inline void validRange(int out_size, int size, int stride, int pad, int offset, int& first, int& last) {
+    int lo = pad - offset;
+    first = lo <= 0 ? 0 : (lo + stride - 1) / stride;
+    int hi = size - 1 + pad - offset;
+    last = hi < 0 ? -1 : std::min(out_size - 1, hi / stride);
+}
+
+void opConv(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    const Tensor& weights = input(node, in, 1);
+    const Tensor* bias = optionalInput(in, 2);
+
+    int batch, channels, in_h, in_w;
+    spatialDims(node, x, batch, channels, in_h, in_w);
+    const int group = static_cast<int>(node.getInt("group", 1));
+    const int out_channels = static_cast<int>(weights.shape[0]);
+    const int group_in = channels / group;
+    const int group_out = out_channels / group;
+    if (group_in != weights.shape[1] || out_channels % group != 0) {
+        fail(node, "weight shape does not match input channels");
+    }
+
+    std::vector<int64_t> kernel(weights.shape.begin() + 2, weights.shape.end());
+    ConvWindow win = readWindow(node, x.rank() - 2, kernel, in_h, in_w, false);
+    const int out_h = (in_h + win.pad_top + win.pad_bottom - ((win.kernel_h - 1) * win.dilation_h + 1)) / win.stride_h + 1;
+    const int out_w = (in_w + win.pad_left + win.pad_right - ((win.kernel_w - 1) * win.dilation_w + 1)) / win.stride_w + 1;
+    if (out_h <= 0 || out_w <= 0) {
+        fail(node, "empty output");
+    }
+
+    Tensor& y = out[0];
+    y = Tensor(spatialShape(x, batch, out_channels, out_h, out_w));
+    const size_t in_plane = static_cast<size_t>(in_h) * in_w;
+    const size_t out_plane = static_cast<size_t>(out_h) * out_w;
+    const size_t kernel_size = static_cast<size_t>(win.kernel_h) * win.kernel_w;
+
+    for (int n = 0; n < batch; ++n) {
+        for (int m = 0; m < out_channels; ++m) {
+            const int g = m / group_out;
+            float* dst = y.data.data() + (static_cast<size_t>(n) * out_channels + m) * out_plane;
+            std::fill(dst, dst + out_plane, bias ? bias->data[m] : 0.0f);
+
+            for (int ic = 0; ic < group_in; ++ic) {
+                const float* src = x.data.data() + (static_cast<size_t>(n) * channels + g * group_in + ic) * in_plane;
+                const float* wk = weights.data.data() + (static_cast<size_t>(m) * group_in + ic) * kernel_size;
+
+                for (int ky = 0; ky < win.kernel_h; ++ky) {
+                    int oy0, oy1;
+                    validRange(out_h, in_h, win.stride_h, win.pad_top, ky * win.dilation_h, oy0, oy1);
+                    for (int kx = 0; kx < win.kernel_w; ++kx) {
+                        const float wv = wk[ky * win.kernel_w + kx];
+                        int ox0, ox1;
+                        validRange(out_w, in_w, win.stride_w, win.pad_left, kx * win.dilation_w, ox0, ox1);
+                        for (int oy = oy0; oy <= oy1; ++oy) {
+                            const int iy = oy * win.stride_h - win.pad_top + ky * win.dilation_h;
+                            const float* row = src + static_cast<size_t>(iy) * in_w;
+                            float* drow = dst + static_cast<size_t>(oy) * out_w;
+                            for (int ox = ox0; ox <= ox1; ++ox) {
+                                drow[ox] += wv * row[ox * win.stride_w - win.pad_left + kx * win.dilation_w];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void opConvTranspose(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    const Tensor& weights = input(node, in, 1);
+    const Tensor* bias = optionalInput(in, 2);
+
+    int batch, channels, in_h, in_w;
+    spatialDims(node, x, batch, channels, in_h, in_w);
+    const int group = static_cast<int>(node.getInt("group", 1));
+    const int group_in = channels / group;
+    const int group_out = static_cast<int>(weights.shape[1]);
+    const int out_channels = group_out * group;
+    if (weights.shape[0] != channels) {
+        fail(node, "weight shape does not match input channels");
+    }
+
+    std::vector<int64_t> kernel(weights.shape.begin() + 2, weights.shape.end());
+    ConvWindow win = readWindow(node, x.rank() - 2, kernel, in_h, in_w, true);
+    std::vector<int64_t> output_padding = node.getInts("output_padding");
+    int extra_h = 0, extra_w = 0;
+    if (output_padding.size() == 2) {
+        extra_h = static_cast<int>(output_padding[0]);
+        extra_w = static_cast<int>(output_padding[1]);
+    } else if (output_padding.size() == 1) {
+        extra_w = static_cast<int>(output_padding[0]);
+    }
+    const int out_h = win.stride_h * (in_h - 1) + extra_h + (win.kernel_h - 1) * win.dilation_h + 1 - win.pad_top - win.pad_bottom;
+    const int out_w = win.stride_w * (in_w - 1) + extra_w + (win.kernel_w - 1) * win.dilation_w + 1 - win.pad_left - win.pad_right;
+    if (out_h <= 0 || out_w <= 0) {
+        fail(node, "empty output");
+    }
+
+    Tensor& y = out[0];
+    y = Tensor(spatialShape(x, batch, out_channels, out_h, out_w));
+    const size_t in_plane = static_cast<size_t>(in_h) * in_w;
+    const size_t out_plane = static_cast<size_t>(out_h) * out_w;
+    const size_t kernel_size = static_cast<size_t>(win.kernel_h) * win.kernel_w;
+
+    for (int n = 0; n < batch; ++n) {
+        for (int c = 0; c < channels; ++c) {
+            const int g = c / group_in;
+            const float* src = x.data.data() + (static_cast<size_t>(n) * channels + c) * in_plane;
+            for (int om = 0; om < group_out; ++om) {
+                const int m = g * group_out + om;
+                float* dst = y.data.data() + (static_cast<size_t>(n) * out_channels + m) * out_plane;
+                const float* wk = weights.data.data() + (static_cast<size_t>(c) * group_out + om) * kernel_size;
+                for (int iy = 0; iy < in_h; ++iy) {
+                    for (int ky = 0; ky < win.kernel_h; ++ky) {
+                        const int oy = iy * win.stride_h - win.pad_top + ky * win.dilation_h;
+                        if (oy < 0 || oy >= out_h) {
+                            continue;
+                        }
+                        for (int ix = 0; ix < in_w; ++ix) {
+                            const float v = src[static_cast<size_t>(iy) * in_w + ix];
+                            for (int kx = 0; kx < win.kernel_w; ++kx) {
+                                const int ox = ix * win.stride_w - win.pad_left + kx * win.dilation_w;
+                                if (ox >= 0 && ox < out_w) {
+                                    dst[static_cast<size_t>(oy) * out_w + ox] += v * wk[ky * win.kernel_w + kx];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        if (bias) {
+            for (int m = 0; m < out_channels; ++m) {
+                float* dst = y.data.data() + (static_cast<size_t>(n) * out_channels + m) * out_plane;
+                for (size_t i = 0; i < out_plane; ++i) {
+                    dst[i] += bias->data[m];
+                }
+            }
+        }
+    }
+}
+
+int pooledSize(int in, int pad_before, int pad_after, int kernel, int stride, int dilation, bool ceil_mode) {
+    const int span = in + pad_before + pad_after - ((kernel - 1) * dilation + 1);
+    int out = (ceil_mode ? (span + stride - 1) / stride : span / stride) + 1;
+    // The last window must start inside the input or left padding
+    if (ceil_mode && (out - 1) * stride >= in + pad_before) {
+        --out;
+    }
+    return out;
+}
+
+void pool(const Node& node, const Inputs& in, Outputs& out, bool max_pool) {
+    const Tensor& x = input(node, in, 0);
+    int batch, channels, in_h, in_w;
+    spatialDims(node, x, batch, channels, in_h, in_w);
+
+    ConvWindow win = readWindow(node, x.rank() - 2, node.getInts("kernel_shape"), in_h, in_w, false);
+    const bool ceil_mode = node.getInt("ceil_mode", 0) != 0;
+    const bool count_pad = node.getInt("count_include_pad", 0) != 0;
+    const int out_h = pooledSize(in_h, win.pad_top, win.pad_bottom, win.kernel_h, win.stride_h, win.dilation_h, ceil_mode);
+    const int out_w = pooledSize(in_w, win.pad_left, win.pad_right, win.kernel_w, win.stride_w, win.dilation_w, ceil_mode);
+
+    Tensor& y = out[0];
+    y = Tensor(spatialShape(x, batch, channels, out_h, out_w));
+    const size_t in_plane = static_cast<size_t>(in_h) * in_w;
+    const size_t out_plane = static_cast<size_t>(out_h) * out_w;
+
+    for (int p = 0; p < batch * channels; ++p) {
+        const float* src = x.data.data() + p * in_plane;
+        float* dst = y.data.data() + p * out_plane;
+        for (int oy = 0; oy < out_h; ++oy) {
+            for (int ox = 0; ox < out_w; ++ox) {
+                float acc = max_pool ? -std::numeric_limits<float>::infinity() : 0.0f;
+                int count = 0, padded_count = 0;
+                for (int ky = 0; ky < win.kernel_h; ++ky) {
+                    const int iy = oy * win.stride_h - win.pad_top + ky * win.dilation_h;
+                    for (int kx = 0; kx < win.kernel_w; ++kx) {
+                        const int ix = ox * win.stride_w - win.pad_left + kx * win.dilation_w;
+                        if (iy < in_h + win.pad_bottom && ix < in_w + win.pad_right) {
+                            ++padded_count;
+                        }
+                        if (iy < 0 || iy >= in_h || ix < 0 || ix >= in_w) {
+                            continue;
+                        }
+                        const float v = src[static_cast<size_t>(iy) * in_w + ix];
+                        acc = max_pool ? std::max(acc, v) : acc + v;
+                        ++count;
+                    }
+                }
+                if (!max_pool) {
+                    int divisor = count_pad ? padded_count : count;
+                    acc = divisor > 0 ? acc / divisor : 0.0f;
+                }
+                dst[static_cast<size_t>(oy) * out_w + ox] = acc;
+            }
+        }
+    }
+}
+
+void opMaxPool(const Node& n, const Inputs& in, Outputs& out) { pool(n, in, out, true); }
+void opAveragePool(const Node& n, const Inputs& in, Outputs& out) { pool(n, in, out, false); }
+
+void globalPool(const Node& node, const Inputs& in, Outputs& out, bool max_pool) {
+    const Tensor& x = input(node, in, 0);
+    if (x.rank() < 3) {
+        fail(node, "expected a spatial input");
+    }
+    std::vector<int64_t> shape = x.shape;
+    size_t plane = 1;
+    for (int i = 2; i < x.rank(); ++i) {
+        plane *= static_cast<size_t>(shape[i]);
+        shape[i] = 1;
+    }
+    Tensor& y = out[0];
+    y = Tensor(shape);
+    for (size_t p = 0; p < y.size(); ++p) {
+        const float* src = x.data.data() + p * plane;
+        if (max_pool) {
+            y.data[p] = *std::max_element(src, src + plane);
+        } else {
+            y.data[p] = std::accumulate(src, src + plane, 0.0f) / plane;
+        }
+    }
+}
+
+void opGlobalAveragePool(const Node& n, const Inputs& in, Outputs& out) { globalPool(n, in, out, false); }
+void opGlobalMaxPool(const Node& n, const Inputs& in, Outputs& out) { globalPool(n, in, out, true); }
+
+// --- Normalization ------------------------------------------------------------
+
+void opBatchNormalization(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    const Tensor& scale = input(node, in, 1);
+    const Tensor& shift = input(node, in, 2);
+    const Tensor& mean = input(node, in, 3);
+    const Tensor& var = input(node, in, 4);
+    const float epsilon = node.getFloat("epsilon", 1e-5f);
+
+    const int64_t batch = x.dim(0), channels = x.dim(1);
+    const size_t plane = x.size() / static_cast<size_t>(batch * channels);
+    Tensor& y = out[0];
+    y = Tensor(x.shape);
+    for (int64_t c = 0; c < channels; ++c) {
+        const float a = scale.data[c] / std::sqrt(var.data[c] + epsilon);
+        const float b = shift.data[c] - mean.data[c] * a;
+        for (int64_t n = 0; n < batch; ++n) {
+            const size_t offset = static_cast<size_t>(n * channels + c) * plane;
+            for (size_t i = 0; i < plane; ++i) {
+                y.data[offset + i] = x.data[offset + i] * a + b;
+            }
+        }
+    }
+}
+
+void opInstanceNormalization(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    const Tensor& scale = input(node, in, 1);
+    const Tensor& shift = input(node, in, 2);
+    const float epsilon = node.getFloat("epsilon", 1e-5f);
+
+    const int64_t batch = x.dim(0), channels = x.dim(1);
+    const size_t plane = x.size() / static_cast<size_t>(batch * channels);
+    Tensor& y = out[0];
+    y = Tensor(x.shape);
+    for (int64_t p = 0; p < batch * channels; ++p) {
+        const float* src = x.data.data() + p * plane;
+        double sum = 0.0, sq = 0.0;
+        for (size_t i = 0; i < plane; ++i) {
+            sum += src[i];
+            sq += static_cast<double>(src[i]) * src[i];
+        }
+        const double mean = sum / plane;
+        const double var = std::max(0.0, sq / plane - mean * mean);
+        const int64_t c = p % channels;
+        const float a = static_cast<float>(scale.data[c] / std::sqrt(var + epsilon));
+        const float b = static_cast<float>(shift.data[c] - mean * a);
+        float* dst = y.data.data() + p * plane;
+        for (size_t i = 0; i < plane; ++i) {
+            dst[i] = src[i] * a + b;
+        }
+    }
+}
+
+void opSoftmax(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    const int axis = normalizeAxis(node, node.getInt("axis", -1), x.rank());
+    const size_t axis_size = static_cast<size_t>(x.shape[axis]);
+    size_t inner = 1;
+    for (int i = axis + 1; i < x.rank(); ++i) {
+        inner *= static_cast<size_t>(x.shape[i]);
+    }
+    const size_t outer = x.size() / (axis_size * inner);
+
+    Tensor& y = out[0];
+    y = Tensor(x.shape);
+    for (size_t o = 0; o < outer; ++o) {
+        for (size_t i = 0; i < inner; ++i) {
+            const size_t base = o * axis_size * inner + i;
+            float peak = -std::numeric_limits<float>::infinity();
+            for (size_t k = 0; k < axis_size; ++k) {
+                peak = std::max(peak, x.data[base + k * inner]);
+            }
+            float sum = 0.0f;
+            for (size_t k = 0; k < axis_size; ++k) {
+                float e = std::exp(x.data[base + k * inner] - peak);
+                y.data[base + k * inner] = e;
+                sum += e;
+            }
+            for (size_t k = 0; k < axis_size; ++k) {
+                y.data[base + k * inner] /= sum;
+            }
+        }
+    }
+}
+
+void opReduceMean(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    std::vector<int64_t> axes = intsFrom(node, in, "axes", 1);
+    const bool keepdims = node.getInt("keepdims", 1) != 0;
+    std::vector<bool> reduce(x.rank(), axes.empty());
+    for (int64_t a : axes) {
+        reduce[normalizeAxis(node, a, x.rank())] = true;
+    }
+
+    std::vector<int64_t> kept_shape = x.shape;
+    for (int i = 0; i < x.rank(); ++i) {
+        if (reduce[i]) {
+            kept_shape[i] = 1;
+        }
+    }
+    Tensor sum(kept_shape);
+    std::vector<size_t> out_strides = broadcastStrides(kept_shape, x.shape);
+    std::vector<int64_t> index(x.rank(), 0);
+    for (size_t i = 0; i < x.size(); ++i) {
+        size_t o = 0;
+        for (int d = 0; d < x.rank(); ++d) {
+            o += index[d] * out_strides[d];
+        }
+        sum.data[o] += x.data[i];
+        for (int d = x.rank() - 1; d >= 0; --d) {
+            if (++index[d] < x.shape[d]) {
+                break;
+            }
+            index[d] = 0;
+        }
+    }
+    const float count = static_cast<float>(x.size() / std::max<size_t>(1, sum.size()));
+    for (float& v : sum.data) {
+        v /= count;
+    }
+
+    if (!keepdims) {
+        std::vector<int64_t> shape;
+        for (int i = 0; i < x.rank(); ++i) {
+            if (!reduce[i]) {
+                shape.push_back(x.shape[i]);
+            }
+        }
+        sum.shape = shape;
+    }
+    out[0] = std::move(sum);
+}
+
+// --- Linear algebra -----------------------------------------------------------
+
+// c[m x n] (+)= a[m x k] * b[k x n] with explicit strides for transposes
+void gemm(const float* a, size_t a_row, size_t a_col, const float* b, size_t b_row, size_t b_col,
+          float* c, int m, int n, int k, float alpha) {
+    for (int i = 0; i < m; ++i) {
+        float* crow = c + static_cast<size_t>(i) * n;
+        for (int p = 0; p < k; ++p) {
+            const float av = alpha * a[i * a_row + p * a_col];
+            const float* brow = b + p * b_row;
+            for (int j = 0; j < n; ++j) {
+                crow[j] += av * brow[j * b_col];
+            }
+        }
+    }
+}
+
+void opGemm(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& a = input(node, in, 0);
+    const Tensor& b = input(node, in, 1);
+    const Tensor* c = optionalInput(in, 2);
+    const bool trans_a = node.getInt("transA", 0) != 0;
+    const bool trans_b = node.getInt("transB", 0) != 0;
+    const float alpha = node.getFloat("alpha", 1.0f);
+    const float beta = node.getFloat("beta", 1.0f);
+    if (a.rank() != 2 || b.rank() != 2) {
+        fail(node, "expected 2-D operands");
+    }
+
+    const int m = static_cast<int>(trans_a ? a.shape[1] : a.shape[0]);
+    const int k = static_cast<int>(trans_a ? a.shape[0] : a.shape[1]);
+    const int n = static_cast<int>(trans_b ? b.shape[0] : b.shape[1]);
+    if ((trans_b ? b.shape[1] : b.shape[0]) != k) {
+        fail(node, "inner dimensions differ");
+    }
+
+    Tensor y({m, n});
+    if (c && beta != 0.0f) {
+        y = broadcastBinary(node, y, *c, [beta](float, float cv) { return beta * cv; });
+    }
+    gemm(a.data.data(), trans_a ? 1 : k, trans_a ? m : 1,
+         b.data.data(), trans_b ? 1 : n, trans_b ? k : 1,
+         y.data.data(), m, n, k, alpha);
+    out[0] = std::move(y);
+}
+
+void opMatMul(const Node& node, const Inputs& in, Outputs& out) {
+    Tensor a = input(node, in, 0);
+    Tensor b = input(node, in, 1);
+    const bool vector_a = a.rank() == 1, vector_b = b.rank() == 1;
+    if (vector_a) {
+        a.shape.insert(a.shape.begin(), 1);
+    }
+    if (vector_b) {
+        b.shape.push_back(1);
+    }
+
+    const int m = static_cast<int>(a.dim(-2)), k = static_cast<int>(a.dim(-1));
+    const int n = static_cast<int>(b.dim(-1));
+    if (b.dim(-2) != k) {
+        fail(node, "inner dimensions differ");
+    }
+
+    std::vector<int64_t> batch_a(a.shape.begin(), a.shape.end() - 2);
+    std::vector<int64_t> batch_b(b.shape.begin(), b.shape.end() - 2);
+    std::vector<int64_t> batch = broadcastShape(node, batch_a, batch_b);
+    std::vector<size_t> stride_a = broadcastStrides(batch_a, batch);
+    std::vector<size_t> stride_b = broadcastStrides(batch_b, batch);
+
+    std::vector<int64_t> shape = batch;
+    shape.push_back(m);
+    shape.push_back(n);
+    Tensor y(shape);
+
+    const size_t batches = shapeSize(batch);
+    std::vector<int64_t> index(batch.size(), 0);
+    for (size_t i = 0; i < batches; ++i) {
+        size_t oa = 0, ob = 0;
+        for (size_t d = 0; d < batch.size(); ++d) {
+            oa += index[d] * stride_a[d];
+            ob += index[d] * stride_b[d];
+        }
+        gemm(a.data.data() + oa * m * k, k, 1, b.data.data() + ob * k * n, n, 1,
+             y.data.data() + i * m * n, m, n, k, 1.0f);
+        for (int d = static_cast<int>(batch.size()) - 1; d >= 0; --d) {
+            if (++index[d] < batch[d]) {
+                break;
+            }
+            index[d] = 0;
+        }
+    }
+
+    if (vector_b) {
+        y.shape.pop_back();
+    }
+    if (vector_a) {
+        y.shape.erase(y.shape.end() - (vector_b ? 1 : 2));
+    }
+    out[0] = std::move(y);
+}
+
+// --- Shape manipulation -------------------------------------------------------
+
+void opReshape(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    std::vector<int64_t> shape = intsFrom(node, in, "shape", 1);
+    int infer = -1;
+    int64_t known = 1;
+    for (size_t i = 0; i < shape.size(); ++i) {
+        if (shape[i] == 0 && i < x.shape.size()) {
+            shape[i] = x.shape[i];
+        }
+        if (shape[i] == -1) {
+            infer = static_cast<int>(i);
+        } else {
+            known *= shape[i];
+        }
+    }
+    if (infer >= 0) {
+        shape[infer] = known ? static_cast<int64_t>(x.size()) / known : 0;
+    }
+    if (shapeSize(shape) != x.size()) {
+        fail(node, "element count changes");
+    }
+    out[0] = Tensor(shape, x.data);
+}
+
+void opFlatten(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    int64_t axis = node.getInt("axis", 1);
+    if (axis < 0) {
+        axis += x.rank();
+    }
+    int64_t outer = 1;
+    for (int64_t i = 0; i < axis; ++i) {
+        outer *= x.shape[i];
+    }
+    out[0] = Tensor({outer, outer ? static_cast<int64_t>(x.size()) / outer : 0}, x.data);
+}
+
+void opSqueeze(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    std::vector<int64_t> axes = intsFrom(node, in, "axes", 1);
+    std::vector<bool> drop(x.rank(), false);
+    for (int64_t a : axes) {
+        drop[normalizeAxis(node, a, x.rank())] = true;
+    }
+    std::vector<int64_t> shape;
+    for (int i = 0; i < x.rank(); ++i) {
+        bool squeeze = axes.empty() ? x.shape[i] == 1 : drop[i];
+        if (!squeeze) {
+            shape.push_back(x.shape[i]);
+        }
+    }
+    out[0] = Tensor(shape, x.data);
+}
+
+void opUnsqueeze(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    std::vector<int64_t> axes = intsFrom(node, in, "axes", 1);
+    const int rank = x.rank() + static_cast<int>(axes.size());
+    std::vector<bool> inserted(rank, false);
+    for (int64_t a : axes) {
+        inserted[normalizeAxis(node, a, rank)] = true;
+    }
+    std::vector<int64_t> shape;
+    size_t next = 0;
+    for (int i = 0; i < rank; ++i) {
+        shape.push_back(inserted[i] ? 1 : x.shape[next++]);
+    }
+    out[0] = Tensor(shape, x.data);
+}
+
+void opTranspose(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    std::vector<int64_t> perm = node.getInts("perm");
+    if (perm.empty()) {
+        for (int i = x.rank() - 1; i >= 0; --i) {
+            perm.push_back(i);
+        }
+    }
+
+    std::vector<int64_t> shape(x.rank());
+    for (int i = 0; i < x.rank(); ++i) {
+        shape[i] = x.shape[perm[i]];
+    }
+    std::vector<size_t> src_strides = stridesOf(x.shape);
+    Tensor y(shape);
+    std::vector<int64_t> index(x.rank(), 0);
+    for (size_t i = 0; i < y.size(); ++i) {
+        size_t offset = 0;
+        for (int d = 0; d < x.rank(); ++d) {
+            offset += index[d] * src_strides[perm[d]];
+        }
+        y.data[i] = x.data[offset];
+        for (int d = x.rank() - 1; d >= 0; --d) {
+            if (++index[d] < shape[d]) {
+                break;
+            }
+            index[d] = 0;
+        }
+    }
+    out[0] = std::move(y);
+}
+
+void opConcat(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& first = input(node, in, 0);
+    const int axis = normalizeAxis(node, node.getInt("axis", 0), first.rank());
+    std::vector<int64_t> shape = first.shape;
+    shape[axis] = 0;
+    for (size_t i = 0; i < in.size(); ++i) {
+        shape[axis] += input(node, in, i).shape[axis];
+    }
+
+    size_t outer = 1;
+    for (int i = 0; i < axis; ++i) {
+        outer *= static_cast<size_t>(shape[i]);
+    }
+    Tensor y(shape);
+    const size_t out_block = y.size() / std::max<size_t>(1, outer);
+    size_t offset = 0;
+    for (size_t i = 0; i < in.size(); ++i) {
+        const Tensor& t = *in[i];
+        const size_t block = t.size() / std::max<size_t>(1, outer);
+        for (size_t o = 0; o < outer; ++o) {
+            std::copy(t.data.begin() + o * block, t.data.begin() + (o + 1) * block,
+                      y.data.begin() + o * out_block + offset);
+        }
+        offset += block;
+    }
+    out[0] = std::move(y);
+}
+
+void opSplit(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    const int axis = normalizeAxis(node, node.getInt("axis", 0), x.rank());
+    std::vector<int64_t> split = intsFrom(node, in, "split", 1);
+    if (split.empty()) {
+        split.assign(out.size(), x.shape[axis] / static_cast<int64_t>(out.size()));
+    }
+    if (split.size() != out.size()) {
+        fail(node, "split count does not match outputs");
+    }
+
+    size_t outer = 1, inner = 1;
+    for (int i = 0; i < axis; ++i) {
+        outer *= static_cast<size_t>(x.shape[i]);
+    }
+    for (int i = axis + 1; i < x.rank(); ++i) {
+        inner *= static_cast<size_t>(x.shape[i]);
+    }
+    const size_t in_block = static_cast<size_t>(x.shape[axis]) * inner;
+    size_t offset = 0;
+    for (size_t s = 0; s < split.size(); ++s) {
+        std::vector<int64_t> shape = x.shape;
+        shape[axis] = split[s];
+        out[s] = Tensor(shape);
+        const size_t block = static_cast<size_t>(split[s]) * inner;
+        for (size_t o = 0; o < outer; ++o) {
+            std::copy(x.data.begin() + o * in_block + offset, x.data.begin() + o * in_block + offset + block,
+                      out[s].data.begin() + o * block);
+        }
+        offset += block;
+    }
+}
+
+void opSlice(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    std::vector<int64_t> starts = intsFrom(node, in, "starts", 1);
+    std::vector<int64_t> ends = intsFrom(node, in, "ends", 2);
+    std::vector<int64_t> axes = intsFrom(node, in, "axes", 3);
+    std::vector<int64_t> steps = intsFrom(node, in, "steps", 4);
+
+    std::vector<int64_t> begin(x.rank(), 0), step(x.rank(), 1), shape = x.shape;
+    for (size_t i = 0; i < starts.size(); ++i) {
+        const int axis = normalizeAxis(node, axes.empty() ? static_cast<int64_t>(i) : axes[i], x.rank());
+        const int64_t size = x.shape[axis];
+        const int64_t s = steps.empty() ? 1 : steps[i];
+        if (s == 0) {
+            fail(node, "zero step");
+        }
+        int64_t b = starts[i] < 0 ? starts[i] + size : starts[i];
+        int64_t e = ends[i] < 0 ? ends[i] + size : std::min(ends[i], size);
+        if (s > 0) {
+            b = std::min(std::max<int64_t>(b, 0), size);
+            e = std::min(std::max<int64_t>(e, 0), size);
+            shape[axis] = std::max<int64_t>(0, (e - b + s - 1) / s);
+        } else {
+            b = std::min(std::max<int64_t>(b, -1), size - 1);
+            e = std::min(std::max<int64_t>(e, -1), size - 1);
+            shape[axis] = std::max<int64_t>(0, (b - e - s - 1) / -s);
+        }
+        begin[axis] = b;
+        step[axis] = s;
+    }
+
+    std::vector<size_t> strides = stridesOf(x.shape);
+    Tensor y(shape);
+    std::vector<int64_t> index(x.rank(), 0);
+    for (size_t i = 0; i < y.size(); ++i) {
+        size_t offset = 0;
+        for (int d = 0; d < x.rank(); ++d) {
+            offset += (begin[d] + index[d] * step[d]) * strides[d];
+        }
+        y.data[i] = x.data[offset];
+        for (int d = x.rank() - 1; d >= 0; --d) {
+            if (++index[d] < shape[d]) {
+                break;
+            }
+            index[d] = 0;
+        }
+    }
+    out[0] = std::move(y);
+}
+
+void opPad(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    std::vector<int64_t> pads = intsFrom(node, in, "pads", 1);
+    float value = node.getFloat("value", 0.0f);
+    if (const Tensor* t = optionalInput(in, 2)) {
+        value = t->data.empty() ? 0.0f : t->data[0];
+    }
+    const std::string mode = node.getString("mode", "constant");
+    const int rank = x.rank();
+    if (pads.size() != static_cast<size_t>(2 * rank)) {
+        fail(node, "pads must have 2 * rank entries");
+    }
+
+    std::vector<int64_t> shape(rank);
+    for (int d = 0; d < rank; ++d) {
+        shape[d] = x.shape[d] + pads[d] + pads[d + rank];
+    }
+    std::vector<size_t> strides = stridesOf(x.shape);
+    Tensor y(shape);
+    std::vector<int64_t> index(rank, 0);
+    for (size_t i = 0; i < y.size(); ++i) {
+        size_t offset = 0;
+        bool outside = false;
+        for (int d = 0; d < rank; ++d) {
+            int64_t p = index[d] - pads[d];
+            const int64_t size = x.shape[d];
+            if (p < 0 || p >= size) {
+                if (mode == "edge") {
+                    p = std::min(std::max<int64_t>(p, 0), size - 1);
+                } else if (mode == "reflect" && size > 1) {
+                    const int64_t period = 2 * (size - 1);
+                    p = ((p % period) + period) % period;
+                    if (p >= size) {
+                        p = period - p;
+                    }
+                } else {
+                    outside = true;
+                }
+            }
+            offset += p * strides[d];
+        }
+        y.data[i] = outside ? value : x.data[offset];
+        for (int d = rank - 1; d >= 0; --d) {
+            if (++index[d] < shape[d]) {
+                break;
+            }
+            index[d] = 0;
+        }
+    }
+    out[0] = std::move(y);
+}
+
+void opShape(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    std::vector<float> dims(x.shape.begin(), x.shape.end());
+    out[0] = Tensor({static_cast<int64_t>(dims.size())}, dims);
+}
+
+void opGather(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    const Tensor& indices = input(node, in, 1);
+    const int axis = normalizeAxis(node, node.getInt("axis", 0), x.rank());
+
+    std::vector<int64_t> shape(x.shape.begin(), x.shape.begin() + axis);
+    shape.insert(shape.end(), indices.shape.begin(), indices.shape.end());
+    shape.insert(shape.end(), x.shape.begin() + axis + 1, x.shape.end());
+
+    size_t outer = 1, inner = 1;
+    for (int i = 0; i < axis; ++i) {
+        outer *= static_cast<size_t>(x.shape[i]);
+    }
+    for (int i = axis + 1; i < x.rank(); ++i) {
+        inner *= static_cast<size_t>(x.shape[i]);
+    }
+    const int64_t axis_size = x.shape[axis];
+    Tensor y(shape);
+    size_t pos = 0;
+    for (size_t o = 0; o < outer; ++o) {
+        for (float fi : indices.data) {
+            int64_t idx = static_cast<int64_t>(fi);
+            if (idx < 0) {
+                idx += axis_size;
+            }
+            if (idx < 0 || idx >= axis_size) {
+                fail(node, "index out of range");
+            }
+            const float* src = x.data.data() + (o * axis_size + idx) * inner;
+            std::copy(src, src + inner, y.data.begin() + pos);
+            pos += inner;
+        }
+    }
+    out[0] = std::move(y);
+}
+
+void opExpand(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    Tensor ones(toInts(input(node, in, 1)));
+    out[0] = broadcastBinary(node, x, ones, [](float a, float) { return a; });
+}
+
+void opConstant(const Node& node, const Inputs&, Outputs& out) {
+    auto it = node.tensors.find("value");
+    if (it != node.tensors.end()) {
+        out[0] = it->second;
+    } else if (node.floats.count("value_float")) {
+        out[0] = Tensor({}, {node.floats.at("value_float")});
+    } else if (node.ints.count("value_int")) {
+        out[0] = Tensor({}, {static_cast<float>(node.ints.at("value_int"))});
+    } else if (node.float_lists.count("value_floats")) {
+        const auto& values = node.float_lists.at("value_floats");
+        out[0] = Tensor({static_cast<int64_t>(values.size())}, values);
+    } else if (node.int_lists.count("value_ints")) {
+        const auto& values = node.int_lists.at("value_ints");
+        out[0] = Tensor({static_cast<int64_t>(values.size())}, std::vector<float>(values.begin(), values.end()));
+    } else {
+        fail(node, "unsupported constant value");
+    }
+}
+
+void opConstantOfShape(const Node& node, const Inputs& in, Outputs& out) {
+    Tensor y(toInts(input(node, in, 0)));
+    auto it = node.tensors.find("value");
+    if (it != node.tensors.end() && !it->second.empty()) {
+        std::fill(y.data.begin(), y.data.end(), it->second.data[0]);
+    }
+    out[0] = std::move(y);
+}
+
+// --- Resampling ---------------------------------------------------------------
+
+float sourceCoordinate(const std::string& mode, int x, float scale, int in_size, int out_size) {
+    if (mode == "align_corners") {
+        return out_size > 1 ? x * static_cast<float>(in_size - 1) / (out_size - 1) : 0.0f;
+    }
+    if (mode == "asymmetric") {
+        return x / scale;
+    }
+    if (mode == "pytorch_half_pixel") {
+        return out_size > 1 ? (x + 0.5f) / scale - 0.5f : 0.0f;
+    }
+    if (mode == "tf_half_pixel_for_nn") {
+        return (x + 0.5f) / scale;
+    }
+    return (x + 0.5f) / scale - 0.5f;   // half_pixel
+}
+
+int nearestIndex(const std::string& mode, float coordinate, int size) {
+    int index;
+    if (mode == "floor") {
+        index = static_cast<int>(std::floor(coordinate));
+    } else if (mode == "ceil") {
+        index = static_cast<int>(std::ceil(coordinate));
+    } else if (mode == "round_prefer_ceil") {
+        index = static_cast<int>(std::floor(coordinate + 0.5f));
+    } else {    // round_prefer_floor
+        index = static_cast<int>(std::ceil(coordinate - 0.5f));
+    }
+    return std::min(std::max(index, 0), size - 1);
+}
+
+void resample(const Node& node, const Tensor& x, std::vector<float> scales, std::vector<int64_t> sizes,
+              const std::string& coordinate_mode, const std::string& nearest_mode, Outputs& out) {
+    if (x.rank() != 4) {
+        fail(node, "only NCHW inputs are supported");
+    }
+    if (sizes.empty()) {
+        if (scales.size() != 4) {
+            fail(node, "expected 4 scales or sizes");
+        }
+        for (int i = 0; i < 4; ++i) {
+            sizes.push_back(static_cast<int64_t>(std::floor(x.shape[i] * scales[i])));
+        }
+    } else {
+        scales.resize(4);
+        for (int i = 0; i < 4; ++i) {
+            scales[i] = static_cast<float>(sizes[i]) / x.shape[i];
+        }
+    }
+    if (sizes[0] != x.shape[0] || sizes[1] != x.shape[1]) {
+        fail(node, "only spatial resizing is supported");
+    }
+
+    const std::string mode = node.getString("mode", "nearest");
+    const int in_h = static_cast<int>(x.shape[2]), in_w = static_cast<int>(x.shape[3]);
+    const int out_h = static_cast<int>(sizes[2]), out_w = static_cast<int>(sizes[3]);
+    Tensor y(sizes);
+    const size_t in_plane = static_cast<size_t>(in_h) * in_w;
+    const size_t out_plane = static_cast<size_t>(out_h) * out_w;
+
+    // Per-axis sample positions are shared by every plane
+    std::vector<int> x0(out_w), x1(out_w), y0(out_h), y1(out_h);
+    std::vector<float> wx(out_w, 0.0f), wy(out_h, 0.0f);
+    const bool linear = (mode == "linear" || mode == "bilinear");
+    auto axis = [&](int out_size, int in_size, float scale, std::vector<int>& i0, std::vector<int>& i1,
+                    std::vector<float>& w) {
+        for (int o = 0; o < out_size; ++o) {
+            float c = sourceCoordinate(coordinate_mode, o, scale, in_size, out_size);
+            if (linear) {
+                c = std::min(std::max(c, 0.0f), static_cast<float>(in_size - 1));
+                i0[o] = static_cast<int>(c);
+                i1[o] = std::min(i0[o] + 1, in_size - 1);
+                w[o] = c - i0[o];
+            } else {
+                i0[o] = i1[o] = nearestIndex(nearest_mode, c, in_size);
+            }
+        }
+    };
+    axis(out_w, in_w, scales[3], x0, x1, wx);
+    axis(out_h, in_h, scales[2], y0, y1, wy);
+
+    for (int64_t p = 0; p < x.shape[0] * x.shape[1]; ++p) {
+        const float* src = x.data.data() + p * in_plane;
+        float* dst = y.data.data() + p * out_plane;
+        for (int oy = 0; oy < out_h; ++oy) {
+            const float* r0 = src + static_cast<size_t>(y0[oy]) * in_w;
+            const float* r1 = src + static_cast<size_t>(y1[oy]) * in_w;
+            float* drow = dst + static_cast<size_t>(oy) * out_w;
+            for (int ox = 0; ox < out_w; ++ox) {
+                const float top = r0[x0[ox]] + (r0[x1[ox]] - r0[x0[ox]]) * wx[ox];
+                const float bottom = r1[x0[ox]] + (r1[x1[ox]] - r1[x0[ox]]) * wx[ox];
+                drow[ox] = top + (bottom - top) * wy[oy];
+            }
+        }
+    }
+    out[0] = std::move(y);
+}
+
+void opResize(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    std::vector<float> scales;
+    std::vector<int64_t> sizes;
+    // Opset 10: (X, scales); opset 11+: (X, roi, scales, sizes)
+    const Tensor* scale_input = optionalInput(in, in.size() == 2 ? 1 : 2);
+    if (scale_input) {
+        scales = scale_input->data;
+    }
+    if (const Tensor* size_input = optionalInput(in, 3)) {
+        if (!size_input->empty()) {
+            sizes = toInts(*size_input);
+        }
+    }
+    resample(node, x, scales, sizes,
+             node.getString("coordinate_transformation_mode", in.size() == 2 ? "asymmetric" : "half_pixel"),
+             node.getString("nearest_mode", in.size() == 2 ? "floor" : "round_prefer_floor"), out);
+}
+
+void opUpsample(const Node& node, const Inputs& in, Outputs& out) {
+    const Tensor& x = input(node, in, 0);
+    std::vector<float> scales;
+    if (const Tensor* t = optionalInput(in, 1)) {
+        scales = t->data;
+    } else if (node.float_lists.count("scales")) {
+        scales = node.float_lists.at("scales");
+    }
+    resample(node, x, scales, {}, "asymmetric", "floor", out);
+}
+
+const std::map<std::string, OpFunction>& opRegistry() {
+    static const std::map<std::string, OpFunction> registry = {
+        {"Abs", opAbs}, {"Add", opAdd}, {"AveragePool", opAveragePool},
+        {"BatchNormalization", opBatchNormalization}, {"Cast", opCast}, {"Clip", opClip},
+        {"Concat", opConcat}, {"Constant", opConstant}, {"ConstantOfShape", opConstantOfShape},
+        {"Conv", opConv}, {"ConvTranspose", opConvTranspose}, {"Div", opDiv}, {"Dropout", opIdentity},
+        {"Elu", opElu}, {"Erf", opErf}, {"Exp", opExp}, {"Expand", opExpand}, {"Flatten", opFlatten},
+        {"Floor", opFloor}, {"Gather", opGather}, {"Gemm", opGemm},
+        {"GlobalAveragePool", opGlobalAveragePool}, {"GlobalMaxPool", opGlobalMaxPool},
+        {"HardSigmoid", opHardSigmoid}, {"HardSwish", opHardSwish}, {"Identity", opIdentity},
+        {"InstanceNormalization", opInstanceNormalization}, {"LeakyRelu", opLeakyRelu},
+        {"MatMul", opMatMul}, {"Max", opMax}, {"MaxPool", opMaxPool}, {"Min", opMin}, {"Mul", opMul},
+        {"Neg", opNeg}, {"Pad", opPad}, {"Pow", opPow}, {"PRelu", opPRelu}, {"ReduceMean", opReduceMean},
+        {"Relu", opRelu}, {"Reshape", opReshape}, {"Resize", opResize}, {"Shape", opShape},
+        {"Sigmoid", opSigmoid}, {"Slice", opSlice}, {"Softmax", opSoftmax}, {"Softplus", opSoftplus},
+        {"Split", opSplit}, {"Sqrt", opSqrt}, {"Squeeze", opSqueeze}, {"Sub", opSub}, {"Tanh", opTanh},
+        {"Transpose", opTranspose}, {"Unsqueeze", opUnsqueeze}, {"Upsample", opUpsample},
+    };
+    return registry;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Network
+
+class Network::Impl {
+public:
+    struct Step {
+        OpFunction run;
+        const Node* node;
+        std::vector<int> inputs;     // Value slots, -1 for omitted inputs
+        std::vector<int> outputs;
+        std::vector<int> release;    // Slots whose last reader is this step
+        std::shared_ptr<PackedConv> conv;   // Set when the step runs a packed conv instead of `run`
+    };
+
+    // Folds BatchNormalization and a trailing Relu/LeakyRelu/Clip into each
+    // Conv with constant weights, then repacks the weights for the blocked
+    // kernels. Folded nodes are marked removed and the Conv takes over the
+    // last folded output name.
+    void fuseConvolutions(std::map<size_t, std::shared_ptr<PackedConv>>& packed, std::vector<bool>& removed) {
+        auto& nodes = graph_.nodes;
+        std::map<std::string, std::vector<size_t>> readers;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            for (const auto& name : nodes[i].inputs) {
+                readers[name].push_back(i);
+            }
+        }
+        for (const auto& info : graph_.outputs) {
+            readers[info.name].push_back(nodes.size());   // Graph outputs must stay observable
+        }
+        auto constant = [this](const std::string& name) -> const Tensor* {
+            auto it = graph_.initializers.find(name);
+            return it != graph_.initializers.end() ? &it->second : nullptr;
+        };
+        auto soleReader = [&](const std::string& name, const char* op_type) -> Node* {
+            const auto& list = readers[name];
+            if (list.size() != 1 || list[0] >= nodes.size() || removed[list[0]]) {
+                return nullptr;
+            }
+            Node& next = nodes[list[0]];
+            return (next.op_type == op_type && next.inputs[0] == name) ? &next : nullptr;
+        };
+
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            Node& node = nodes[i];
+            if (node.op_type != "Conv" || node.inputs.size() < 2 || node.outputs.size() != 1) {
+                continue;
+            }
+            const Tensor* weights = constant(node.inputs[1]);
+            const bool has_bias = node.inputs.size() > 2 && !node.inputs[2].empty();
+            const Tensor* bias = has_bias ? constant(node.inputs[2]) : nullptr;
+            const int group = static_cast<int>(node.getInt("group", 1));
+            // 1-D convolutions and malformed weights stay on the reference path
+            if (!weights || weights->rank() != 4 || (has_bias && !bias) || group <= 0 ||
+                weights->shape[0] % group != 0) {
+                continue;
+            }
+            const int64_t out_channels = weights->shape[0];
+            Tensor folded_weights = *weights;
+            Tensor folded_bias({out_channels});
+            if (bias) {
+                folded_bias.data = bias->data;
+            }
+            std::string output = node.outputs[0];
+
+            if (Node* bn = soleReader(output, "BatchNormalization")) {
+                const Tensor *scale = nullptr, *shift = nullptr, *mean = nullptr, *var = nullptr;
+                if (bn->inputs.size() == 5) {
+                    scale = constant(bn->inputs[1]);
+                    shift = constant(bn->inputs[2]);
+                    mean = constant(bn->inputs[3]);
+                    var = constant(bn->inputs[4]);
+                }
+                bool foldable = scale && shift && mean && var && bn->outputs.size() == 1;
+                for (const Tensor* t : {scale, shift, mean, var}) {
+                    foldable = foldable && static_cast<int64_t>(t->size()) == out_channels;
+                }
+                if (foldable) {
+                    const float epsilon = bn->getFloat("epsilon", 1e-5f);
+                    const size_t per_channel = folded_weights.size() / out_channels;
+                    for (int64_t m = 0; m < out_channels; ++m) {
+                        const float a = scale->data[m] / std::sqrt(var->data[m] + epsilon);
+                        for (size_t k = 0; k < per_channel; ++k) {
+                            folded_weights.data[m * per_channel + k] *= a;
+                        }
+                        folded_bias.data[m] = (folded_bias.data[m] - mean->data[m]) * a + shift->data[m];
+                    }
+                    removed[bn - nodes.data()] = true;
+                    output = bn->outputs[0];
+                }
+            }
+
+            auto conv = std::make_shared<PackedConv>();
+            Node* act = nullptr;
+            if ((act = soleReader(output, "Relu"))) {
+                conv->activation = Activation::RELU;
+            } else if ((act = soleReader(output, "LeakyRelu"))) {
+                conv->activation = Activation::LEAKY_RELU;
+                conv->alpha = act->getFloat("alpha", 0.01f);
+            } else if ((act = soleReader(output, "Clip"))) {
+                conv->lower = act->getFloat("min", -std::numeric_limits<float>::infinity());
+                conv->upper = act->getFloat("max", std::numeric_limits<float>::infinity());
+                const Tensor* lower = act->inputs.size() > 1 && !act->inputs[1].empty() ? constant(act->inputs[1]) : nullptr;
+                const Tensor* upper = act->inputs.size() > 2 && !act->inputs[2].empty() ? constant(act->inputs[2]) : nullptr;
+                const bool dynamic = (act->inputs.size() > 1 && !act->inputs[1].empty() && (!lower || lower->empty())) ||
+                                     (act->inputs.size() > 2 && !act->inputs[2].empty() && (!upper || upper->empty()));
+                if (dynamic) {
+                    act = nullptr;
+                } else {
+                    conv->activation = Activation::CLIP;
+                    conv->lower = lower ? lower->data[0] : conv->lower;
+                    conv->upper = upper ? upper->data[0] : conv->upper;
+                }
+            }
+            if (act) {
+                removed[act - nodes.data()] = true;
+                output = act->outputs[0];
+            }
+
+            packConv(folded_weights, &folded_bias, group, *conv);
+            node.outputs[0] = output;
+            packed[i] = std::move(conv);
+        }
+    }
+
+    bool build(Graph graph) {
+        graph_ = std::move(graph);
+        steps_.clear();
+        slots_.clear();
+        slot_names_.clear();
+        weight_bytes_ = 0;
+
+        std::map<size_t, std::shared_ptr<PackedConv>> packed;
+        std::vector<bool> removed(graph_.nodes.size(), false);
+        if (optimize_) {
+            fuseConvolutions(packed, removed);
+        }
+
+        std::map<std::string, int> slot_of;
+        auto slot = [&](const std::string& name) {
+            auto it = slot_of.find(name);
+            if (it != slot_of.end()) {
+                return it->second;
+            }
+            int id = static_cast<int>(slot_names_.size());
+            slot_of[name] = id;
+            slot_names_.push_back(name);
+            return id;
+        };
+
+        for (auto& entry : graph_.initializers) {
+            slot(entry.first);
+        }
+        input_slots_.clear();
+        for (const auto& info : graph_.inputs) {
+            input_slots_.push_back(slot(info.name));
+        }
+
+        std::vector<bool> produced(slot_names_.size(), true);
+        const auto& registry = opRegistry();
+        for (size_t i = 0; i < graph_.nodes.size(); ++i) {
+            const Node& node = graph_.nodes[i];
+            if (removed[i]) {
+                continue;
+            }
+            auto op = registry.find(node.op_type);
+            if (op == registry.end()) {
+                last_error_ = "unsupported operator " + node.op_type;
+                return false;
+            }
+            Step step{op->second, &node, {}, {}, {}, nullptr};
+            auto fused = packed.find(i);
+            if (fused != packed.end()) {
+                step.conv = fused->second;   // Reads only X; weights live in the packed copy
+            }
+            for (const auto& name : node.inputs) {
+                if (step.conv && !step.inputs.empty()) {
+                    break;
+                }
+                if (name.empty()) {
+                    step.inputs.push_back(-1);
+                    continue;
+                }
+                auto it = slot_of.find(name);
+                if (it == slot_of.end()) {
+                    last_error_ = "node " + node.name + " reads undefined value " + name;
+                    return false;
+                }
+                step.inputs.push_back(it->second);
+            }
+            for (const auto& name : node.outputs) {
+                step.outputs.push_back(name.empty() ? -1 : slot(name));
+            }
+            steps_.push_back(std::move(step));
+        }
+
+        output_slots_.clear();
+        for (const auto& info : graph_.outputs) {
+            auto it = slot_of.find(info.name);
+            if (it == slot_of.end()) {
+                last_error_ = "graph output " + info.name + " is never produced";
+                return false;
+            }
+            output_slots_.push_back(it->second);
+        }
+
+        // Free intermediates after their last reader to bound peak memory
+        std::vector<int> last_use(slot_names_.size(), -1);
+        for (size_t i = 0; i < steps_.size(); ++i) {
+            for (int s : steps_[i].inputs) {
+                if (s >= 0) {
+                    last_use[s] = static_cast<int>(i);
+                }
+            }
+        }
+
+        // Initializers that were folded into packed convs are not needed again
+        std::vector<bool> output_slot(slot_names_.size(), false);
+        for (int s : output_slots_) {
+            output_slot[s] = true;
+        }
+        for (auto it = graph_.initializers.begin(); it != graph_.initializers.end();) {
+            const int s = slot_of[it->first];
+            it = (last_use[s] < 0 && !output_slot[s]) ? graph_.initializers.erase(it) : std::next(it);
+        }
+        for (const auto& entry : graph_.initializers) {
+            weight_bytes_ += entry.second.size() * sizeof(float);
+        }
+        for (const auto& entry : packed) {
+            weight_bytes_ += (entry.second->weights.size() + entry.second->bias.size()) * sizeof(float);
+        }
+        std::vector<bool> keep(slot_names_.size(), false);
+        for (auto& entry : graph_.initializers) {
+            keep[slot_of[entry.first]] = true;
+        }
+        for (int s : output_slots_) {
+            keep[s] = true;
+        }
+        for (size_t s = 0; s < last_use.size(); ++s) {
+            if (!keep[s] && last_use[s] >= 0) {
+                steps_[last_use[s]].release.push_back(static_cast<int>(s));
+            }
+        }
+
+        slots_.assign(slot_names_.size(), Tensor());
+        for (auto& entry : graph_.initializers) {
+            slots_[slot_of[entry.first]] = entry.second;
+        }
+        bound_.assign(input_slots_.size(), Tensor());
+        return true;
+    }
+
+    bool forward(std::vector<Tensor>& outputs) {
+        for (size_t i = 0; i < input_slots_.size(); ++i) {
+            if (bound_[i].empty()) {
+                last_error_ = "input " + graph_.inputs[i].name + " is not set";
+                return false;
+            }
+            slots_[input_slots_[i]] = bound_[i];
+        }
+
+        try {
+            Inputs inputs;
+            Outputs results;
+            for (const auto& step : steps_) {
+                inputs.clear();
+                for (int s : step.inputs) {
+                    inputs.push_back(s >= 0 ? &slots_[s] : nullptr);
+                }
+                results.assign(step.outputs.size(), Tensor());
+                if (step.conv) {
+                    runConv(step, inputs, results);
+                } else {
+                    step.run(*step.node, inputs, results);
+                }
+                for (size_t o = 0; o < step.outputs.size(); ++o) {
+                    if (step.outputs[o] >= 0) {
+                        slots_[step.outputs[o]] = std::move(results[o]);
+                    }
+                }
+                for (int s : step.release) {
+                    slots_[s] = Tensor();
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            last_error_ = e.what();
+            return false;
+        }
+
+        outputs.clear();
+        for (int s : output_slots_) {
+            outputs.push_back(slots_[s]);
+        }
+        return true;
+    }
+
+    void runConv(const Step& step, const Inputs& in, Outputs& out) const {
+        const Node& node = *step.node;
+        const PackedConv& conv = *step.conv;
+        const Tensor& x = input(node, in, 0);
+        if (x.rank() != 4 || x.shape[1] != static_cast<int64_t>(conv.in_channels) * conv.group) {
+            fail(node, "weight shape does not match input channels");
+        }
+        const int in_h = static_cast<int>(x.shape[2]), in_w = static_cast<int>(x.shape[3]);
+        ConvWindow win = readWindow(node, 2, {conv.kernel_h, conv.kernel_w}, in_h, in_w, false);
+        if (in_h + win.pad_top + win.pad_bottom < (conv.kernel_h - 1) * win.dilation_h + 1 ||
+            in_w + win.pad_left + win.pad_right < (conv.kernel_w - 1) * win.dilation_w + 1) {
+            fail(node, "empty output");
+        }
+        runPackedConv(conv, win, x, out[0], num_threads_);
+    }
+
+    Graph graph_;
+    std::vector<Step> steps_;
+    std::vector<std::string> slot_names_;
+    std::vector<Tensor> slots_;
+    std::vector<int> input_slots_;
+    std::vector<int> output_slots_;
+    std::vector<Tensor> bound_;
+    std::string last_error_;
+    size_t weight_bytes_ = 0;
+    bool loaded_ = false;
+    bool optimize_ = true;
+    int num_threads_ = 0;
+};
+
+Network::Network() : pImpl(std::make_unique<Impl>()) {}
+Network::~Network() = default;
+
+bool Network::load(const std::string& onnx_path) {
+    Graph graph;
+    std::string error;
+    if (!readOnnxModel(onnx_path, graph, error)) {
+        pImpl->last_error_ = error;
+        std::cerr << "Failed to read model " << onnx_path << ": " << error << std::endl;
+        return false;
+    }
+    if (!load(std::move(graph))) {
+        std::cerr << "Failed to load model " << onnx_path << ": " << pImpl->last_error_ << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Network::load(Graph graph) {
+    pImpl->loaded_ = pImpl->build(std::move(graph));
+    return pImpl->loaded_;
+}
+
+void Network::enableOptimizations(bool enabled) {
+    pImpl->optimize_ = enabled;
+}
+
+void Network::setNumThreads(int threads) {
+    pImpl->num_threads_ = std::max(0, threads);
+}
+
+bool Network::empty() const {
+    return !pImpl->loaded_;
+}
+
+const std::vector<ValueInfo>& Network::getInputs() const {
+    return pImpl->graph_.inputs;
+}
+
+const std::vector<ValueInfo>& Network::getOutputs() const {
+    return pImpl->graph_.outputs;
+}
+
+void Network::setInput(const Tensor& tensor, const std::string& name) {
+    const auto& inputs = pImpl->graph_.inputs;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (name.empty() || inputs[i].name == name) {
+            pImpl->bound_[i] = tensor;
+            return;
+        }
+    }
+    std::cerr << "Unknown network input: " << name << std::endl;
+}
+
+bool Network::forward(std::vector<Tensor>& outputs) {
+    if (!pImpl->loaded_) {
+        pImpl->last_error_ = "network not loaded";
+        return false;
+    }
+    return pImpl->forward(outputs);
+}
+
+const std::string& Network::getLastError() const {
+    return pImpl->last_error_;
+}
+
+size_t Network::getWeightBytes() const {
+    return pImpl->weight_bytes_;
+}
+
+} // namespace runtime
+} // namespace ufra
@@ -23,14 +23,26 @@ mkdir -p build/lib
 mkdir -p build/bin
 mkdir -p build/obj
 
-# Compile flags
-CXXFLAGS="-std=c++17 -O2 -fPIC -Icore/include"
+# Compile flags. ARCH_FLAGS selects the SIMD width of the convolution
+# kernels. The default runs on any CPU of the target architecture;
+# UFRA_NATIVE_ARCH=1 builds for the host CPU only (AVX2/AVX-512 where present).
+if [ "${UFRA_NATIVE_ARCH:-0}" = "1" ]; then
+    ARCH_FLAGS="${ARCH_FLAGS--march=native}"
+else
+    ARCH_FLAGS="${ARCH_FLAGS-}"
+fi
+CXXFLAGS="-std=c++17 -O2 -fPIC -pthread $ARCH_FLAGS -Icore/include"
 
 echo "Compiling minimal UFRa library..."
 
 # Compile only working sources
 SOURCES=(
     "core/src/minimal_engine.cpp"
+    "core/src/image_kernels.cpp"
+    "core/src/tensor_runtime.cpp"
+    "core/src/conv_kernels.cpp"
+    "core/src/onnx_reader.cpp"
+    "core/src/onnx_writer.cpp"
     "core/src/utils.cpp"
 )
 
@@ -141,7 +153,10 @@ int main() {
         context.frame_number = 0;
         
         auto result = engine->processFrame(context);
-        if (result.success) {
+        // Without models nothing may be detected, and timings are measured
+        if (result.success && result.processed_faces.empty() &&
+            result.metrics.count("processing_time_ms") &&
+            result.output_frame.data == context.input_frame.data) {
             std::cout << "PASSED" << std::endl;
             tests_passed++;
         } else {
@@ -1,7 +1,12 @@
 #include "ofxsImageEffect.h"
 #include "ofxsMultiThread.h"
 #include "ufra/engine.h"
+#include "ufra/render_service.h"
+#include <algorithm>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
 
 #define kPluginName "UFRa"
 #define kPluginGrouping "MetaGPT/FaceReaging"
@@ -18,9 +23,101 @@
 #define kParamTextureKeep "textureKeep"
 #define kParamSkinClean "skinClean"
 #define kParamGrayDensity "grayDensity"
+#define kParamRenderService "renderService"
 
 using namespace OFX;
 
+namespace {
+
+// OFX images run bottom-up in RGB(A) at the host's bit depth; frames are
+// 8-bit BGR with the top row first. Only `window` is converted; it must lie
+// inside the images, so a row without a pixel address fails the render.
+template <typename T>
+bool imageToFrame(const Image& image, const OfxRectI& window, float scale, const ufra::service::FrameView& frame,
+                  int components) {
+    for (int y = 0; y < frame.height; ++y) {
+        const T* src = static_cast<const T*>(image.getPixelAddress(window.x1, window.y2 - 1 - y));
+        if (!src) {
+            return false;
+        }
+        uint8_t* dst = frame.data + y * frame.stride;
+        for (int x = 0; x < frame.width; ++x, src += components, dst += 3) {
+            for (int c = 0; c < 3; ++c) {
+                const float value = static_cast<float>(src[2 - c]) * scale;
+                dst[c] = static_cast<uint8_t>(std::min(std::max(value, 0.0f), 255.0f) + 0.5f);
+            }
+        }
+    }
+    return true;
+}
+
+template <typename T>
+bool frameToImage(const ufra::service::FrameView& frame, const OfxRectI& window, float scale, const Image& source,
+                  Image& image, int components) {
+    for (int y = 0; y < frame.height; ++y) {
+        const uint8_t* src = frame.data + y * frame.stride;
+        const T* alpha = static_cast<const T*>(source.getPixelAddress(window.x1, window.y2 - 1 - y));
+        T* dst = static_cast<T*>(image.getPixelAddress(window.x1, window.y2 - 1 - y));
+        if (!alpha || !dst) {
+            return false;
+        }
+        for (int x = 0; x < frame.width; ++x, src += 3, dst += components, alpha += components) {
+            for (int c = 0; c < 3; ++c) {
+                dst[c] = static_cast<T>(src[2 - c] * scale);
+            }
+            if (components == 4) {
+                dst[3] = alpha[3];   // Matte passes through
+            }
+        }
+    }
+    return true;
+}
+
+int componentCount(const Image& image) {
+    return image.getPixelComponents() == ePixelComponentRGBA ? 4 : 3;
+}
+
+bool convertToFrame(const Image& image, const OfxRectI& window, const ufra::service::FrameView& frame) {
+    if (frame.width != window.x2 - window.x1 || frame.height != window.y2 - window.y1) {
+        return false;
+    }
+    const int components = componentCount(image);
+    switch (image.getPixelDepth()) {
+    case eBitDepthUByte: return imageToFrame<uint8_t>(image, window, 1.0f, frame, components);
+    case eBitDepthUShort: return imageToFrame<uint16_t>(image, window, 255.0f / 65535.0f, frame, components);
+    case eBitDepthFloat: return imageToFrame<float>(image, window, 255.0f, frame, components);
+    default: return false;
+    }
+}
+
+bool convertFromFrame(const ufra::service::FrameView& frame, const OfxRectI& window, const Image& source,
+                      Image& image) {
+    if (frame.width != window.x2 - window.x1 || frame.height != window.y2 - window.y1) {
+        return false;
+    }
+    const int components = componentCount(image);
+    switch (image.getPixelDepth()) {
+    case eBitDepthUByte: return frameToImage<uint8_t>(frame, window, 1.0f, source, image, components);
+    case eBitDepthUShort: return frameToImage<uint16_t>(frame, window, 65535.0f / 255.0f, source, image, components);
+    case eBitDepthFloat: return frameToImage<float>(frame, window, 1.0f / 255.0f, source, image, components);
+    default: return false;
+    }
+}
+
+// The part of `window` that both images cover; empty if there is none
+OfxRectI clipWindow(const OfxRectI& window, const Image& src, const Image& dst) {
+    const OfxRectI a = src.getBounds();
+    const OfxRectI b = dst.getBounds();
+    OfxRectI clipped;
+    clipped.x1 = std::max({window.x1, a.x1, b.x1});
+    clipped.y1 = std::max({window.y1, a.y1, b.y1});
+    clipped.x2 = std::min({window.x2, a.x2, b.x2});
+    clipped.y2 = std::min({window.y2, a.y2, b.y2});
+    return clipped;
+}
+
+} // namespace
+
 class UFRaPlugin : public ImageEffect {
 public:
     UFRaPlugin(OfxImageEffectHandle handle);
@@ -31,6 +128,8 @@ public:
 
 private:
     void setupEngine();
+    bool renderInProcess(const Image& src, Image& dst, const OfxRectI& window, const ufra::FrameContext& context);
+    bool renderOnService(const Image& src, Image& dst, const OfxRectI& window, const ufra::FrameContext& context);
     ufra::AgeControls getAgeControls(double time);
     ufra::ProcessingMode getProcessingMode(double time);
 
@@ -46,10 +145,23 @@ private:
     DoubleParam *textureKeep_;
     DoubleParam *skinClean_;
     DoubleParam *grayDensity_;
+    BooleanParam *renderService_;
 
-    // UFRa Engine
+    // The engine's and the service's tracks for this instance's clip. Random,
+    // so instances in other host processes sharing the service get their own.
+    uint64_t clipId_;
+
+    // UFRa Engine, loaded on first in-process render
+    std::once_flag engineOnce_;
     std::unique_ptr<ufra::Engine> engine_;
     bool engineInitialized_;
+
+    // Out of process: models live in ufra_server, shared by every host
+    // process, and an engine failure cannot take the host down. Each
+    // concurrent render call uses its own connection so the service can
+    // batch them.
+    std::mutex clientsMutex_;
+    std::vector<std::unique_ptr<ufra::service::RenderClient>> idleClients_;
 };
 
 UFRaPlugin::UFRaPlugin(OfxImageEffectHandle handle)
@@ -65,8 +177,12 @@ UFRaPlugin::UFRaPlugin(OfxImageEffectHandle handle)
     textureKeep_ = fetchDoubleParam(kParamTextureKeep);
     skinClean_ = fetchDoubleParam(kParamSkinClean);
     grayDensity_ = fetchDoubleParam(kParamGrayDensity);
+    renderService_ = fetchBooleanParam(kParamRenderService);
 
-    setupEngine();
+    std::random_device random;
+    do {
+        clipId_ = (static_cast<uint64_t>(random()) << 32) | random();
+    } while (clipId_ == 0);
 }
 
 UFRaPlugin::~UFRaPlugin() {}
@@ -92,11 +208,6 @@ void UFRaPlugin::setupEngine() {
 }
 
 void UFRaPlugin::render(const RenderArguments &args) {
-    if (!engineInitialized_) {
-        throwSuiteStatusException(kOfxStatFailed);
-        return;
-    }
-
     auto_ptr<Image> src(srcClip_->fetchImage(args.time));
     auto_ptr<Image> dst(dstClip_->fetchImage(args.time));
 
@@ -105,17 +216,96 @@ void UFRaPlugin::render(const RenderArguments &args) {
         return;
     }
 
-    // Convert and process (simplified version)
-    cv::Mat srcMat, dstMat;
-    // ... conversion code ...
-    
+    // Source and output must agree on pixel layout, and the frame covers
+    // only the render window, clipped to both images
+    if (src->getPixelDepth() != dst->getPixelDepth() || src->getPixelComponents() != dst->getPixelComponents()) {
+        setPersistentMessage(Message::eMessageError, "", "UFRa: source and output pixel formats differ");
+        throwSuiteStatusException(kOfxStatErrImageFormat);
+        return;
+    }
+    const OfxRectI window = clipWindow(args.renderWindow, *src, *dst);
+    if (window.x2 <= window.x1 || window.y2 <= window.y1) {
+        setPersistentMessage(Message::eMessageError, "", "UFRa: render window lies outside the images");
+        throwSuiteStatusException(kOfxStatFailed);
+        return;
+    }
+
     ufra::FrameContext context;
     context.frame_number = static_cast<int>(args.time);
+    context.clip_id = clipId_;
     context.controls = getAgeControls(args.time);
     context.mode = getProcessingMode(args.time);
 
+    const bool rendered = renderService_->getValueAtTime(args.time)
+                              ? renderOnService(*src, *dst, window, context)
+                              : renderInProcess(*src, *dst, window, context);
+    if (!rendered) {
+        throwSuiteStatusException(kOfxStatFailed);
+    }
+}
+
+bool UFRaPlugin::renderInProcess(const Image& src, Image& dst, const OfxRectI& window,
+                                 const ufra::FrameContext& frame_context) {
+    std::call_once(engineOnce_, [this] { setupEngine(); });
+    if (!engineInitialized_) {
+        return false;
+    }
+
+    cv::Mat srcMat(window.y2 - window.y1, window.x2 - window.x1, CV_8UC3);
+    if (!convertToFrame(src, window, ufra::service::FrameView{srcMat.data, srcMat.cols, srcMat.rows, 3, srcMat.step})) {
+        return false;
+    }
+
+    ufra::FrameContext context = frame_context;
+    context.input_frame = srcMat;
     ufra::ProcessingResult result = engine_->processFrame(context);
-    // ... result handling ...
+    if (!result.success || result.output_frame.size() != srcMat.size() || result.output_frame.type() != CV_8UC3) {
+        return false;
+    }
+    cv::Mat& dstMat = result.output_frame;
+    return convertFromFrame(ufra::service::FrameView{dstMat.data, dstMat.cols, dstMat.rows, 3, dstMat.step}, window,
+                            src, dst);
+}
+
+bool UFRaPlugin::renderOnService(const Image& src, Image& dst, const OfxRectI& window,
+                                 const ufra::FrameContext& context) {
+    std::unique_ptr<ufra::service::RenderClient> client;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex_);
+        if (!idleClients_.empty()) {
+            client = std::move(idleClients_.back());
+            idleClients_.pop_back();
+        }
+    }
+    if (!client) {
+        client = std::make_unique<ufra::service::RenderClient>();
+    }
+    if (!client->isConnected() && !client->connect()) {
+        setPersistentMessage(Message::eMessageError, "", client->getLastError());
+        return false;
+    }
+
+    // Converting straight into the shared buffer saves the copy in render()
+    ufra::service::FrameView input = client->inputBuffer(window.x2 - window.x1, window.y2 - window.y1, 3);
+    ufra::service::FrameView output;
+    ufra::service::JobSettings settings;
+    settings.target_age = context.controls.target_age;
+    settings.identity_lock = context.controls.identity_lock_strength;
+    settings.temporal_stability = context.controls.temporal_stability;
+    settings.mode = static_cast<int>(context.mode);
+    settings.frame_number = context.frame_number;
+    settings.clip_id = context.clip_id;   // Pooled clients are separate connections
+    const bool rendered = !input.empty() && convertToFrame(src, window, input) &&
+                          client->render(input, settings, output) && convertFromFrame(output, window, src, dst);
+    if (!rendered && !client->getLastError().empty()) {
+        setPersistentMessage(Message::eMessageError, "", client->getLastError());
+    } else if (rendered) {
+        clearPersistentMessage();
+    }
+
+    std::lock_guard<std::mutex> lock(clientsMutex_);
+    idleClients_.push_back(std::move(client));
+    return rendered;
 }
 
 ufra::AgeControls UFRaPlugin::getAgeControls(double time) {
@@ -3,11 +3,163 @@
 #include <pybind11/stl.h>
 #include <pybind11/functional.h>
 #include <opencv2/opencv.hpp>
+#include "ufra/age_estimator.h"
 #include "ufra/engine.h"
+#include "ufra/face_detector.h"
+#include "ufra/face_parser.h"
+#include "ufra/feedforward_generator.h"
+#include "ufra/render_service.h"
+#include "ufra/stub_network.h"
 #include "ufra/types.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 
 namespace py = pybind11;
 
+using FrameArray = py::array_t<uint8_t, py::array::c_style | py::array::forcecast>;
+
+// DLPack ABI (dlpack.h, v0.8): the layout every __dlpack__ producer and
+// from_dlpack consumer agrees on. Only CPU tensors are exchanged.
+extern "C" {
+struct DLDevice {
+    int32_t device_type;
+    int32_t device_id;
+};
+
+struct DLDataType {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+};
+
+struct DLTensor {
+    void* data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t* shape;
+    int64_t* strides;   // In elements; null means compact row-major
+    uint64_t byte_offset;
+};
+
+struct DLManagedTensor {
+    DLTensor dl_tensor;
+    void* manager_ctx;
+    void (*deleter)(DLManagedTensor* self);
+};
+}
+
+constexpr int32_t kDLCPU = 1;
+constexpr uint8_t kDLUInt = 1;
+constexpr uint8_t kDLFloat = 2;
+
+// Engine image (frame, crop or mask) shared with Python without copies:
+// numpy reads it through the buffer protocol, PyTorch and others through
+// DLPack. Imported tensors keep their producer's DLManagedTensor alive.
+struct SharedImage {
+    cv::Mat mat;
+    std::shared_ptr<DLManagedTensor> owner;
+};
+
+// Keeps the exported Mat (and so its buffer, or the imported tensor it
+// views) alive until the consumer calls the deleter
+struct DLPackExport {
+    cv::Mat mat;
+    std::shared_ptr<DLManagedTensor> owner;
+    int64_t shape[3];
+    int64_t strides[3];
+    DLManagedTensor tensor;
+};
+
+py::capsule to_dlpack(const SharedImage& image) {
+    const cv::Mat& mat = image.mat;
+    if (mat.empty() || (mat.depth() != CV_8U && mat.depth() != CV_32F)) {
+        throw std::invalid_argument("only non-empty uint8 and float32 images can be exported");
+    }
+    auto* exported = new DLPackExport();
+    exported->mat = mat;
+    exported->owner = image.owner;
+    const int64_t element = static_cast<int64_t>(mat.elemSize1());
+    const int ndim = mat.channels() == 1 ? 2 : 3;
+    exported->shape[0] = mat.rows;
+    exported->shape[1] = mat.cols;
+    exported->shape[2] = mat.channels();
+    exported->strides[0] = static_cast<int64_t>(mat.step[0]) / element;
+    exported->strides[1] = mat.channels();
+    exported->strides[2] = 1;
+
+    DLTensor& tensor = exported->tensor.dl_tensor;
+    tensor.data = mat.data;
+    tensor.device = DLDevice{kDLCPU, 0};
+    tensor.ndim = ndim;
+    tensor.dtype = DLDataType{mat.depth() == CV_8U ? kDLUInt : kDLFloat, static_cast<uint8_t>(element * 8), 1};
+    tensor.shape = exported->shape;
+    tensor.strides = exported->strides;
+    tensor.byte_offset = 0;
+    exported->tensor.manager_ctx = exported;
+    exported->tensor.deleter = [](DLManagedTensor* self) {
+        delete static_cast<DLPackExport*>(self->manager_ctx);
+    };
+
+    // A consumer renames the capsule to "used_dltensor" and owns the tensor
+    // from then on; an unconsumed capsule frees it itself
+    return py::capsule(&exported->tensor, "dltensor", [](PyObject* capsule) {
+        if (PyCapsule_IsValid(capsule, "dltensor")) {
+            auto* tensor = static_cast<DLManagedTensor*>(PyCapsule_GetPointer(capsule, "dltensor"));
+            tensor->deleter(tensor);
+        }
+    });
+}
+
+// Wraps a DLPack producer (anything with __dlpack__, or a raw capsule) as an
+// image view. Rows may be padded; pixels within a row must be packed.
+SharedImage from_dlpack(const py::object& source) {
+    py::object capsule = py::hasattr(source, "__dlpack__") ? source.attr("__dlpack__")() : source;
+    if (!PyCapsule_IsValid(capsule.ptr(), "dltensor")) {
+        throw std::invalid_argument("expected an object implementing __dlpack__ or an unused DLPack capsule");
+    }
+    auto* managed = static_cast<DLManagedTensor*>(PyCapsule_GetPointer(capsule.ptr(), "dltensor"));
+    PyCapsule_SetName(capsule.ptr(), "used_dltensor");
+    SharedImage image;
+    image.owner = std::shared_ptr<DLManagedTensor>(managed, [](DLManagedTensor* tensor) {
+        if (tensor->deleter) {
+            tensor->deleter(tensor);
+        }
+    });
+
+    const DLTensor& tensor = managed->dl_tensor;
+    const bool uint8 = tensor.dtype.code == kDLUInt && tensor.dtype.bits == 8;
+    const bool float32 = tensor.dtype.code == kDLFloat && tensor.dtype.bits == 32;
+    if (tensor.device.device_type != kDLCPU || (tensor.ndim != 2 && tensor.ndim != 3) ||
+        (!uint8 && !float32) || tensor.dtype.lanes != 1) {
+        throw std::invalid_argument("expected a CPU uint8 or float32 tensor of shape HxW or HxWxC");
+    }
+    const int rows = static_cast<int>(tensor.shape[0]);
+    const int cols = static_cast<int>(tensor.shape[1]);
+    const int channels = tensor.ndim == 3 ? static_cast<int>(tensor.shape[2]) : 1;
+    int64_t row_elements = static_cast<int64_t>(cols) * channels;
+    if (tensor.strides) {
+        const bool packed = tensor.strides[1] == channels && (tensor.ndim == 2 || tensor.strides[2] == 1);
+        if (!packed || tensor.strides[0] < row_elements) {
+            throw std::invalid_argument("tensor pixels must be packed within each row");
+        }
+        row_elements = tensor.strides[0];
+    }
+    const size_t element = uint8 ? 1 : 4;
+    image.mat = cv::Mat(rows, cols, CV_MAKETYPE(uint8 ? CV_8U : CV_32F, channels),
+                        static_cast<uint8_t*>(tensor.data) + tensor.byte_offset,
+                        static_cast<size_t>(row_elements) * element);
+    return image;
+}
+
 // Helper functions for OpenCV Mat conversion
 cv::Mat numpy_to_mat(py::array_t<uint8_t> input) {
     py::buffer_info buf_info = input.request();
@@ -23,6 +175,339 @@ py::array_t<uint8_t> mat_to_numpy(cv::Mat mat) {
     );
 }
 
+// cv::Mat header over an HxW or HxWxC uint8 array, no copy; the array must
+// outlive the Mat
+cv::Mat mat_view(const FrameArray& frame) {
+    if (frame.ndim() != 2 && frame.ndim() != 3) {
+        throw std::invalid_argument("frame must be HxW or HxWxC uint8");
+    }
+    const int channels = frame.ndim() == 3 ? static_cast<int>(frame.shape(2)) : 1;
+    return cv::Mat(static_cast<int>(frame.shape(0)), static_cast<int>(frame.shape(1)), CV_8UC(channels),
+                   const_cast<uint8_t*>(frame.data()));
+}
+
+// Views of a list (or stack) of images; `arrays` keeps them referenced
+std::vector<cv::Mat> mat_views(const std::vector<FrameArray>& arrays) {
+    std::vector<cv::Mat> mats;
+    mats.reserve(arrays.size());
+    for (const FrameArray& array : arrays) {
+        mats.push_back(mat_view(array));
+    }
+    return mats;
+}
+
+// numpy array owning a reference to `mat`: HxW for one channel, else HxWxC
+py::array mat_to_array(const cv::Mat& mat) {
+    if (mat.depth() != CV_8U && mat.depth() != CV_32F) {
+        throw std::invalid_argument("only uint8 and float32 images are exposed");
+    }
+    const py::dtype dtype = mat.depth() == CV_8U ? py::dtype::of<uint8_t>() : py::dtype::of<float>();
+    const py::ssize_t element = static_cast<py::ssize_t>(mat.elemSize1());
+    std::vector<py::ssize_t> shape{mat.rows, mat.cols};
+    std::vector<py::ssize_t> strides{static_cast<py::ssize_t>(mat.empty() ? 0 : mat.step[0]),
+                                     element * mat.channels()};
+    if (mat.channels() > 1) {
+        shape.push_back(mat.channels());
+        strides.push_back(element);
+    }
+    auto* owner = new cv::Mat(mat);
+    py::capsule base(owner, [](void* pointer) { delete static_cast<cv::Mat*>(pointer); });
+    return py::array(dtype, shape, strides, owner->data, base);
+}
+
+std::vector<py::array> mats_to_arrays(const std::vector<cv::Mat>& mats) {
+    std::vector<py::array> arrays;
+    arrays.reserve(mats.size());
+    for (const cv::Mat& mat : mats) {
+        arrays.push_back(mat_to_array(mat));
+    }
+    return arrays;
+}
+
+// Runs fn(0..count-1) on up to `threads` threads (0 = hardware concurrency).
+// Components draw a session per thread, so calls scale across cores.
+void parallel_for(size_t count, int threads, const std::function<void(size_t)>& fn) {
+    size_t workers = threads > 0 ? static_cast<size_t>(threads) : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min(workers, count);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    std::vector<std::thread> pool;
+    for (size_t w = 0; w < workers; ++w) {
+        pool.emplace_back([&] {
+            for (size_t i = next++; i < count; i = next++) {
+                try {
+                    fn(i);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    error = std::current_exception();
+                }
+            }
+        });
+    }
+    for (auto& worker : pool) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// Detected crops are ROIs of the input; copy them so faces outlive the array
+std::vector<ufra::Face> detect_owned(ufra::FaceDetector& detector, const cv::Mat& image) {
+    std::vector<ufra::Face> faces = detector.detectFaces(image);
+    for (ufra::Face& face : faces) {
+        face.aligned_crop = face.aligned_crop.clone();
+    }
+    return faces;
+}
+
+// Engine results carry faces whose crops view the input frame; copy them
+// when that frame is Python memory the results may outlive
+void own_faces(std::vector<ufra::Face>& faces) {
+    for (ufra::Face& face : faces) {
+        face.aligned_crop = face.aligned_crop.clone();
+    }
+}
+
+std::vector<py::array> generate_batch(ufra::FeedforwardGenerator& generator, const std::vector<FrameArray>& crops,
+                                      const std::vector<ufra::AgeControls>& controls,
+                                      const std::vector<FrameArray>& parsing_masks) {
+    if (controls.size() != 1 && controls.size() != crops.size()) {
+        throw std::invalid_argument("controls must be one AgeControls or one per crop");
+    }
+    if (!parsing_masks.empty() && parsing_masks.size() != crops.size()) {
+        throw std::invalid_argument("parsing_masks must be empty or one per crop");
+    }
+    const std::vector<cv::Mat> crop_views = mat_views(crops);
+    const std::vector<cv::Mat> mask_views = mat_views(parsing_masks);
+    std::vector<cv::Mat> aged;
+    {
+        py::gil_scoped_release release;
+        aged = generator.generateAgedFacesBatch(crop_views, controls, mask_views);
+    }
+    return mats_to_arrays(aged);
+}
+
+// Renders an (N, H, W, C) stack in one Engine::processBatch call. Inputs are
+// viewed in place; outputs are written into one new stack. Frames that fail
+// are passed through unchanged.
+py::object process_batch(ufra::Engine& engine, const FrameArray& frames, const std::vector<ufra::AgeControls>& controls,
+                         ufra::ProcessingMode mode, int first_frame_number, bool return_results) {
+    if (frames.ndim() != 4) {
+        throw std::invalid_argument("frames must be an (N, H, W, C) uint8 array");
+    }
+    const py::ssize_t count = frames.shape(0);
+    const int height = static_cast<int>(frames.shape(1));
+    const int width = static_cast<int>(frames.shape(2));
+    const int channels = static_cast<int>(frames.shape(3));
+    if (controls.size() != 1 && static_cast<py::ssize_t>(controls.size()) != count) {
+        throw std::invalid_argument("controls must be one AgeControls or one per frame");
+    }
+
+    std::vector<ufra::FrameContext> contexts(static_cast<size_t>(count));
+    for (py::ssize_t i = 0; i < count; ++i) {
+        ufra::FrameContext& context = contexts[i];
+        context.frame_number = first_frame_number + static_cast<int>(i);
+        context.input_frame = cv::Mat(height, width, CV_8UC(channels), const_cast<uint8_t*>(frames.data(i)));
+        context.controls = controls.size() == 1 ? controls[0] : controls[i];
+        context.mode = mode;
+    }
+
+    FrameArray output({count, static_cast<py::ssize_t>(height), static_cast<py::ssize_t>(width),
+                       static_cast<py::ssize_t>(channels)});
+    uint8_t* output_data = output.mutable_data();
+    const py::ssize_t output_frame_bytes = output.strides(0);
+    std::vector<ufra::ProcessingResult> results;
+    {
+        py::gil_scoped_release release;
+        results = engine.processBatch(contexts);
+        for (py::ssize_t i = 0; i < count; ++i) {
+            cv::Mat destination(height, width, CV_8UC(channels), output_data + i * output_frame_bytes);
+            ufra::ProcessingResult& result = results[i];
+            if (result.success && result.output_frame.size() == destination.size() &&
+                result.output_frame.type() == destination.type()) {
+                result.output_frame.copyTo(destination);
+            } else {
+                contexts[i].input_frame.copyTo(destination);
+            }
+            result.output_frame = cv::Mat();   // Already in the stack
+            if (return_results) {
+                own_faces(result.processed_faces);
+            }
+        }
+    }
+    if (return_results) {
+        return py::make_tuple(output, results);
+    }
+    return std::move(output);
+}
+
+// Iterator over rendered frames of a Python frame iterator. Up to `prefetch`
+// frames run ahead on C++ worker threads, so their faces share network
+// batches and Python only pays for pulling frames and consuming results.
+// When the mode continues clip state (tracks, temporal caches, keyframes),
+// frames go to the engine in order instead: one processBatch call per
+// `prefetch` frames on a single worker, with the next batch pulled while
+// the previous one renders.
+class FrameStream {
+public:
+    FrameStream(ufra::Engine& engine, const py::iterable& frames, const ufra::AgeControls& controls,
+                ufra::ProcessingMode mode, int prefetch)
+        : engine_(engine), source_(py::iter(frames)), controls_(controls), mode_(mode),
+          prefetch_(static_cast<size_t>(std::max(1, prefetch))) {
+        static std::atomic<uint64_t> next_clip_id{1};
+        clip_id_ = next_clip_id++;   // Each stream is its own clip for the engine's tracks
+        ufra::FrameContext probe;
+        probe.mode = mode_;
+        in_order_ = engine_.usesClipState(probe);
+        const size_t worker_count = in_order_ ? 1 : prefetch_;
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers_.emplace_back([this] { work(); });
+        }
+    }
+
+    ~FrameStream() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        // Workers may still read frames owned by in_flight_
+        py::gil_scoped_release release;
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ufra::ProcessingResult next() {
+        fill();
+        if (in_flight_.empty()) {
+            throw py::stop_iteration();
+        }
+        Pending pending = std::move(in_flight_.front());
+        in_flight_.pop_front();
+        fill();   // Keep the workers busy while Python consumes this result
+        ufra::ProcessingResult result;
+        {
+            py::gil_scoped_release release;
+            result = pending.result.get();
+            own_faces(result.processed_faces);   // pending.frame is released on return
+        }
+        return result;
+    }
+
+private:
+    struct Pending {
+        py::object frame;   // Keeps the viewed array alive
+        std::future<ufra::ProcessingResult> result;
+    };
+
+    // Pulls frames from the Python iterator until `prefetch` are in flight,
+    // or in order until two batches are
+    void fill() {
+        const size_t task_frames = in_order_ ? prefetch_ : 1;
+        const size_t limit = in_order_ ? 2 * prefetch_ : prefetch_;
+        while (!exhausted_ && in_flight_.size() + task_frames <= limit) {
+            std::vector<ufra::FrameContext> contexts;
+            while (contexts.size() < task_frames) {
+                if (source_ == py::iterator::sentinel()) {
+                    exhausted_ = true;
+                    break;
+                }
+                FrameArray frame = FrameArray::ensure(*source_);
+                ++source_;
+                if (!frame) {
+                    throw std::invalid_argument("stream frames must be uint8 arrays");
+                }
+
+                ufra::FrameContext context;
+                context.frame_number = frame_number_++;
+                context.clip_id = clip_id_;
+                context.input_frame = mat_view(frame);
+                context.controls = controls_;
+                context.mode = mode_;
+                contexts.push_back(context);
+                in_flight_.push_back(Pending{frame, {}});
+            }
+            if (!contexts.empty()) {
+                submit(std::move(contexts));
+            }
+        }
+    }
+
+    // Queues one task for the last contexts.size() frames of in_flight_
+    void submit(std::vector<ufra::FrameContext> contexts) {
+        auto promises = std::make_shared<std::vector<std::promise<ufra::ProcessingResult>>>(contexts.size());
+        for (size_t i = 0; i < contexts.size(); ++i) {
+            in_flight_[in_flight_.size() - contexts.size() + i].result = (*promises)[i].get_future();
+        }
+        auto task = [this, contexts = std::move(contexts), promises] {
+            std::vector<ufra::ProcessingResult> results;
+            try {
+                if (contexts.size() == 1) {
+                    results.push_back(engine_.processFrame(contexts[0]));
+                } else {
+                    results = engine_.processBatch(contexts);
+                }
+            } catch (...) {
+                for (auto& promise : *promises) {
+                    promise.set_exception(std::current_exception());
+                }
+                return;
+            }
+            for (size_t i = 0; i < promises->size(); ++i) {
+                (*promises)[i].set_value(std::move(results[i]));
+            }
+        };
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    void work() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (stopping_) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    ufra::Engine& engine_;
+    py::iterator source_;
+    ufra::AgeControls controls_;
+    ufra::ProcessingMode mode_;
+    size_t prefetch_;
+    bool in_order_ = false;
+    bool exhausted_ = false;
+    int frame_number_ = 0;
+    uint64_t clip_id_ = 0;
+    std::deque<Pending> in_flight_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
 PYBIND11_MODULE(pyufra, m) {
     m.doc() = "Universal Face Re-Aging (UFRa) Python Bindings";
 
@@ -31,7 +516,8 @@ PYBIND11_MODULE(pyufra, m) {
         .value("FEEDFORWARD", ufra::ProcessingMode::FEEDFORWARD)
         .value("DIFFUSION", ufra::ProcessingMode::DIFFUSION)
         .value("HYBRID", ufra::ProcessingMode::HYBRID)
-        .value("AUTO", ufra::ProcessingMode::AUTO);
+        .value("AUTO", ufra::ProcessingMode::AUTO)
+        .value("KEYFRAME", ufra::ProcessingMode::KEYFRAME);
 
     py::enum_<ufra::GPUBackend>(m, "GPUBackend")
         .value("CUDA", ufra::GPUBackend::CUDA)
@@ -49,11 +535,36 @@ PYBIND11_MODULE(pyufra, m) {
         .def_readwrite("confidence", &ufra::FaceBox::confidence)
         .def_readwrite("face_id", &ufra::FaceBox::face_id);
 
+    py::class_<SharedImage>(m, "Image", py::buffer_protocol())
+        .def_buffer([](SharedImage &image) -> py::buffer_info {
+            const cv::Mat& mat = image.mat;
+            const bool is_float = mat.depth() == CV_32F;
+            if (!is_float && mat.depth() != CV_8U) {
+                throw std::invalid_argument("only uint8 and float32 images are exposed");
+            }
+            const py::ssize_t element = static_cast<py::ssize_t>(mat.elemSize1());
+            return py::buffer_info(mat.data, element,
+                                   is_float ? py::format_descriptor<float>::format()
+                                            : py::format_descriptor<uint8_t>::format(),
+                                   3, {mat.rows, mat.cols, mat.channels()},
+                                   {static_cast<py::ssize_t>(mat.step[0]), element * mat.channels(), element});
+        })
+        .def_property_readonly("shape", [](const SharedImage &image) {
+            return py::make_tuple(image.mat.rows, image.mat.cols, image.mat.channels());
+        })
+        .def("__dlpack__", [](const SharedImage &image, py::object /*stream*/) { return to_dlpack(image); },
+             py::arg("stream") = py::none())
+        .def("__dlpack_device__", [](const SharedImage &) { return py::make_tuple(kDLCPU, 0); });
+    m.def("from_dlpack", &from_dlpack, py::arg("tensor"),
+          "View a CPU tensor from any DLPack producer (torch, numpy, ...) as an Image without copying");
+
     py::class_<ufra::Face>(m, "Face")
         .def(py::init<>())
         .def_readwrite("box", &ufra::Face::box)
         .def_readwrite("track_id", &ufra::Face::track_id)
-        .def_readwrite("frame_number", &ufra::Face::frame_number);
+        .def_readwrite("frame_number", &ufra::Face::frame_number)
+        .def_property_readonly("aligned_crop", [](const ufra::Face &face) { return SharedImage{face.aligned_crop, {}}; })
+        .def_property_readonly("parsing_mask", [](const ufra::Face &face) { return SharedImage{face.parsing_mask, {}}; });
 
     py::class_<ufra::AgeControls>(m, "AgeControls")
         .def(py::init<>())
@@ -71,7 +582,14 @@ PYBIND11_MODULE(pyufra, m) {
         .def_readwrite("backend", &ufra::ModelConfig::backend)
         .def_readwrite("batch_size", &ufra::ModelConfig::batch_size)
         .def_readwrite("use_half_precision", &ufra::ModelConfig::use_half_precision)
-        .def_readwrite("max_resolution", &ufra::ModelConfig::max_resolution);
+        .def_readwrite("max_resolution", &ufra::ModelConfig::max_resolution)
+        .def_readwrite("deterministic", &ufra::ModelConfig::deterministic)
+        .def_readwrite("profile_counters", &ufra::ModelConfig::profile_counters)
+        .def_readwrite("metrics_file", &ufra::ModelConfig::metrics_file)
+        .def_readwrite("metrics_port", &ufra::ModelConfig::metrics_port)
+        .def_readwrite("auto_tune_batch", &ufra::ModelConfig::auto_tune_batch)
+        .def_readwrite("batch_latency_cap_ms", &ufra::ModelConfig::batch_latency_cap_ms)
+        .def_readwrite("batch_tuning_file", &ufra::ModelConfig::batch_tuning_file);
 
     py::class_<ufra::ProcessingResult>(m, "ProcessingResult")
         .def(py::init<>())
@@ -79,19 +597,124 @@ PYBIND11_MODULE(pyufra, m) {
         .def_readwrite("metrics", &ufra::ProcessingResult::metrics)
         .def_readwrite("success", &ufra::ProcessingResult::success)
         .def_readwrite("error_message", &ufra::ProcessingResult::error_message)
+        .def_readwrite("output_hash", &ufra::ProcessingResult::output_hash)
         .def("get_output_frame", [](const ufra::ProcessingResult &result) {
             return mat_to_numpy(result.output_frame);
-        });
+        })
+        .def_property_readonly("output", [](const ufra::ProcessingResult &result) {
+            return SharedImage{result.output_frame, {}};
+        }, "Output frame shared with the engine: np.asarray(...) or torch.from_dlpack(...) without copies");
 
     py::class_<ufra::FrameContext>(m, "FrameContext")
         .def(py::init<>())
         .def_readwrite("frame_number", &ufra::FrameContext::frame_number)
+        .def_readwrite("clip_id", &ufra::FrameContext::clip_id)
         .def_readwrite("detected_faces", &ufra::FrameContext::detected_faces)
         .def_readwrite("controls", &ufra::FrameContext::controls)
         .def_readwrite("mode", &ufra::FrameContext::mode)
         .def("set_input_frame", [](ufra::FrameContext &ctx, py::array_t<uint8_t> input) {
             ctx.input_frame = numpy_to_mat(input);
-        });
+        })
+        .def("set_input_view", [](ufra::FrameContext &ctx, const SharedImage &image) {
+            ctx.input_frame = image.mat;
+        }, py::keep_alive<1, 2>(), "Use an Image (e.g. pyufra.from_dlpack(tensor)) as input without copying");
+
+    // Individual components for staged pipelines. Images are viewed in place
+    // and the GIL is released while the networks run, so Python threads (or
+    // the `threads` argument) spread calls over cores.
+    py::class_<ufra::FaceDetector>(m, "FaceDetector")
+        .def(py::init<>())
+        .def("load_model", &ufra::FaceDetector::loadModel, py::arg("model_path"))
+        .def("set_confidence_threshold", &ufra::FaceDetector::setConfidenceThreshold)
+        .def("set_nms_threshold", &ufra::FaceDetector::setNMSThreshold)
+        .def("set_max_faces", &ufra::FaceDetector::setMaxFaces)
+        .def("detect", [](ufra::FaceDetector &detector, const FrameArray &image) {
+            const cv::Mat view = mat_view(image);
+            py::gil_scoped_release release;
+            return detect_owned(detector, view);
+        }, py::arg("image"))
+        .def("detect_batch", [](ufra::FaceDetector &detector, const std::vector<FrameArray> &images, int threads) {
+            const std::vector<cv::Mat> views = mat_views(images);
+            std::vector<std::vector<ufra::Face>> faces(views.size());
+            py::gil_scoped_release release;
+            parallel_for(views.size(), threads, [&](size_t i) { faces[i] = detect_owned(detector, views[i]); });
+            return faces;
+        }, py::arg("images"), py::arg("threads") = 0,
+           "Detect faces in each image on up to `threads` threads (0 = all cores)");
+
+    py::class_<ufra::FaceParser>(m, "FaceParser")
+        .def(py::init<>())
+        .def("load_model", &ufra::FaceParser::loadModel, py::arg("model_path"))
+        .def("set_input_size", &ufra::FaceParser::setInputSize, py::arg("width"), py::arg("height"))
+        .def("get_input_size", [](const ufra::FaceParser &parser) {
+            const cv::Size size = parser.getInputSize();
+            return py::make_tuple(size.width, size.height);
+        })
+        .def("parse", [](ufra::FaceParser &parser, const FrameArray &crop) {
+            const cv::Mat view = mat_view(crop);
+            cv::Mat mask;
+            {
+                py::gil_scoped_release release;
+                mask = parser.parseFace(view);
+            }
+            return mat_to_array(mask);
+        }, py::arg("crop"), "Label mask (HxW uint8) for a face crop")
+        .def("parse_batch", [](ufra::FaceParser &parser, const std::vector<FrameArray> &crops) {
+            const std::vector<cv::Mat> views = mat_views(crops);
+            std::vector<cv::Mat> masks;
+            {
+                py::gil_scoped_release release;
+                masks = parser.parseFacesBatch(views);
+            }
+            return mats_to_arrays(masks);
+        }, py::arg("crops"));
+
+    py::class_<ufra::AgeEstimator>(m, "AgeEstimator")
+        .def(py::init<>())
+        .def("load_model", &ufra::AgeEstimator::loadModel, py::arg("model_path"))
+        .def("set_input_size", &ufra::AgeEstimator::setInputSize, py::arg("width"), py::arg("height"))
+        .def("set_normalization", &ufra::AgeEstimator::setNormalization, py::arg("mean"), py::arg("std"))
+        .def("estimate", [](ufra::AgeEstimator &estimator, const FrameArray &crop) {
+            const cv::Mat view = mat_view(crop);
+            py::gil_scoped_release release;
+            return estimator.estimateAge(view);
+        }, py::arg("crop"))
+        .def("estimate_batch", [](ufra::AgeEstimator &estimator, const std::vector<FrameArray> &crops) {
+            const std::vector<cv::Mat> views = mat_views(crops);
+            py::gil_scoped_release release;
+            return estimator.estimateAgeBatch(views);
+        }, py::arg("crops"));
+
+    py::class_<ufra::FeedforwardGenerator>(m, "FeedforwardGenerator")
+        .def(py::init<>())
+        .def("load_model", &ufra::FeedforwardGenerator::loadModel, py::arg("model_path"))
+        .def("set_input_resolution", &ufra::FeedforwardGenerator::setInputResolution,
+             py::arg("width"), py::arg("height"))
+        .def("enable_temporal_stabilization", &ufra::FeedforwardGenerator::enableTemporalStabilization)
+        .def("set_identity_preservation_strength", &ufra::FeedforwardGenerator::setIdentityPreservationStrength)
+        .def("generate", [](ufra::FeedforwardGenerator &generator, const FrameArray &crop,
+                            const ufra::AgeControls &controls, py::object parsing_mask) {
+            const cv::Mat view = mat_view(crop);
+            FrameArray mask_array;
+            cv::Mat mask;
+            if (!parsing_mask.is_none()) {
+                mask_array = parsing_mask.cast<FrameArray>();
+                mask = mat_view(mask_array);
+            }
+            cv::Mat aged;
+            {
+                py::gil_scoped_release release;
+                aged = generator.generateAgedFace(view, controls, mask);
+            }
+            return mat_to_array(aged);
+        }, py::arg("crop"), py::arg("controls"), py::arg("parsing_mask") = py::none())
+        .def("generate_batch", [](ufra::FeedforwardGenerator &generator, const std::vector<FrameArray> &crops,
+                                  const ufra::AgeControls &controls, const std::vector<FrameArray> &parsing_masks) {
+            return generate_batch(generator, crops, {controls}, parsing_masks);
+        }, py::arg("crops"), py::arg("controls"), py::arg("parsing_masks") = std::vector<FrameArray>())
+        .def("generate_batch", &generate_batch, py::arg("crops"), py::arg("controls"),
+             py::arg("parsing_masks") = std::vector<FrameArray>(),
+             "Age each crop with one AgeControls or one per crop, optionally guided by parser masks");
 
     // Main Engine class
     py::class_<ufra::Engine>(m, "Engine")
@@ -99,21 +722,98 @@ PYBIND11_MODULE(pyufra, m) {
         .def("initialize", &ufra::Engine::initialize)
         .def("is_initialized", &ufra::Engine::isInitialized)
         .def("load_models", &ufra::Engine::loadModels)
-        .def("process_frame", &ufra::Engine::processFrame)
+        .def("process_frame", [](ufra::Engine &engine, const ufra::FrameContext &context) {
+            py::gil_scoped_release release;
+            ufra::ProcessingResult result = engine.processFrame(context);
+            own_faces(result.processed_faces);   // The context may view an Image that dies first
+            return result;
+        }, py::arg("context"))
         .def("detect_faces", [](ufra::Engine &engine, py::array_t<uint8_t> input) {
             cv::Mat image = numpy_to_mat(input);
             return engine.detectFaces(image);
         })
+        .def("process_batch", [](ufra::Engine &engine, const FrameArray &frames, const ufra::AgeControls &controls,
+                                 ufra::ProcessingMode mode, int first_frame_number, bool return_results) {
+            return process_batch(engine, frames, {controls}, mode, first_frame_number, return_results);
+        }, py::arg("frames"), py::arg("controls"), py::arg("mode") = ufra::ProcessingMode::FEEDFORWARD,
+           py::arg("first_frame_number") = 0, py::arg("return_results") = false)
+        .def("process_batch", &process_batch, py::arg("frames"), py::arg("controls"),
+             py::arg("mode") = ufra::ProcessingMode::FEEDFORWARD, py::arg("first_frame_number") = 0,
+             py::arg("return_results") = false,
+             "Render an (N, H, W, C) uint8 stack with one AgeControls or one per frame. Returns the stacked "
+             "output, plus the per-frame results if return_results is set.")
+        .def("stream", [](ufra::Engine &engine, const py::iterable &frames, const ufra::AgeControls &controls,
+                          ufra::ProcessingMode mode, int prefetch) {
+            return std::make_unique<FrameStream>(engine, frames, controls, mode, prefetch);
+        }, py::keep_alive<0, 1>(), py::arg("frames"), py::arg("controls"),
+           py::arg("mode") = ufra::ProcessingMode::FEEDFORWARD, py::arg("prefetch") = 4,
+           "Iterate over results for an iterable of frames, rendering up to `prefetch` frames ahead")
         .def("estimate_age", &ufra::Engine::estimateAge)
         .def("set_processing_mode", &ufra::Engine::setProcessingMode)
         .def("get_processing_mode", &ufra::Engine::getProcessingMode)
         .def("get_version_info", &ufra::Engine::getVersionInfo)
         .def("set_error_callback", &ufra::Engine::setErrorCallback);
 
+    py::class_<FrameStream>(m, "FrameStream")
+        .def("__iter__", [](FrameStream &stream) -> FrameStream & { return stream; })
+        .def("__next__", &FrameStream::next);
+
+    // Client for a running ufra_server: models stay resident in the service,
+    // so short-lived Python processes skip loading and warm-up
+    py::class_<ufra::service::RenderClient>(m, "RenderClient")
+        .def(py::init<>())
+        .def("connect", &ufra::service::RenderClient::connect, py::arg("socket_path") = "")
+        .def("disconnect", &ufra::service::RenderClient::disconnect)
+        .def("is_connected", &ufra::service::RenderClient::isConnected)
+        .def("get_last_error", &ufra::service::RenderClient::getLastError)
+        .def("render", [](ufra::service::RenderClient &client,
+                          py::array_t<uint8_t, py::array::c_style | py::array::forcecast> frame,
+                          const ufra::AgeControls &controls, ufra::ProcessingMode mode, int frame_number) {
+            if (frame.ndim() != 2 && frame.ndim() != 3) {
+                throw std::invalid_argument("frame must be HxW or HxWxC uint8");
+            }
+            const int height = static_cast<int>(frame.shape(0));
+            const int width = static_cast<int>(frame.shape(1));
+            const int channels = frame.ndim() == 3 ? static_cast<int>(frame.shape(2)) : 1;
+            ufra::service::FrameView input{const_cast<uint8_t*>(frame.data()), width, height, channels,
+                                           static_cast<size_t>(width) * channels};
+            ufra::service::JobSettings settings;
+            settings.target_age = controls.target_age;
+            settings.identity_lock = controls.identity_lock_strength;
+            settings.temporal_stability = controls.temporal_stability;
+            settings.mode = static_cast<int>(mode);
+            settings.frame_number = frame_number;
+
+            ufra::ProcessingResult result;
+            ufra::service::FrameView output;
+            {
+                py::gil_scoped_release release;
+                result.success = client.render(input, settings, output, &result.metrics);
+            }
+            if (result.success) {
+                result.output_frame = cv::Mat(output.height, output.width, CV_8UC(output.channels),
+                                              output.data, output.stride).clone();
+            } else {
+                result.error_message = client.getLastError();
+            }
+            return result;
+        }, py::arg("frame"), py::arg("controls"), py::arg("mode") = ufra::ProcessingMode::FEEDFORWARD,
+           py::arg("frame_number") = 0);
+    m.def("default_server_socket", &ufra::service::defaultSocketPath, "Socket path ufra_server listens on by default");
+
     // Factory functions
     m.def("create_engine", &ufra::createEngine, "Create a new UFRa engine instance");
     m.def("get_library_version", &ufra::getLibraryVersion, "Get library version");
     m.def("get_available_backends", &ufra::getAvailableBackends, "Get available GPU backends");
+    m.def("stub_model_dir", [](double call_ms, double item_ms) {
+        ufra::StubCost cost;
+        cost.call_ms = call_ms;
+        cost.item_ms = item_ms;
+        return ufra::stubModelDir(cost);
+    }, py::arg("call_ms") = 0.0, py::arg("item_ms") = 0.0, "Model directory of built-in stub networks for load_models");
+    m.def("render_stub_frame", [](int width, int height, int face_count) {
+        return mat_to_array(ufra::renderStubFrame(width, height, face_count));
+    }, py::arg("width"), py::arg("height"), py::arg("face_count") = 2, "BGR frame with faces the stub detector finds");
 
     // Helper functions
     m.def("numpy_to_mat", &numpy_to_mat, "Convert numpy array to OpenCV Mat");
@@ -0,0 +1,147 @@
+"""pyufra tests on the built-in stub models: results must own their images,
+and Image must stay valid for as long as numpy or DLPack consumers use it."""
+
+import gc
+import sys
+import unittest
+
+import numpy as np
+
+import pyufra
+
+
+def make_engine():
+    config = pyufra.ModelConfig()
+    config.backend = pyufra.GPUBackend.CPU_FALLBACK
+    config.batch_size = 1
+    engine = pyufra.Engine()
+    assert engine.initialize(config)
+    assert engine.load_models(pyufra.stub_model_dir())
+    return engine
+
+
+def make_controls():
+    controls = pyufra.AgeControls()
+    controls.target_age = 70.0
+    controls.identity_lock_strength = 0.5
+    controls.temporal_stability = 0.5
+    controls.texture_keep = 0.5
+    controls.skin_clean = 0.0
+    controls.enable_hair_aging = False
+    controls.gray_density = 0.5
+    return controls
+
+
+class ResultLifetimeTest(unittest.TestCase):
+    def setUp(self):
+        self.engine = make_engine()
+        self.controls = make_controls()
+
+    def assert_crops_owned(self, faces, frames):
+        crops = [np.array(face.aligned_crop, copy=True) for face in faces]
+        self.assertTrue(crops)
+        frames[...] = 0   # A view into the input would follow this write
+        for face, crop in zip(faces, crops):
+            view = np.asarray(face.aligned_crop)
+            self.assertFalse(np.shares_memory(view, frames))
+            np.testing.assert_array_equal(view, crop)
+
+    def test_process_batch_results_own_crops(self):
+        frame = pyufra.render_stub_frame(640, 480, 2)
+        frames = np.stack([frame, frame])
+        _, results = self.engine.process_batch(frames, self.controls, return_results=True)
+        faces = [face for result in results for face in result.processed_faces]
+        self.assert_crops_owned(faces, frames)
+
+    def test_stream_results_own_crops(self):
+        frames = [pyufra.render_stub_frame(640, 480, 2) for _ in range(3)]
+        results = list(self.engine.stream(iter(frames), self.controls, prefetch=2))
+        self.assertEqual(len(results), 3)
+        for result, frame in zip(results, frames):
+            self.assert_crops_owned(result.processed_faces, frame)
+
+    def test_crops_outlive_input(self):
+        frames = np.stack([pyufra.render_stub_frame(640, 480, 2)])
+        _, results = self.engine.process_batch(frames, self.controls, return_results=True)
+        del frames
+        gc.collect()
+        crop = np.asarray(results[0].processed_faces[0].aligned_crop)
+        self.assertEqual(crop.dtype, np.uint8)
+        self.assertGreater(int(crop.max()), 0)   # Stub faces are bright
+
+
+class DLPackTest(unittest.TestCase):
+    def test_asarray_round_trip(self):
+        source = np.arange(12 * 10 * 3, dtype=np.uint8).reshape(12, 10, 3)
+        image = pyufra.from_dlpack(source)
+        self.assertEqual(image.shape, (12, 10, 3))
+        view = np.asarray(image)
+        self.assertTrue(np.shares_memory(view, source))
+        np.testing.assert_array_equal(view, source)
+
+    def test_from_dlpack_round_trip(self):
+        source = np.linspace(0.0, 1.0, 8 * 6, dtype=np.float32).reshape(8, 6, 1)
+        image = pyufra.from_dlpack(source)
+        back = np.from_dlpack(image)
+        self.assertEqual(back.dtype, np.float32)
+        self.assertTrue(np.shares_memory(back, source))
+        np.testing.assert_array_equal(back.reshape(source.shape), source)
+
+    def test_padded_rows(self):
+        padded = np.zeros((4, 8, 3), dtype=np.uint8)
+        padded[:, :5] = 7
+        image = pyufra.from_dlpack(padded[:, :5])
+        np.testing.assert_array_equal(np.asarray(image), padded[:, :5])
+
+    def test_capsule_deleter_releases_producer(self):
+        source = np.zeros((4, 4, 3), dtype=np.uint8)
+        baseline = sys.getrefcount(source)
+        image = pyufra.from_dlpack(source)
+        self.assertGreater(sys.getrefcount(source), baseline)
+
+        # An unconsumed capsule frees its tensor, and it keeps the producer
+        # alive after the Image it came from is gone
+        capsule = image.__dlpack__()
+        del image
+        gc.collect()
+        self.assertGreater(sys.getrefcount(source), baseline)
+        del capsule
+        gc.collect()
+        self.assertEqual(sys.getrefcount(source), baseline)
+
+        # A consumed capsule is freed by its consumer
+        consumer = np.from_dlpack(pyufra.from_dlpack(source))
+        self.assertGreater(sys.getrefcount(source), baseline)
+        del consumer
+        gc.collect()
+        self.assertEqual(sys.getrefcount(source), baseline)
+
+    def test_rejects_unsupported_tensors(self):
+        with self.assertRaises(ValueError):
+            pyufra.from_dlpack(np.zeros((4, 4), dtype=np.int16))
+        with self.assertRaises(ValueError):
+            pyufra.from_dlpack(np.zeros((4, 4, 3), dtype=np.uint8)[:, ::2])
+
+
+class StreamOrderTest(unittest.TestCase):
+    def test_keyframe_stream_propagates_in_order(self):
+        engine = make_engine()
+        frames = [pyufra.render_stub_frame(320, 240, 1) for _ in range(7)]
+        results = list(engine.stream(iter(frames), make_controls(), mode=pyufra.ProcessingMode.KEYFRAME,
+                                     prefetch=3))
+        self.assertEqual(len(results), 7)
+        for result in results:
+            self.assertTrue(result.success, result.error_message)
+            self.assertEqual(len(result.processed_faces), 1)
+        # The first frame keys the track; each later frame propagates it, one
+        # more than the frame before when the frames reach the engine in order
+        self.assertEqual(results[0].metrics["keyframe_faces"], 1.0)
+        track_id = results[0].processed_faces[0].track_id
+        for index, result in enumerate(results[1:], start=1):
+            self.assertEqual(result.metrics["keyframe_faces"], 0.0)
+            self.assertEqual(result.metrics["propagated"], float(index))
+            self.assertEqual(result.processed_faces[0].track_id, track_id)
+
+
+if __name__ == "__main__":
+    unittest.main()
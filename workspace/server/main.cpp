@@ -0,0 +1,195 @@
+#include "ufra/engine.h"
+#include "ufra/render_service.h"
+#include <opencv2/opencv.hpp>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ufra_server: keeps one engine and its models resident and renders frames
+// for local clients (ufra_cli --server, pyufra.RenderClient, the OpenFX
+// plugin). Frames from concurrent clients are batched into one
+// Engine::processBatch call so their faces share network passes.
+
+namespace {
+
+void printUsage() {
+    std::cout << "UFRa render service\n";
+    std::cout << "Usage: ufra_server [options]\n";
+    std::cout << "\nOptions:\n";
+    std::cout << "  --socket <path>         Unix socket to listen on (default $UFRA_SOCKET,\n";
+    std::cout << "                          $XDG_RUNTIME_DIR/ufra.sock or /tmp/ufra-<uid>.sock)\n";
+    std::cout << "  --models <path>         Path to model directory, or stub: for built-in stubs\n";
+    std::cout << "  --gpu <backend>         GPU backend (cuda|metal|directml|cpu)\n";
+    std::cout << "  --max-batch <n>         Frames rendered together across clients (default 8)\n";
+    std::cout << "  --batch-window <ms>     Time a frame waits for others to join its batch (default 2)\n";
+    std::cout << "  --result-cache <dir>    Reuse per-face results from earlier renders, stored in <dir>\n";
+    std::cout << "  --result-cache-gb <n>   Size limit of the result cache (default 8)\n";
+    std::cout << "  --auto-batch            Measure the fastest face batch size per network (stored per machine)\n";
+    std::cout << "  --batch-latency-cap <ms> Longest network call --auto-batch may choose (default 100)\n";
+    std::cout << "  --metrics-file <path>   Write OpenMetrics text to <path> every 5 s\n";
+    std::cout << "  --metrics-port <n>      Serve OpenMetrics at http://127.0.0.1:<n>/metrics\n";
+    std::cout << "  --profile-counters      Add per-stage IPC and cache/branch miss rates to the metrics\n";
+    std::cout << "  --help                  Show this help message\n";
+}
+
+struct ServerConfig {
+    std::string models_path = "/usr/local/share/ufra/models";
+    ufra::GPUBackend gpu_backend = ufra::GPUBackend::CUDA;
+    ufra::service::ServerOptions options;
+    std::string result_cache_dir;
+    size_t result_cache_bytes = size_t(8) << 30;
+    bool profile_counters = false;
+    std::string metrics_file;
+    int metrics_port = 0;
+    bool auto_batch = false;
+    float batch_latency_cap_ms = 100.0f;
+    bool help = false;
+};
+
+ServerConfig parseArguments(int argc, char* argv[]) {
+    ServerConfig config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            config.help = true;
+        } else if (arg == "--socket" && i + 1 < argc) {
+            config.options.socket_path = argv[++i];
+        } else if (arg == "--models" && i + 1 < argc) {
+            config.models_path = argv[++i];
+        } else if (arg == "--gpu" && i + 1 < argc) {
+            std::string gpu_str = argv[++i];
+            if (gpu_str == "cuda") config.gpu_backend = ufra::GPUBackend::CUDA;
+            else if (gpu_str == "metal") config.gpu_backend = ufra::GPUBackend::METAL;
+            else if (gpu_str == "directml") config.gpu_backend = ufra::GPUBackend::DIRECTML;
+            else if (gpu_str == "cpu") config.gpu_backend = ufra::GPUBackend::CPU_FALLBACK;
+        } else if (arg == "--max-batch" && i + 1 < argc) {
+            config.options.max_batch = std::stoi(argv[++i]);
+        } else if (arg == "--batch-window" && i + 1 < argc) {
+            config.options.batch_window_us = static_cast<int>(std::stof(argv[++i]) * 1000.0f);
+        } else if (arg == "--result-cache" && i + 1 < argc) {
+            config.result_cache_dir = argv[++i];
+        } else if (arg == "--result-cache-gb" && i + 1 < argc) {
+            config.result_cache_bytes = static_cast<size_t>(std::stod(argv[++i]) * (1 << 30));
+        } else if (arg == "--profile-counters") {
+            config.profile_counters = true;
+        } else if (arg == "--auto-batch") {
+            config.auto_batch = true;
+        } else if (arg == "--batch-latency-cap" && i + 1 < argc) {
+            config.batch_latency_cap_ms = std::stof(argv[++i]);
+        } else if (arg == "--metrics-file" && i + 1 < argc) {
+            config.metrics_file = argv[++i];
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            config.metrics_port = std::stoi(argv[++i]);
+        }
+    }
+    return config;
+}
+
+// Wraps each job's shared-memory frames as cv::Mat headers (no copies) and
+// renders all of them in one engine batch
+void renderBatch(ufra::Engine& engine, std::vector<ufra::service::RenderJob*>& jobs) {
+    std::vector<ufra::FrameContext> contexts;
+    contexts.reserve(jobs.size());
+    for (auto* job : jobs) {
+        ufra::FrameContext context;
+        context.frame_number = job->settings.frame_number;
+        // A client streams its own clip unless the job names one shared
+        // across connections
+        context.clip_id = job->settings.clip_id != 0 ? job->settings.clip_id : job->client_id;
+        context.input_frame = cv::Mat(job->input.height, job->input.width, CV_8UC(job->input.channels),
+                                      job->input.data, job->input.stride);
+        context.controls = ufra::AgeControls{};
+        context.controls.target_age = job->settings.target_age;
+        context.controls.identity_lock_strength = job->settings.identity_lock;
+        context.controls.temporal_stability = job->settings.temporal_stability;
+        context.mode = static_cast<ufra::ProcessingMode>(job->settings.mode);
+        contexts.push_back(context);
+    }
+
+    std::vector<ufra::ProcessingResult> results = engine.processBatch(contexts);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        auto* job = jobs[i];
+        const ufra::ProcessingResult& result = results[i];
+        job->metrics = result.metrics;
+        job->success = result.success;
+        job->error = result.error_message;
+        if (!result.success) {
+            continue;
+        }
+
+        cv::Mat output(job->output.height, job->output.width, CV_8UC(job->output.channels),
+                       job->output.data, job->output.stride);
+        if (result.output_frame.size() != output.size() || result.output_frame.type() != output.type()) {
+            job->success = false;
+            job->error = "engine output does not match the input frame";
+            continue;
+        }
+        result.output_frame.copyTo(output);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    ServerConfig config = parseArguments(argc, argv);
+    if (config.help) {
+        printUsage();
+        return 0;
+    }
+
+    // Handled by sigwait below; blocked before any thread starts so no
+    // worker receives them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    auto engine = ufra::createEngine();
+    ufra::ModelConfig model_config;
+    model_config.backend = config.gpu_backend;
+    model_config.batch_size = config.options.max_batch;
+    model_config.use_half_precision = true;
+    model_config.max_resolution = 1024;
+    model_config.result_cache_dir = config.result_cache_dir;
+    model_config.result_cache_max_bytes = config.result_cache_bytes;
+    model_config.profile_counters = config.profile_counters;
+    model_config.metrics_file = config.metrics_file;
+    model_config.metrics_port = config.metrics_port;
+    model_config.auto_tune_batch = config.auto_batch;
+    model_config.batch_latency_cap_ms = config.batch_latency_cap_ms;
+
+    if (!engine->initialize(model_config)) {
+        std::cerr << "Error: Failed to initialize UFRa engine" << std::endl;
+        return -1;
+    }
+    if (!engine->loadModels(config.models_path)) {
+        std::cerr << "Error: Failed to load models from: " << config.models_path << std::endl;
+        return -1;
+    }
+
+    ufra::service::RenderServer server;
+    bool started = server.start(config.options, [&engine](std::vector<ufra::service::RenderJob*>& jobs) {
+        renderBatch(*engine, jobs);
+    });
+    if (!started) {
+        return -1;
+    }
+    std::cout << "UFRa render service listening on " << server.getSocketPath() << std::endl;
+
+    int signal_number = 0;
+    sigwait(&signals, &signal_number);
+
+    auto stats = server.getStats();
+    server.stop();
+    std::cout << "Rendered " << stats["jobs"] << " frames in " << stats["batches"]
+              << " batches (mean batch " << stats["mean_batch_size"] << ")" << std::endl;
+    auto metrics = engine->getPerformanceMetrics();
+    if (metrics.count("result_cache_hits")) {
+        std::cout << "Result cache: " << metrics["result_cache_hits"] << " faces reused ("
+                  << metrics["result_cache_hit_rate"] * 100.0f << "%), "
+                  << metrics["result_cache_bytes_saved"] / (1024.0f * 1024.0f) << " MB saved" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "ufra/batch_scheduler.h"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+using ufra::BatchScheduler;
+using ufra::BatchSchedulerOptions;
+
+namespace {
+
+// Doubles every item and records the size of each batch
+struct Doubler {
+    std::mutex mutex;
+    std::vector<size_t> batch_sizes;
+
+    std::vector<int> operator()(const std::vector<int>& items) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batch_sizes.push_back(items.size());
+        }
+        std::vector<int> results;
+        for (int item : items) {
+            results.push_back(item * 2);
+        }
+        return results;
+    }
+};
+
+} // namespace
+
+TEST(BatchSchedulerTest, BatchesConcurrentCallersAndScattersResults) {
+    Doubler doubler;
+    BatchSchedulerOptions options;
+    options.max_batch_size = 6;
+    options.max_delay_us = 2000000;   // Only a full batch or the last caller dispatches
+    BatchScheduler<int, int> scheduler([&](const std::vector<int>& items) { return doubler(items); }, options);
+
+    constexpr int kCallers = 3;
+    for (int c = 0; c < kCallers; ++c) {
+        scheduler.enter();
+    }
+    std::vector<std::vector<int>> results(kCallers);
+    std::vector<std::thread> callers;
+    for (int c = 0; c < kCallers; ++c) {
+        callers.emplace_back([&, c] {
+            results[c] = scheduler.run(7, {c * 10, c * 10 + 1});
+            scheduler.leave();
+        });
+    }
+    for (auto& thread : callers) {
+        thread.join();
+    }
+
+    for (int c = 0; c < kCallers; ++c) {
+        EXPECT_EQ(results[c], (std::vector<int>{c * 20, c * 20 + 2}));
+    }
+    ASSERT_EQ(doubler.batch_sizes.size(), 1u);
+    EXPECT_EQ(doubler.batch_sizes[0], 6u);
+    auto stats = scheduler.getStats();
+    EXPECT_EQ(stats["batches"], 1.0f);
+    EXPECT_EQ(stats["mean_batch_size"], 6.0f);
+}
+
+TEST(BatchSchedulerTest, SplitsByKeyAndBatchSize) {
+    Doubler doubler;
+    BatchSchedulerOptions options;
+    options.max_batch_size = 4;
+    BatchScheduler<int, int> scheduler([&](const std::vector<int>& items) { return doubler(items); }, options);
+
+    std::vector<int> items(10);
+    for (int i = 0; i < 10; ++i) {
+        items[i] = i;
+    }
+    std::vector<int> results = scheduler.run(1, items);
+    ASSERT_EQ(results.size(), 10u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(results[i], 2 * i);
+    }
+    EXPECT_EQ(doubler.batch_sizes, (std::vector<size_t>{4, 4, 2}));
+    EXPECT_TRUE(scheduler.run(2, {}).empty());
+
+    // Callers on different keys never share a batch
+    scheduler.enter();
+    scheduler.enter();
+    std::thread other([&] {
+        scheduler.run(3, {1});
+        scheduler.leave();
+    });
+    scheduler.run(4, {2});
+    scheduler.leave();
+    other.join();
+    EXPECT_EQ(doubler.batch_sizes.size(), 5u);
+    EXPECT_EQ(scheduler.getStats()["max_batch_size"], 4.0f);
+}
+
+TEST(BatchSchedulerTest, LoneCallerDoesNotWaitAndErrorsPropagate) {
+    std::atomic<int> calls{0};
+    BatchSchedulerOptions options;
+    options.max_delay_us = 5000000;
+    BatchScheduler<int, int> scheduler([&](const std::vector<int>& items) {
+        if (++calls == 2) {
+            throw std::runtime_error("network failed");
+        }
+        return items;
+    }, options);
+
+    scheduler.enter();
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(scheduler.run(0, {5}), std::vector<int>{5});
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    EXPECT_THROW(scheduler.run(0, {6}), std::runtime_error);
+    EXPECT_EQ(scheduler.run(0, {7}), std::vector<int>{7});   // Later batches are unaffected
+    scheduler.leave();
+}
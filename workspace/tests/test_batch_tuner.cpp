@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "ufra/batch_tuner.h"
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::vector<ufra::BatchTiming> timings(const std::vector<std::pair<int, double>>& points) {
+    std::vector<ufra::BatchTiming> sweep;
+    for (const auto& point : points) {
+        ufra::BatchTiming timing;
+        timing.batch_size = point.first;
+        timing.call_ms = point.second;
+        sweep.push_back(timing);
+    }
+    return sweep;
+}
+
+} // namespace
+
+TEST(BatchTunerTest, SelectsFastestPerItemUnderCap) {
+    // Per item: 10, 6, 4, 3.5 and 3.75 ms
+    const auto sweep = timings({{1, 10.0}, {2, 12.0}, {4, 16.0}, {8, 28.0}, {16, 60.0}});
+    EXPECT_EQ(ufra::BatchTuner::select(sweep, 0.0), 8);
+    EXPECT_EQ(ufra::BatchTuner::select(sweep, 20.0), 4);
+    EXPECT_EQ(ufra::BatchTuner::select(sweep, 5.0), 1);   // Nothing fits
+    EXPECT_EQ(ufra::BatchTuner::select({}, 0.0), 1);
+
+    // 5.1 ms per item is within 5% of 5.0, so the smaller batch wins
+    EXPECT_EQ(ufra::BatchTuner::select(timings({{1, 10.0}, {2, 10.2}, {4, 20.0}}), 0.0), 2);
+}
+
+TEST(BatchTunerTest, SweepStopsAfterCap) {
+    int calls = 0;
+    auto run = [&calls](int batch) {   // 2 ms per call plus 1 ms per item
+        ++calls;
+        std::this_thread::sleep_for(std::chrono::microseconds(2000 + 1000 * batch));
+    };
+    const std::vector<int> candidates = {1, 2, 4, 8, 16, 32};
+    const auto sweep = ufra::BatchTuner::sweep(run, candidates, 12.0, 3);
+
+    ASSERT_EQ(sweep.size(), 5u);   // 16 takes 18 ms, so 32 is never tried
+    EXPECT_EQ(calls, 5 * 4);
+    EXPECT_EQ(sweep[3].batch_size, 8);
+    EXPECT_GE(sweep[3].call_ms, 10.0);
+    EXPECT_EQ(ufra::BatchTuner::select(sweep, 12.0), 8);
+
+    EXPECT_TRUE(ufra::BatchTuner::covers(sweep, candidates, 12.0));
+    EXPECT_FALSE(ufra::BatchTuner::covers(sweep, candidates, 100.0));   // 32 may fit now
+    EXPECT_FALSE(ufra::BatchTuner::covers(sweep, {3, 4}, 12.0));
+    EXPECT_FALSE(ufra::BatchTuner::covers({}, candidates, 12.0));
+}
+
+TEST(BatchTunerTest, StoresSweepsPerKeyAcrossInstances) {
+    const fs::path path = fs::temp_directory_path() / ("ufra_batch_tuning_" + std::to_string(getpid())) / "tuning.tsv";
+    fs::remove_all(path.parent_path());
+    const auto parser = timings({{1, 3.0}, {2, 4.5}});
+    const auto generator = timings({{1, 7.25}, {4, 20.0}});
+
+    ufra::BatchTuner first;
+    ASSERT_TRUE(first.open(path.string()));
+    EXPECT_TRUE(first.lookup("host/cpu/parser").empty());
+
+    ufra::BatchTuner second;
+    ASSERT_TRUE(second.open(path.string()));
+    EXPECT_TRUE(second.store("host/cpu/generator", generator));
+    EXPECT_TRUE(first.store("host/cpu/parser", parser));   // Keeps the other process's entry
+
+    ufra::BatchTuner reopened;
+    ASSERT_TRUE(reopened.open(path.string()));
+    const auto loaded = reopened.lookup("host/cpu/generator");
+    ASSERT_EQ(loaded.size(), 2u);
+    EXPECT_EQ(loaded[1].batch_size, 4);
+    EXPECT_DOUBLE_EQ(loaded[0].call_ms, 7.25);
+    EXPECT_EQ(reopened.lookup("host/cpu/parser").size(), 2u);
+    fs::remove_all(path.parent_path());
+
+    const std::string machine = ufra::BatchTuner::machineKey();
+    EXPECT_EQ(machine.back(), 't');
+    EXPECT_EQ(machine.find_first_of(" \t/"), std::string::npos);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "ufra/crop_cache.h"
+#include "ufra/frame_pyramid.h"
+#include <opencv2/opencv.hpp>
+
+class CropCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        frame = cv::Mat::zeros(480, 640, CV_8UC3);
+        cv::circle(frame, cv::Point(320, 240), 80, cv::Scalar(200, 180, 160), -1);
+
+        face.box.x = 240.0f;
+        face.box.y = 160.0f;
+        face.box.width = 160.0f;
+        face.box.height = 160.0f;
+        face.box.confidence = 0.9f;
+        face.box.face_id = 0;
+        face.aligned_crop = frame(cv::Rect(200, 120, 240, 240));
+    }
+
+    cv::Mat frame;
+    ufra::Face face;
+    ufra::CropCache cache;
+};
+
+TEST_F(CropCacheTest, CropIsViewIntoFrame) {
+    EXPECT_FALSE(face.aligned_crop.isContinuous());
+    EXPECT_EQ(face.aligned_crop.data, frame.ptr(120) + 200 * 3);
+}
+
+TEST_F(CropCacheTest, ResizesOncePerResolution) {
+    const cv::Mat& parser_input = cache.getResized(face, cv::Size(512, 512));
+    const cv::Mat& generator_input = cache.getResized(face, cv::Size(512, 512));
+    const cv::Mat& age_input = cache.getResized(face, cv::Size(224, 224));
+
+    EXPECT_EQ(parser_input.data, generator_input.data);
+    EXPECT_EQ(parser_input.size(), cv::Size(512, 512));
+    EXPECT_EQ(age_input.size(), cv::Size(224, 224));
+    EXPECT_EQ(cache.getResizeCount(), 2u);
+    EXPECT_EQ(cache.getHitCount(), 1u);
+    EXPECT_EQ(cache.getMemoryBytes(), (512u * 512u + 224u * 224u) * 3u);
+}
+
+TEST_F(CropCacheTest, NativeSizeIsNotCopied) {
+    const cv::Mat& same = cache.getResized(face, face.aligned_crop.size());
+    EXPECT_EQ(same.data, face.aligned_crop.data);
+    EXPECT_EQ(cache.getResizeCount(), 0u);
+}
+
+TEST_F(CropCacheTest, ResetStartsNewFrame) {
+    cache.getResized(face, cv::Size(512, 512));
+    cache.reset();
+    EXPECT_EQ(cache.getResizeCount(), 0u);
+    EXPECT_EQ(cache.getMemoryBytes(), 0u);
+
+    cache.getResized(face, cv::Size(512, 512));
+    EXPECT_EQ(cache.getResizeCount(), 1u);
+    EXPECT_EQ(cache.getHitCount(), 0u);
+}
+
+TEST_F(CropCacheTest, SamplesFromPyramidLevel) {
+    cv::Mat uhd(2160, 3840, CV_8UC3, cv::Scalar(90, 120, 150));
+    ufra::Face big_face = face;
+    big_face.aligned_crop = uhd(cv::Rect(1000, 500, 1200, 1200));
+
+    ufra::FramePyramid pyramid;
+    pyramid.reset(uhd);
+    cache.reset(&pyramid);
+
+    const cv::Mat& small = cache.getResized(big_face, cv::Size(224, 224));
+    EXPECT_EQ(small.size(), cv::Size(224, 224));
+    EXPECT_EQ(small.at<cv::Vec3b>(100, 100), cv::Vec3b(90, 120, 150));
+
+    // 1200 -> 224 is served from level 2 (300x300 ROI), not level 0
+    EXPECT_EQ(pyramid.getLevelCount(), 3);
+}
+
+TEST(FramePyramidTest, DetectorInputFromCoarseLevel) {
+    cv::Mat uhd = cv::Mat::zeros(2160, 3840, CV_8UC3);
+    ufra::FramePyramid pyramid;
+    pyramid.reset(uhd);
+
+    cv::Mat detector_input = pyramid.sampleFrame(cv::Size(640, 640));
+    EXPECT_EQ(detector_input.size(), cv::Size(640, 640));
+    EXPECT_EQ(pyramid.getLevel(1).size(), cv::Size(1920, 1080));
+    EXPECT_EQ(pyramid.getLevelCount(), 2);  // 1080 / 2 < 640, so level 1 is nearest
+
+    cv::Rect roi;
+    EXPECT_TRUE(pyramid.locate(uhd(cv::Rect(10, 20, 30, 40)), roi));
+    EXPECT_EQ(roi, cv::Rect(10, 20, 30, 40));
+    EXPECT_FALSE(pyramid.locate(cv::Mat::zeros(30, 40, CV_8UC3), roi));
+}
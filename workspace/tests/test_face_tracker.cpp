@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "ufra/face_tracker.h"
+
+namespace {
+
+ufra::Face makeFace(float x, float y, float size) {
+    ufra::Face face;
+    face.box.x = x;
+    face.box.y = y;
+    face.box.width = size;
+    face.box.height = size;
+    face.box.confidence = 0.9f;
+    face.box.face_id = 0;
+    return face;
+}
+
+} // namespace
+
+TEST(FaceTrackerTest, KeepsIdsAcrossSmallMotion) {
+    ufra::FaceTracker tracker;
+    std::vector<ufra::Face> first{makeFace(100, 100, 80), makeFace(400, 120, 90)};
+    tracker.update(first, 0);
+    EXPECT_NE(first[0].track_id, first[1].track_id);
+
+    // Same faces, moved a little and listed in the opposite order
+    std::vector<ufra::Face> second{makeFace(405, 118, 90), makeFace(104, 102, 80)};
+    tracker.update(second, 1);
+    EXPECT_EQ(second[0].track_id, first[1].track_id);
+    EXPECT_EQ(second[1].track_id, first[0].track_id);
+    EXPECT_EQ(second[0].frame_number, 1);
+    EXPECT_EQ(tracker.getActiveTrackCount(), 2u);
+}
+
+TEST(FaceTrackerTest, NewFacesGetFreshIdsAndLostTracksRetire) {
+    ufra::FaceTracker tracker;
+    tracker.setMaxMissedFrames(1);
+    std::vector<ufra::Face> faces{makeFace(100, 100, 80)};
+    tracker.update(faces, 0);
+    const int first_id = faces[0].track_id;
+
+    std::vector<ufra::Face> elsewhere{makeFace(600, 300, 80)};
+    EXPECT_TRUE(tracker.update(elsewhere, 1).empty());
+    EXPECT_NE(elsewhere[0].track_id, first_id);
+
+    std::vector<ufra::Face> none;
+    std::vector<int> retired = tracker.update(none, 3);
+    EXPECT_EQ(retired.size(), 2u);
+    EXPECT_EQ(tracker.getActiveTrackCount(), 0u);
+
+    // Ids are not reused after a reset
+    tracker.reset();
+    tracker.update(faces, 4);
+    EXPECT_NE(faces[0].track_id, first_id);
+}
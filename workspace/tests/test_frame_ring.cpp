@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "ufra/frame_ring.h"
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace ufra::service;
+
+TEST(FrameRingTest, PassesFramesInOrderAndBlocksWhenFull) {
+    FrameRing producer;
+    ASSERT_TRUE(producer.create(2, 100)) << producer.getLastError();
+    EXPECT_EQ(producer.slotCount(), 2u);
+    EXPECT_EQ(producer.slotBytes(), 4096u);   // Slots are page aligned
+
+    FrameRing consumer;
+    ASSERT_TRUE(consumer.attach(dup(producer.fd()), FrameRing::Role::CONSUMER)) << consumer.getLastError();
+
+    for (int i = 0; i < 2; ++i) {
+        uint8_t* slot = producer.acquire(0);
+        ASSERT_NE(slot, nullptr);
+        slot[0] = static_cast<uint8_t>(i + 1);
+        RingSlot header;
+        header.sequence = static_cast<uint64_t>(i);
+        header.width = 1;
+        header.meta_bytes = 5;
+        std::memcpy(header.meta, "meta", 5);
+        ASSERT_TRUE(producer.publish(header));
+    }
+    EXPECT_EQ(producer.acquire(10), nullptr);   // Full until the consumer releases
+
+    RingSlot header;
+    const uint8_t* data = nullptr;
+    ASSERT_TRUE(consumer.receive(header, data, 0));
+    EXPECT_EQ(header.sequence, 0u);
+    EXPECT_EQ(data[0], 1);
+    EXPECT_STREQ(reinterpret_cast<const char*>(header.meta), "meta");
+    ASSERT_TRUE(consumer.receive(header, data, 0));
+    EXPECT_EQ(header.sequence, 1u);
+    EXPECT_EQ(data[0], 2);
+    EXPECT_FALSE(consumer.receive(header, data, 10));
+
+    consumer.release();
+    EXPECT_NE(producer.acquire(0), nullptr);
+
+    producer.close();
+    EXPECT_TRUE(consumer.isClosed());
+    EXPECT_FALSE(consumer.receive(header, data, -1));
+}
+
+TEST(FrameRingTest, StreamsAcrossProcesses) {
+    constexpr int kFrames = 200;
+    FrameRing producer;
+    ASSERT_TRUE(producer.create(4, 64 * 64)) << producer.getLastError();
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        // Consumer process: checks order and contents, exits non-zero on mismatch
+        FrameRing consumer;
+        if (!consumer.attach(dup(producer.fd()), FrameRing::Role::CONSUMER)) {
+            _exit(2);
+        }
+        for (int i = 0; i < kFrames; ++i) {
+            RingSlot header;
+            const uint8_t* data = nullptr;
+            if (!consumer.receive(header, data, 5000) || header.sequence != static_cast<uint64_t>(i) ||
+                data[0] != static_cast<uint8_t>(i) || data[64 * 64 - 1] != static_cast<uint8_t>(i)) {
+                _exit(3);
+            }
+            consumer.release();
+        }
+        _exit(0);
+    }
+
+    for (int i = 0; i < kFrames; ++i) {
+        uint8_t* slot = producer.acquire(5000);
+        ASSERT_NE(slot, nullptr) << producer.getLastError();
+        std::memset(slot, i, 64 * 64);
+        RingSlot header;
+        header.sequence = static_cast<uint64_t>(i);
+        ASSERT_TRUE(producer.publish(header));
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(FrameRingTest, ConsumerMappingIsReadOnlyAndRejectsForeignFds) {
+    FrameRing producer;
+    ASSERT_TRUE(producer.create(1, 4096));
+    FrameRing consumer;
+    ASSERT_TRUE(consumer.attach(dup(producer.fd()), FrameRing::Role::CONSUMER));
+    EXPECT_EQ(consumer.acquire(0), nullptr);   // Wrong role
+
+    producer.acquire(0);
+    producer.publish(RingSlot());
+    RingSlot header;
+    const uint8_t* data = nullptr;
+    ASSERT_TRUE(consumer.receive(header, data, 0));
+    EXPECT_DEATH(const_cast<uint8_t*>(data)[0] = 1, "");
+
+    int plain = memfd_create("not-a-ring", MFD_CLOEXEC);
+    ASSERT_GE(plain, 0);
+    ASSERT_EQ(ftruncate(plain, 1 << 16), 0);
+    FrameRing foreign;
+    EXPECT_FALSE(foreign.attach(plain, FrameRing::Role::CONSUMER));
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include "ufra/huge_page_allocator.h"
+#include <cstring>
+
+using namespace ufra;
+
+TEST(HugePageArenaTest, SmallAllocationsBypassArena) {
+    HugePageArena arena;
+    void* ptr = arena.allocate(4096);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 64, 0u);
+    EXPECT_EQ(arena.getMappedBytes(), 0u);
+    arena.deallocate(ptr);
+}
+
+TEST(HugePageArenaTest, LargeBlocksAreReused) {
+    HugePageArena arena;
+    arena.setMode(HugePageMode::TRANSPARENT);
+
+    const size_t bytes = 1920 * 1080 * 3;
+    void* first = arena.allocate(bytes);
+    ASSERT_NE(first, nullptr);
+    std::memset(first, 0x5A, bytes);
+    EXPECT_EQ(arena.getMappedBytes() % (2 * 1024 * 1024), 0u);
+    EXPECT_GE(arena.getMappedBytes(), bytes);
+    arena.deallocate(first);
+    EXPECT_GT(arena.getCachedBytes(), 0u);
+
+    void* second = arena.allocate(bytes);
+    EXPECT_EQ(second, first);
+    EXPECT_EQ(arena.getReuseCount(), 1u);
+    arena.deallocate(second);
+
+    arena.trim();
+    EXPECT_EQ(arena.getCachedBytes(), 0u);
+    EXPECT_EQ(arena.getMappedBytes(), 0u);
+}
+
+TEST(HugePageArenaTest, FallsBackWithoutHugePages) {
+    HugePageArena arena;
+    arena.setMode(HugePageMode::NONE);
+    void* ptr = arena.allocate(4 * 1024 * 1024);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(arena.getLastMappingMode(), HugePageMode::NONE);
+    arena.deallocate(ptr);
+}
+
+TEST(HugePageArenaTest, CacheCapUnmapsExcess) {
+    HugePageArena arena;
+    arena.setMaxCachedBytes(0);
+    void* ptr = arena.allocate(4 * 1024 * 1024);
+    ASSERT_NE(ptr, nullptr);
+    arena.deallocate(ptr);
+    EXPECT_EQ(arena.getCachedBytes(), 0u);
+    EXPECT_EQ(arena.getMappedBytes(), 0u);
+}
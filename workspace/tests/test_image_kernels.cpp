@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include "ufra/image_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> makeGradient(int width, int height, int channels) {
+    std::vector<uint8_t> image(static_cast<size_t>(width) * height * channels);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            for (int c = 0; c < channels; ++c) {
+                image[(static_cast<size_t>(y) * width + x) * channels + c] =
+                    static_cast<uint8_t>((x * 7 + y * 13 + c * 29) & 0xFF);
+            }
+        }
+    }
+    return image;
+}
+
+} // namespace
+
+TEST(ImageKernelsTest, Downsample2xMatchesReference) {
+    for (int channels : {1, 3, 4, 2}) {
+        const int width = 101, height = 37;  // Odd sizes exercise the scalar tails
+        std::vector<uint8_t> src = makeGradient(width, height, channels);
+        const int dst_width = width / 2, dst_height = height / 2;
+        std::vector<uint8_t> dst(static_cast<size_t>(dst_width) * dst_height * channels);
+
+        ufra::kernels::downsample2x(src.data(), width, height, width * channels, channels,
+                                    dst.data(), dst_width * channels);
+
+        for (int y = 0; y < dst_height; ++y) {
+            for (int x = 0; x < dst_width; ++x) {
+                for (int c = 0; c < channels; ++c) {
+                    auto at = [&](int sx, int sy) {
+                        return src[(static_cast<size_t>(sy) * width + sx) * channels + c];
+                    };
+                    int expected = (at(2 * x, 2 * y) + at(2 * x + 1, 2 * y) +
+                                    at(2 * x, 2 * y + 1) + at(2 * x + 1, 2 * y + 1) + 2) >> 2;
+                    ASSERT_EQ(dst[(static_cast<size_t>(y) * dst_width + x) * channels + c], expected)
+                        << "channels=" << channels << " x=" << x << " y=" << y;
+                }
+            }
+        }
+    }
+}
+
+TEST(ImageKernelsTest, Downsample2xHonoursStrides) {
+    // 8x4 single-channel image inside a 12-byte-stride buffer
+    const int width = 8, height = 4, stride = 12;
+    std::vector<uint8_t> src(stride * height, 255);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            src[y * stride + x] = 100;
+        }
+    }
+    std::vector<uint8_t> dst(2 * 6, 0);
+    ufra::kernels::downsample2x(src.data(), width, height, stride, 1, dst.data(), 6);
+
+    for (int y = 0; y < 2; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            EXPECT_EQ(dst[y * 6 + x], 100);
+        }
+        EXPECT_EQ(dst[y * 6 + 4], 0);  // Padding untouched
+    }
+}
+
+TEST(ImageKernelsTest, ResizeBilinearPreservesFlatAndIdentity) {
+    const int width = 37, height = 23, channels = 3;
+    std::vector<uint8_t> src = makeGradient(width, height, channels);
+    std::vector<uint8_t> same(src.size());
+    ufra::kernels::resizeBilinear(src.data(), width, height, width * channels, channels,
+                                  same.data(), width, height, width * channels);
+    EXPECT_EQ(same, src);
+
+    std::vector<uint8_t> flat(16 * 16, 77), up(40 * 24);
+    ufra::kernels::resizeBilinear(flat.data(), 16, 16, 16, 1, up.data(), 40, 24, 40);
+    for (uint8_t v : up) {
+        ASSERT_EQ(v, 77);
+    }
+}
+
+TEST(ImageKernelsTest, ResizeBilinearInterpolatesHalfPixelCenters) {
+    // 2 -> 4 upscale: samples at -0.25, 0.25, 0.75, 1.25 clamp to the edges
+    const uint8_t src[2] = {0, 200};
+    uint8_t dst[4] = {};
+    ufra::kernels::resizeBilinear(src, 2, 1, 2, 1, dst, 4, 1, 4);
+    EXPECT_EQ(dst[0], 0);
+    EXPECT_EQ(dst[1], 50);
+    EXPECT_EQ(dst[2], 150);
+    EXPECT_EQ(dst[3], 200);
+}
+
+TEST(ImageKernelsTest, PackAndUnpackPlanarRoundTrip) {
+    const int width = 5, height = 3;
+    std::vector<uint8_t> src = makeGradient(width, height, 3);
+    std::vector<float> planar(src.size());
+    const float mean[3] = {127.5f, 127.5f, 127.5f};
+    ufra::kernels::packPlanar(src.data(), width, height, width * 3, 3, true, mean, 2.0f / 255.0f, planar.data());
+
+    // Plane 0 holds the swapped (third) channel
+    EXPECT_FLOAT_EQ(planar[0], (src[2] - 127.5f) * 2.0f / 255.0f);
+
+    std::vector<uint8_t> back(src.size());
+    ufra::kernels::unpackPlanar(planar.data(), width, height, 3, true, 127.5f, 127.5f, back.data(), width * 3);
+    EXPECT_EQ(back, src);
+}
+
+TEST(ImageKernelsTest, BlendMaskedUsesPerPixelAlpha) {
+    const uint8_t src[6] = {200, 200, 200, 200, 200, 200};
+    const uint8_t alpha[2] = {0, 255};
+    uint8_t dst[6] = {10, 10, 10, 10, 10, 10};
+    ufra::kernels::blendMasked(src, 6, alpha, 2, 2, 1, 3, dst, 6);
+    EXPECT_EQ(dst[0], 10);
+    EXPECT_EQ(dst[3], 200);
+
+    uint8_t half[3] = {};
+    ufra::kernels::blendWeighted(src, 3, dst, 3, 1, 1, 3, 0.5f, half, 3);
+    EXPECT_EQ(half[0], 105);
+}
+
+namespace {
+
+// Smooth blob texture, so Lucas-Kanade has gradients everywhere
+std::vector<uint8_t> makeTexture(int width, int height, float shift_x, float shift_y) {
+    std::vector<uint8_t> image(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const float u = (x - shift_x) * 0.15f;
+            const float v = (y - shift_y) * 0.11f;
+            image[static_cast<size_t>(y) * width + x] =
+                static_cast<uint8_t>(128.0f + 60.0f * std::sin(u) * std::cos(v) + 40.0f * std::sin(0.7f * u + 0.5f * v));
+        }
+    }
+    return image;
+}
+
+} // namespace
+
+TEST(ImageKernelsTest, FlowRecoversTranslation) {
+    const int width = 96, height = 80;
+    std::vector<uint8_t> reference = makeTexture(width, height, 0.0f, 0.0f);
+    std::vector<uint8_t> target = makeTexture(width, height, 3.0f, -2.0f);   // Content moved by (+3, -2)
+    std::vector<float> flow(static_cast<size_t>(width) * height * 2);
+    ufra::kernels::computeFlowLK(reference.data(), width, target.data(), width, width, height, 3, 4, 4, flow.data());
+
+    double dx = 0.0, dy = 0.0;
+    int samples = 0;
+    for (int y = 16; y < height - 16; ++y) {
+        for (int x = 16; x < width - 16; ++x) {
+            dx += flow[2 * (static_cast<size_t>(y) * width + x)];
+            dy += flow[2 * (static_cast<size_t>(y) * width + x) + 1];
+            ++samples;
+        }
+    }
+    EXPECT_NEAR(dx / samples, 3.0, 0.25);
+    EXPECT_NEAR(dy / samples, -2.0, 0.25);
+
+    // Warping the target back by the flow reproduces the reference
+    std::vector<uint8_t> warped(reference.size());
+    ufra::kernels::warpByFlow(target.data(), width, width, height, 1, flow.data(), warped.data(), width);
+    const float before = ufra::kernels::meanAbsDiff(reference.data(), width, target.data(), width, width, height, 1);
+    const float after = ufra::kernels::meanAbsDiff(reference.data(), width, warped.data(), width, width, height, 1);
+    EXPECT_LT(after, before * 0.25f);
+}
+
+TEST(ImageKernelsTest, WarpByIntegerFlowShifts) {
+    const int width = 7, height = 5;
+    std::vector<uint8_t> src = makeGradient(width, height, 3);
+    std::vector<float> flow(static_cast<size_t>(width) * height * 2);
+    for (size_t i = 0; i < flow.size(); i += 2) {
+        flow[i] = 1.0f;   // dst(x, y) = src(x + 1, y)
+    }
+    std::vector<uint8_t> dst(src.size());
+    ufra::kernels::warpByFlow(src.data(), width * 3, width, height, 3, flow.data(), dst.data(), width * 3);
+    EXPECT_EQ(dst[0], src[3]);
+    EXPECT_EQ(dst[(width - 1) * 3], src[(width - 1) * 3]);   // Clamped at the border
+
+    std::vector<float> noise(src.begin(), src.end());
+    std::vector<float> warped_noise(noise.size());
+    ufra::kernels::warpByFlow(noise.data(), width * 3, width, height, 3, flow.data(), warped_noise.data(), width * 3);
+    EXPECT_FLOAT_EQ(warped_noise[4], noise[7]);
+}
+
+TEST(ImageKernelsTest, MeanAbsDiffMatchesReference) {
+    const int width = 37, height = 3;   // Spans the 16-byte blocks and the scalar tail
+    std::vector<uint8_t> a = makeGradient(width, height, 3);
+    std::vector<uint8_t> b(a.rbegin(), a.rend());
+    double expected = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        expected += std::abs(a[i] - b[i]);
+    }
+    EXPECT_NEAR(ufra::kernels::meanAbsDiff(a.data(), width * 3, b.data(), width * 3, width, height, 3),
+                expected / a.size(), 1e-3);
+}
+
+TEST(ImageKernelsTest, ContentHashIgnoresPaddingAndSeesEveryByte) {
+    const int width = 77, height = 19, channels = 3;
+    std::vector<uint8_t> image = makeGradient(width, height, channels);
+    const size_t row_bytes = static_cast<size_t>(width) * channels;
+    const uint64_t hash = ufra::kernels::contentHash(image.data(), row_bytes, height, row_bytes);
+
+    // Same pixels in a padded buffer
+    const size_t stride = row_bytes + 45;
+    std::vector<uint8_t> padded(stride * height, 0xAB);
+    for (int y = 0; y < height; ++y) {
+        std::copy_n(&image[y * row_bytes], row_bytes, &padded[y * stride]);
+    }
+    EXPECT_EQ(ufra::kernels::contentHash(padded.data(), row_bytes, height, stride), hash);
+
+    image[row_bytes * 7 + 100] ^= 1;
+    EXPECT_NE(ufra::kernels::contentHash(image.data(), row_bytes, height, row_bytes), hash);
+    image[row_bytes * 7 + 100] ^= 1;
+    EXPECT_NE(ufra::kernels::contentHash(image.data(), row_bytes, height - 1, row_bytes), hash);
+}
+
+TEST(ImageKernelsTest, ContentHashSeedsAreIndependent) {
+    std::vector<uint8_t> image = makeGradient(40, 8, 1);
+    const uint64_t a = ufra::kernels::contentHash(image.data(), 40, 8, 40);
+    const uint64_t b = ufra::kernels::contentHash(image.data(), 40, 8, 40, 1);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(ufra::kernels::contentHash(image.data(), 40, 8, 40, 1), b);
+}
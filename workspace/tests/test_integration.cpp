@@ -5,7 +5,13 @@
 #include "ufra/face_parser.h"
 #include "ufra/feedforward_generator.h"
 #include "ufra/compositor.h"
+#include "ufra/stub_network.h"
 #include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
 
 class IntegrationTest : public ::testing::Test {
 protected:
@@ -301,4 +307,232 @@ TEST_F(IntegrationTest, ErrorRecovery) {
     ufra::ProcessingResult result = engine->processFrame(valid_context);
     // Should still work after handling errors
     EXPECT_FALSE(result.success); // Without models, but should not crash
-}
\ No newline at end of file
+}
+
+TEST_F(IntegrationTest, StubModelsEndToEnd) {
+    auto engine = ufra::createEngine();
+    ufra::ModelConfig config;
+    config.backend = ufra::GPUBackend::CPU_FALLBACK;
+    config.batch_size = 1;
+    ASSERT_TRUE(engine->initialize(config));
+    ASSERT_TRUE(engine->loadModels(ufra::stubModelDir()));
+
+    cv::Mat frame = ufra::renderStubFrame(640, 480, 2);
+    ufra::FrameContext context;
+    context.frame_number = 0;
+    context.input_frame = frame;
+    context.controls = age_controls;
+    context.controls.target_age = 80.0f;
+    context.controls.identity_lock_strength = 0.2f;
+    context.mode = ufra::ProcessingMode::FEEDFORWARD;
+
+    ufra::ProcessingResult result = engine->processFrame(context);
+    ASSERT_TRUE(result.success) << result.error_message;
+    ASSERT_EQ(result.processed_faces.size(), 2u);
+    ASSERT_EQ(result.output_frame.size(), frame.size());
+
+    // Faces change, the background far from them does not
+    for (const ufra::FaceBox& box : ufra::stubFaceLayout(640, 480, 2)) {
+        cv::Rect inner(static_cast<int>(box.x + box.width * 0.3f), static_cast<int>(box.y + box.height * 0.3f),
+                       static_cast<int>(box.width * 0.4f), static_cast<int>(box.height * 0.4f));
+        EXPECT_GT(cv::norm(result.output_frame(inner), frame(inner), cv::NORM_L1) / inner.area(), 1.0);
+    }
+    cv::Rect corner(0, 0, 32, 32);
+    EXPECT_EQ(cv::norm(result.output_frame(corner), frame(corner), cv::NORM_INF), 0.0);
+}
+
+TEST_F(IntegrationTest, StubModelsChargeInferenceCost) {
+    auto engine = ufra::createEngine();
+    ufra::ModelConfig config;
+    config.backend = ufra::GPUBackend::CPU_FALLBACK;
+    config.batch_size = 4;
+    ASSERT_TRUE(engine->initialize(config));
+
+    ufra::StubCost cost;
+    cost.call_ms = 2.0;
+    ASSERT_TRUE(engine->loadModels(ufra::stubModelDir(cost)));
+
+    std::vector<ufra::FrameContext> contexts(8);
+    for (size_t i = 0; i < contexts.size(); ++i) {
+        contexts[i].frame_number = static_cast<int>(i);
+        contexts[i].input_frame = ufra::renderStubFrame(320, 240, 1);
+        contexts[i].controls = age_controls;
+        contexts[i].mode = ufra::ProcessingMode::FEEDFORWARD;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ufra::ProcessingResult> results = engine->processBatch(contexts);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ASSERT_EQ(results.size(), contexts.size());
+    for (const auto& result : results) {
+        EXPECT_TRUE(result.success) << result.error_message;
+        EXPECT_EQ(result.processed_faces.size(), 1u);
+    }
+    EXPECT_GE(ms, 8 * cost.call_ms);   // At least one detector call per frame
+}
+
+TEST_F(IntegrationTest, DeterministicRunsMatchByHash) {
+    auto render = [&](bool deterministic) {
+        auto engine = ufra::createEngine();
+        ufra::ModelConfig config;
+        config.backend = ufra::GPUBackend::CPU_FALLBACK;
+        config.batch_size = 2;
+        config.deterministic = deterministic;
+        EXPECT_TRUE(engine->initialize(config));
+        EXPECT_TRUE(engine->loadModels(ufra::stubModelDir()));
+
+        std::vector<ufra::FrameContext> contexts(3);
+        for (size_t i = 0; i < contexts.size(); ++i) {
+            contexts[i].frame_number = static_cast<int>(i);
+            contexts[i].input_frame = ufra::renderStubFrame(320, 240, 2);
+            contexts[i].controls = age_controls;
+            contexts[i].controls.target_age = 40.0f + 10.0f * i;
+            contexts[i].mode = ufra::ProcessingMode::FEEDFORWARD;
+        }
+        std::vector<uint64_t> hashes;
+        for (const ufra::ProcessingResult& result : engine->processBatch(contexts)) {
+            EXPECT_TRUE(result.success) << result.error_message;
+            hashes.push_back(result.output_hash);
+        }
+        return hashes;
+    };
+
+    const std::vector<uint64_t> first = render(true);
+    render(false);   // A regular engine in between must not change the next run
+    const std::vector<uint64_t> second = render(true);
+    ASSERT_EQ(first.size(), 3u);
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first[0], 0u);
+    EXPECT_NE(first[0], first[2]);   // Different target ages
+}
+
+TEST_F(IntegrationTest, InterleavedClipsKeepTheirOwnTracks) {
+    auto engine = ufra::createEngine();
+    ufra::ModelConfig config;
+    config.backend = ufra::GPUBackend::CPU_FALLBACK;
+    config.batch_size = 4;
+    config.temporal_coherence = true;
+    config.detection_interval = 4;
+    ASSERT_TRUE(engine->initialize(config));
+    ASSERT_TRUE(engine->loadModels(ufra::stubModelDir()));
+
+    // Clip 1 has one face and clip 2 has two
+    auto frame = [&](uint64_t clip_id, int frame_number) {
+        ufra::FrameContext context;
+        context.clip_id = clip_id;
+        context.frame_number = frame_number;
+        context.input_frame = ufra::renderStubFrame(320, 240, static_cast<int>(clip_id));
+        context.controls = age_controls;
+        context.mode = ufra::ProcessingMode::FEEDFORWARD;
+        return context;
+    };
+    auto trackIds = [](const ufra::ProcessingResult& result) {
+        std::vector<int> ids;
+        for (const ufra::Face& face : result.processed_faces) {
+            ids.push_back(face.track_id);
+        }
+        return ids;
+    };
+
+    // Both clips share batches without failing or resetting each other
+    std::vector<ufra::ProcessingResult> first =
+        engine->processBatch({frame(1, 0), frame(2, 0), frame(1, 1), frame(2, 1)});
+    std::vector<ufra::ProcessingResult> second = engine->processBatch({frame(2, 2), frame(1, 2)});
+    ASSERT_EQ(first.size(), 4u);
+    ASSERT_EQ(second.size(), 2u);
+    for (const auto* results : {&first, &second}) {
+        for (const ufra::ProcessingResult& result : *results) {
+            ASSERT_TRUE(result.success) << result.error_message;
+        }
+    }
+    const ufra::ProcessingResult* clip1[] = {&first[0], &first[2], &second[1]};
+    const ufra::ProcessingResult* clip2[] = {&first[1], &first[3], &second[0]};
+    EXPECT_EQ(clip1[0]->metrics.at("faces_detected"), 1.0f);
+    EXPECT_EQ(clip2[0]->metrics.at("faces_detected"), 1.0f);
+    for (int f = 1; f < 3; ++f) {
+        // Later frames reuse their own clip's boxes and keep their tracks
+        EXPECT_EQ(clip1[f]->metrics.at("faces_detected"), 0.0f) << "frame " << f;
+        EXPECT_EQ(clip2[f]->metrics.at("faces_detected"), 0.0f) << "frame " << f;
+        EXPECT_EQ(clip1[f]->processed_faces.size(), 1u) << "frame " << f;
+        EXPECT_EQ(clip2[f]->processed_faces.size(), 2u) << "frame " << f;
+        EXPECT_EQ(trackIds(*clip1[f]), trackIds(*clip1[0])) << "frame " << f;
+        EXPECT_EQ(trackIds(*clip2[f]), trackIds(*clip2[0])) << "frame " << f;
+    }
+}
+
+TEST_F(IntegrationTest, ExportsOpenMetrics) {
+    const std::string path = "/tmp/ufra_integration_" + std::to_string(getpid()) + ".prom";
+    auto engine = ufra::createEngine();
+    ufra::ModelConfig config;
+    config.backend = ufra::GPUBackend::CPU_FALLBACK;
+    config.batch_size = 2;
+    config.metrics_file = path;
+    ASSERT_TRUE(engine->initialize(config));
+    ASSERT_TRUE(engine->loadModels(ufra::stubModelDir()));
+
+    std::vector<ufra::FrameContext> contexts(3);
+    for (size_t i = 0; i < contexts.size(); ++i) {
+        contexts[i].frame_number = static_cast<int>(i);
+        contexts[i].input_frame = ufra::renderStubFrame(320, 240, 2);
+        contexts[i].controls = age_controls;
+        contexts[i].mode = ufra::ProcessingMode::FEEDFORWARD;
+    }
+    engine->processBatch(contexts);
+    engine.reset();   // Final write
+
+    std::ifstream file(path);
+    std::stringstream text;
+    text << file.rdbuf();
+    EXPECT_NE(text.str().find("ufra_frames_total 3\n"), std::string::npos);
+    EXPECT_NE(text.str().find("ufra_faces_total 6\n"), std::string::npos);
+    EXPECT_NE(text.str().find("ufra_stage_latency_seconds_count{stage=\"parse\"} "), std::string::npos);
+    EXPECT_NE(text.str().find("ufra_memory_bytes{category=\"models\"}"), std::string::npos);
+    std::remove(path.c_str());
+}
+
+TEST_F(IntegrationTest, AutoTunedBatchSizesAreStored) {
+    const std::string path = "/tmp/ufra_integration_tuning_" + std::to_string(getpid()) + ".tsv";
+    std::remove(path.c_str());
+    ufra::StubCost cost;
+    cost.item_ms = 1.0;
+
+    auto loadTuned = [&]() {
+        auto engine = ufra::createEngine();
+        ufra::ModelConfig config;
+        config.backend = ufra::GPUBackend::CPU_FALLBACK;
+        config.batch_size = 1;
+        config.auto_tune_batch = true;
+        config.batch_latency_cap_ms = 10.0f;
+        config.batch_tuning_file = path;
+        EXPECT_TRUE(engine->initialize(config));
+        EXPECT_TRUE(engine->loadModels(ufra::stubModelDir(cost)));
+
+        ufra::FrameContext context;
+        context.frame_number = 0;
+        context.input_frame = ufra::renderStubFrame(320, 240, 1);
+        context.controls = age_controls;
+        context.mode = ufra::ProcessingMode::FEEDFORWARD;
+        return engine->processFrame(context);
+    };
+
+    ufra::ProcessingResult swept = loadTuned();
+    ufra::ProcessingResult cached = loadTuned();
+
+    ASSERT_TRUE(swept.success) << swept.error_message;
+    ASSERT_TRUE(cached.success) << cached.error_message;
+    EXPECT_EQ(swept.metrics["batch_tuning_sweeps"], 2.0f);   // Parser and generator
+    EXPECT_EQ(cached.metrics["batch_tuning_sweeps"], 0.0f);  // Second run only looks them up
+    const float parser_batch = swept.metrics["scheduler_parser_batch_limit"];
+    EXPECT_GE(parser_batch, 1.0f);
+    EXPECT_LE(parser_batch, 8.0f);   // 1 ms per item under a 10 ms cap
+    EXPECT_EQ(cached.metrics["scheduler_parser_batch_limit"], parser_batch);
+    EXPECT_EQ(cached.metrics["scheduler_generator_batch_limit"], swept.metrics["scheduler_generator_batch_limit"]);
+
+    std::ifstream file(path);
+    std::stringstream text;
+    text << file.rdbuf();
+    EXPECT_NE(text.str().find("/face_parser/"), std::string::npos);
+    EXPECT_NE(text.str().find("/feedforward_generator/"), std::string::npos);
+    std::remove(path.c_str());
+}
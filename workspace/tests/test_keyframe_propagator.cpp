@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include "ufra/keyframe_propagator.h"
+#include <opencv2/opencv.hpp>
+
+namespace {
+
+// Textured crop with its content shifted by (dx, dy)
+cv::Mat makeCrop(int dx, int dy, int brightness = 0) {
+    cv::Mat crop(128, 128, CV_8UC3);
+    for (int y = 0; y < crop.rows; ++y) {
+        for (int x = 0; x < crop.cols; ++x) {
+            const float u = (x - dx) * 0.15f;
+            const float v = (y - dy) * 0.11f;
+            const auto value = cv::saturate_cast<uchar>(brightness + 128 + 60 * std::sin(u) * std::cos(v) +
+                                                        40 * std::sin(0.7f * u + 0.5f * v));
+            crop.at<cv::Vec3b>(y, x) = cv::Vec3b(value, value, value);
+        }
+    }
+    return crop;
+}
+
+} // namespace
+
+TEST(KeyframePropagatorTest, PropagatesKeyframeResidualAcrossSmallMotion) {
+    ufra::KeyframePropagator propagator;
+    cv::Mat key_crop = makeCrop(0, 0);
+    ufra::KeyframePropagator::Plan key_plan = propagator.plan(3, key_crop, {}, 0);
+    ASSERT_TRUE(key_plan.keyframe);
+
+    // Generator output: the keyframe crop, darkened
+    cv::Mat generated = key_crop - cv::Scalar(20, 20, 20);
+    propagator.setKeyframe(key_plan, key_crop, generated);
+
+    cv::Mat crop = makeCrop(1, 1);
+    ufra::KeyframePropagator::Plan plan = propagator.plan(3, crop, {}, 1);
+    ASSERT_FALSE(plan.keyframe);
+    EXPECT_LT(plan.change, 0.03f);
+    EXPECT_EQ(plan.key, key_plan.key);
+
+    cv::Mat output = propagator.propagate(plan, crop);
+    cv::Rect inner(16, 16, 96, 96);
+    cv::Mat expected = crop - cv::Scalar(20, 20, 20);
+    EXPECT_LT(cv::norm(output(inner), expected(inner), cv::NORM_L1) / (inner.area() * 3), 2.0);
+
+    // Same inputs, same output
+    cv::Mat again = propagator.propagate(propagator.plan(3, crop, {}, 2), crop);
+    EXPECT_EQ(cv::norm(again, output, cv::NORM_INF), 0.0);
+
+    std::map<std::string, float> stats = propagator.getStats();
+    EXPECT_FLOAT_EQ(stats["keyframes"], 1.0f);
+    EXPECT_FLOAT_EQ(stats["propagated"], 2.0f);
+}
+
+TEST(KeyframePropagatorTest, RekeysOnChangeIntervalAndInvalidation) {
+    ufra::KeyframePropagator propagator;
+    ufra::KeyframePolicy policy;
+    policy.max_interval = 4;
+    propagator.setPolicy(policy);
+    cv::Mat crop = makeCrop(0, 0);
+
+    EXPECT_TRUE(propagator.plan(1, crop, {}, 0).keyframe);
+    EXPECT_FALSE(propagator.plan(1, crop, {}, 3).keyframe);
+    EXPECT_TRUE(propagator.plan(1, crop, {}, 4).keyframe);                  // Interval reached
+    EXPECT_TRUE(propagator.plan(1, makeCrop(0, 0, 60), {}, 5).keyframe);    // Appearance change
+    EXPECT_TRUE(propagator.plan(1, cv::Mat(64, 64, CV_8UC3, cv::Scalar::all(0)), {}, 6).keyframe); // Different resolution
+    EXPECT_TRUE(propagator.plan(2, crop, {}, 6).keyframe);                  // Unknown track
+
+    propagator.invalidate(2);
+    EXPECT_TRUE(propagator.plan(2, crop, {}, 7).keyframe);
+    propagator.reset();
+    EXPECT_TRUE(propagator.plan(2, crop, {}, 8).keyframe);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "ufra/memory_budget.h"
+#include "ufra/gpu_memory_manager.h"
+
+TEST(MemoryBudgetTest, UnlimitedBudgetOnlyAccounts) {
+    ufra::MemoryBudget budget;
+    EXPECT_TRUE(budget.tryReserve(ufra::MemoryCategory::FRAMES, 1ull << 40));
+    EXPECT_EQ(budget.getPressure(), ufra::MemoryPressure::NORMAL);
+
+    budget.release(ufra::MemoryCategory::FRAMES, 1ull << 40);
+    EXPECT_EQ(budget.getTotalUsage(), 0u);
+}
+
+TEST(MemoryBudgetTest, AdmissionControl) {
+    ufra::MemoryBudget budget;
+    budget.setLimit(1000);
+    budget.setUsage(ufra::MemoryCategory::MODELS, 600);
+
+    EXPECT_TRUE(budget.tryReserve(ufra::MemoryCategory::FRAMES, 300));
+    EXPECT_FALSE(budget.tryReserve(ufra::MemoryCategory::FRAMES, 200));
+    EXPECT_EQ(budget.getUsage(ufra::MemoryCategory::FRAMES), 300u);  // Failed reservation has no effect
+    EXPECT_EQ(budget.getPressure(), ufra::MemoryPressure::HIGH);
+
+    budget.release(ufra::MemoryCategory::FRAMES, 300);
+    EXPECT_EQ(budget.getPressure(), ufra::MemoryPressure::NORMAL);
+
+    budget.setUsage(ufra::MemoryCategory::CACHES, 400);
+    EXPECT_EQ(budget.getPressure(), ufra::MemoryPressure::CRITICAL);
+}
+
+TEST(MemoryBudgetTest, ReleaseNeverUnderflows) {
+    ufra::MemoryBudget budget;
+    budget.tryReserve(ufra::MemoryCategory::CACHES, 10);
+    budget.release(ufra::MemoryCategory::CACHES, 100);
+    EXPECT_EQ(budget.getUsage(ufra::MemoryCategory::CACHES), 0u);
+}
+
+TEST(MemoryBudgetTest, MetricsReportUsage) {
+    ufra::MemoryBudget budget;
+    budget.setLimit(64u << 20);
+    budget.setUsage(ufra::MemoryCategory::MODELS, 16u << 20);
+    budget.tryReserve(ufra::MemoryCategory::FRAMES, 8u << 20);
+
+    auto metrics = budget.getMetrics();
+    EXPECT_FLOAT_EQ(metrics["memory_used_mb"], 24.0f);
+    EXPECT_FLOAT_EQ(metrics["memory_budget_mb"], 64.0f);
+    EXPECT_FLOAT_EQ(metrics["memory_models_mb"], 16.0f);
+    EXPECT_FLOAT_EQ(metrics["memory_frames_mb"], 8.0f);
+}
+
+TEST(GPUMemoryManagerTest, ReportsRealCPUNumbers) {
+    ufra::GPUMemoryManager manager;
+    ASSERT_TRUE(manager.initialize(ufra::GPUBackend::CPU_FALLBACK));
+
+    EXPECT_GT(manager.getTotalMemory(), 0u);
+    EXPECT_LE(manager.getAvailableMemory(), manager.getTotalMemory());
+    float utilization = manager.getMemoryUtilization();
+    EXPECT_GT(utilization, 0.0f);
+    EXPECT_LT(utilization, 1.0f);
+    EXPECT_EQ(manager.getBackendInfo(), "CPU");
+}
+
+TEST(GPUMemoryManagerTest, PooledAllocationsAreReused) {
+    ufra::GPUMemoryManager manager;
+    manager.initialize(ufra::GPUBackend::CPU_FALLBACK);
+    manager.enableMemoryPool(true);
+
+    void* first = manager.allocateMemory(4096);
+    ASSERT_NE(first, nullptr);
+    manager.deallocateMemory(first);
+    void* second = manager.allocateMemory(4096);
+    EXPECT_EQ(first, second);
+    manager.deallocateMemory(second);
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "ufra/metrics_exporter.h"
+#include <arpa/inet.h>
+#include <filesystem>
+#include <fstream>
+#include <netinet/in.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string httpGet(int port, const std::string& target) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return "";
+    }
+    const std::string request = "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    send(fd, request.data(), request.size(), 0);
+    std::string response;
+    char buffer[4096];
+    ssize_t received;
+    while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<size_t>(received));
+    }
+    close(fd);
+    return response;
+}
+
+bool contains(const std::string& text, const std::string& line) {
+    return text.find(line) != std::string::npos;
+}
+
+} // namespace
+
+TEST(MetricsExporterTest, HistogramMergesThreadShards) {
+    ufra::LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&histogram] {
+            for (int i = 0; i < 1000; ++i) {
+                histogram.observe(i % 2 ? 0.003 : 0.2);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    histogram.observe(60.0);
+
+    ufra::LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+    const std::vector<double>& bounds = ufra::LatencyHistogram::bucketBounds();
+    ASSERT_EQ(snapshot.buckets.size(), bounds.size() + 1);
+    EXPECT_EQ(snapshot.count, 4001u);
+    EXPECT_EQ(snapshot.buckets[3], 2000u);   // le 0.005
+    EXPECT_EQ(snapshot.buckets[8], 2000u);   // le 0.25
+    EXPECT_EQ(snapshot.buckets.back(), 1u);  // +Inf
+    EXPECT_NEAR(snapshot.sum, 2000 * 0.003 + 2000 * 0.2 + 60.0, 1e-6);
+}
+
+TEST(MetricsExporterTest, RendersOpenMetricsText) {
+    ufra::MetricsExporter exporter({"detect", "parse"});
+    exporter.observeStage("detect", 0.004);
+    exporter.observeStage("unknown", 1.0);
+    std::map<std::string, float> metrics = {{"faces_processed", 2.0f},  {"memory_models_mb", 1.5f},
+                                            {"memory_budget_mb", 0.0f}, {"result_cache_hits", 3.0f},
+                                            {"result_cache_misses", 1.0f}};
+    exporter.recordFrame(0.02, metrics);
+    exporter.recordFrame(0.03, metrics);
+    exporter.recordError();
+
+    const std::string text = exporter.render();
+    EXPECT_TRUE(contains(text, "# TYPE ufra_frames counter\n"));
+    EXPECT_TRUE(contains(text, "ufra_frames_total 2\n"));
+    EXPECT_TRUE(contains(text, "ufra_frame_errors_total 1\n"));
+    EXPECT_TRUE(contains(text, "ufra_faces_total 4\n"));
+    EXPECT_TRUE(contains(text, "ufra_stage_latency_seconds_bucket{stage=\"detect\",le=\"0.0025\"} 0\n"));
+    EXPECT_TRUE(contains(text, "ufra_stage_latency_seconds_bucket{stage=\"detect\",le=\"0.005\"} 1\n"));
+    EXPECT_TRUE(contains(text, "ufra_stage_latency_seconds_bucket{stage=\"detect\",le=\"+Inf\"} 1\n"));
+    EXPECT_TRUE(contains(text, "ufra_stage_latency_seconds_count{stage=\"parse\"} 0\n"));
+    EXPECT_FALSE(contains(text, "unknown"));
+    EXPECT_TRUE(contains(text, "ufra_frame_latency_seconds_bucket{le=\"0.025\"} 1\n"));
+    EXPECT_TRUE(contains(text, "ufra_frame_latency_seconds_count 2\n"));
+    EXPECT_TRUE(contains(text, "ufra_cache_hit_ratio{cache=\"result\"} 0.75\n"));
+    EXPECT_FALSE(contains(text, "cache=\"temporal\""));   // Never reported
+    EXPECT_TRUE(contains(text, "ufra_memory_bytes{category=\"models\"} 1572864\n"));
+    EXPECT_TRUE(contains(text, "ufra_memory_budget_bytes 0\n"));
+    EXPECT_EQ(text.substr(text.size() - 6), "# EOF\n");
+}
+
+TEST(MetricsExporterTest, ServesOverHttp) {
+    ufra::MetricsExporter exporter({"detect"});
+    ASSERT_TRUE(exporter.listen(0));
+    ASSERT_GT(exporter.getPort(), 0);
+    exporter.recordFrame(0.01, {});
+
+    const std::string response = httpGet(exporter.getPort(), "/metrics");
+    EXPECT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_TRUE(contains(response, "application/openmetrics-text"));
+    EXPECT_TRUE(contains(response, "ufra_frames_total 1\n"));
+    EXPECT_EQ(httpGet(exporter.getPort(), "/favicon.ico").rfind("HTTP/1.1 404", 0), 0u);
+
+    const int port = exporter.getPort();
+    exporter.stop();
+    EXPECT_EQ(httpGet(port, "/metrics"), "");
+}
+
+TEST(MetricsExporterTest, WritesFileUntilStopped) {
+    const fs::path path = fs::temp_directory_path() / ("ufra_metrics_" + std::to_string(getpid()) + ".prom");
+    ufra::MetricsExporter exporter({"detect"});
+    ASSERT_TRUE(exporter.writeToFile(path.string(), 60000));
+    EXPECT_FALSE(exporter.writeToFile(path.string()));
+
+    exporter.recordFrame(0.01, {});
+    exporter.recordFrame(0.01, {});
+    exporter.stop();   // Final write with the totals so far
+
+    std::ifstream file(path);
+    std::stringstream text;
+    text << file.rdbuf();
+    EXPECT_TRUE(contains(text.str(), "ufra_frames_total 2\n"));
+    EXPECT_FALSE(fs::exists(path.string() + ".tmp"));
+    fs::remove(path);
+
+    ufra::MetricsExporter unwritable({"detect"});
+    EXPECT_FALSE(unwritable.writeToFile("/nonexistent/dir/metrics.prom"));
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "ufra/perf_counters.h"
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Enough retired instructions and data traffic for every counter to move
+double work() {
+    std::vector<double> data(1 << 20, 1.0);
+    double sum = 0.0;
+    for (int pass = 0; pass < 4; ++pass) {
+        for (size_t i = 0; i < data.size(); i += 7) {
+            sum += data[i] * (i & 3 ? 1.0 : -0.5);
+        }
+    }
+    return sum;
+}
+
+} // namespace
+
+TEST(PerfCountersTest, ReportsStagesOrDegradesGracefully) {
+    ufra::StageProfiler profiler;
+    volatile double sink = 0.0;
+    {
+        ufra::StageProfiler::Scope scope(&profiler, "work");
+        sink = sink + work();
+    }
+
+    std::map<std::string, float> metrics = profiler.getMetrics();
+    if (!ufra::perfCountersAvailable()) {
+        // Containers and VMs without a PMU: a reason, and no stage metrics
+        EXPECT_FALSE(ufra::perfCountersUnavailableReason().empty());
+        EXPECT_FALSE(profiler.isAvailable());
+        EXPECT_FLOAT_EQ(metrics["perf_counters"], 0.0f);
+        EXPECT_EQ(metrics.count("perf_work_ipc"), 0u);
+        EXPECT_EQ(profiler.getTotals("work").cycles, 0u);
+        return;
+    }
+
+    EXPECT_TRUE(ufra::perfCountersUnavailableReason().empty());
+    EXPECT_FLOAT_EQ(metrics["perf_counters"], 1.0f);
+    ufra::CounterSample totals = profiler.getTotals("work");
+    EXPECT_GT(totals.cycles, 0u);
+    EXPECT_GT(totals.instructions, 1000000u);
+    EXPECT_GT(metrics["perf_work_ipc"], 0.0f);
+    EXPECT_GT(metrics["perf_work_gcycles"], 0.0f);
+}
+
+TEST(PerfCountersTest, AccumulatesAcrossThreads) {
+    ufra::StageProfiler profiler;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; ++t) {
+        threads.emplace_back([&profiler] {
+            volatile double sink = 0.0;
+            ufra::StageProfiler::Scope scope(&profiler, "threaded");
+            sink = sink + work();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ufra::CounterSample totals = profiler.getTotals("threaded");
+    if (ufra::perfCountersAvailable()) {
+        EXPECT_GT(totals.instructions, 3000000u);
+    } else {
+        EXPECT_EQ(totals.instructions, 0u);
+    }
+
+    profiler.reset();
+    EXPECT_EQ(profiler.getTotals("threaded").instructions, 0u);
+}
+
+TEST(PerfCountersTest, NullProfilerAndDeltas) {
+    {
+        ufra::StageProfiler::Scope scope(nullptr, "unused");   // Profiling off: no-op
+    }
+
+    ufra::CounterSample a, b;
+    a.cycles = 100;
+    a.instructions = 50;
+    b.cycles = 40;
+    b.instructions = 60;   // Multiplexing estimates may step backwards
+    ufra::CounterSample delta = a - b;
+    EXPECT_EQ(delta.cycles, 60u);
+    EXPECT_EQ(delta.instructions, 0u);
+    delta += a;
+    EXPECT_EQ(delta.cycles, 160u);
+}
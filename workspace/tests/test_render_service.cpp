@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include "ufra/render_service.h"
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace ufra::service;
+
+namespace {
+
+std::string testSocketPath(const char* name) {
+    return "/tmp/ufra-test-" + std::to_string(getpid()) + "-" + name + ".sock";
+}
+
+// Inverts every pixel, standing in for Engine::processBatch
+void invertFrames(std::vector<RenderJob*>& jobs) {
+    for (RenderJob* job : jobs) {
+        for (int y = 0; y < job->input.height; ++y) {
+            const uint8_t* src = job->input.data + y * job->input.stride;
+            uint8_t* dst = job->output.data + y * job->output.stride;
+            for (int x = 0; x < job->input.width * job->input.channels; ++x) {
+                dst[x] = static_cast<uint8_t>(255 - src[x]);
+            }
+        }
+        job->metrics["face_count"] = 1.0f;
+        job->success = true;
+    }
+}
+
+} // namespace
+
+TEST(RenderServiceTest, RendersThroughSharedMemory) {
+    RenderServer server;
+    ServerOptions options;
+    options.socket_path = testSocketPath("render");
+    ASSERT_TRUE(server.start(options, invertFrames));
+
+    RenderClient client;
+    ASSERT_TRUE(client.connect(options.socket_path)) << client.getLastError();
+
+    std::vector<uint8_t> pixels(4 * 3 * 3);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = static_cast<uint8_t>(i * 7);
+    }
+    FrameView input{pixels.data(), 4, 3, 3, 12};
+    FrameView output;
+    std::map<std::string, float> metrics;
+    ASSERT_TRUE(client.render(input, JobSettings(), output, &metrics)) << client.getLastError();
+
+    ASSERT_EQ(output.width, 4);
+    ASSERT_EQ(output.height, 3);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        EXPECT_EQ(output.data[i], 255 - pixels[i]);
+    }
+    EXPECT_EQ(metrics["face_count"], 1.0f);
+    EXPECT_EQ(metrics["server_batch_size"], 1.0f);
+    EXPECT_GT(metrics["client_round_trip_ms"], 0.0f);
+    EXPECT_LE(metrics["transport_overhead_ms"], metrics["client_round_trip_ms"]);
+
+    // A larger frame replaces the shared buffer; rendering straight into it
+    // skips the client-side copy
+    FrameView large = client.inputBuffer(640, 480, 3);
+    ASSERT_FALSE(large.empty());
+    std::fill(large.data, large.data + large.bytes(), 10);
+    ASSERT_TRUE(client.render(large, JobSettings(), output)) << client.getLastError();
+    EXPECT_EQ(output.data[0], 245);
+    EXPECT_EQ(output.data[large.bytes() - 1], 245);
+}
+
+TEST(RenderServiceTest, BatchesFramesAcrossClients) {
+    RenderServer server;
+    ServerOptions options;
+    options.socket_path = testSocketPath("batch");
+    options.max_batch = 2;
+    options.batch_window_us = 2000000;   // Dispatch only once both clients are queued
+    ASSERT_TRUE(server.start(options, invertFrames));
+
+    std::vector<float> batch_sizes(2, 0.0f);
+    std::vector<std::thread> clients;
+    for (int i = 0; i < 2; ++i) {
+        clients.emplace_back([&, i] {
+            RenderClient client;
+            std::vector<uint8_t> pixels(16 * 16, static_cast<uint8_t>(i));
+            FrameView output;
+            std::map<std::string, float> metrics;
+            if (client.connect(options.socket_path) &&
+                client.render(FrameView{pixels.data(), 16, 16, 1, 16}, JobSettings(), output, &metrics)) {
+                batch_sizes[i] = metrics["server_batch_size"];
+            }
+        });
+    }
+    for (auto& thread : clients) {
+        thread.join();
+    }
+
+    EXPECT_EQ(batch_sizes[0], 2.0f);
+    EXPECT_EQ(batch_sizes[1], 2.0f);
+    auto stats = server.getStats();
+    EXPECT_EQ(stats["jobs"], 2.0f);
+    EXPECT_EQ(stats["batches"], 1.0f);
+}
+
+TEST(RenderServiceTest, ForwardsClipIdAcrossConnections) {
+    RenderServer server;
+    ServerOptions options;
+    options.socket_path = testSocketPath("clip");
+    ASSERT_TRUE(server.start(options, [](std::vector<RenderJob*>& jobs) {
+        invertFrames(jobs);
+        for (RenderJob* job : jobs) {
+            job->metrics["clip_id"] = static_cast<float>(job->settings.clip_id);
+            job->metrics["client_id"] = static_cast<float>(job->client_id);
+        }
+    }));
+
+    // Two pooled connections rendering one clip, as the OpenFX plugin does
+    RenderClient first;
+    RenderClient second;
+    ASSERT_TRUE(first.connect(options.socket_path)) << first.getLastError();
+    ASSERT_TRUE(second.connect(options.socket_path)) << second.getLastError();
+    std::vector<uint8_t> pixels(4 * 4 * 3, 50);
+    JobSettings settings;
+    settings.clip_id = 77;
+    FrameView output;
+    std::map<std::string, float> first_metrics;
+    std::map<std::string, float> second_metrics;
+    ASSERT_TRUE(first.render(FrameView{pixels.data(), 4, 4, 3, 12}, settings, output, &first_metrics));
+    settings.frame_number = 1;
+    ASSERT_TRUE(second.render(FrameView{pixels.data(), 4, 4, 3, 12}, settings, output, &second_metrics));
+    EXPECT_EQ(first_metrics["clip_id"], 77.0f);
+    EXPECT_EQ(second_metrics["clip_id"], 77.0f);
+    EXPECT_NE(first_metrics["client_id"], second_metrics["client_id"]);
+}
+
+TEST(RenderServiceTest, StreamsFramesThroughRings) {
+    RenderServer server;
+    ServerOptions options;
+    options.socket_path = testSocketPath("stream");
+    ASSERT_TRUE(server.start(options, invertFrames));
+
+    RenderClient client;
+    ASSERT_TRUE(client.connect(options.socket_path));
+    ASSERT_TRUE(client.openStream(3, 32 * 32 * 3)) << client.getLastError();
+    EXPECT_TRUE(client.isStreaming());
+
+    // Keeps the pipeline full: submit until the depth is reached, then
+    // receive the oldest result before submitting the next frame
+    constexpr int kFrames = 20;
+    int received = 0;
+    for (int i = 0; i < kFrames || client.inFlight() > 0;) {
+        if (i < kFrames && client.inFlight() < 3) {
+            FrameView slot = client.streamInputBuffer(32, 32, 3);
+            ASSERT_FALSE(slot.empty()) << client.getLastError();
+            std::fill(slot.data, slot.data + slot.bytes(), static_cast<uint8_t>(i));
+            JobSettings settings;
+            settings.frame_number = i++;
+            ASSERT_TRUE(client.submit(slot, settings)) << client.getLastError();
+            continue;
+        }
+        FrameView output;
+        std::map<std::string, float> metrics;
+        ASSERT_TRUE(client.receive(output, &metrics, 5000)) << client.getLastError();
+        ASSERT_EQ(output.width, 32);
+        EXPECT_EQ(output.data[0], 255 - received);
+        EXPECT_EQ(output.data[output.bytes() - 1], 255 - received);
+        EXPECT_EQ(metrics["face_count"], 1.0f);
+        received++;
+    }
+    EXPECT_EQ(received, kFrames);
+    EXPECT_TRUE(client.streamInputBuffer(32, 32, 3).data != nullptr);
+    EXPECT_TRUE(client.streamInputBuffer(64, 64, 3).empty());   // Larger than the slots
+
+    // submit() copies frames that are not already in a slot
+    std::vector<uint8_t> pixels(8 * 8, 100);
+    ASSERT_TRUE(client.submit(FrameView{pixels.data(), 8, 8, 1, 8}, JobSettings()));
+    FrameView output;
+    ASSERT_TRUE(client.receive(output, nullptr, 5000));
+    EXPECT_EQ(output.data[63], 155);
+    EXPECT_EQ(server.getStats()["streams"], 1.0f);
+
+    uint8_t pixel[3] = {1, 2, 3};
+    EXPECT_FALSE(client.render(FrameView{pixel, 1, 1, 3, 3}, JobSettings(), output));
+
+    client.disconnect();
+    for (int i = 0; i < 100 && server.getStats()["streams"] > 0.0f; ++i) {
+        usleep(10000);
+    }
+    EXPECT_EQ(server.getStats()["streams"], 0.0f);
+}
+
+TEST(RenderServiceTest, ReportsHandlerFailureAndMissingServer) {
+    RenderServer server;
+    ServerOptions options;
+    options.socket_path = testSocketPath("fail");
+    ASSERT_TRUE(server.start(options, [](std::vector<RenderJob*>&) { throw std::runtime_error("model crashed"); }));
+
+    RenderClient client;
+    ASSERT_TRUE(client.connect(options.socket_path));
+    uint8_t pixel[3] = {1, 2, 3};
+    FrameView output;
+    EXPECT_FALSE(client.render(FrameView{pixel, 1, 1, 3, 3}, JobSettings(), output));
+    EXPECT_NE(client.getLastError().find("model crashed"), std::string::npos);
+    EXPECT_TRUE(client.isConnected());   // The service survives handler failures
+
+    server.stop();
+    RenderClient orphan;
+    EXPECT_FALSE(orphan.connect(options.socket_path));
+}
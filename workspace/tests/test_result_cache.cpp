@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "ufra/result_cache.h"
+#include <opencv2/opencv.hpp>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path freshDirectory(const std::string& name) {
+    fs::path directory = fs::temp_directory_path() / name;
+    fs::remove_all(directory);
+    return directory;
+}
+
+} // namespace
+
+TEST(ResultCacheTest, RoundTripsAcrossInstances) {
+    const fs::path directory = freshDirectory("ufra_result_cache_roundtrip");
+    cv::Mat frame(64, 64, CV_8UC3);
+    cv::randu(frame, 0, 255);
+    cv::Mat roi = frame(cv::Rect(8, 8, 32, 32));
+    cv::Mat result(32, 32, CV_8UC3, cv::Scalar(10, 20, 30));
+    cv::Mat mask(32, 32, CV_8UC1, cv::Scalar(3));
+    const ufra::ResultKey key = ufra::ResultCache::makeKey(roi, 42);
+
+    {
+        ufra::ResultCache cache;
+        ASSERT_TRUE(cache.open(directory.string(), 1 << 20));
+        cv::Mat loaded, loaded_mask;
+        EXPECT_FALSE(cache.load(key, loaded, loaded_mask));
+        EXPECT_TRUE(cache.store(key, result, mask));
+    }
+
+    ufra::ResultCache cache;
+    ASSERT_TRUE(cache.open(directory.string(), 1 << 20));
+    cv::Mat loaded, loaded_mask;
+    ASSERT_TRUE(cache.load(key, loaded, loaded_mask));
+    EXPECT_EQ(cv::norm(loaded, result, cv::NORM_INF), 0.0);
+    EXPECT_EQ(cv::norm(loaded_mask, mask, cv::NORM_INF), 0.0);
+
+    // Any change to the pixels or the context is a different address
+    EXPECT_FALSE(cache.load(ufra::ResultCache::makeKey(roi, 43), loaded, loaded_mask));
+    cv::Mat edited = roi.clone();
+    edited.at<cv::Vec3b>(5, 5)[0] ^= 1;
+    EXPECT_FALSE(cache.load(ufra::ResultCache::makeKey(edited, 42), loaded, loaded_mask));
+    EXPECT_EQ(ufra::ResultCache::makeKey(roi.clone(), 42).hex(), key.hex());
+
+    std::map<std::string, float> stats = cache.getStats();
+    EXPECT_FLOAT_EQ(stats["hits"], 1.0f);
+    EXPECT_FLOAT_EQ(stats["misses"], 2.0f);
+    EXPECT_FLOAT_EQ(stats["bytes_saved"], static_cast<float>(result.total() * result.elemSize()));
+    fs::remove_all(directory);
+}
+
+TEST(ResultCacheTest, EvictsLeastRecentlyUsedBeyondLimit) {
+    const fs::path directory = freshDirectory("ufra_result_cache_evict");
+    cv::Mat result(64, 64, CV_8UC3, cv::Scalar::all(1));
+    const size_t entry_bytes = result.total() * result.elemSize();
+    ufra::ResultCache cache;
+    ASSERT_TRUE(cache.open(directory.string(), entry_bytes * 3 + entry_bytes / 2));
+
+    std::vector<ufra::ResultKey> keys;
+    for (int i = 0; i < 3; ++i) {
+        cv::Mat roi(16, 16, CV_8UC3, cv::Scalar::all(i));
+        keys.push_back(ufra::ResultCache::makeKey(roi, 0));
+        ASSERT_TRUE(cache.store(keys.back(), result, cv::Mat()));
+    }
+    cv::Mat loaded, mask;
+    ASSERT_TRUE(cache.load(keys[0], loaded, mask));   // Now most recently used
+
+    cv::Mat roi(16, 16, CV_8UC3, cv::Scalar::all(9));
+    ASSERT_TRUE(cache.store(ufra::ResultCache::makeKey(roi, 0), result, cv::Mat()));
+    EXPECT_TRUE(cache.load(keys[0], loaded, mask));
+    EXPECT_FALSE(cache.load(keys[1], loaded, mask));
+    EXPECT_TRUE(cache.load(keys[2], loaded, mask));
+    EXPECT_FLOAT_EQ(cache.getStats()["evictions"], 1.0f);
+    fs::remove_all(directory);
+}
+
+TEST(ResultCacheTest, RejectsCorruptEntryHeaders) {
+    const fs::path directory = freshDirectory("ufra_result_cache_corrupt");
+    cv::Mat result(32, 32, CV_8UC3, cv::Scalar(10, 20, 30));
+    ufra::ResultCache cache;
+    ASSERT_TRUE(cache.open(directory.string(), 1 << 20));
+    EXPECT_FALSE(cache.store(ufra::ResultCache::makeKey(result, 1), cv::Mat(32, 32, CV_32FC1), cv::Mat()));
+
+    // {rows, cols, type} headers a corrupt file could carry: far more pixels
+    // than the file holds, and a type entries are never written with
+    const int32_t headers[][3] = {{1 << 20, 1 << 20, CV_8UC3}, {32, 32, CV_32FC1}, {32, 32, CV_8UC4}};
+    for (int i = 0; i < 3; ++i) {
+        const ufra::ResultKey key = ufra::ResultCache::makeKey(result, 100 + i);
+        ASSERT_TRUE(cache.store(key, result, cv::Mat()));
+        fs::path entry;
+        for (const auto& file : fs::recursive_directory_iterator(directory)) {
+            if (file.is_regular_file() && file.path().stem() == key.hex()) {
+                entry = file.path();
+            }
+        }
+        ASSERT_FALSE(entry.empty());
+        {
+            std::fstream file(entry, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(8);   // Past magic and version
+            file.write(reinterpret_cast<const char*>(headers[i]), sizeof(headers[i]));
+        }
+        cv::Mat loaded, mask;
+        EXPECT_FALSE(cache.load(key, loaded, mask));
+        EXPECT_FALSE(fs::exists(entry));   // Dropped, not retried
+    }
+    fs::remove_all(directory);
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include "ufra/roi_skip_cache.h"
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> makeRoi(int width, int height, int offset) {
+    std::vector<uint8_t> roi(static_cast<size_t>(width) * height * 3);
+    for (size_t i = 0; i < roi.size(); ++i) {
+        roi[i] = static_cast<uint8_t>((i * 7 + offset) % 200 + 20);
+    }
+    return roi;
+}
+
+} // namespace
+
+TEST(RoiSkipCacheTest, ReusesUnchangedRoisOnly) {
+    const int width = 96, height = 112;
+    std::vector<uint8_t> roi = makeRoi(width, height, 0);
+    ufra::RoiSignature signature = ufra::computeRoiSignature(roi.data(), width, height, width * 3, 3);
+    ufra::RoiSkipCache cache;
+    ufra::ImageData result;
+    ufra::MaskImage mask;
+    EXPECT_FALSE(cache.lookup(4, signature, 1, result, mask));
+    cache.store(4, signature, 1, ufra::ImageData(), ufra::MaskImage());
+
+    bool exact = false;
+    EXPECT_TRUE(cache.lookup(4, signature, 1, result, mask, &exact));
+    EXPECT_TRUE(exact);
+    EXPECT_FALSE(cache.lookup(4, signature, 2, result, mask));   // Controls changed
+
+    // Noise of one level survives; a local change does not
+    std::vector<uint8_t> noisy = roi;
+    for (size_t i = 0; i < noisy.size(); i += 97) {
+        noisy[i] = static_cast<uint8_t>(noisy[i] + 1);
+    }
+    ufra::RoiSignature near = ufra::computeRoiSignature(noisy.data(), width, height, width * 3, 3);
+    EXPECT_TRUE(cache.lookup(4, near, 1, result, mask));
+
+    std::vector<uint8_t> blink = roi;
+    for (int y = 30; y < 40; ++y) {
+        for (int x = 20; x < 40; ++x) {
+            blink[(static_cast<size_t>(y) * width + x) * 3] = 0;
+        }
+    }
+    ufra::RoiSignature changed = ufra::computeRoiSignature(blink.data(), width, height, width * 3, 3);
+    EXPECT_FALSE(cache.lookup(4, changed, 1, result, mask));
+
+    cache.invalidate(4);
+    EXPECT_FALSE(cache.lookup(4, signature, 1, result, mask));
+    std::map<std::string, float> stats = cache.getStats();
+    EXPECT_FLOAT_EQ(stats["hits"], 2.0f);
+    EXPECT_FLOAT_EQ(stats["exact_hits"], 1.0f);
+    EXPECT_FLOAT_EQ(stats["misses"], 4.0f);
+}
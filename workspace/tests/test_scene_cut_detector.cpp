@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "ufra/scene_cut_detector.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// Smooth "shot": a lit blob on a background, offset by (dx, dy)
+std::vector<uint8_t> makeShot(int width, int height, int background, int dx, int dy) {
+    std::vector<uint8_t> frame(static_cast<size_t>(width) * height * 3);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const float fx = static_cast<float>(x - dx) / width - 0.4f;
+            const float fy = static_cast<float>(y - dy) / height - 0.5f;
+            const int value = background + static_cast<int>(150.0f * std::exp(-(fx * fx + fy * fy) * 12.0f));
+            uint8_t* pixel = &frame[(static_cast<size_t>(y) * width + x) * 3];
+            pixel[0] = static_cast<uint8_t>(std::min(255, value));
+            pixel[1] = static_cast<uint8_t>(std::min(255, value + 10));
+            pixel[2] = static_cast<uint8_t>(std::min(255, value / 2));
+        }
+    }
+    return frame;
+}
+
+} // namespace
+
+TEST(SceneCutDetectorTest, MotionIsNotACutButANewShotIs) {
+    const int width = 640, height = 360;
+    ufra::SceneCutDetector detector;
+    std::vector<uint8_t> first = makeShot(width, height, 30, 0, 0);
+    EXPECT_FALSE(detector.update(first.data(), width, height, width * 3, 3));
+
+    // Same shot, camera drifting
+    for (int frame = 1; frame <= 5; ++frame) {
+        std::vector<uint8_t> moved = makeShot(width, height, 30, frame * 4, frame * 2);
+        EXPECT_FALSE(detector.update(moved.data(), width, height, width * 3, 3)) << "frame " << frame;
+        EXPECT_LT(detector.getLastScore(), detector.getThreshold());
+    }
+
+    // Different shot: bright background, subject elsewhere
+    std::vector<uint8_t> cut = makeShot(width, height, 160, 250, -60);
+    EXPECT_TRUE(detector.update(cut.data(), width, height, width * 3, 3));
+    EXPECT_EQ(detector.getCutCount(), 1u);
+
+    detector.reset();
+    EXPECT_FALSE(detector.update(first.data(), width, height, width * 3, 3));
+}
+
+TEST(SceneCutDetectorTest, FourKFrameCostsWellUnderAMillisecond) {
+    const int width = 3840, height = 2160;
+    std::vector<uint8_t> a = makeShot(width, height, 30, 0, 0);
+    std::vector<uint8_t> b = makeShot(width, height, 160, 900, 0);
+    ufra::SceneCutDetector detector;
+
+    const int frames = 40;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        const std::vector<uint8_t>& frame = (i / 10) % 2 ? b : a;
+        detector.update(frame.data(), width, height, width * 3, 3);
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+    EXPECT_EQ(detector.getCutCount(), 3u);
+#if !defined(__OPTIMIZE__) || defined(__SANITIZE_ADDRESS__)
+    GTEST_SKIP() << "Timing needs an optimized, uninstrumented build; " << ms << " ms per frame";
+#endif
+    EXPECT_LT(ms, 1.0);   // About 0.4 ms at -O2
+}
+
+TEST(SceneCutDetectorTest, ReportsRepeatsAndPulldownCadence) {
+    const int width = 640, height = 360;
+    ufra::SceneCutDetector detector;
+
+    // 24 fps motion telecined to 30: every fifth frame repeats the one before
+    int source = 0;
+    for (int frame = 0; frame < 20; ++frame) {
+        const bool repeat = frame % 5 == 3;
+        source += repeat ? 0 : 1;
+        std::vector<uint8_t> image = makeShot(width, height, 30, source * 6, 0);
+        detector.update(image.data(), width, height, width * 3, 3);
+        EXPECT_EQ(detector.isRepeat(), repeat) << "frame " << frame;
+    }
+    EXPECT_EQ(detector.getRepeatCount(), 4u);
+    EXPECT_EQ(detector.getPulldownPhase(), 3);
+
+    // A hold repeats every frame, which is not a cadence
+    detector.reset();
+    std::vector<uint8_t> still = makeShot(width, height, 30, 0, 0);
+    for (int frame = 0; frame < 12; ++frame) {
+        detector.update(still.data(), width, height, width * 3, 3);
+    }
+    EXPECT_TRUE(detector.isRepeat());
+    EXPECT_EQ(detector.getPulldownPhase(), -1);
+}
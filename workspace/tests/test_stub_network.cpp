@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include "ufra/stub_network.h"
+#include "ufra/face_detector.h"
+#include "ufra/face_parser.h"
+#include "ufra/feedforward_generator.h"
+#include "ufra/inference_session.h"
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+TEST(StubNetworkTest, ParsesKindAndCostFromPath) {
+    ufra::StubCost cost;
+    cost.call_ms = 1.5;
+    cost.item_ms = 0.25;
+    const std::string dir = ufra::stubModelDir(cost);
+    EXPECT_TRUE(ufra::isStubModelPath(dir));
+    EXPECT_FALSE(ufra::isStubModelPath("/models/face_parser.onnx"));
+
+    auto network = ufra::StubNetwork::create(dir + "/diffusion_editor/unet.onnx");
+    ASSERT_NE(network, nullptr);
+    EXPECT_EQ(network->getKind(), "unet");
+    EXPECT_DOUBLE_EQ(network->getCost().call_ms, 1.5);
+    EXPECT_DOUBLE_EQ(network->getCost().item_ms, 0.25);
+
+    EXPECT_EQ(ufra::StubNetwork::create(dir + "/segmenter.onnx"), nullptr);
+    EXPECT_EQ(ufra::SharedModel::load(dir + "/segmenter.onnx", ufra::GPUBackend::CPU_FALLBACK), nullptr);
+}
+
+TEST(StubNetworkTest, SpendsConfiguredCostPerCall) {
+    ufra::StubCost cost;
+    cost.call_ms = 5.0;
+    cost.item_ms = 5.0;
+    auto model = ufra::SharedModel::load(ufra::stubModelDir(cost) + "/face_parser.onnx",
+                                         ufra::GPUBackend::CPU_FALLBACK);
+    ASSERT_NE(model, nullptr);
+    EXPECT_EQ(model->getWeightBytes(), 0u);
+
+    auto session = model->createSession();
+    const int shape[4] = {2, 3, 16, 16};
+    session->setInput(cv::Mat(4, shape, CV_32F, cv::Scalar(0)));
+    auto start = std::chrono::steady_clock::now();
+    cv::Mat output = session->forward();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_GE(ms, 15.0);   // 5 ms per call + 5 ms per item, two items
+    EXPECT_EQ(output.dims, 4);
+    EXPECT_EQ(output.size[1], 19);
+}
+
+TEST(StubNetworkTest, DeterministicModelsAreSharedSeparately) {
+    const std::string path = ufra::stubModelDir() + "/face_parser.onnx";
+    auto deterministic = ufra::SharedModel::load(path, ufra::GPUBackend::CUDA, true);
+    auto regular = ufra::SharedModel::load(path, ufra::GPUBackend::CUDA);
+    ASSERT_NE(deterministic, nullptr);
+    ASSERT_NE(regular, nullptr);
+    EXPECT_NE(deterministic, regular);
+    EXPECT_TRUE(deterministic->isDeterministic());
+    EXPECT_EQ(deterministic->getBackend(), ufra::GPUBackend::CPU_FALLBACK);
+    EXPECT_FALSE(regular->isDeterministic());
+    EXPECT_EQ(regular->getBackend(), ufra::GPUBackend::CUDA);   // Not switched by the earlier load
+    EXPECT_EQ(ufra::SharedModel::load(path, ufra::GPUBackend::CPU_FALLBACK, true), deterministic);
+}
+
+TEST(StubNetworkTest, DetectorFindsRenderedFaces) {
+    ufra::FaceDetector detector;
+    ASSERT_TRUE(detector.loadModel(ufra::stubModelDir() + "/face_detector.onnx"));
+
+    cv::Mat frame = ufra::renderStubFrame(640, 480, 2);
+    std::vector<ufra::Face> faces = detector.detectFaces(frame);
+    std::vector<ufra::FaceBox> layout = ufra::stubFaceLayout(640, 480, 2);
+    ASSERT_EQ(faces.size(), layout.size());
+
+    std::sort(faces.begin(), faces.end(), [](const ufra::Face& a, const ufra::Face& b) { return a.box.x < b.box.x; });
+    for (size_t i = 0; i < layout.size(); ++i) {
+        EXPECT_NEAR(faces[i].box.x, layout[i].x, 4.0f);
+        EXPECT_NEAR(faces[i].box.y, layout[i].y, 4.0f);
+        EXPECT_NEAR(faces[i].box.width, layout[i].width, 6.0f);
+        EXPECT_NEAR(faces[i].box.height, layout[i].height, 6.0f);
+    }
+
+    EXPECT_TRUE(detector.detectFaces(ufra::renderStubFrame(640, 480, 0)).empty());
+}
+
+TEST(StubNetworkTest, ParserLabelsByGeometry) {
+    ufra::FaceParser parser;
+    ASSERT_TRUE(parser.loadModel(ufra::stubModelDir() + "/face_parser.onnx"));
+
+    cv::Mat crop(256, 256, CV_8UC3, cv::Scalar(150, 170, 210));
+    cv::Mat mask = parser.parseFace(crop);
+    ASSERT_EQ(mask.size(), crop.size());
+    EXPECT_EQ(mask.at<uchar>(2, 2), 0);        // background
+    EXPECT_EQ(mask.at<uchar>(140, 128), 2);    // nose
+    EXPECT_EQ(mask.at<uchar>(160, 60), 1);     // cheek
+    EXPECT_EQ(mask.at<uchar>(107, 97), 4);     // left eye
+    EXPECT_EQ(mask.at<uchar>(40, 128), 13);    // hair
+    EXPECT_GT(cv::countNonZero(parser.getEyesMask(mask)), 0);
+}
+
+TEST(StubNetworkTest, GeneratorAgesWithTarget) {
+    ufra::FeedforwardGenerator generator;
+    ASSERT_TRUE(generator.loadModel(ufra::stubModelDir() + "/feedforward_generator.onnx"));
+    generator.setInputResolution(128, 128);
+
+    cv::Mat face(128, 128, CV_8UC3, cv::Scalar(150, 170, 210));
+    ufra::AgeControls young, old;
+    young.target_age = 20.0f;
+    old.target_age = 80.0f;
+    young.identity_lock_strength = old.identity_lock_strength = 0.0f;
+
+    cv::Scalar young_mean = cv::mean(generator.generateAgedFace(face, young, cv::Mat()));
+    cv::Scalar old_mean = cv::mean(generator.generateAgedFace(face, old, cv::Mat()));
+    EXPECT_LT(old_mean[0] + old_mean[1] + old_mean[2], young_mean[0] + young_mean[1] + young_mean[2]);
+    EXPECT_LT(std::abs(old_mean[2] - old_mean[0]), std::abs(young_mean[2] - young_mean[0]));   // Desaturated
+}
+
+TEST(StubNetworkTest, BatchesRunInOneNetworkCall) {
+    ufra::StubCost cost;
+    cost.call_ms = 30.0;
+    ufra::FaceParser parser;
+    ufra::FeedforwardGenerator generator;
+    ASSERT_TRUE(parser.loadModel(ufra::stubModelDir(cost) + "/face_parser.onnx"));
+    ASSERT_TRUE(generator.loadModel(ufra::stubModelDir(cost) + "/feedforward_generator.onnx"));
+    parser.setInputSize(64, 64);
+    generator.setInputResolution(64, 64);
+
+    std::vector<cv::Mat> crops;
+    std::vector<ufra::AgeControls> controls(4);
+    for (int i = 0; i < 4; ++i) {
+        crops.push_back(cv::Mat(64, 64, CV_8UC3, cv::Scalar(150, 170, 210 - 10 * i)));
+        controls[i].target_age = 20.0f + 20.0f * i;
+        controls[i].identity_lock_strength = 0.0f;
+        controls[i].enable_hair_aging = false;
+    }
+    crops.push_back(cv::Mat());   // Passed through, not sent to the network
+    controls.push_back(controls[0]);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<cv::Mat> masks = parser.parseFacesBatch(crops);
+    std::vector<cv::Mat> aged = generator.generateAgedFacesBatch(crops, controls, {});
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_LT(ms, 4 * cost.call_ms);   // One call per network, not one per crop
+
+    // Split back per crop, each with its own target age
+    ASSERT_EQ(masks.size(), crops.size());
+    ASSERT_EQ(aged.size(), crops.size());
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(cv::norm(masks[i], parser.parseFace(crops[i]), cv::NORM_INF), 0.0);
+        EXPECT_EQ(cv::norm(aged[i], generator.generateAgedFace(crops[i], controls[i], cv::Mat()), cv::NORM_INF), 0.0);
+    }
+    EXPECT_TRUE(masks[4].empty());
+    EXPECT_TRUE(aged[4].empty());
+}
+
+TEST(StubNetworkTest, PooledSessionsShareWeightsAndAreReclaimed) {
+    auto model = ufra::SharedModel::load(ufra::stubModelDir() + "/face_parser.onnx", ufra::GPUBackend::CPU_FALLBACK);
+    ASSERT_NE(model, nullptr);
+    const size_t weight_bytes = model->getWeightBytes();
+    const size_t loaded_bytes = ufra::getLoadedModelBytes();
+    ufra::SessionPool pool(model);
+
+    // Each wave holds one session per thread at once, then the threads exit
+    const int threads = 4;
+    auto wave = [&] {
+        std::mutex mutex;
+        std::condition_variable all_leased;
+        int leased = 0;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                auto lease = pool.acquire();
+                std::unique_lock<std::mutex> lock(mutex);
+                if (++leased == threads) {
+                    all_leased.notify_all();
+                }
+                all_leased.wait(lock, [&] { return leased == threads; });
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    };
+
+    wave();
+    EXPECT_EQ(pool.getSessionCount(), static_cast<size_t>(threads));
+    EXPECT_EQ(model->getWeightBytes(), weight_bytes);
+    EXPECT_EQ(ufra::getLoadedModelBytes(), loaded_bytes);
+
+    // Sessions of exited threads are reused rather than added to
+    for (int i = 0; i < 3; ++i) {
+        wave();
+    }
+    EXPECT_EQ(pool.getSessionCount(), static_cast<size_t>(threads));
+    EXPECT_EQ(model->getWeightBytes(), weight_bytes);
+    EXPECT_EQ(ufra::getLoadedModelBytes(), loaded_bytes);
+
+    pool.acquire(7);
+    EXPECT_EQ(pool.getSessionCount(), static_cast<size_t>(threads));   // From the idle list
+    pool.release(7);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "ufra/temporal_cache.h"
+#include <opencv2/opencv.hpp>
+
+namespace {
+
+// Textured crop with its content shifted by (dx, dy)
+cv::Mat makeCrop(int dx, int dy) {
+    cv::Mat crop(128, 128, CV_8UC3);
+    for (int y = 0; y < crop.rows; ++y) {
+        for (int x = 0; x < crop.cols; ++x) {
+            const float u = (x - dx) * 0.15f;
+            const float v = (y - dy) * 0.11f;
+            const auto value = cv::saturate_cast<uchar>(128 + 60 * std::sin(u) * std::cos(v) + 40 * std::sin(0.7f * u + 0.5f * v));
+            crop.at<cv::Vec3b>(y, x) = cv::Vec3b(value, value, value);
+        }
+    }
+    return crop;
+}
+
+} // namespace
+
+TEST(TemporalCacheTest, WarpsPreviousResultOntoCurrentCrop) {
+    ufra::TemporalCache cache;
+    cv::Mat previous = makeCrop(0, 0);
+    cv::Mat noise(previous.size(), CV_32FC3, cv::Scalar(0.5f, -0.5f, 1.0f));
+    cache.store(7, previous, previous, noise, 10);
+
+    cv::Mat current = makeCrop(2, 1);
+    ufra::TemporalPrior prior = cache.lookup(7, current, 11);
+    ASSERT_TRUE(prior.valid);
+    EXPECT_EQ(prior.frame_gap, 1);
+    EXPECT_EQ(prior.result.size(), current.size());
+    EXPECT_EQ(prior.state.type(), CV_32FC3);
+    EXPECT_LT(prior.residual, 0.02f);
+
+    // The stored result follows the motion: it matches the current crop
+    // far better than the unwarped previous frame does
+    cv::Rect inner(16, 16, 96, 96);
+    EXPECT_LT(cv::norm(prior.result(inner), current(inner), cv::NORM_L1),
+              0.3 * cv::norm(previous(inner), current(inner), cv::NORM_L1));
+}
+
+TEST(TemporalCacheTest, MissesOnGapsSizeChangesAndInvalidation) {
+    ufra::TemporalCache cache;
+    cv::Mat crop = makeCrop(0, 0);
+    cache.store(1, crop, crop, cv::Mat(), 0);
+
+    EXPECT_FALSE(cache.lookup(1, crop, 5).valid);                    // Beyond the max frame gap
+    EXPECT_FALSE(cache.lookup(1, cv::Mat(64, 64, CV_8UC3), 1).valid); // Different resolution
+    EXPECT_FALSE(cache.lookup(2, crop, 1).valid);                    // Unknown track
+    EXPECT_TRUE(cache.lookup(1, crop, 1).valid);
+
+    cache.invalidate(1);
+    EXPECT_FALSE(cache.lookup(1, crop, 1).valid);
+
+    cache.recordFrameSteps(30);
+    cache.recordFrameSteps(10);
+    std::map<std::string, float> stats = cache.getStats();
+    EXPECT_FLOAT_EQ(stats["mean_steps_per_frame"], 20.0f);
+    EXPECT_FLOAT_EQ(stats["hits"], 1.0f);
+    EXPECT_FLOAT_EQ(stats["misses"], 4.0f);
+}
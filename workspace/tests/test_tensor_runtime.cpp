@@ -0,0 +1,306 @@
+#include <gtest/gtest.h>
+#include "ufra/tensor_runtime.h"
+#include <cmath>
+#include <cstring>
+
+using namespace ufra::runtime;
+
+namespace {
+
+// Minimal protobuf encoder for building ONNX models in memory
+struct Proto {
+    std::string bytes;
+
+    Proto& varint(int field, uint64_t value) {
+        key(field, 0);
+        raw(value);
+        return *this;
+    }
+    Proto& string(int field, const std::string& value) {
+        key(field, 2);
+        raw(value.size());
+        bytes += value;
+        return *this;
+    }
+    Proto& message(int field, const Proto& value) { return string(field, value.bytes); }
+    Proto& packed(int field, const std::vector<int64_t>& values) {
+        Proto body;
+        for (int64_t v : values) {
+            body.raw(static_cast<uint64_t>(v));
+        }
+        return string(field, body.bytes);
+    }
+
+private:
+    void key(int field, int wire_type) { raw(static_cast<uint64_t>(field) << 3 | wire_type); }
+    void raw(uint64_t value) {
+        do {
+            uint8_t byte = value & 0x7F;
+            value >>= 7;
+            bytes.push_back(static_cast<char>(value ? byte | 0x80 : byte));
+        } while (value);
+    }
+};
+
+Proto valueInfo(const std::string& name, const std::vector<int64_t>& dims) {
+    Proto shape;
+    for (int64_t d : dims) {
+        shape.message(1, Proto().varint(1, d));
+    }
+    Proto tensor_type;
+    tensor_type.varint(1, 1).message(2, shape);
+    return Proto().string(1, name).message(2, Proto().message(1, tensor_type));
+}
+
+Node makeNode(const std::string& op, std::vector<std::string> inputs, std::vector<std::string> outputs) {
+    Node node;
+    node.op_type = op;
+    node.name = op;
+    node.inputs = std::move(inputs);
+    node.outputs = std::move(outputs);
+    return node;
+}
+
+} // namespace
+
+TEST(TensorRuntimeTest, ParsesOnnxConvModel) {
+    // 1x1x3x3 input, one 3x3 kernel of ones, pads 1: each output is the sum
+    // of its 3x3 neighbourhood
+    std::vector<float> weights(9, 1.0f);
+    std::string raw(reinterpret_cast<const char*>(weights.data()), weights.size() * sizeof(float));
+
+    Proto node;
+    node.string(1, "x").string(1, "w").string(2, "y").string(3, "conv").string(4, "Conv")
+        .message(5, Proto().string(1, "pads").packed(8, {1, 1, 1, 1}).varint(20, 7));
+    Proto initializer;
+    initializer.packed(1, {1, 1, 3, 3}).varint(2, 1).string(8, "w").string(9, raw);
+    Proto graph;
+    graph.message(1, node).message(5, initializer)
+        .message(11, valueInfo("x", {1, 1, 3, 3})).message(12, valueInfo("y", {1, 1, 3, 3}));
+    Proto model;
+    model.varint(1, 8).message(7, graph);
+
+    Graph parsed;
+    std::string error;
+    ASSERT_TRUE(parseOnnxModel(reinterpret_cast<const uint8_t*>(model.bytes.data()),
+                               model.bytes.size(), parsed, error)) << error;
+    ASSERT_EQ(parsed.nodes.size(), 1u);
+    EXPECT_EQ(parsed.nodes[0].getInts("pads"), std::vector<int64_t>({1, 1, 1, 1}));
+    ASSERT_EQ(parsed.inputs.size(), 1u);
+    EXPECT_EQ(parsed.inputs[0].shape, std::vector<int64_t>({1, 1, 3, 3}));
+
+    Network net;
+    ASSERT_TRUE(net.load(std::move(parsed))) << net.getLastError();
+    net.setInput(Tensor({1, 1, 3, 3}, std::vector<float>(9, 1.0f)));
+    std::vector<Tensor> outputs;
+    ASSERT_TRUE(net.forward(outputs)) << net.getLastError();
+    ASSERT_EQ(outputs.size(), 1u);
+    EXPECT_EQ(outputs[0].data, std::vector<float>({4, 6, 4, 6, 9, 6, 4, 6, 4}));
+}
+
+TEST(TensorRuntimeTest, RejectsTruncatedModel) {
+    std::string bytes = "\x3a\x10\x0a";
+    Graph graph;
+    std::string error;
+    EXPECT_FALSE(parseOnnxModel(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size(), graph, error));
+    EXPECT_FALSE(error.empty());
+}
+
+TEST(TensorRuntimeTest, RunsClassifierGraph) {
+    // Conv(stride 2) -> BatchNorm -> Relu -> GlobalAveragePool -> Flatten -> Gemm -> Softmax
+    Graph graph;
+    graph.inputs.push_back({"x", {1, 2, 4, 4}});
+    graph.outputs.push_back({"prob", {1, 3}});
+    graph.initializers["w"] = Tensor({4, 2, 1, 1}, {1, 0, 0, 1, 1, 1, -1, -1});
+    graph.initializers["scale"] = Tensor({4}, {1, 1, 1, 1});
+    graph.initializers["shift"] = Tensor({4}, {0, 0, 0, 0});
+    graph.initializers["mean"] = Tensor({4}, {0, 0, 0, 0});
+    graph.initializers["var"] = Tensor({4}, {1, 1, 1, 1});
+    graph.initializers["fc"] = Tensor({3, 4}, {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 1});
+    graph.initializers["fc_b"] = Tensor({3}, {0, 0, 0});
+
+    Node conv = makeNode("Conv", {"x", "w"}, {"c"});
+    conv.int_lists["strides"] = {2, 2};
+    graph.nodes.push_back(conv);
+    Node bn = makeNode("BatchNormalization", {"c", "scale", "shift", "mean", "var"}, {"b"});
+    bn.floats["epsilon"] = 0.0f;
+    graph.nodes.push_back(bn);
+    graph.nodes.push_back(makeNode("Relu", {"b"}, {"r"}));
+    graph.nodes.push_back(makeNode("GlobalAveragePool", {"r"}, {"g"}));
+    graph.nodes.push_back(makeNode("Flatten", {"g"}, {"f"}));
+    Node fc = makeNode("Gemm", {"f", "fc", "fc_b"}, {"logits"});
+    fc.ints["transB"] = 1;
+    graph.nodes.push_back(fc);
+    graph.nodes.push_back(makeNode("Softmax", {"logits"}, {"prob"}));
+
+    Network net;
+    ASSERT_TRUE(net.load(std::move(graph))) << net.getLastError();
+
+    // Channel 0 is all 1, channel 1 all 2
+    Tensor x({1, 2, 4, 4});
+    std::fill(x.data.begin(), x.data.begin() + 16, 1.0f);
+    std::fill(x.data.begin() + 16, x.data.end(), 2.0f);
+    net.setInput(x, "x");
+
+    std::vector<Tensor> outputs;
+    ASSERT_TRUE(net.forward(outputs)) << net.getLastError();
+    ASSERT_EQ(outputs[0].shape, std::vector<int64_t>({1, 3}));
+
+    // Pooled features (1, 2, 3, 0) -> logits (1, 2, 3)
+    float e1 = std::exp(1.0f), e2 = std::exp(2.0f), e3 = std::exp(3.0f);
+    EXPECT_NEAR(outputs[0].data[0], e1 / (e1 + e2 + e3), 1e-5f);
+    EXPECT_NEAR(outputs[0].data[2], e3 / (e1 + e2 + e3), 1e-5f);
+}
+
+TEST(TensorRuntimeTest, BroadcastsPerChannelBias) {
+    Graph graph;
+    graph.inputs.push_back({"x", {1, 2, 1, 2}});
+    graph.outputs.push_back({"y", {}});
+    graph.initializers["bias"] = Tensor({1, 2, 1, 1}, {10, 20});
+    graph.nodes.push_back(makeNode("Add", {"x", "bias"}, {"y"}));
+
+    Network net;
+    ASSERT_TRUE(net.load(std::move(graph)));
+    net.setInput(Tensor({1, 2, 1, 2}, {1, 2, 3, 4}));
+    std::vector<Tensor> outputs;
+    ASSERT_TRUE(net.forward(outputs));
+    EXPECT_EQ(outputs[0].data, std::vector<float>({11, 12, 23, 24}));
+}
+
+TEST(TensorRuntimeTest, ResizesNearestAndLinear) {
+    Graph graph;
+    graph.inputs.push_back({"x", {1, 1, 1, 2}});
+    graph.outputs.push_back({"near", {}});
+    graph.outputs.push_back({"lin", {}});
+    graph.initializers["scales"] = Tensor({4}, {1, 1, 1, 2});
+    graph.initializers["roi"] = Tensor({0});
+
+    Node nearest = makeNode("Resize", {"x", "roi", "scales"}, {"near"});
+    nearest.strings["coordinate_transformation_mode"] = "asymmetric";
+    nearest.strings["nearest_mode"] = "floor";
+    graph.nodes.push_back(nearest);
+    Node linear = makeNode("Resize", {"x", "roi", "scales"}, {"lin"});
+    linear.strings["mode"] = "linear";
+    graph.nodes.push_back(linear);
+
+    Network net;
+    ASSERT_TRUE(net.load(std::move(graph))) << net.getLastError();
+    net.setInput(Tensor({1, 1, 1, 2}, {0, 4}));
+    std::vector<Tensor> outputs;
+    ASSERT_TRUE(net.forward(outputs)) << net.getLastError();
+    EXPECT_EQ(outputs[0].data, std::vector<float>({0, 0, 4, 4}));
+    EXPECT_EQ(outputs[1].data, std::vector<float>({0, 1, 3, 4}));
+}
+
+TEST(TensorRuntimeTest, ReportsUnsupportedOperator) {
+    Graph graph;
+    graph.inputs.push_back({"x", {1}});
+    graph.outputs.push_back({"y", {1}});
+    graph.nodes.push_back(makeNode("NonMaxSuppression", {"x"}, {"y"}));
+
+    Network net;
+    EXPECT_FALSE(net.load(std::move(graph)));
+    EXPECT_NE(net.getLastError().find("NonMaxSuppression"), std::string::npos);
+}
+
+TEST(TensorRuntimeTest, PackedConvMatchesReference) {
+    // Conv -> BatchNorm -> activation over grouped, depthwise, strided,
+    // dilated and padded shapes; fusion must not change the result
+    struct Case {
+        int in_channels, out_channels, group, kernel, stride, dilation, pad;
+        const char* activation;
+    };
+    const std::vector<Case> cases = {
+        {3, 16, 1, 3, 1, 1, 1, "Relu"},
+        {8, 21, 1, 3, 2, 1, 1, "LeakyRelu"},
+        {12, 12, 12, 3, 1, 1, 1, "Clip"},       // Depthwise
+        {12, 12, 12, 5, 2, 1, 2, "Relu"},       // Strided depthwise
+        {8, 12, 4, 3, 1, 2, 2, ""},             // Grouped and dilated
+        {5, 7, 1, 1, 1, 1, 0, "Relu"},          // Pointwise
+    };
+
+    uint32_t seed = 12345;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f;
+    };
+    auto fill = [&random](std::vector<int64_t> shape, float offset) {
+        Tensor t(std::move(shape));
+        for (float& v : t.data) {
+            v = random() + offset;
+        }
+        return t;
+    };
+
+    for (const Case& c : cases) {
+        const int64_t oc = c.out_channels;
+        Graph graph;
+        graph.inputs.push_back({"x", {2, c.in_channels, 13, 11}});
+        graph.outputs.push_back({"y", {}});
+        graph.initializers["w"] = fill({oc, c.in_channels / c.group, c.kernel, c.kernel}, 0.0f);
+        graph.initializers["b"] = fill({oc}, 0.0f);
+        graph.initializers["scale"] = fill({oc}, 1.5f);
+        graph.initializers["shift"] = fill({oc}, 0.0f);
+        graph.initializers["mean"] = fill({oc}, 0.0f);
+        graph.initializers["var"] = fill({oc}, 2.0f);
+
+        Node conv = makeNode("Conv", {"x", "w", "b"}, {"c"});
+        conv.ints["group"] = c.group;
+        conv.int_lists["strides"] = {c.stride, c.stride};
+        conv.int_lists["dilations"] = {c.dilation, c.dilation};
+        conv.int_lists["pads"] = {c.pad, c.pad, c.pad, c.pad};
+        graph.nodes.push_back(conv);
+        const std::string activation = c.activation;
+        graph.nodes.push_back(makeNode("BatchNormalization", {"c", "scale", "shift", "mean", "var"},
+                                       {activation.empty() ? "y" : "bn"}));
+        if (!activation.empty()) {
+            Node act = makeNode(activation, {"bn"}, {"y"});
+            act.floats["alpha"] = 0.1f;
+            act.floats["min"] = 0.0f;
+            act.floats["max"] = 0.5f;
+            graph.nodes.push_back(act);
+        }
+
+        Network reference, optimized;
+        reference.enableOptimizations(false);
+        ASSERT_TRUE(reference.load(graph)) << reference.getLastError();
+        ASSERT_TRUE(optimized.load(graph)) << optimized.getLastError();
+
+        Tensor x = fill({2, c.in_channels, 13, 11}, 0.0f);
+        reference.setInput(x);
+        optimized.setInput(x);
+        std::vector<Tensor> expected, actual;
+        ASSERT_TRUE(reference.forward(expected)) << reference.getLastError();
+        ASSERT_TRUE(optimized.forward(actual)) << optimized.getLastError();
+
+        ASSERT_EQ(actual[0].shape, expected[0].shape);
+        for (size_t i = 0; i < expected[0].size(); ++i) {
+            ASSERT_NEAR(actual[0].data[i], expected[0].data[i], 1e-4f)
+                << "case " << (&c - cases.data()) << " index " << i;
+        }
+    }
+}
+
+TEST(TensorRuntimeTest, SerializedGraphRoundTrips) {
+    Graph graph;
+    graph.inputs.push_back({"x", {1, 2, -1, 4}});
+    graph.outputs.push_back({"y", {}});
+    graph.initializers["w"] = Tensor({3, 2, 1, 1}, {1, 2, 3, 4, 5, 6});
+    Node conv = makeNode("Conv", {"x", "w"}, {"y"});
+    conv.int_lists["strides"] = {1, 1};
+    conv.strings["auto_pad"] = "VALID";
+    conv.floats["unused"] = 0.5f;
+    graph.nodes.push_back(conv);
+
+    std::string bytes;
+    serializeOnnxModel(graph, bytes);
+    Graph parsed;
+    std::string error;
+    ASSERT_TRUE(parseOnnxModel(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size(), parsed, error)) << error;
+    ASSERT_EQ(parsed.nodes.size(), 1u);
+    EXPECT_EQ(parsed.nodes[0].getInts("strides"), std::vector<int64_t>({1, 1}));
+    EXPECT_EQ(parsed.nodes[0].getString("auto_pad", ""), "VALID");
+    EXPECT_FLOAT_EQ(parsed.nodes[0].getFloat("unused", 0.0f), 0.5f);
+    EXPECT_EQ(parsed.inputs[0].shape, std::vector<int64_t>({1, 2, -1, 4}));
+    EXPECT_EQ(parsed.initializers["w"].data, graph.initializers["w"].data);
+}